@@ -0,0 +1,93 @@
+#version 440
+
+/*
+ * Bitonic sort of the alive list by SortKeys, largest key first (back to front). The list must
+ * be a power of two long, and at least SORT_BLOCK_SIZE long
+ *
+ * Steps that only compare elements within a block of SORT_BLOCK_SIZE are done in shared memory,
+ * so the whole sort takes one dispatch for the first log2(SORT_BLOCK_SIZE) stages, then for each
+ * larger stage one dispatch per step that crosses blocks, plus one for the rest of the stage
+*/
+
+// Must match ParticleSystem::SORT_GROUP_SIZE
+#define SORT_GROUP_SIZE 512
+#define SORT_BLOCK_SIZE (SORT_GROUP_SIZE * 2)
+
+layout (local_size_x = SORT_GROUP_SIZE) in;
+
+#include "../fragments/particle_buffers.glsl"
+
+#define MODE_LOCAL_SORT  0
+#define MODE_GLOBAL_STEP 1
+#define MODE_LOCAL_MERGE 2
+
+uniform int  u_Mode;
+// The size of the sequences being merged in this stage
+uniform int  u_Stage;
+// The distance between compared elements, only used for global steps
+uniform int  u_Step;
+
+shared float s_Keys[SORT_BLOCK_SIZE];
+shared uint  s_Values[SORT_BLOCK_SIZE];
+
+// Gets the index of the first element in the pair that this thread compares
+uint GetPairIndex(uint thread, uint step) {
+    return 2 * step * (thread / step) + (thread % step);
+}
+
+// Returns true if the elements with the given keys need to be swapped. Sequences alternate
+// between descending and ascending, based on which half of the stage the element is in
+bool ShouldSwap(uint globalIndex, uint stage, float keyA, float keyB) {
+    bool descending = (globalIndex & stage) == 0;
+    return descending ? keyA < keyB : keyA > keyB;
+}
+
+void LocalCompare(uint stage, uint step) {
+    uint a = GetPairIndex(gl_LocalInvocationID.x, step);
+    uint b = a + step;
+    uint globalIndex = gl_WorkGroupID.x * SORT_BLOCK_SIZE + a;
+    if (ShouldSwap(globalIndex, stage, s_Keys[a], s_Keys[b])) {
+        float key = s_Keys[a]; s_Keys[a] = s_Keys[b]; s_Keys[b] = key;
+        uint value = s_Values[a]; s_Values[a] = s_Values[b]; s_Values[b] = value;
+    }
+}
+
+void main() {
+    if (u_Mode == MODE_GLOBAL_STEP) {
+        uint a = GetPairIndex(gl_GlobalInvocationID.x, uint(u_Step));
+        uint b = a + uint(u_Step);
+        if (ShouldSwap(a, uint(u_Stage), SortKeys[a], SortKeys[b])) {
+            float key = SortKeys[a]; SortKeys[a] = SortKeys[b]; SortKeys[b] = key;
+            uint value = AliveList[a]; AliveList[a] = AliveList[b]; AliveList[b] = value;
+        }
+        return;
+    }
+
+    // Load our block into shared memory, each thread handles 2 elements
+    uint base = gl_WorkGroupID.x * SORT_BLOCK_SIZE;
+    uint local = gl_LocalInvocationID.x;
+    s_Keys[local] = SortKeys[base + local];
+    s_Keys[local + SORT_GROUP_SIZE] = SortKeys[base + local + SORT_GROUP_SIZE];
+    s_Values[local] = AliveList[base + local];
+    s_Values[local + SORT_GROUP_SIZE] = AliveList[base + local + SORT_GROUP_SIZE];
+
+    if (u_Mode == MODE_LOCAL_SORT) {
+        for (uint stage = 2; stage <= SORT_BLOCK_SIZE; stage <<= 1) {
+            for (uint step = stage >> 1; step > 0; step >>= 1) {
+                barrier();
+                LocalCompare(stage, step);
+            }
+        }
+    } else {
+        for (uint step = SORT_BLOCK_SIZE >> 1; step > 0; step >>= 1) {
+            barrier();
+            LocalCompare(uint(u_Stage), step);
+        }
+    }
+    barrier();
+
+    SortKeys[base + local] = s_Keys[local];
+    SortKeys[base + local + SORT_GROUP_SIZE] = s_Keys[local + SORT_GROUP_SIZE];
+    AliveList[base + local] = s_Values[local];
+    AliveList[base + local + SORT_GROUP_SIZE] = s_Values[local + SORT_GROUP_SIZE];
+}
@@ -0,0 +1,80 @@
+#version 440
+
+// One work group per emitter, each thread spawns every 64th particle
+layout (local_size_x = 64) in;
+
+#include "../fragments/particle_buffers.glsl"
+#include "../fragments/math_constants.glsl"
+
+// Must match ParticleSystem::GpuEmitter
+struct Emitter {
+    // Local space position in xyz, cone angle in radians in w
+    vec4 PositionCone;
+    // Local space initial velocity in xyz
+    vec4 Velocity;
+    vec4 Color;
+    // Min and max lifetime of spawned particles
+    vec2 LifetimeRange;
+    // The number of particles to spawn this step
+    uint SpawnCount;
+    uint Seed;
+};
+
+layout (std430, binding = 7) readonly buffer b_ParticleEmitters {
+    Emitter Emitters[];
+};
+
+uniform mat4  u_ModelMatrix;
+uniform float u_TimeStep;
+
+// See https://www.reedbeta.com/blog/hash-functions-for-gpu-rendering/
+uint PcgHash(uint value) {
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// Returns a random number between 0 and 1, and advances the seed
+float Random(inout uint seed) {
+    seed = PcgHash(seed);
+    return float(seed) / 4294967295.0;
+}
+
+void main() {
+    Emitter emitter = Emitters[gl_WorkGroupID.x];
+
+    vec3 origin   = (u_ModelMatrix * vec4(emitter.PositionCone.xyz, 1)).xyz;
+    vec3 velocity = mat3(u_ModelMatrix) * emitter.Velocity.xyz;
+    float speed   = length(velocity);
+
+    // Build a basis around the emit direction so we can scatter particles within the cone
+    vec3 forward = speed > 0 ? velocity / speed : vec3(0, 0, 1);
+    vec3 side    = normalize(cross(forward, abs(forward.z) < 0.99 ? vec3(0, 0, 1) : vec3(1, 0, 0)));
+    vec3 up      = cross(side, forward);
+    float cosCone = cos(emitter.PositionCone.w);
+
+    for (uint ix = gl_LocalInvocationID.x; ix < emitter.SpawnCount; ix += gl_WorkGroupSize.x) {
+        // Pop a free slot off the dead list, if it's empty we put the count back and stop
+        int slot = int(atomicAdd(DeadCount, 0xFFFFFFFFu)) - 1;
+        if (slot < 0) {
+            atomicAdd(DeadCount, 1u);
+            break;
+        }
+        uint index = DeadList[slot];
+        uint seed = PcgHash(emitter.Seed ^ PcgHash(ix));
+
+        // Pick a direction uniformly within the cone
+        float cosAngle = mix(1.0, cosCone, Random(seed));
+        float sinAngle = sqrt(max(1.0 - cosAngle * cosAngle, 0.0));
+        float spin     = Random(seed) * M_2PI;
+        vec3  dir      = forward * cosAngle + (side * cos(spin) + up * sin(spin)) * sinAngle;
+
+        float lifetime = mix(emitter.LifetimeRange.x, emitter.LifetimeRange.y, Random(seed));
+        // Spread spawns over the time step, so that fast emitters don't spawn in clumps
+        float age = Random(seed) * u_TimeStep;
+
+        Positions[index]  = vec4(origin + dir * speed * age, lifetime);
+        Velocities[index] = vec4(dir * speed, lifetime);
+        Colors[index]     = emitter.Color;
+    }
+}
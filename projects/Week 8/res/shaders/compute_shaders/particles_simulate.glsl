@@ -0,0 +1,37 @@
+#version 440
+
+layout (local_size_x = 256) in;
+
+#include "../fragments/particle_buffers.glsl"
+
+uniform vec3  u_Gravity;
+uniform float u_TimeStep;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(Positions.length())) {
+        return;
+    }
+
+    // Dead particles have no lifetime left, and are already on the dead list
+    vec4 position = Positions[index];
+    if (position.w <= 0) {
+        return;
+    }
+
+    position.w -= u_TimeStep;
+    if (position.w <= 0) {
+        Positions[index].w = 0;
+        DeadList[atomicAdd(DeadCount, 1u)] = index;
+        return;
+    }
+
+    // Update position and apply forces
+    vec3 velocity = Velocities[index].xyz;
+    position.xyz += velocity * u_TimeStep;
+    velocity     += u_Gravity * u_TimeStep;
+
+    Positions[index] = position;
+    Velocities[index].xyz = velocity;
+    AliveList[atomicAdd(AliveCount, 1u)] = index;
+}
@@ -0,0 +1,23 @@
+#version 440
+
+layout (local_size_x = 256) in;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/particle_buffers.glsl"
+
+#define FLT_MAX 3.402823466e+38
+
+void main() {
+    uint ix = gl_GlobalInvocationID.x;
+    if (ix >= uint(SortKeys.length())) {
+        return;
+    }
+
+    // Sort by distance in front of the camera, the padding past the end of the alive list
+    // gets a key lower than any particle so it ends up at the back
+    if (ix < AliveCount) {
+        SortKeys[ix] = -(u_View * vec4(Positions[AliveList[ix]].xyz, 1)).z;
+    } else {
+        SortKeys[ix] = -FLT_MAX;
+    }
+}
@@ -2,12 +2,8 @@
 
 #include "../fragments/fs_common_inputs.glsl"
 #include "../fragments/frame_uniforms.glsl"
+#include "../fragments/gbuffer_output.glsl"
 
-// We output a single color to the color buffer
-layout(location = 0) out vec4 albedo_specPower;
-layout(location = 1) out vec4 normal_metallic;
-layout(location = 2) out vec4 emissive;
-layout(location = 3) out vec3 view_pos;
 
 // Represents a collection of attributes that would define a material
 // For instance, you can think of this like material settings in 
@@ -42,9 +38,6 @@ void main() {
 		discard;
 	}
 
-	// Extract albedo from material, and store shininess
-	albedo_specPower = vec4(albedoColor.rgb, lightingParams.x);
-	
 	// Normalize our input normal
     // Read our tangent from the map, and convert from the [0,1] range to [-1,1] range
     vec3 normal = texture(u_Material.NormalMap, inUV).rgb;
@@ -52,13 +45,7 @@ void main() {
 
     // Here we apply the TBN matrix to transform the normal from tangent space to view space
     normal = normalize(inTBN * normal);
-	
-	// Map [-1, 1] to [0, 1]
-	normal = clamp((normal + 1) / 2.0, 0, 1);
-	normal_metallic = vec4(normal, lightingParams.y);
 
-	// Extract emissive from the material
-	emissive = texture(u_Material.EmissiveMap, inUV);
-	
-	view_pos = inViewPos;
+	// Store albedo and shininess, the normal, and emissive from the material
+	WriteGBuffer(albedoColor.rgb, lightingParams.x, normal, lightingParams.y, texture(u_Material.EmissiveMap, inUV), inViewPos);
 }
\ No newline at end of file
@@ -19,5 +19,8 @@ void main() {
     vec3 specular = texture(s_SpecularAccumulation, inUV).rgb;
     vec4 emissive = texture(s_Emissive, inUV);
 
-	outColor = vec4(albedo * (diffuse + specular + (emissive.rgb * emissive.a)), 1.0);
+    // The compact G-Buffer stores emissive pre-multiplied, with metallic in alpha
+    vec3 emission = IsFlagSet(FLAG_COMPACT_GBUFFER) ? emissive.rgb : emissive.rgb * emissive.a;
+
+	outColor = vec4(albedo * (diffuse + specular + emission), 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 440
+
+layout(location = 0) in vec2 inUV;
+
+uniform layout(binding=0) sampler2D s_Depth;
+
+// Copies depth from the G-Buffer into the currently bound depth buffer, 
+// should be used with color writes disabled
+void main() {
+    gl_FragDepth = texelFetch(s_Depth, ivec2(gl_FragCoord.xy), 0).r;
+}
@@ -34,11 +34,7 @@ uniform Material u_Material;
 ///////////// Application Level Uniforms ///////////////////////
 ////////////////////////////////////////////////////////////////
 
-// We output a single color to the color buffer
-layout(location = 0) out vec4 albedo_specPower;
-layout(location = 1) out vec4 normal_metallic;
-layout(location = 2) out vec4 emissive;
-layout(location = 3) out vec3 view_pos;
+#include "../fragments/gbuffer_output.glsl"
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
@@ -53,9 +49,6 @@ void main() {
 		discard;
 	}
 
-	// Extract albedo from material, and store shininess
-	albedo_specPower = vec4(albedoColor.rgb, u_Material.Shininess);
-	
 	// Normalize our input normal
 	vec3 normal = normalize(
 		texture(u_Material.NormalMapA, inUV).rgb * inTextureWeights.x +
@@ -65,15 +58,12 @@ void main() {
 	
     // Here we apply the TBN matrix to transform the normal from tangent space to view space
     normal = normalize(inTBN * normal);
-	
-	// Map [-1, 1] to [0, 1]
-	normal = clamp((normal + 1) / 2.0, 0, 1);
-	normal_metallic = vec4(normal, 0.0f);
 
 	// Extract emissive from the material
-	emissive = 
+	vec4 emission = 
 		texture(u_Material.EmissiveA, inUV).rgba * inTextureWeights.x +
 		texture(u_Material.EmissiveB, inUV).rgba * inTextureWeights.y;
-		
-	view_pos = inViewPos;
+
+	// Store albedo and shininess, the normal, and emissive
+	WriteGBuffer(albedoColor.rgb, u_Material.Shininess, normal, 0.0f, emission, inViewPos);
 }
\ No newline at end of file
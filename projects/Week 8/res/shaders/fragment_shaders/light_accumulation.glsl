@@ -29,10 +29,10 @@ layout (std140, binding = 2) uniform b_LightBlock {
 	mat3  EnvironmentRotation;
 };
 
-#include "../fragments/deferred_post_common.glsl"
-
 #include "../fragments/frame_uniforms.glsl"
 
+#include "../fragments/deferred_post_common.glsl"
+
 // Calculates the contribution the given point light has 
 // for the current fragment
 // @param viewPos   The fragment's position in view space
@@ -0,0 +1,66 @@
+#version 440
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outDiffuse;
+layout(location = 1) out vec4 outSpecular;
+
+#include "../fragments/frame_uniforms.glsl"
+
+#include "../fragments/deferred_post_common.glsl"
+
+#include "../fragments/clustered_lights.glsl"
+
+// Calculates the contribution the given point light has 
+// for the current fragment, this matches light_accumulation.glsl
+// but fades out at the light's range
+// @param viewPos   The fragment's position in view space
+// @param normal    The fragment's normal (normalized)
+// @param Light     The light to caluclate the contribution for
+// @param shininess The specular power for the fragment, between 0 and 1
+void CalcPointLightContribution(vec3 viewPos, vec3 normal, ClusterLight light, float shininess, inout vec3 diffuse, inout vec3 specular) {
+        vec3 lightVec = light.PositionRadius.xyz - viewPos;
+        float dist = length(lightVec);
+        vec3 lightDir = lightVec / dist;
+
+        // Same falloff as the fullscreen path, where the attenuation factor is derived from the range
+        float radius = light.PositionRadius.w;
+        float attenuationFactor = 1.0 / (1.0 + radius);
+        float attenuation = clamp(1.0 / (1.0 + attenuationFactor * pow(dist, 2)), 0, 256);
+        attenuation *= CalcRangeFalloff(dist, radius);
+
+        // Dot product between normal and light
+        float NdotL = max(dot(normal, lightDir), 0.0);
+        diffuse += NdotL * attenuation * light.ColorIntensity.w * light.ColorIntensity.rgb;
+        
+        vec3 reflectDir = reflect(lightDir, normal);
+        float VdotR = pow(max(dot(normalize(-viewPos), reflectDir), 0.0), pow(2, shininess * 8));
+        
+        specular += VdotR * light.ColorIntensity.rgb * shininess * attenuation * light.ColorIntensity.w;
+}
+
+void main() {
+    vec3 normal = GetNormal(inUV);
+    
+    if (length(normal) < 0.1) {
+        discard;
+    }
+
+    normal = normalize(normal);
+
+    vec3 viewPos = GetViewPosition(inUV);
+    
+    float specularPow = texture(s_AlbedoSpec, inUV).a;
+
+    // Only shade against the lights that were binned into our cluster
+    uvec2 range = ClusterRanges[GetClusterIndex(inUV, viewPos.z)];
+
+    vec3 diffuse = vec3(0);
+    vec3 specular = vec3(0);
+    for (uint ix = 0; ix < range.y; ix++) {
+        ClusterLight light = ClusterLights[ClusterLightIndices[range.x + ix]];
+        CalcPointLightContribution(viewPos, normal, light, specularPow, diffuse, specular);
+    }
+
+    outDiffuse = vec4(diffuse, 1);
+    outSpecular = vec4(specular, 1);
+}
@@ -0,0 +1,52 @@
+#version 440
+
+layout(location = 0) out vec4 outDiffuse;
+layout(location = 1) out vec4 outSpecular;
+
+#include "../fragments/frame_uniforms.glsl"
+
+#include "../fragments/deferred_post_common.glsl"
+
+// The light's position in view space (xyz) and it's range (w)
+uniform vec4 u_LightPosRadius;
+// The light's color (rgb) and intensity (a)
+uniform vec4 u_LightColorIntensity;
+
+// Shades a single light, this matches light_clustered.glsl so that
+// the two lighting modes can be compared
+void main() {
+    // We're drawing a mesh instead of a fullscreen quad, so we work out our UV from the pixel coords
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(s_Depth, 0));
+
+    vec3 normal = GetNormal(uv);
+    if (length(normal) < 0.1) {
+        discard;
+    }
+    normal = normalize(normal);
+
+    vec3 viewPos = GetViewPosition(uv);
+    float shininess = texture(s_AlbedoSpec, uv).a;
+
+    vec3 lightVec = u_LightPosRadius.xyz - viewPos;
+    float dist = length(lightVec);
+    vec3 lightDir = lightVec / dist;
+
+    // Same falloff as the fullscreen path, but fades out at the light's range so
+    // there's no visible edge where the volume ends
+    float radius = u_LightPosRadius.w;
+    float attenuationFactor = 1.0 / (1.0 + radius);
+    float attenuation = clamp(1.0 / (1.0 + attenuationFactor * pow(dist, 2)), 0, 256);
+    float ratio = dist / radius;
+    float falloff = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    attenuation *= falloff * falloff;
+
+    float NdotL = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = NdotL * attenuation * u_LightColorIntensity.a * u_LightColorIntensity.rgb;
+
+    vec3 reflectDir = reflect(lightDir, normal);
+    float VdotR = pow(max(dot(normalize(-viewPos), reflectDir), 0.0), pow(2, shininess * 8));
+    vec3 specular = VdotR * u_LightColorIntensity.rgb * shininess * attenuation * u_LightColorIntensity.a;
+
+    outDiffuse = vec4(diffuse, 1);
+    outSpecular = vec4(specular, 1);
+}
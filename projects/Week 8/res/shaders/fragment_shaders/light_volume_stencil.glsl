@@ -0,0 +1,6 @@
+#version 440
+
+// Used when marking light volumes in the stencil buffer, we only care
+// about the depth and stencil results so there's nothing to output
+void main() {
+}
@@ -4,10 +4,8 @@ layout (location = 0) in vec4 fragColor;
 layout (location = 1) in flat uint outType;
 layout (location = 2) in vec3 viewPos;
 
-layout(location = 0) out vec4 albedo_specPower;
-layout(location = 1) out vec4 normal_metallic;
-layout(location = 2) out vec4 emissive;
-layout(location = 3) out vec3 view_pos;
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/gbuffer_output.glsl"
 
 #define TYPE_EMITTER 0
 #define TYPE_PARTICLE 1
@@ -17,9 +15,6 @@ void main() {
 		discard;
 	}
 
-	albedo_specPower = fragColor;
-	normal_metallic = vec4(0.5, 0.5, 1, 0);
-	emissive = vec4(0);
-	view_pos = viewPos;
+	WriteGBuffer(fragColor.rgb, fragColor.a, vec3(0, 0, 1), 0.0, vec4(0), viewPos);
 }
 
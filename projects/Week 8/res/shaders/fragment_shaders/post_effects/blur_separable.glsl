@@ -0,0 +1,27 @@
+#version 430
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+uniform layout(binding = 0) sampler2D s_Image;
+
+// Must match SeparableBlur::MAX_SAMPLES
+#define MAX_SAMPLES 33
+
+// Offsets (in pixels) and weights for each sample, element 0 is the center pixel. The
+// other samples sit between two pixels so that bilinear filtering blends both of them,
+// and are taken on both sides of the center
+uniform float u_Offsets[MAX_SAMPLES];
+uniform float u_Weights[MAX_SAMPLES];
+uniform int   u_SampleCount;
+// The size of one pixel along the direction we're blurring, in UV space
+uniform vec2  u_Step;
+
+void main() {
+    vec3 result = texture(s_Image, inUV).rgb * u_Weights[0];
+    for (int ix = 1; ix < u_SampleCount; ix++) {
+        vec2 offset = u_Step * u_Offsets[ix];
+        result += (texture(s_Image, inUV + offset).rgb + texture(s_Image, inUV - offset).rgb) * u_Weights[ix];
+    }
+    outColor = result;
+}
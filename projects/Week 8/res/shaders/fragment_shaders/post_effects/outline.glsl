@@ -21,11 +21,21 @@ uniform float u_DepthNormThresholdScale;
 uniform vec2  u_PixelSize;
 
 #include "../../fragments/frame_uniforms.glsl"
+#include "../../fragments/normal_encoding.glsl"
+
+// Reads a view space normal, handling both G-Buffer layouts
+vec3 ReadNormal(vec2 uv) {
+    if (IsFlagSet(FLAG_COMPACT_GBUFFER)) {
+        return OctahedralDecode(texture(s_Normals, uv).rg);
+    } else {
+        return texture(s_Normals, uv).rgb * 2 - 1;
+    }
+}
 
 void main() {
 
     float depth = texture(s_Depth, inUV).r;
-    vec3 norm = texture(s_Normals, inUV).rgb * 2 - 1;
+    vec3 norm = ReadNormal(inUV);
 
     float halfScale = u_Scale * 0.5f;
 
@@ -42,10 +52,10 @@ void main() {
     float d3 = texture(s_Depth, u3).r;
 
     // Grab normals
-    vec3 n0 = texture(s_Normals, u0).rgb * 2 - 1;
-    vec3 n1 = texture(s_Normals, u1).rgb * 2 - 1;
-    vec3 n2 = texture(s_Normals, u2).rgb * 2 - 1;
-    vec3 n3 = texture(s_Normals, u3).rgb * 2 - 1;
+    vec3 n0 = ReadNormal(u0);
+    vec3 n1 = ReadNormal(u1);
+    vec3 n2 = ReadNormal(u2);
+    vec3 n3 = ReadNormal(u3);
 
     // Compute a threshold term based on the dot product between the camera and the normal
     float nDotV = 1 - dot(norm, -inViewDir);
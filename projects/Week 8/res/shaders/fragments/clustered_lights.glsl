@@ -0,0 +1,60 @@
+/*
+ * This is a partial file that declares the light lists built by LightClusterGrid,
+ * see Graphics/LightClusterGrid.h for how the clusters are laid out
+ *
+ * Usage:
+ * uint cluster = GetClusterIndex(uv, viewPos.z);
+ * uvec2 range = ClusterRanges[cluster];
+ * for (uint ix = 0; ix < range.y; ix++) {
+ *     ClusterLight light = ClusterLights[ClusterLightIndices[range.x + ix]];
+ * }
+*/
+
+// Must match the values in LightClusterGrid.h
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES  24
+
+// Represents a single point light
+struct ClusterLight {
+    // View space position in xyz, range in w
+    vec4 PositionRadius;
+    // Color in rgb, intensity in w
+    vec4 ColorIntensity;
+};
+
+layout (std430, binding = 0) readonly buffer b_ClusterLights {
+    ClusterLight ClusterLights[];
+};
+
+// The offset (x) and count (y) of each cluster's lights in ClusterLightIndices
+layout (std430, binding = 1) readonly buffer b_ClusterRanges {
+    uvec2 ClusterRanges[];
+};
+
+layout (std430, binding = 2) readonly buffer b_ClusterLightIndices {
+    uint ClusterLightIndices[];
+};
+
+// Converts log(depth) into a depth slice index, scale in x and bias in y
+uniform vec2 u_ClusterSliceScaleBias;
+
+// Gets the index of the cluster that contains a fragment
+// @param uv    The fragment's screen UV, between 0 and 1
+// @param viewZ The fragment's Z coordinate in view space
+uint GetClusterIndex(vec2 uv, float viewZ) {
+    uvec2 tile = uvec2(clamp(uv * vec2(CLUSTER_TILES_X, CLUSTER_TILES_Y), vec2(0), vec2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1)));
+    float slice = floor(log(max(-viewZ, 0.0001)) * u_ClusterSliceScaleBias.x + u_ClusterSliceScaleBias.y);
+    uint z = uint(clamp(slice, 0, CLUSTER_SLICES - 1));
+    return tile.x + CLUSTER_TILES_X * (tile.y + CLUSTER_TILES_Y * z);
+}
+
+// Smoothly fades a light's contribution to zero at it's range, so that lights can be
+// culled at their range without a visible edge
+// @param dist   The distance from the light to the fragment
+// @param radius The range of the light
+float CalcRangeFalloff(float dist, float radius) {
+    float ratio = dist / radius;
+    float falloff = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return falloff * falloff;
+}
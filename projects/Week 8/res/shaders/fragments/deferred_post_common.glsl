@@ -1,3 +1,7 @@
+// Samplers and helpers for reading the G-Buffer, frame_uniforms.glsl must be included first
+// See gbuffer_output.glsl for the layouts
+
+#include "normal_encoding.glsl"
 
 uniform layout(binding=0) sampler2D s_Depth;
 uniform layout(binding=1) sampler2D s_AlbedoSpec;
@@ -5,15 +9,44 @@ uniform layout(binding=2) sampler2D s_NormalsMetallic;
 uniform layout(binding=3) sampler2D s_Emissive;
 uniform layout(binding=4) sampler2D s_Position;
 
-
+// Gets the view space normal, or a zero vector where nothing was drawn
 vec3 GetNormal(vec2 uv) {
-    return ((texture(s_NormalsMetallic, uv).xyz) * 2) - 1;
+    if (IsFlagSet(FLAG_COMPACT_GBUFFER)) {
+        // Every encoded value is a valid normal, so we use depth to find empty pixels
+        return texture(s_Depth, uv).r < 1.0 ? OctahedralDecode(texture(s_NormalsMetallic, uv).rg) : vec3(0);
+    } else {
+        return ((texture(s_NormalsMetallic, uv).xyz) * 2) - 1;
+    }
 }
 
 vec3 GetAlbedo(vec2 uv) {
     return texture(s_AlbedoSpec, uv).rgb;
 }
 
+// Rebuilds the view space position from the depth buffer
+vec3 ReconstructViewPosition(vec2 uv) {
+    float depth = texture(s_Depth, uv).r;
+    vec2 ndc = uv * 2 - 1;
+
+    // Perspective projection, get linear depth from the clip planes and scale the ray
+    // through this pixel on the near plane out to that depth
+    if (u_Projection[3][3] == 0.0) {
+        float viewZ = -(2 * u_ZNear * u_ZFar) / (u_ZFar + u_ZNear - (depth * 2 - 1) * (u_ZFar - u_ZNear));
+        vec4 nearPos = u_InverseProjection * vec4(ndc, -1, 1);
+        nearPos.xyz /= nearPos.w;
+        return nearPos.xyz * (viewZ / nearPos.z);
+    }
+    // Orthographic depth is already linear, so we can just un-project
+    else {
+        vec4 viewPos = u_InverseProjection * vec4(ndc, depth * 2 - 1, 1);
+        return viewPos.xyz / viewPos.w;
+    }
+}
+
 vec3 GetViewPosition(vec2 uv) {
-    return texture(s_Position, uv).rgb;
-}
\ No newline at end of file
+    if (IsFlagSet(FLAG_COMPACT_GBUFFER)) {
+        return ReconstructViewPosition(uv);
+    } else {
+        return texture(s_Position, uv).rgb;
+    }
+}
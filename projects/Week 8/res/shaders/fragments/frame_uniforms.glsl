@@ -6,6 +6,8 @@ layout (std140, binding = 0) uniform b_FrameLevelUniforms {
     uniform mat4 u_Projection;
     // The combined viewProject matrix
     uniform mat4 u_ViewProjection;
+    // The inverse of the projection matrix, for going from clip space back to view space
+    uniform mat4 u_InverseProjection;
     // The position of the camera in world space
     uniform vec4  u_CamPos;
     // The time in seconds since the start of the application
@@ -20,6 +22,8 @@ layout (std140, binding = 0) uniform b_FrameLevelUniforms {
     uniform float u_ZFar;
 };
 
+// Instanced vertex shaders get these values from per-instance attributes instead, see vs_common.glsl
+#ifndef INSTANCED
 // Stores uniforms that change every object/instance
 layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     // Complete MVP
@@ -31,8 +35,10 @@ layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     // Normal Matrix for transforming normals
     uniform mat4 u_NormalMatrix;
 };
+#endif
 
 #define FLAG_ENABLE_COLOR_CORRECTION (1 << 0)
+#define FLAG_COMPACT_GBUFFER         (1 << 1)
 
 bool IsFlagSet(uint flag) {
     return (u_Flags & flag) != 0;
@@ -0,0 +1,41 @@
+// Outputs for shaders that write to the G-Buffer, frame_uniforms.glsl must be included first
+//
+// Standard layout:
+//  0: albedo (rgb), specular power (a)
+//  1: normal (rgb, mapped to [0, 1]), metallic (a)
+//  2: emissive (rgb), emissive strength (a)
+//  3: view space position
+//
+// Compact layout (FLAG_COMPACT_GBUFFER):
+//  0: albedo (rgb), specular power (a)
+//  1: octahedral normal (rg)
+//  2: emissive pre-multiplied by strength (rgb), metallic (a)
+//  View position is rebuilt from depth instead of being stored
+
+#include "normal_encoding.glsl"
+
+layout(location = 0) out vec4 albedo_specPower;
+layout(location = 1) out vec4 normal_metallic;
+layout(location = 2) out vec4 emissive;
+layout(location = 3) out vec3 view_pos;
+
+// Writes a surface to the G-Buffer using the active layout
+// @param albedo    The surface color
+// @param specPower The specular power, between 0 and 1
+// @param normal    The view space normal, must be normalized
+// @param metallic  How metallic the surface is, between 0 and 1
+// @param emission  The emissive color (rgb) and strength (a)
+// @param viewPos   The position of the fragment in view space
+void WriteGBuffer(vec3 albedo, float specPower, vec3 normal, float metallic, vec4 emission, vec3 viewPos) {
+    albedo_specPower = vec4(albedo, specPower);
+
+    if (IsFlagSet(FLAG_COMPACT_GBUFFER)) {
+        normal_metallic = vec4(OctahedralEncode(normal), 0, 0);
+        emissive = vec4(emission.rgb * emission.a, metallic);
+    } else {
+        // Map [-1, 1] to [0, 1]
+        normal_metallic = vec4(clamp((normal + 1) / 2.0, 0, 1), metallic);
+        emissive = emission;
+        view_pos = viewPos;
+    }
+}
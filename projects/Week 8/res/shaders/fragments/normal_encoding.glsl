@@ -0,0 +1,23 @@
+// Octahedral normal encoding, maps a unit vector onto the faces of an octahedron and
+// unfolds it into a square, so that normals can be stored in 2 channels
+// http://jcgt.org/published/0003/02/01/
+
+vec2 OctWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Encodes a normalized vector into the [0, 1] range for storage in a UNORM texture
+vec2 OctahedralEncode(vec3 n) {
+    n /= (abs(n.x) + abs(n.y) + abs(n.z));
+    n.xy = n.z >= 0.0 ? n.xy : OctWrap(n.xy);
+    return n.xy * 0.5 + 0.5;
+}
+
+// Decodes a vector stored with OctahedralEncode
+vec3 OctahedralDecode(vec2 f) {
+    f = f * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
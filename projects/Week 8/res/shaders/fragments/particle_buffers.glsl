@@ -0,0 +1,47 @@
+/*
+ * This is a partial file that declares the particle storage used by the compute particle
+ * backend, see Gameplay/Components/ParticleSystem.h. Particles are stored as a structure
+ * of arrays, so each pass only touches the data it needs
+ *
+ * Binding slots must match ParticleSystem::ComputeBuffer
+*/
+
+// Position in xyz, remaining lifetime in w. Dead particles have a lifetime of 0
+layout (std430, binding = 0) buffer b_ParticlePositions {
+    vec4 Positions[];
+};
+
+// Velocity in xyz, lifetime the particle was spawned with in w
+layout (std430, binding = 1) buffer b_ParticleVelocities {
+    vec4 Velocities[];
+};
+
+layout (std430, binding = 2) buffer b_ParticleColors {
+    vec4 Colors[];
+};
+
+// Indices of the particles that are free to spawn into, the first DeadCount are valid
+layout (std430, binding = 3) buffer b_ParticleDeadList {
+    uint DeadList[];
+};
+
+// Indices of the particles that survived the last simulation step, the first AliveCount are
+// valid. When sorting is enabled this is re-ordered back to front before drawing
+layout (std430, binding = 4) buffer b_ParticleAliveList {
+    uint AliveList[];
+};
+
+// The sort key for each entry in AliveList, padded out to a power of two
+layout (std430, binding = 5) buffer b_ParticleSortKeys {
+    float SortKeys[];
+};
+
+// The first 4 values double as the arguments to glDrawArraysIndirect, so the draw
+// call's vertex count is the alive count without the CPU ever reading it
+layout (std430, binding = 6) buffer b_ParticleCounters {
+    uint AliveCount;
+    uint InstanceCount;
+    uint FirstVertex;
+    uint BaseInstance;
+    uint DeadCount;
+};
@@ -2,11 +2,45 @@
 // Vertex inputs
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
+layout(location = 2) in vec3 inNormalRaw;
 layout(location = 3) in vec2 inUV;
 
-layout(location = 4) in vec3 inTangent;
-layout(location = 5) in vec3 inBiTangent;
+layout(location = 4) in vec3 inTangentRaw;
+layout(location = 5) in vec3 inBiTangentRaw;
+
+// Set by the renderer for meshes with packed vertices (VertexPackedPosNormTexColTangents), where
+// the normal and tangent are octahedral encoded in xy, and the bitangent's sign is stored in x (0 or 1)
+uniform bool u_PackedNormals;
+// Takes the stored vertex position into model space, for meshes with quantized positions. The renderer already
+// folds this into the model matrix, it's only needed by shaders that use the model space position directly
+uniform mat4 u_PositionTransform = mat4(1.0);
+
+vec3 DecodeOctahedral(vec2 e) {
+	vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (v.z < 0.0) {
+		v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(v);
+}
+
+vec3 GetVertexNormal() {
+	return u_PackedNormals ? DecodeOctahedral(inNormalRaw.xy) : inNormalRaw;
+}
+vec3 GetVertexTangent() {
+	return u_PackedNormals ? DecodeOctahedral(inTangentRaw.xy) : inTangentRaw;
+}
+vec3 GetVertexBiTangent() {
+	return u_PackedNormals ? cross(GetVertexNormal(), GetVertexTangent()) * (inBiTangentRaw.x * 2.0 - 1.0) : inBiTangentRaw;
+}
+
+vec3 GetModelPosition() {
+	return (u_PositionTransform * vec4(inPosition, 1.0)).xyz;
+}
+
+// Shaders can keep using the regular names, and work with either vertex format
+#define inNormal    GetVertexNormal()
+#define inTangent   GetVertexTangent()
+#define inBiTangent GetVertexBiTangent()
 
 // Standard vertex shader outputs
 layout(location = 0) out vec3 outViewPos;
@@ -17,3 +51,18 @@ layout(location = 4) out mat3 outTBN;
 
 // Include the matrices and frame level parameters
 #include "frame_uniforms.glsl"
+
+#ifdef INSTANCED
+// When the renderer batches objects that share a mesh and material, the per-object
+// matrices are streamed in as instanced attributes. The model matrix takes up 4 slots,
+// and the normal matrix takes up 3
+layout(location = 8)  in mat4 inInstanceModel;
+layout(location = 12) in mat3 inInstanceNormal;
+
+// Map the instance level uniforms onto our attributes, so that vertex shaders don't need
+// to care whether or not they're being instanced
+#define u_Model               inInstanceModel
+#define u_ModelView           (u_View * inInstanceModel)
+#define u_ModelViewProjection (u_ViewProjection * inInstanceModel)
+#define u_NormalMatrix        mat4(inInstanceNormal)
+#endif
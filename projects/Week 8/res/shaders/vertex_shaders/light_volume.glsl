@@ -0,0 +1,14 @@
+#version 440
+
+layout (location = 0) in vec3 inPosition;
+
+#include "../fragments/frame_uniforms.glsl"
+
+// The light's position in view space (xyz) and it's range (w)
+uniform vec4 u_LightPosRadius;
+
+// Scales and moves a unit sphere to cover the light's range
+void main() {
+    vec3 viewPos = u_LightPosRadius.xyz + inPosition * u_LightPosRadius.w;
+    gl_Position = u_Projection * vec4(viewPos, 1);
+}
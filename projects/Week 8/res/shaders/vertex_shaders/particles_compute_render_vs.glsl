@@ -0,0 +1,24 @@
+#version 450
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out flat uint outType;
+layout (location = 2) out vec3 viewPos;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/particle_buffers.glsl"
+
+#define TYPE_PARTICLE 1
+
+// Drawn with glDrawArraysIndirect using the alive count, so each vertex is one entry in the alive list
+void main() {
+    uint index = AliveList[gl_VertexID];
+    vec4 position = Positions[index];
+
+    viewPos = (u_View * vec4(position.xyz, 1)).xyz;
+    gl_Position = u_Projection * vec4(viewPos, 1);
+
+    // Fade out over the particle's lifetime
+    fragColor = vec4(Colors[index].rgb, position.w / Velocities[index].w);
+    outType = TYPE_PARTICLE;
+    gl_PointSize = 10.0;
+}
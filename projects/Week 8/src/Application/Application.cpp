@@ -59,12 +59,14 @@
 #include "Layers/InstancedRenderingTestLayer.h"
 #include "Layers/ParticleLayer.h"
 #include "Layers/PostProcessingLayer.h"
+#include "Layers/LightingBenchmarkLayer.h"
 
 Application* Application::_singleton = nullptr;
 std::string Application::_applicationName = "INFR-2350U - DEMO";
 
 #define DEFAULT_WINDOW_WIDTH 1280
 #define DEFAULT_WINDOW_HEIGHT 720
+#define DEFAULT_UPLOAD_BUDGET_MS 4.0f
 
 Application::Application() :
 	_window(nullptr),
@@ -118,6 +120,10 @@ bool Application::LoadScene(const std::string& path) {
 		if (std::filesystem::exists(manifestPath)) {
 			LOG_INFO("Loading manifest from \"{}\"", manifestPath);
 			ResourceManager::LoadManifest(manifestPath);
+
+			// Start decoding everything in the background, anything the scene needs right away will be
+			// finished as it's requested, and the rest will be uploaded over the next few frames
+			ResourceManager::LoadAllAsync();
 		}
 
 		Gameplay::Scene::Sptr scene = Gameplay::Scene::Load(path);
@@ -149,6 +155,7 @@ void Application::_Run()
 	_layers.push_back(std::make_shared<GLAppLayer>());
 	_layers.push_back(std::make_shared<DefaultSceneLayer>());
 	_layers.push_back(std::make_shared<LogicUpdateLayer>());
+	_layers.push_back(std::make_shared<LightingBenchmarkLayer>());
 	_layers.push_back(std::make_shared<RenderLayer>());
 	_layers.push_back(std::make_shared<ParticleLayer>());
 	_layers.push_back(std::make_shared<PostProcessingLayer>());
@@ -165,6 +172,7 @@ void Application::_Run()
 	// We'll grab these since we'll need them!
 	_windowSize.x = JsonGet(_appSettings, "window_width", DEFAULT_WINDOW_WIDTH);
 	_windowSize.y = JsonGet(_appSettings, "window_height", DEFAULT_WINDOW_HEIGHT);
+	float uploadBudgetMs = JsonGet(_appSettings, "upload_budget_ms", DEFAULT_UPLOAD_BUDGET_MS);
 
 	// By default, we want our viewport to be the whole screen
 	_primaryViewport = { 0, 0, _windowSize.x, _windowSize.y };
@@ -197,6 +205,9 @@ void Application::_Run()
 			_isRunning = false;
 		}
 
+		// Finish resources that were loaded in the background, spreading the uploads over multiple frames
+		ResourceManager::ProcessUploads(uploadBudgetMs);
+
 		// Grab the timing singleton instance as a reference
 		Timing& timing = Timing::_singleton;
 
@@ -437,6 +448,7 @@ nlohmann::json Application::_GetDefaultAppSettings()
 
 	result["window_width"]  = DEFAULT_WINDOW_WIDTH;
 	result["window_height"] = DEFAULT_WINDOW_HEIGHT;
+	result["upload_budget_ms"] = DEFAULT_UPLOAD_BUDGET_MS;
 	return result;
 }
 
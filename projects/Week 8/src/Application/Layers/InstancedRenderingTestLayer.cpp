@@ -94,7 +94,7 @@ void InstancedRenderingTestLayer::_UpdateInstances() {
 		// For now just update everything regardless of if it's changed or not
 		// A smarter system would only update if the data is old
 		data[ix].ModelMatrix  = _instances[ix]->GetTransform();
-		data[ix].NormalMatrix = glm::mat3(glm::transpose(glm::inverse(_instances[ix]->GetTransform())));
+		data[ix].NormalMatrix = glm::mat4(_instances[ix]->GetNormalMatrix());
 	}
 
 	// Unmap the buffer so that the GPU can see it again
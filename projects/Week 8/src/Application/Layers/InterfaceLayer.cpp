@@ -36,6 +36,7 @@ void InterfaceLayer::OnRender(const Framebuffer::Sptr& prevLayer) {
 	// Our projection matrix will be our entire window for now
 	glm::mat4 proj = glm::ortho(0.0f, (float)app.GetWindowSize().x, (float)app.GetWindowSize().y, 0.0f, -1.0f, 1.0f);
 	GuiBatcher::SetProjection(proj);
+	GuiBatcher::BeginFrame();
 
 	// Iterate over and render all the GUI objects
 	app.CurrentScene()->RenderGUI();
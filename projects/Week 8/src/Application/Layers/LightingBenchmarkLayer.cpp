@@ -0,0 +1,167 @@
+#include "LightingBenchmarkLayer.h"
+#include <random>
+
+#include "../Application.h"
+#include "../Timing.h"
+#include "Gameplay/Components/Light.h"
+#include "Logging.h"
+
+LightingBenchmarkLayer::LightingBenchmarkLayer() :
+	ApplicationLayer(),
+	_isRunning(false),
+	_runs(),
+	_results(),
+	_runIndex(0),
+	_frame(0),
+	_frameMsTotal(0.0),
+	_lightingMsTotal(0.0),
+	_previousMode(LightingMode::Clustered),
+	_lights()
+{
+	Name = "Lighting Benchmark";
+	Overrides = AppLayerFunctions::OnUpdate | AppLayerFunctions::OnSceneUnload;
+}
+
+LightingBenchmarkLayer::~LightingBenchmarkLayer() = default;
+
+void LightingBenchmarkLayer::Start(const std::vector<uint32_t>& lightCounts)
+{
+	if (_isRunning) return;
+
+	RenderLayer::Sptr renderLayer = Application::Get().GetLayer<RenderLayer>();
+	_previousMode = renderLayer->GetLightingMode();
+
+	// We do every mode for each light count, so we only need to re-generate lights when the count changes
+	_runs.clear();
+	for (uint32_t count : lightCounts) {
+		for (LightingMode mode : { LightingMode::Fullscreen, LightingMode::Clustered, LightingMode::Volumes }) {
+			_runs.push_back({ mode, count, 0.0, 0.0 });
+		}
+	}
+
+	LOG_INFO("Starting lighting benchmark, {} runs of {} frames", _runs.size(), WARMUP_FRAMES + MEASURE_FRAMES);
+	_isRunning = _runs.size() > 0;
+	_runIndex = 0;
+	if (_isRunning) {
+		_BeginRun();
+	}
+}
+
+bool LightingBenchmarkLayer::IsRunning() const {
+	return _isRunning;
+}
+
+const std::vector<LightingBenchmarkLayer::Result>& LightingBenchmarkLayer::GetResults() const {
+	return _results;
+}
+
+std::vector<Gameplay::GameObject::Sptr> LightingBenchmarkLayer::PopulateScene(const Gameplay::Scene::Sptr& scene, uint32_t lightCount, float areaSize, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> horizontal(-areaSize * 0.5f, areaSize * 0.5f);
+	std::uniform_real_distribution<float> height(0.5f, 4.0f);
+	std::uniform_real_distribution<float> radius(2.0f, 6.0f);
+	std::uniform_real_distribution<float> hue(0.0f, 1.0f);
+
+	std::vector<Gameplay::GameObject::Sptr> result;
+	result.reserve(lightCount);
+	for (uint32_t ix = 0; ix < lightCount; ix++) {
+		Gameplay::GameObject::Sptr object = scene->CreateGameObject("Benchmark Light " + std::to_string(ix));
+		object->SetPostion(glm::vec3(horizontal(random), horizontal(random), height(random)));
+
+		// Saturated colors make it easy to see where each light is reaching
+		float h = hue(random) * 6.0f;
+		glm::vec3 color = glm::clamp(glm::vec3(glm::abs(h - 3.0f) - 1.0f, 2.0f - glm::abs(h - 2.0f), 2.0f - glm::abs(h - 4.0f)), 0.0f, 1.0f);
+
+		Light::Sptr light = object->Add<Light>();
+		light->SetColor(color);
+		light->SetRadius(radius(random));
+		light->SetIntensity(1.0f);
+
+		result.push_back(object);
+	}
+	return result;
+}
+
+void LightingBenchmarkLayer::OnUpdate()
+{
+	if (!_isRunning) return;
+
+	_frame++;
+	if (_frame > WARMUP_FRAMES) {
+		RenderLayer::Sptr renderLayer = Application::Get().GetLayer<RenderLayer>();
+		const RenderLayer::RenderStats& stats = renderLayer->GetRenderStats();
+		_frameMsTotal += Timing::Current().UnscaledDeltaTime() * 1000.0;
+		_lightingMsTotal += stats.LightingGpuMs;
+
+		// Make sure every batch of lights actually made it to the screen, rather than timing a pass
+		// that's skipping lights
+		const Result& run = _runs[_runIndex];
+		if (run.Mode == LightingMode::Fullscreen && _frame == WARMUP_FRAMES + 1) {
+			uint32_t expectedBatches = (stats.Lights + MAX_LIGHTS - 1) / MAX_LIGHTS;
+			if (stats.Lights < run.LightCount || stats.LightBatches != expectedBatches) {
+				LOG_ERROR("Fullscreen lighting drew {} batches for {} lights, expected {} batches for {} lights", stats.LightBatches, stats.Lights, (run.LightCount + MAX_LIGHTS - 1) / MAX_LIGHTS, run.LightCount);
+			}
+		}
+	}
+
+	if (_frame >= WARMUP_FRAMES + MEASURE_FRAMES) {
+		Result& run = _runs[_runIndex];
+		run.FrameMs = _frameMsTotal / MEASURE_FRAMES;
+		run.LightingGpuMs = _lightingMsTotal / MEASURE_FRAMES;
+
+		_runIndex++;
+		if (_runIndex < _runs.size()) {
+			_BeginRun();
+		} else {
+			_Finish();
+		}
+	}
+}
+
+void LightingBenchmarkLayer::OnSceneUnload()
+{
+	// Our lights are gone with the scene, so there's nothing left to measure
+	if (_isRunning) {
+		LOG_WARN("Scene unloaded, cancelling lighting benchmark");
+		_lights.clear();
+		_isRunning = false;
+		Application::Get().GetLayer<RenderLayer>()->SetLightingMode(_previousMode);
+	}
+}
+
+void LightingBenchmarkLayer::_BeginRun()
+{
+	const Result& run = _runs[_runIndex];
+	if (_lights.size() != run.LightCount) {
+		_RemoveLights();
+		_lights = PopulateScene(Application::Get().CurrentScene(), run.LightCount);
+	}
+	Application::Get().GetLayer<RenderLayer>()->SetLightingMode(run.Mode);
+
+	_frame = 0;
+	_frameMsTotal = 0.0;
+	_lightingMsTotal = 0.0;
+}
+
+void LightingBenchmarkLayer::_Finish()
+{
+	_RemoveLights();
+	_isRunning = false;
+	Application::Get().GetLayer<RenderLayer>()->SetLightingMode(_previousMode);
+	_results = _runs;
+
+	LOG_INFO("Lighting benchmark results ({} frames per run, frame times may be capped by vsync):", MEASURE_FRAMES);
+	for (const Result& result : _results) {
+		LOG_INFO("\t{:>10} {:>5} lights: {:.3f}ms/frame, {:.3f}ms GPU lighting", ~result.Mode, result.LightCount, result.FrameMs, result.LightingGpuMs);
+	}
+}
+
+void LightingBenchmarkLayer::_RemoveLights()
+{
+	Gameplay::Scene::Sptr scene = Application::Get().CurrentScene();
+	for (const auto& object : _lights) {
+		scene->RemoveGameObject(object);
+	}
+	_lights.clear();
+}
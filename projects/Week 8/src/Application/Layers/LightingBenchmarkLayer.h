@@ -0,0 +1,72 @@
+#pragma once
+#include "../ApplicationLayer.h"
+#include "Application/Layers/RenderLayer.h"
+#include "Gameplay/Scene.h"
+
+/// <summary>
+/// Measures how our deferred lighting scales with the number of lights. When started, fills the
+/// current scene with increasing numbers of point lights, and records the average frame time and
+/// GPU lighting time with each lighting mode, then logs the results and removes the lights
+/// </summary>
+class LightingBenchmarkLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(LightingBenchmarkLayer)
+
+	// Number of frames to let things settle before measuring, and the number of frames to measure
+	static const uint32_t WARMUP_FRAMES  = 30;
+	static const uint32_t MEASURE_FRAMES = 120;
+
+	struct Result {
+		LightingMode Mode;
+		uint32_t     LightCount;
+		double       FrameMs;
+		double       LightingGpuMs;
+	};
+
+	LightingBenchmarkLayer();
+	virtual ~LightingBenchmarkLayer();
+
+	/// <summary>
+	/// Starts the benchmark on the current scene, does nothing if a benchmark is already running
+	/// </summary>
+	/// <param name="lightCounts">The numbers of lights to measure</param>
+	void Start(const std::vector<uint32_t>& lightCounts = { 8, 64, 512, 2048 });
+	bool IsRunning() const;
+
+	/// <summary>
+	/// Gets the results from the last completed benchmark
+	/// </summary>
+	const std::vector<Result>& GetResults() const;
+
+	/// <summary>
+	/// Adds a number of randomly placed and colored point lights to a scene, spread over an area
+	/// around the origin
+	/// </summary>
+	/// <param name="scene">The scene to add lights to</param>
+	/// <param name="lightCount">The number of lights to add</param>
+	/// <param name="areaSize">The width and depth of the area to spread the lights over</param>
+	/// <param name="seed">The seed for the random generator, so the same lights are generated each time</param>
+	/// <returns>The game objects that were created</returns>
+	static std::vector<Gameplay::GameObject::Sptr> PopulateScene(const Gameplay::Scene::Sptr& scene, uint32_t lightCount, float areaSize = 40.0f, uint32_t seed = 1234);
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnUpdate() override;
+	virtual void OnSceneUnload() override;
+
+protected:
+	bool                  _isRunning;
+	std::vector<Result>   _runs;
+	std::vector<Result>   _results;
+	uint32_t              _runIndex;
+	uint32_t              _frame;
+	double                _frameMsTotal;
+	double                _lightingMsTotal;
+	LightingMode          _previousMode;
+
+	std::vector<Gameplay::GameObject::Sptr> _lights;
+
+	void _BeginRun();
+	void _Finish();
+	void _RemoveLights();
+};
@@ -1,16 +1,32 @@
 #include "LogicUpdateLayer.h"
 #include "../Application.h"
 #include "../Timing.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Logging.h"
 
 LogicUpdateLayer::LogicUpdateLayer() :
-	ApplicationLayer()
+	ApplicationLayer(),
+	_physicsStepRate(60.0f),
+	_maxPhysicsSubSteps(5)
 {
 	Name = "Logic";
-	Overrides = AppLayerFunctions::OnUpdate;
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnUpdate;
 }
 
 LogicUpdateLayer::~LogicUpdateLayer() = default;
 
+void LogicUpdateLayer::OnAppLoad(const nlohmann::json& config)
+{
+	nlohmann::json settings = config.contains(Name) ? config[Name] : nlohmann::json();
+	_physicsStepRate    = JsonGet(settings, "physics_step_rate", _physicsStepRate);
+	_maxPhysicsSubSteps = JsonGet(settings, "max_physics_substeps", _maxPhysicsSubSteps);
+
+	if (_physicsStepRate <= 0.0f) {
+		LOG_WARN("Invalid physics step rate {}, falling back to 60Hz", _physicsStepRate);
+		_physicsStepRate = 60.0f;
+	}
+}
+
 void LogicUpdateLayer::OnUpdate()
 {
 	Application& app = Application::Get();
@@ -18,6 +34,19 @@ void LogicUpdateLayer::OnUpdate()
 	// Perform updates for all components
 	app.CurrentScene()->Update(Timing::Current().DeltaTime());
 
-	// Update our worlds physics!
+	// Update our worlds physics! Scenes can be swapped at any time, so we re-apply our settings each frame
+	app.CurrentScene()->SetPhysicsStepRate(_physicsStepRate);
+	app.CurrentScene()->SetMaxPhysicsSubSteps(_maxPhysicsSubSteps);
 	app.CurrentScene()->DoPhysics(Timing::Current().DeltaTime());
+
+	// Now that everything has moved, update all the transforms in one go
+	app.CurrentScene()->UpdateTransforms();
 }
+
+nlohmann::json LogicUpdateLayer::GetDefaultConfig()
+{
+	nlohmann::json result;
+	result["physics_step_rate"]    = _physicsStepRate;
+	result["max_physics_substeps"] = _maxPhysicsSubSteps;
+	return result;
+}
\ No newline at end of file
@@ -10,8 +10,12 @@ public:
 
 	// Inherited from ApplicationLayer
 
+	virtual void OnAppLoad(const nlohmann::json& config) override;
 	virtual void OnUpdate() override;
+	virtual nlohmann::json GetDefaultConfig() override;
 
 protected:
-
-};
\ No newline at end of file
+	// How many times per second physics is stepped, and the max steps we'll take in one frame
+	float _physicsStepRate;
+	int   _maxPhysicsSubSteps;
+};
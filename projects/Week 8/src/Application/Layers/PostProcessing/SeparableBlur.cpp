@@ -0,0 +1,212 @@
+#include "SeparableBlur.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ImGuiHelper.h"
+#include "Graphics/Framebuffer.h"
+
+#include <GLM/glm.hpp>
+
+SeparableBlur::SeparableBlur() :
+	PostProcessingLayer::Effect(),
+	Kernel(BlurKernel::Gaussian),
+	Radius(8),
+	DownsampleLevels(0),
+	_blurShader(nullptr),
+	_copyShader(nullptr),
+	_builtKernel(BlurKernel::Gaussian),
+	_builtRadius(-1),
+	_offsets(),
+	_weights()
+{
+	Name = "Separable Blur";
+	Enabled = false;
+	_format = RenderTargetType::ColorRgb8;
+
+	_blurShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/blur_separable.glsl" }
+	});
+	_copyShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/texture_passthrough.glsl" }
+	});
+}
+
+SeparableBlur::~SeparableBlur() = default;
+
+void SeparableBlur::Render(const Framebuffer::Sptr& input, const Framebuffer::Sptr& output, const Framebuffer::Sptr& gBuffer, RenderTargetPool& pool)
+{
+	const int downsampleLevels = _GetDownsampleLevels(input->GetSize());
+	int radius = _GetScaledRadius(downsampleLevels);
+	if (radius != _builtRadius || Kernel != _builtKernel) {
+		_BuildSamples(Kernel, radius);
+	}
+
+	if (downsampleLevels <= 0) {
+		Framebuffer::Sptr temp = pool.Acquire(output->GetSize(), _format);
+		_BlurPass(input, temp, glm::vec2(1.0f, 0.0f));
+		_BlurPass(temp, output, glm::vec2(0.0f, 1.0f));
+		pool.Release(temp);
+		return;
+	}
+
+	// Build the pyramid by repeatedly halving the image, bilinear filtering averages each 2x2 block for us
+	std::vector<Framebuffer::Sptr> levels;
+	Framebuffer::Sptr source = input;
+	for (int ix = 0; ix < downsampleLevels; ix++) {
+		glm::ivec2 size = source->GetSize() / 2;
+		Framebuffer::Sptr level = pool.Acquire(size, _format);
+		_Copy(source, level);
+		levels.push_back(level);
+		source = level;
+	}
+
+	// Blur the smallest level in place
+	Framebuffer::Sptr smallest = levels.back();
+	Framebuffer::Sptr temp = pool.Acquire(smallest->GetSize(), _format);
+	_BlurPass(smallest, temp, glm::vec2(1.0f, 0.0f));
+	_BlurPass(temp, smallest, glm::vec2(0.0f, 1.0f));
+	pool.Release(temp);
+
+	// Step back up one level at a time, which gives a smoother result than stretching the smallest level
+	for (int ix = static_cast<int>(levels.size()) - 2; ix >= 0; ix--) {
+		_Copy(levels[ix + 1], levels[ix]);
+	}
+	_Copy(levels[0], output);
+
+	for (const auto& level : levels) {
+		pool.Release(level);
+	}
+}
+
+void SeparableBlur::RenderImGui()
+{
+	ImGui::PushID(this);
+
+	if (ImGui::BeginCombo("Kernel", (~Kernel).c_str())) {
+		for (BlurKernel kernel : { BlurKernel::Box, BlurKernel::Gaussian }) {
+			if (ImGui::Selectable((~kernel).c_str(), kernel == Kernel)) {
+				Kernel = kernel;
+			}
+		}
+		ImGui::EndCombo();
+	}
+	LABEL_LEFT(ImGui::SliderInt, "Radius", &Radius, 1, MAX_RADIUS << MAX_DOWNSAMPLE_LEVELS);
+	LABEL_LEFT(ImGui::SliderInt, "Downsample Levels", &DownsampleLevels, 0, MAX_DOWNSAMPLE_LEVELS);
+
+	int levels = glm::clamp(DownsampleLevels, 0, MAX_DOWNSAMPLE_LEVELS);
+	int radius = _GetScaledRadius(levels);
+	int taps = (radius / 2 + (radius & 1)) * 2 + 1;
+	int fullTaps = (Radius * 2 + 1) * (Radius * 2 + 1);
+	ImGui::Text("Taps per pass: %d (2 passes, radius %d at blur resolution)", taps, radius);
+	ImGui::Text("A single pass %dx%d kernel would take %d taps", Radius * 2 + 1, Radius * 2 + 1, fullTaps);
+	if (Radius >> levels > MAX_RADIUS) {
+		ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Radius is clamped to %d, try more downsample levels", MAX_RADIUS);
+	}
+
+	ImGui::PopID();
+}
+
+SeparableBlur::Sptr SeparableBlur::FromJson(const nlohmann::json& data)
+{
+	SeparableBlur::Sptr result = std::make_shared<SeparableBlur>();
+	result->Enabled = JsonGet(data, "enabled", false);
+	result->Kernel = JsonParseEnum(BlurKernel, data, "kernel", result->Kernel);
+	result->Radius = JsonGet(data, "radius", result->Radius);
+	result->DownsampleLevels = glm::clamp(JsonGet(data, "downsample_levels", result->DownsampleLevels), 0, MAX_DOWNSAMPLE_LEVELS);
+	return result;
+}
+
+nlohmann::json SeparableBlur::ToJson() const
+{
+	return {
+		{ "enabled", Enabled },
+		{ "kernel", ~Kernel },
+		{ "radius", Radius },
+		{ "downsample_levels", DownsampleLevels }
+	};
+}
+
+int SeparableBlur::_GetDownsampleLevels(const glm::ivec2& size) const
+{
+	// Every level halves the size, so floor(log2(size)) levels takes the smaller side down to one pixel
+	int smallest = glm::min(size.x, size.y);
+	int maxLevels = smallest > 0 ? static_cast<int>(glm::log2(static_cast<float>(smallest))) : 0;
+	return glm::clamp(DownsampleLevels, 0, glm::min(maxLevels, static_cast<int>(MAX_DOWNSAMPLE_LEVELS)));
+}
+
+int SeparableBlur::_GetScaledRadius(int downsampleLevels) const
+{
+	return glm::clamp(Radius >> downsampleLevels, 1, MAX_RADIUS);
+}
+
+void SeparableBlur::_BuildSamples(BlurKernel kernel, int radius)
+{
+	// Weights for each pixel from the center outwards
+	std::vector<float> pixelWeights(radius + 1);
+	if (kernel == BlurKernel::Gaussian) {
+		// Most of the curve's weight lies within 3 standard deviations
+		float sigma = glm::max(radius / 3.0f, 0.5f);
+		for (int ix = 0; ix <= radius; ix++) {
+			pixelWeights[ix] = glm::exp(-(ix * ix) / (2.0f * sigma * sigma));
+		}
+	} else {
+		for (int ix = 0; ix <= radius; ix++) {
+			pixelWeights[ix] = 1.0f;
+		}
+	}
+
+	// Normalize, counting both sides of the center
+	float sum = pixelWeights[0];
+	for (int ix = 1; ix <= radius; ix++) {
+		sum += pixelWeights[ix] * 2.0f;
+	}
+	for (float& weight : pixelWeights) {
+		weight /= sum;
+	}
+
+	// The center pixel is sampled on it's own, then we merge each pair of pixels into one sample
+	// placed so that bilinear filtering gives each pixel it's own weight
+	_offsets.clear();
+	_weights.clear();
+	_offsets.push_back(0.0f);
+	_weights.push_back(pixelWeights[0]);
+	for (int ix = 1; ix <= radius; ix += 2) {
+		float w1 = pixelWeights[ix];
+		float w2 = ix + 1 <= radius ? pixelWeights[ix + 1] : 0.0f;
+		float weight = w1 + w2;
+		_offsets.push_back((ix * w1 + (ix + 1) * w2) / weight);
+		_weights.push_back(weight);
+	}
+
+	_builtKernel = kernel;
+	_builtRadius = radius;
+}
+
+void SeparableBlur::_BlurPass(const Framebuffer::Sptr& source, const Framebuffer::Sptr& dest, const glm::vec2& direction)
+{
+	dest->Bind();
+	glViewport(0, 0, dest->GetWidth(), dest->GetHeight());
+	source->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+	_blurShader->Bind();
+	_blurShader->SetUniform("u_Offsets", _offsets.data(), static_cast<int>(_offsets.size()));
+	_blurShader->SetUniform("u_Weights", _weights.data(), static_cast<int>(_weights.size()));
+	_blurShader->SetUniform("u_SampleCount", static_cast<int>(_offsets.size()));
+	_blurShader->SetUniform("u_Step", direction / glm::vec2(source->GetSize()));
+	DrawFullscreen();
+
+	dest->Unbind();
+}
+
+void SeparableBlur::_Copy(const Framebuffer::Sptr& source, const Framebuffer::Sptr& dest)
+{
+	dest->Bind();
+	glViewport(0, 0, dest->GetWidth(), dest->GetHeight());
+	source->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+	_copyShader->Bind();
+	DrawFullscreen();
+
+	dest->Unbind();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <EnumToString.h>
+#include "Application/Layers/PostProcessingLayer.h"
+#include "Graphics/ShaderProgram.h"
+
+/**
+ * The weighting used for each pixel in a blur
+ */
+ENUM(BlurKernel, int,
+	Box      = 0,
+	Gaussian = 1
+);
+
+/**
+ * A blur with an arbitrary radius, done as a horizontal pass followed by a vertical pass so that
+ * it costs O(radius) samples per pixel instead of O(radius^2). Samples are placed between pixels
+ * so that bilinear filtering does half the work, so a pass takes about radius + 1 taps
+ *
+ * For large radii, the image can be blurred at a lower resolution by downsampling it a number of
+ * times first, then upsampling the result back to the screen size (ex: for bloom)
+ */
+class SeparableBlur : public PostProcessingLayer::Effect {
+public:
+	MAKE_PTRS(SeparableBlur);
+
+	// The largest radius we support, in pixels at the resolution being blurred
+	static const int MAX_RADIUS = 64;
+	// The number of samples needed for MAX_RADIUS, must match blur_separable.glsl
+	static const int MAX_SAMPLES = MAX_RADIUS / 2 + 1;
+	// The max number of times we will halve the image before blurring
+	static const int MAX_DOWNSAMPLE_LEVELS = 5;
+
+	BlurKernel Kernel;
+	// The blur radius in full resolution pixels
+	int        Radius;
+	// How many times to halve the image's resolution before blurring, this is clamped to
+	// MAX_DOWNSAMPLE_LEVELS and to the number of times the image can be halved
+	int        DownsampleLevels;
+
+	SeparableBlur();
+	virtual ~SeparableBlur();
+
+	virtual void Render(const Framebuffer::Sptr& input, const Framebuffer::Sptr& output, const Framebuffer::Sptr& gBuffer, RenderTargetPool& pool) override;
+	virtual void RenderImGui() override;
+
+	// Inherited from IResource
+
+	SeparableBlur::Sptr FromJson(const nlohmann::json& data);
+	virtual nlohmann::json ToJson() const override;
+
+protected:
+	ShaderProgram::Sptr _blurShader;
+	ShaderProgram::Sptr _copyShader;
+
+	// The kernel we last built samples for, so we only rebuild when settings change
+	BlurKernel         _builtKernel;
+	int                _builtRadius;
+	std::vector<float> _offsets;
+	std::vector<float> _weights;
+
+	/**
+	 * Gets the number of times we can actually halve an image of the given size, so that
+	 * the smallest level is still at least a pixel across
+	 */
+	int _GetDownsampleLevels(const glm::ivec2& size) const;
+	/**
+	 * Gets the radius in pixels at the resolution we'll actually be blurring at
+	 */
+	int _GetScaledRadius(int downsampleLevels) const;
+	/**
+	 * Calculates the sample offsets and weights for the given kernel and radius
+	 */
+	void _BuildSamples(BlurKernel kernel, int radius);
+	/**
+	 * Blurs source into dest along a single axis, both must be the same size
+	 */
+	void _BlurPass(const Framebuffer::Sptr& source, const Framebuffer::Sptr& dest, const glm::vec2& direction);
+	/**
+	 * Copies source into dest, relying on bilinear filtering when the sizes differ
+	 */
+	void _Copy(const Framebuffer::Sptr& source, const Framebuffer::Sptr& dest);
+};
@@ -7,9 +7,13 @@
 #include "PostProcessing/BoxFilter3x3.h"
 #include "PostProcessing/BoxFilter5x5.h"
 #include "PostProcessing/OutlineEffect.h"
+#include "PostProcessing/SeparableBlur.h"
 
 PostProcessingLayer::PostProcessingLayer() :
-	ApplicationLayer()
+	ApplicationLayer(),
+	_effects(),
+	_quadVAO(nullptr),
+	_targetPool(nullptr)
 {
 	Name = "Post Processing";
 	Overrides =
@@ -32,19 +36,11 @@ void PostProcessingLayer::OnAppLoad(const nlohmann::json& config)
 	_effects.push_back(std::make_shared<BoxFilter3x3>());
 	_effects.push_back(std::make_shared<BoxFilter5x5>());
 	_effects.push_back(std::make_shared<OutlineEffect>());
+	_effects.push_back(std::make_shared<SeparableBlur>());
 
-	Application& app = Application::Get();
-	const glm::uvec4& viewport = app.GetPrimaryViewport();
-
-	// Initialize all the effect's output FBOs (inefficient) 
-	for (const auto& effect : _effects) {
-		FramebufferDescriptor fboDesc = FramebufferDescriptor();
-		fboDesc.Width  = viewport.z * effect->_outputScale.x;
-		fboDesc.Height = viewport.w * effect->_outputScale.y;
-		fboDesc.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(effect->_format);
-
-		effect->_output = std::make_shared<Framebuffer>(fboDesc);
-	}
+	// Effect outputs are borrowed from here as needed, so we only allocate targets for the
+	// effects that are actually enabled, and chained effects can share them
+	_targetPool = RenderTargetPool::Create();
 
 	// We need a mesh for drawing fullscreen quads
 	glm::vec2 positions[6] = {
@@ -86,20 +82,19 @@ void PostProcessingLayer::OnPostRender()
 	for (const auto& effect : _effects) {
 		// Only render if it's enabled
 		if (effect->Enabled) {
-			// Bind the FBO and make sure we're rendering to the whole thing
-			effect->_output->Bind();
-			glViewport(0, 0, effect->_output->GetWidth(), effect->_output->GetHeight());
-
-			// Bind color 0 from previous pass to texture slot 0 so our effects can access
-			current->BindAttachment(RenderTargetAttachment::Color0, 0);
-
-			// Apply the effect and render the fullscreen quad
-			effect->Apply(gBuffer);
-			_quadVAO->Draw();
-
-			// Unbind output and set it as input for next pass
-			effect->_output->Unbind();
-			current = effect->_output;
+			// Grab a target to render into from the pool
+			glm::ivec2 size = glm::max(glm::ivec2(glm::round(glm::vec2(output->GetSize()) * effect->_outputScale)), glm::ivec2(1));
+			Framebuffer::Sptr target = _targetPool->Acquire(size, effect->_format);
+
+			// Render the effect from the previous pass into our target
+			effect->Render(current, target, gBuffer, *_targetPool);
+
+			// Set the output as input for next pass. We're done reading the previous pass,
+			// so it can go back to the pool for the next effect to render into
+			if (current != output) {
+				_targetPool->Release(current);
+			}
+			current = target;
 		}
 	}
 	_quadVAO->Unbind();
@@ -120,6 +115,9 @@ void PostProcessingLayer::OnPostRender()
 	);
 
 	current->Unbind();
+
+	// Everything we borrowed this frame goes back to the pool
+	_targetPool->EndFrame();
 }
 
 void PostProcessingLayer::OnSceneLoad()
@@ -140,7 +138,10 @@ void PostProcessingLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::i
 {
 	for (const auto& effect : _effects) {
 		effect->OnWindowResize(oldSize, newSize);
-		effect->_output->Resize(newSize.x, newSize.y);
+	}
+	// The render layer doesn't resize it's output when minimized, so neither do we
+	if (newSize.x * newSize.y > 0) {
+		_targetPool->Resize(oldSize, newSize);
 	}
 }
 
@@ -149,6 +150,27 @@ const std::vector<PostProcessingLayer::Effect::Sptr>& PostProcessingLayer::GetEf
 	return _effects;
 }
 
+const RenderTargetPool::Sptr& PostProcessingLayer::GetTargetPool() const
+{
+	return _targetPool;
+}
+
+void PostProcessingLayer::Effect::Render(const Framebuffer::Sptr& input, const Framebuffer::Sptr& output, const Framebuffer::Sptr& gBuffer, RenderTargetPool& pool)
+{
+	// Bind the FBO and make sure we're rendering to the whole thing
+	output->Bind();
+	glViewport(0, 0, output->GetWidth(), output->GetHeight());
+
+	// Bind color 0 from previous pass to texture slot 0 so our effects can access
+	input->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+	// Apply the effect and render the fullscreen quad
+	Apply(gBuffer);
+	DrawFullscreen();
+
+	output->Unbind();
+}
+
 void PostProcessingLayer::Effect::DrawFullscreen()
 {
 	glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -3,6 +3,7 @@
 #include "Application/ApplicationLayer.h"
 #include "Utils/Macros.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/RenderTargetPool.h"
 
 /**
  * The post processing layer will handle rendering effects after the primary
@@ -29,10 +30,22 @@ public:
 
 		/**
 		 * Overload this in derived classes to apply the effect. Texture slot 0
-		 * will contain the image from the previous pass
+		 * will contain the image from the previous pass. Effects that override
+		 * Render don't need to implement this
 		 * @param gBuffer The G-Buffer from the deferred rendering pipeline
 		 */
-		virtual void Apply(const Framebuffer::Sptr& gBuffer) = 0;
+		virtual void Apply(const Framebuffer::Sptr& /*gBuffer*/) {}
+		/**
+		 * Renders this effect from input into output. By default this binds the output, binds
+		 * the input's color to slot 0, and calls Apply before drawing a fullscreen quad. Effects
+		 * that need multiple passes can override this, borrowing any intermediate targets from
+		 * the pool and releasing them before returning
+		 * @param input The image from the previous pass
+		 * @param output The target to render into, sized and formatted for this effect
+		 * @param gBuffer The G-Buffer from the deferred rendering pipeline
+		 * @param pool The pool to borrow intermediate targets from
+		 */
+		virtual void Render(const Framebuffer::Sptr& input, const Framebuffer::Sptr& output, const Framebuffer::Sptr& gBuffer, RenderTargetPool& pool);
 		/**
 		 * Allows this effect to perform logic when a new scene is loaded
 		 */
@@ -43,7 +56,6 @@ public:
 		virtual void OnSceneUnload() {}
 		/**
 		 * Allows this effect to perform additional logic when the window is resized
-		 * Note that the output framebuffer will already be resized by the post processing layer
 		 */
 		virtual void OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize) {}
 		/**
@@ -61,9 +73,8 @@ public:
 	protected:
 		friend class PostProcessingLayer;
 
-		// The output that this effect will render into
-		Framebuffer::Sptr _output = nullptr;
-		// The scaling between this effect's output and the screen size, default 1
+		// The scaling between this effect's output and the screen size, default 1. The output
+		// itself is borrowed from the layer's render target pool each frame
 		glm::vec2 _outputScale = glm::vec2(1);
 		// The render target format for the effect's buffer
 		RenderTargetType _format = RenderTargetType::ColorRgba8;
@@ -99,6 +110,11 @@ public:
 	 */
 	void AddEffect(const Effect::Sptr& effect);
 
+	/**
+	 * Gets the pool that effect outputs are allocated from
+	 */
+	const RenderTargetPool::Sptr& GetTargetPool() const;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
@@ -112,4 +128,5 @@ protected:
 
 	std::vector<Effect::Sptr> _effects;
 	VertexArrayObject::Sptr _quadVAO;
+	RenderTargetPool::Sptr  _targetPool;
 };
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "Gameplay/Components/ComponentManager.h"
 #include "Gameplay/Components/RenderComponent.h"
 #include "Gameplay/Components/Light.h"
+#include "Utils/MeshFactory.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Logging.h"
 
 // GLM math library
 #include <GLM/glm.hpp>
@@ -24,7 +27,27 @@ RenderLayer::RenderLayer() :
 	_frameUniforms(nullptr),
 	_instanceUniforms(nullptr),
 	_renderFlags(RenderFlags::None),
-	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
+	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f }),
+	_sortDraws(true),
+	_renderQueue(),
+	_drawList(),
+	_materialIds(),
+	_stats(),
+	_autoInstancing(true),
+	_drawBatches(),
+	_instanceData(),
+	_instanceBuffer(nullptr),
+	_transientUniforms(nullptr),
+	_frustumCulling(true),
+	_cullingBvh(),
+	_cullingProxies(),
+	_visibleProxies(),
+	_cullingFrame(0),
+	_lightingMode(LightingMode::Clustered),
+	_lightClusters(nullptr),
+	_lightingTimers(),
+	_lightingTimerFrame(0),
+	_lightingGpuMs(0.0f)
 {
 	Name = "Rendering";
 	Overrides = 
@@ -33,7 +56,12 @@ RenderLayer::RenderLayer() :
 		AppLayerFunctions::OnWindowResize;
 }
 
-RenderLayer::~RenderLayer() = default;
+RenderLayer::~RenderLayer() {
+	// Our timers are only created once the app has loaded
+	if (_lightingTimers[0] != 0) {
+		glDeleteQueries(LIGHTING_TIMER_COUNT, _lightingTimers);
+	}
+}
 
 void RenderLayer::OnPreRender()
 {
@@ -91,6 +119,7 @@ void RenderLayer::OnPreRender()
 	frameData.u_Projection = camera->GetProjection();
 	frameData.u_View = camera->GetView();
 	frameData.u_ViewProjection = camera->GetViewProjection();
+	frameData.u_InverseProjection = glm::inverse(camera->GetProjection());
 	frameData.u_CameraPos = glm::vec4(camera->GetGameObject()->GetPosition(), 1.0f);
 	frameData.u_Time = static_cast<float>(Timing::Current().TimeSinceSceneLoad());
 	frameData.u_DeltaTime = Timing::Current().DeltaTime();
@@ -115,10 +144,6 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	// Cache the camera's viewprojection
 	glm::mat4 viewProj = camera->GetViewProjection(); 
 
-	// The current material that is bound for rendering
-	Material::Sptr currentMat = nullptr;
-	ShaderProgram::Sptr shader = nullptr;
-
 	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
 
 	// Make sure depth testing and culling are re-enabled
@@ -129,8 +154,15 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	// Disable blending, we want to override any existing colors
 	glDisable(GL_BLEND);
 
-	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+	// Reset our stats for this frame
+	_stats = RenderStats();
+
+	// Gather all the renderables in the scene that can be drawn. Objects with bounds are kept in our
+	// BVH so that we only need to draw the ones that are inside the camera's frustum
+	_drawList.clear();
+	_cullingFrame++;
+
+	app.CurrentScene()->Components().EachRaw<RenderComponent>([&](RenderComponent* renderable) {
 		// Early bail if mesh not set
 		if (renderable->GetMesh() == nullptr) {
 			return;
@@ -146,30 +178,222 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 			}
 		}
 
-		// If the material has changed, we need to bind the new shader and set up our material and frame data
-		// Note: This is a good reason why we should be sorting the render components in ComponentManager
-		if (renderable->GetMaterial() != currentMat) {
-			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
+		// If the object has bounds, update it in the BVH, it will be added to the draw list if it's visible
+		if (_frustumCulling) {
+			AABB bounds = renderable->GetWorldBounds();
+			if (bounds.IsValid()) {
+				_UpdateCullingProxy(renderable, bounds);
+				return;
+			}
+		}
+
+		_drawList.push_back(renderable);
+	});
 
-			shader->Bind();
-			currentMat->Apply();
+	if (_frustumCulling) {
+		// Remove any objects that were not seen this frame (destroyed, or had their mesh removed)
+		for (auto it = _cullingProxies.begin(); it != _cullingProxies.end(); ) {
+			if (it->second.LastSeenFrame != _cullingFrame) {
+				_cullingBvh.Remove(it->second.Leaf);
+				it = _cullingProxies.erase(it);
+			} else {
+				it++;
+			}
 		}
 
-		// Grab the game object so we can do some stuff with it
-		GameObject* object = renderable->GetGameObject();
+		// Query the BVH for everything inside our frustum, and add it to the draw list
+		_visibleProxies.clear();
+		_cullingBvh.Query(Frustum(viewProj), _visibleProxies);
+		for (void* renderable : _visibleProxies) {
+			_drawList.push_back(static_cast<RenderComponent*>(renderable));
+		}
 
-		// Use our uniform buffer for our instance level uniforms
-		auto& instanceData = _instanceUniforms->GetData();
-		instanceData.u_Model = object->GetTransform();
-		instanceData.u_ModelViewProjection = viewProj * object->GetTransform();
-		instanceData.u_ModelView = view * object->GetTransform();
-		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
-		_instanceUniforms->Update();
+		_stats.CullTested = static_cast<uint32_t>(_cullingProxies.size());
+		_stats.Culled = _stats.CullTested - static_cast<uint32_t>(_visibleProxies.size());
+	} 
+	// If culling was turned off, we don't need to keep the BVH around
+	else if (!_cullingProxies.empty()) {
+		_cullingBvh.Clear();
+		_cullingProxies.clear();
+	}
 
-		// Draw the object
-		renderable->GetMesh()->Draw();
-	});
+	// Build our render queue from all the visible renderables. Each draw gets a key made from
+	// it's shader, material, mesh and depth, so that sorting will group draws that share state
+	_renderQueue.Clear();
+	_materialIds.clear();
+
+	float zNear = camera->GetNearPlane();
+	float zFar  = camera->GetFarPlane();
+
+	for (uint32_t ix = 0; ix < _drawList.size(); ix++) {
+		RenderComponent* renderable = _drawList[ix];
+		const Material::Sptr& material = renderable->GetMaterial();
+
+		// Materials do not have a small numeric ID, so we hand them out in the order we see them
+		auto it = _materialIds.find(material.get());
+		uint32_t materialId = 0;
+		if (it == _materialIds.end()) {
+			materialId = static_cast<uint32_t>(_materialIds.size());
+			_materialIds[material.get()] = materialId;
+		} else {
+			materialId = it->second;
+		}
+
+		// Use the object's origin in view space for depth, sorting front to back within a batch
+		// lets us get a bit more out of early depth testing
+		const glm::mat4& transform = renderable->GetGameObject()->GetTransform();
+		float viewDepth = -(view * transform[3]).z;
+		float depth = (viewDepth - zNear) / (zFar - zNear);
+
+		uint64_t key = RenderQueue::MakeKey(
+			material->GetShader()->GetHandle(),
+			materialId,
+			renderable->GetMeshResource()->Mesh->GetHandle(),
+			depth
+		);
+		_renderQueue.Push(key, ix);
+	}
+
+	if (_sortDraws) {
+		_renderQueue.Sort();
+	}
+
+	// Split the queue into batches, since the queue is sorted any objects that share a material and
+	// mesh will be next to each other, and can be drawn with a single instanced draw call
+	const std::vector<RenderQueue::Entry>& entries = _renderQueue.GetEntries();
+	_drawBatches.clear();
+	_instanceData.clear();
+	for (uint32_t ix = 0; ix < entries.size(); ) {
+		RenderComponent* first = _drawList[entries[ix].Index];
+		const Material::Sptr& material = first->GetMaterial();
+		const VertexArrayObject::Sptr& vao = first->GetMeshResource()->Mesh;
+
+		// Find how many of the following draws use the same material and mesh
+		uint32_t count = 1;
+		if (_autoInstancing) {
+			while (ix + count < entries.size()) {
+				RenderComponent* next = _drawList[entries[ix + count].Index];
+				if (next->GetMaterial() != material || next->GetMeshResource()->Mesh != vao) {
+					break;
+				}
+				count++;
+			}
+		}
+
+		// Unique objects, or objects with shaders that can't be instanced, get drawn one at a time
+		if (count < MIN_INSTANCE_BATCH || material->GetShader()->GetInstancedVariant() == nullptr) {
+			for (uint32_t iy = 0; iy < count; iy++) {
+				_drawBatches.push_back({ ix + iy, 1, NO_INSTANCING });
+			}
+		} else {
+			_drawBatches.push_back({ ix, count, static_cast<uint32_t>(_instanceData.size()) });
+			for (uint32_t iy = 0; iy < count; iy++) {
+				const GameObject* object = _drawList[entries[ix + iy].Index]->GetGameObject();
+				_instanceData.push_back({ _GetModelMatrix(object, vao.get()), glm::mat4(object->GetNormalMatrix()) });
+			}
+		}
+
+		ix += count;
+	}
+
+	// Upload all the instance data for the frame in one go
+	if (!_instanceData.empty()) {
+		_instanceBuffer->UpdateData(_instanceData.data(), sizeof(InstanceData), static_cast<uint32_t>(_instanceData.size()));
+	}
+
+	// Start a new frame in our transient uniform buffer, any per-object uniforms will get written here
+	_transientUniforms->BeginFrame();
+
+	// The state that is currently bound for rendering
+	Material* boundMaterial = nullptr;
+	ShaderProgram* boundShader = nullptr;
+	VertexArrayObject* boundVao = nullptr;
+
+	// Render all our batches in sorted order
+	for (const DrawBatch& batch : _drawBatches) {
+		RenderComponent* renderable = _drawList[entries[batch.First].Index];
+		Material* material = renderable->GetMaterial().get();
+		VertexArrayObject* vao = renderable->GetMeshResource()->Mesh.get();
+		bool instanced = batch.BaseInstance != NO_INSTANCING;
+
+		// Instanced batches use the instanced version of the material's shader
+		const ShaderProgram::Sptr& shader = instanced ? material->GetShader()->GetInstancedVariant() : material->GetShader();
+		bool shaderChanged = false;
+		if (shader.get() != boundShader) {
+			shaderChanged = true;
+			boundShader = shader.get();
+			boundShader->Bind();
+			_stats.ShaderChanges++;
+
+			// The material parameters need to be sent to the new shader as well
+			boundMaterial = nullptr;
+		}
+
+		// If the material has changed, we need to set up our material
+		if (material != boundMaterial) {
+			boundMaterial = material;
+			boundMaterial->Apply(shader);
+			_stats.MaterialChanges++;
+		}
+
+		if (vao != boundVao || shaderChanged) {
+			if (vao != boundVao) {
+				boundVao = vao;
+				_stats.VaoChanges++;
+			}
+
+			// Packed vertices need to be decoded in the vertex shader, this is program state so it needs to be set
+			// whenever the shader or the mesh changes
+			const ShaderProgram::VertexFormatUniforms& formatUniforms = boundShader->GetVertexFormatUniforms();
+			if (formatUniforms.PackedNormals != -1) {
+				bool isPacked = vao->HasPackedNormals();
+				boundShader->SetUniform(formatUniforms.PackedNormals, &isPacked);
+			}
+			if (formatUniforms.PositionTransform != -1) {
+				boundShader->SetUniformMatrix(formatUniforms.PositionTransform, &vao->GetPositionTransform());
+			}
+		}
+
+		if (instanced) {
+			// Make sure the mesh can read from our instance buffer, then draw the whole batch
+			_AttachInstanceBuffer(vao);
+			vao->DrawInstanced(batch.Count, DrawMode::TriangleList, batch.BaseInstance);
+			_stats.InstancedDraws++;
+			_stats.InstancedObjects += batch.Count;
+		} else {
+			// Grab the game object so we can do some stuff with it
+			GameObject* object = renderable->GetGameObject();
+
+			// Meshes with packed positions need to be scaled back out to model space, but their normals don't,
+			// so the normal matrix still comes from the object's transform
+			const glm::mat4 model = _GetModelMatrix(object, vao);
+
+			InstanceLevelUniforms instanceData;
+			instanceData.u_Model = model;
+			instanceData.u_ModelViewProjection = viewProj * model;
+			instanceData.u_ModelView = view * model;
+			instanceData.u_NormalMatrix = glm::mat4(object->GetNormalMatrix());
+
+			// Write our instance level uniforms straight into mapped memory, and bind just that range
+			RingBuffer::Allocation allocation = _transientUniforms->Write(instanceData);
+			if (allocation.IsValid()) {
+				_transientUniforms->BindRange(allocation, INSTANCE_UBO_BINDING);
+			}
+			// If the ring buffer is full (it will grow next frame), fall back to our regular UBO
+			else {
+				_instanceUniforms->SetData(instanceData);
+				_instanceUniforms->Bind(INSTANCE_UBO_BINDING);
+			}
+
+			// Draw the object
+			vao->Draw();
+		}
+		_stats.DrawCalls++;
+	}
+
+	// Fence off this frame's uniforms, and restore our regular instance UBO for anything drawn after us
+	_transientUniforms->EndFrame();
+	_instanceUniforms->Bind(INSTANCE_UBO_BINDING);
 
 	// Use our cubemap to draw our skybox
 	app.CurrentScene()->DrawSkybox();
@@ -233,25 +457,77 @@ void RenderLayer::_AccumulateLighting()
 	};
 	_ClearFramebuffer(_lightingFBO, colors, 2);  
 
+	// Grab the result from the oldest timer before we re-use it
+	GLuint timer = _lightingTimers[_lightingTimerFrame % LIGHTING_TIMER_COUNT];
+	if (_lightingTimerFrame >= LIGHTING_TIMER_COUNT) {
+		GLint available = 0;
+		glGetQueryObjectiv(timer, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint64 elapsedNs = 0;
+			glGetQueryObjectui64v(timer, GL_QUERY_RESULT, &elapsedNs);
+			_lightingGpuMs = static_cast<float>(elapsedNs / 1000000.0);
+		}
+	}
+	glBeginQuery(GL_TIME_ELAPSED, timer);
+
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 
-	// Bind our shader for processing lighting
-	_lightAccumulationShader->Bind();
-
 	// Bind our G-Buffer textures so that they're readable
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Depth)->Bind(0);  // depth
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color0)->Bind(1); // albedo + spec
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color1)->Bind(2); // normals + metallic
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color2)->Bind(3); // emissive
-	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color3)->Bind(4); // view pos
-
-	const glm::mat4& view = scene->MainCamera->GetView();
+	// The compact layout rebuilds view positions from depth instead
+	if (Texture2D::Sptr position = _primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color3)) {
+		position->Bind(4); // view pos
+	}
 
 	// Send in how many active lights we have and the global lighting settings
 	data.AmbientCol = glm::vec3(0.1f);
+
+	if (_lightingMode == LightingMode::Volumes) {
+		_AccumulateVolumeLighting();
+	} else {
+		// Our fullscreen passes all land at the same depth, so with depth testing on every batch after
+		// the first would fail against the depth written by the first one
+		glDisable(GL_DEPTH_TEST);
+		glDepthMask(GL_FALSE);
+
+		// Clustering relies on the light ranges, so we only use it for perspective cameras
+		if (_lightingMode == LightingMode::Clustered && !scene->MainCamera->GetOrthoEnabled()) {
+			_AccumulateClusteredLighting();
+		} else {
+			_AccumulateFullscreenLighting();
+		}
+
+		glEnable(GL_DEPTH_TEST);
+		glDepthMask(GL_TRUE);
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	_lightingTimerFrame++;
+	_stats.LightingGpuMs = _lightingGpuMs;
+
+	// Unbind the lighting FBO so we can read its textures
+	_lightingFBO->Unbind();
+}
+
+void RenderLayer::_AccumulateFullscreenLighting()
+{
+	using namespace Gameplay;
+
+	Application& app = Application::Get();
+	Scene::Sptr& scene = app.CurrentScene();
+	LightingUboStruct& data = _lightingUbo->GetData();
+
+	// Bind our shader for processing lighting
+	_lightAccumulationShader->Bind();
+
+	const glm::mat4& view = scene->MainCamera->GetView();
+
 	int ix = 0;
-	app.CurrentScene()->Components().Each<Light>([&](const Light::Sptr& light) {
+	app.CurrentScene()->Components().EachRaw<Light>([&](Light* light) {
 		// Get the light's position in view space, since we're doing view space lighting
 		glm::vec4 pos = glm::vec4(light->GetGameObject()->GetWorldPosition(), 1.0f);
 		pos = view * pos;
@@ -263,6 +539,7 @@ void RenderLayer::_AccumulateLighting()
 		data.Lights[ix].Attenuation = 1.0f / (1.0f + light->GetRadius());  
 
 		ix++;
+		_stats.Lights++;
 
 		// If we've reached the max # of lights the shader supports, draw to the screen and start the next batch
 		if (ix == MAX_LIGHTS) {
@@ -272,7 +549,7 @@ void RenderLayer::_AccumulateLighting()
 			_lightingUbo->Update();
 
 			// Draw the fullscreen quad to accumulate the lights
-			_fullscreenQuad->Draw();
+			_DrawLightBatch();
 
 			ix = 0;
 		}
@@ -286,11 +563,157 @@ void RenderLayer::_AccumulateLighting()
 		_lightingUbo->Update();
 
 		// Draw the fullscreen quad to accumulate the lights
-		_fullscreenQuad->Draw();
+		_DrawLightBatch();
 	}
+}
 
-	// Unbind the lighting FBO so we can read its textures
-	_lightingFBO->Unbind();
+void RenderLayer::_DrawLightBatch()
+{
+	// Batches are blended on top of each other at the same depth, anything that turns depth testing back
+	// on between them will silently drop every batch after the first
+	LOG_ASSERT(_stats.LightBatches == 0 || !glIsEnabled(GL_DEPTH_TEST), "Depth testing must be disabled when accumulating multiple light batches!");
+
+	_fullscreenQuad->Draw();
+	_stats.LightBatches++;
+}
+
+void RenderLayer::_AccumulateClusteredLighting()
+{
+	using namespace Gameplay;
+
+	Application& app = Application::Get();
+	Scene::Sptr& scene = app.CurrentScene();
+	Camera::Sptr& camera = scene->MainCamera;
+	LightingUboStruct& data = _lightingUbo->GetData();
+
+	const glm::mat4& view = camera->GetView();
+
+	_lightClusters->Clear();
+	int uboLights = 0;
+	scene->Components().EachRaw<Light>([&](Light* light) {
+		glm::vec4 pos = view * glm::vec4(light->GetGameObject()->GetWorldPosition(), 1.0f);
+		glm::vec3 viewPos = glm::vec3(pos) / pos.w;
+		_lightClusters->AddLight(viewPos, light->GetRadius(), light->GetColor(), light->GetIntensity());
+
+		// Forward shaders still read lights from the UBO, so we give them the first batch
+		if (uboLights < MAX_LIGHTS) {
+			data.Lights[uboLights].Position = viewPos;
+			data.Lights[uboLights].Intensity = light->GetIntensity();
+			data.Lights[uboLights].Color = light->GetColor();
+			data.Lights[uboLights].Attenuation = 1.0f / (1.0f + light->GetRadius());
+			uboLights++;
+		}
+	});
+	data.NumLights = static_cast<float>(uboLights);
+	_lightingUbo->Update();
+
+	_lightClusters->Build(camera->GetProjection(), camera->GetNearPlane(), camera->GetFarPlane());
+	_lightClusters->Bind(CLUSTER_LIGHTS_SSBO_BINDING, CLUSTER_RANGES_SSBO_BINDING, CLUSTER_INDICES_SSBO_BINDING);
+
+	_stats.Lights = _lightClusters->GetLightCount();
+	_stats.ClusterLightRefs = _lightClusters->GetLightReferenceCount();
+
+	// Every pixel is shaded exactly once, against the lights in it's cluster
+	_clusteredLightShader->Bind();
+	_clusteredLightShader->SetUniform("u_ClusterSliceScaleBias", _lightClusters->GetSliceScaleBias());
+	_DrawLightBatch();
+}
+
+void RenderLayer::_AccumulateVolumeLighting()
+{
+	using namespace Gameplay;
+
+	Application& app = Application::Get();
+	Scene::Sptr& scene = app.CurrentScene();
+	Camera::Sptr& camera = scene->MainCamera;
+	LightingUboStruct& data = _lightingUbo->GetData();
+
+	const glm::mat4& view = camera->GetView();
+	const float zNear = camera->GetNearPlane();
+
+	// Copy the G-Buffer's depth into our lighting depth-stencil buffer so that we can
+	// test our light volumes against the scene
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_ALWAYS);
+	_depthCopyShader->Bind();
+	_fullscreenQuad->Draw();
+	glDepthFunc(GL_LESS);
+
+	const GLint clearStencil = 0;
+	glClearNamedFramebufferiv(_lightingFBO->GetHandle(), GL_STENCIL, 0, &clearStencil);
+
+	// Depth is read only from here on. Depth clamping stops the back of large volumes
+	// from being clipped by the far plane
+	glDepthMask(GL_FALSE);
+	glEnable(GL_STENCIL_TEST);
+	glEnable(GL_DEPTH_CLAMP);
+
+	int uboLights = 0;
+	scene->Components().EachRaw<Light>([&](Light* light) {
+		glm::vec4 pos = view * glm::vec4(light->GetGameObject()->GetWorldPosition(), 1.0f);
+		glm::vec3 viewPos = glm::vec3(pos) / pos.w;
+		float radius = light->GetRadius();
+
+		// Forward shaders still read lights from the UBO, so we give them the first batch
+		if (uboLights < MAX_LIGHTS) {
+			data.Lights[uboLights].Position = viewPos;
+			data.Lights[uboLights].Intensity = light->GetIntensity();
+			data.Lights[uboLights].Color = light->GetColor();
+			data.Lights[uboLights].Attenuation = 1.0f / (1.0f + radius);
+			uboLights++;
+		}
+		_stats.Lights++;
+
+		// Lights that are entirely behind the camera can't touch anything on screen
+		if (viewPos.z - radius > -zNear) {
+			return;
+		}
+
+		const glm::vec4 posRadius = glm::vec4(viewPos, radius);
+
+		// Mark the pixels where the scene is inside the volume. Back faces behind the scene
+		// increment, front faces behind the scene decrement, so only pixels between the
+		// front and back of the sphere are left non-zero. Using depth fail means this still
+		// works when the camera is inside the volume
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		glEnable(GL_DEPTH_TEST);
+		glDisable(GL_CULL_FACE);
+		glStencilFunc(GL_ALWAYS, 0, 0xFF);
+		glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+		glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+
+		_lightVolumeStencilShader->Bind();
+		_lightVolumeStencilShader->SetUniform("u_LightPosRadius", posRadius);
+		_lightVolumeMesh->Draw();
+
+		// Shade the marked pixels, drawing back faces so that each pixel is only touched once
+		// even when the camera is inside the volume. We zero the stencil as we go, so it's
+		// clean for the next light
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_CULL_FACE);
+		glCullFace(GL_FRONT);
+		glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+		glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+
+		_lightVolumeShader->Bind();
+		_lightVolumeShader->SetUniform("u_LightPosRadius", posRadius);
+		_lightVolumeShader->SetUniform("u_LightColorIntensity", glm::vec4(light->GetColor(), light->GetIntensity()));
+		_lightVolumeMesh->Draw();
+	});
+	data.NumLights = static_cast<float>(uboLights);
+	_lightingUbo->Update();
+
+	// Restore our default states
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glCullFace(GL_BACK);
+	glEnable(GL_CULL_FACE);
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_STENCIL_TEST);
+	glDisable(GL_DEPTH_CLAMP);
 }
 
 void RenderLayer::_Composite()
@@ -364,6 +787,49 @@ void RenderLayer::_ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4*
 	glDepthFunc(GL_LESS);
 }
 
+void RenderLayer::_UpdateCullingProxy(RenderComponent* renderable, const AABB& bounds) {
+	auto it = _cullingProxies.find(renderable);
+	if (it == _cullingProxies.end()) {
+		CullingProxy proxy;
+		proxy.Leaf = _cullingBvh.Insert(bounds, renderable);
+		proxy.LastSeenFrame = _cullingFrame;
+		_cullingProxies[renderable] = proxy;
+	} else {
+		_cullingBvh.Update(it->second.Leaf, bounds);
+		it->second.LastSeenFrame = _cullingFrame;
+	}
+}
+
+glm::mat4 RenderLayer::_GetModelMatrix(const Gameplay::GameObject* object, const VertexArrayObject* vao) {
+	return vao->HasPositionTransform() ? object->GetTransform() * vao->GetPositionTransform() : object->GetTransform();
+}
+
+void RenderLayer::_AttachInstanceBuffer(VertexArrayObject* vao) {
+	if (vao->HasVertexBuffer(_instanceBuffer)) {
+		return;
+	}
+
+	// Sending our 2 matrices as attributes, see InstanceData
+	vao->AddVertexBuffer(_instanceBuffer, {
+		BufferAttribute(8,  4, AttributeType::Float, sizeof(InstanceData), 0, AttribUsage::User0),
+		BufferAttribute(9,  4, AttributeType::Float, sizeof(InstanceData), 4 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(10, 4, AttributeType::Float, sizeof(InstanceData), 8 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(11, 4, AttributeType::Float, sizeof(InstanceData), 12 * sizeof(float), AttribUsage::User0),
+
+		BufferAttribute(12, 3, AttributeType::Float, sizeof(InstanceData), 16 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(13, 3, AttributeType::Float, sizeof(InstanceData), 20 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(14, 3, AttributeType::Float, sizeof(InstanceData), 24 * sizeof(float), AttribUsage::User0),
+	}, true);
+}
+
+nlohmann::json RenderLayer::GetDefaultConfig()
+{
+	nlohmann::json result;
+	result["lighting_mode"] = ~_lightingMode;
+	result["compact_gbuffer"] = *(_renderFlags & RenderFlags::CompactGBuffer);
+	return result;
+}
+
 void RenderLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize)
 {
 	if (newSize.x * newSize.y == 0) return;
@@ -382,33 +848,29 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 {
 	Application& app = Application::Get();
 
+	nlohmann::json settings = config.contains(Name) ? config[Name] : nlohmann::json();
+	_lightingMode = JsonParseEnum(LightingMode, settings, "lighting_mode", _lightingMode);
+	if (JsonGet(settings, "compact_gbuffer", false)) {
+		_renderFlags = _renderFlags | RenderFlags::CompactGBuffer;
+	}
+
 	// GL states, we'll enable depth testing and backface fulling
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 
+	// Create the primary FBO
+	_CreateGBuffer(app.GetWindowSize());
+
 	// Create a new descriptor for our FBO
 	FramebufferDescriptor fboDescriptor;
 	fboDescriptor.Width = app.GetWindowSize().x;
 	fboDescriptor.Height = app.GetWindowSize().y;
 
-	// We want to use a 32 bit depth buffer, we'll ignore the stencil buffer for now
-	fboDescriptor.RenderTargets[RenderTargetAttachment::Depth] = RenderTargetDescriptor(RenderTargetType::Depth32);
-	// Color layer 0 (albedo, specular)
-	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
-	// Color layer 1 (normals, metallic)
-	fboDescriptor.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
-	// Color layer 2 (emissive)  
-	fboDescriptor.RenderTargets[RenderTargetAttachment::Color2] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
-	// Color layer 3 (view space position)  
-	fboDescriptor.RenderTargets[RenderTargetAttachment::Color3] = RenderTargetDescriptor(RenderTargetType::ColorRgba16F);
-	 
-	// Create the primary FBO
-	_primaryFBO = std::make_shared<Framebuffer>(fboDescriptor);
-
-	fboDescriptor.RenderTargets.clear();
 	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Diffuse
 	fboDescriptor.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Specular
+	// Depth and stencil for light volumes, we copy the G-Buffer depth in here since it has no stencil
+	fboDescriptor.RenderTargets[RenderTargetAttachment::DepthStencil] = RenderTargetDescriptor(RenderTargetType::DepthStencil, false);
 
 	_lightingFBO = std::make_shared<Framebuffer>(fboDescriptor);
 
@@ -430,6 +892,26 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	_compositingShader->LoadShaderPartFromFile("shaders/fragment_shaders/deferred_composite.glsl", ShaderPartType::Fragment);
 	_compositingShader->Link();
 
+	_clusteredLightShader = ShaderProgram::Create();
+	_clusteredLightShader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_quad.glsl", ShaderPartType::Vertex);
+	_clusteredLightShader->LoadShaderPartFromFile("shaders/fragment_shaders/light_clustered.glsl", ShaderPartType::Fragment);
+	_clusteredLightShader->Link();
+
+	_lightVolumeShader = ShaderProgram::Create();
+	_lightVolumeShader->LoadShaderPartFromFile("shaders/vertex_shaders/light_volume.glsl", ShaderPartType::Vertex);
+	_lightVolumeShader->LoadShaderPartFromFile("shaders/fragment_shaders/light_volume.glsl", ShaderPartType::Fragment);
+	_lightVolumeShader->Link();
+
+	_lightVolumeStencilShader = ShaderProgram::Create();
+	_lightVolumeStencilShader->LoadShaderPartFromFile("shaders/vertex_shaders/light_volume.glsl", ShaderPartType::Vertex);
+	_lightVolumeStencilShader->LoadShaderPartFromFile("shaders/fragment_shaders/light_volume_stencil.glsl", ShaderPartType::Fragment);
+	_lightVolumeStencilShader->Link();
+
+	_depthCopyShader = ShaderProgram::Create();
+	_depthCopyShader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_quad.glsl", ShaderPartType::Vertex);
+	_depthCopyShader->LoadShaderPartFromFile("shaders/fragment_shaders/depth_copy.glsl", ShaderPartType::Fragment);
+	_depthCopyShader->Link();
+
 	_clearShader = ShaderProgram::Create();
 	_clearShader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_quad.glsl", ShaderPartType::Vertex);
 	_clearShader->LoadShaderPartFromFile("shaders/fragment_shaders/clear.glsl", ShaderPartType::Fragment);
@@ -450,10 +932,36 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 		BufferAttribute(0, 2, AttributeType::Float, sizeof(glm::vec2), 0, AttribUsage::Position)
 	});
 
+	// Light volumes use a low poly sphere. The flat faces of an ico-sphere cut inside the sphere
+	// it approximates, so we find the closest face and scale the mesh up until it touches radius 1
+	MeshBuilder<VertexPosNormTexCol> sphere;
+	MeshFactory::AddIcoSphere(sphere, glm::vec3(0.0f), 1.0f, 1);
+	float minFaceDistance = 1.0f;
+	for (size_t ix = 0; ix + 2 < sphere.GetIndexCount(); ix += 3) {
+		const glm::vec3& a = sphere.GetVertexDataPtr()[sphere.GetIndexDataPtr()[ix + 0]].Position;
+		const glm::vec3& b = sphere.GetVertexDataPtr()[sphere.GetIndexDataPtr()[ix + 1]].Position;
+		const glm::vec3& c = sphere.GetVertexDataPtr()[sphere.GetIndexDataPtr()[ix + 2]].Position;
+		glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+		minFaceDistance = glm::min(minFaceDistance, glm::abs(glm::dot(normal, a)));
+	}
+	sphere.Reset();
+	MeshFactory::AddIcoSphere(sphere, glm::vec3(0.0f), 1.0f / minFaceDistance, 1);
+	_lightVolumeMesh = sphere.Bake();
+
 	// Create our common uniform buffers
 	_frameUniforms = std::make_shared<UniformBuffer<FrameLevelUniforms>>(BufferUsage::DynamicDraw);
 	_instanceUniforms = std::make_shared<UniformBuffer<InstanceLevelUniforms>>(BufferUsage::DynamicDraw);
 	_lightingUbo = std::make_shared<UniformBuffer<LightingUboStruct>>(BufferUsage::DynamicDraw);
+
+	// Transient storage for per-object uniforms, will grow as needed
+	_transientUniforms = RingBuffer::Create(BufferType::Uniform, TRANSIENT_UNIFORM_FRAME_SIZE);
+
+	// Per-instance data for automatic instancing, will grow as needed
+	_instanceBuffer = VertexBuffer::Create(BufferUsage::DynamicDraw);
+
+	// Light lists for clustered lighting, will grow as needed
+	_lightClusters = LightClusterGrid::Create();
+	glCreateQueries(GL_TIME_ELAPSED, LIGHTING_TIMER_COUNT, _lightingTimers);
 }
 
 const Framebuffer::Sptr& RenderLayer::GetPrimaryFBO() const {
@@ -481,13 +989,55 @@ void RenderLayer::SetClearColor(const glm::vec4 & value) {
 }
 
 void RenderLayer::SetRenderFlags(RenderFlags value) {
+	bool layoutChanged = (value & RenderFlags::CompactGBuffer) != (_renderFlags & RenderFlags::CompactGBuffer);
 	_renderFlags = value;
+
+	// The G-Buffer only exists once we've loaded
+	if (layoutChanged && _primaryFBO != nullptr) {
+		_CreateGBuffer(_primaryFBO->GetSize());
+	}
 }
 
 RenderFlags RenderLayer::GetRenderFlags() const {
 	return _renderFlags;
 }
 
+void RenderLayer::SetSortingEnabled(bool value) {
+	_sortDraws = value;
+}
+
+bool RenderLayer::IsSortingEnabled() const {
+	return _sortDraws;
+}
+
+void RenderLayer::SetInstancingEnabled(bool value) {
+	_autoInstancing = value;
+}
+
+bool RenderLayer::IsInstancingEnabled() const {
+	return _autoInstancing;
+}
+
+void RenderLayer::SetCullingEnabled(bool value) {
+	_frustumCulling = value;
+}
+
+bool RenderLayer::IsCullingEnabled() const {
+	return _frustumCulling;
+}
+
+void RenderLayer::SetLightingMode(LightingMode value) {
+	_lightingMode = value;
+}
+
+LightingMode RenderLayer::GetLightingMode() const {
+	return _lightingMode;
+}
+
+const RenderLayer::RenderStats& RenderLayer::GetRenderStats() const {
+	return _stats;
+}
+
 const Framebuffer::Sptr& RenderLayer::GetLightingBuffer() const {
 	return _lightingFBO;
 }
@@ -497,3 +1047,44 @@ const Framebuffer::Sptr& RenderLayer::GetGBuffer() const
 	return _primaryFBO;
 }
 
+uint32_t RenderLayer::GetGBufferBytesPerPixel() const
+{
+	uint32_t result = 0;
+	for (RenderTargetAttachment attachment : { RenderTargetAttachment::Depth, RenderTargetAttachment::Color0, RenderTargetAttachment::Color1, RenderTargetAttachment::Color2, RenderTargetAttachment::Color3 }) {
+		Texture2D::Sptr texture = _primaryFBO->GetTextureAttachment(attachment);
+		if (texture != nullptr) {
+			result += static_cast<uint32_t>(GetRenderTargetTexelSize(static_cast<RenderTargetType>(texture->GetDescription().Format)));
+		}
+	}
+	return result;
+}
+
+void RenderLayer::_CreateGBuffer(const glm::ivec2& size)
+{
+	FramebufferDescriptor fboDescriptor;
+	fboDescriptor.Width = size.x;
+	fboDescriptor.Height = size.y;
+
+	// We want to use a 32 bit depth buffer, we'll ignore the stencil buffer for now
+	fboDescriptor.RenderTargets[RenderTargetAttachment::Depth] = RenderTargetDescriptor(RenderTargetType::Depth32);
+	// Color layer 0 (albedo, specular)
+	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
+
+	if (*(_renderFlags & RenderFlags::CompactGBuffer)) {
+		// Color layer 1 (octahedral normals)
+		fboDescriptor.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRG16);
+		// Color layer 2 (pre-multiplied emissive, metallic)
+		fboDescriptor.RenderTargets[RenderTargetAttachment::Color2] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
+		// View space position is rebuilt from depth
+	} else {
+		// Color layer 1 (normals, metallic)
+		fboDescriptor.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
+		// Color layer 2 (emissive)  
+		fboDescriptor.RenderTargets[RenderTargetAttachment::Color2] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
+		// Color layer 3 (view space position)  
+		fboDescriptor.RenderTargets[RenderTargetAttachment::Color3] = RenderTargetDescriptor(RenderTargetType::ColorRgba16F);
+	}
+
+	_primaryFBO = std::make_shared<Framebuffer>(fboDescriptor);
+}
+
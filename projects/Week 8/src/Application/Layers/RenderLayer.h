@@ -2,14 +2,40 @@
 #include "../ApplicationLayer.h"
 #include "Graphics/Framebuffer.h"
 #include "Graphics/Buffers/UniformBuffer.h"
+#include "Graphics/Buffers/RingBuffer.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/RenderQueue.h"
+#include "Graphics/BoundingVolumeHierarchy.h"
+#include "Graphics/LightClusterGrid.h"
 
 #define MAX_LIGHTS 8
 
+class RenderComponent;
+namespace Gameplay {
+	class Material;
+	class GameObject;
+}
+
 ENUM_FLAGS(RenderFlags, uint32_t,
 	None = 0,
-	EnableColorCorrection = 1 << 0
+	EnableColorCorrection = 1 << 0,
+	// Use the compact G-Buffer layout, see fragments/gbuffer_output.glsl
+	CompactGBuffer        = 1 << 1
+);
+
+/// <summary>
+/// The methods we can use to accumulate deferred lighting
+/// </summary>
+ENUM(LightingMode, int,
+	// Lights are drawn in batches of MAX_LIGHTS, with a fullscreen pass per batch
+	Fullscreen = 0,
+	// Lights are binned into clusters on the CPU, and each pixel is shaded once against only
+	// the lights in it's cluster
+	Clustered  = 1,
+	// Each light is drawn as a sphere covering it's range, with the stencil buffer marking
+	// which pixels are actually inside the sphere so only those get shaded
+	Volumes    = 2
 );
 
 class RenderLayer final : public ApplicationLayer {
@@ -26,6 +52,8 @@ public:
 		glm::mat4 u_Projection;
 		// The combined viewProject matrix
 		glm::mat4 u_ViewProjection;
+		// The inverse of the projection matrix, for rebuilding view positions from depth
+		glm::mat4 u_InverseProjection;
 		// The camera's position in world space
 		glm::vec4 u_CameraPos;
 		// The time in seconds since the start of the application
@@ -52,6 +80,15 @@ public:
 		glm::mat4 u_NormalMatrix;
 	};
 
+	// Structure for our per-instance vertex attributes, matches the
+	// instanced inputs in fragments/vs_common.glsl
+	struct InstanceData {
+		// The model transform, fed to attributes 8-11
+		glm::mat4 Model;
+		// The normal matrix, only the first 3 columns are used (attributes 12-14)
+		glm::mat4 NormalMatrix;
+	};
+
 	/// <summary>
 	/// Represents a c++ struct layout that matches that of
 	/// our multiple light uniform buffer
@@ -78,6 +115,43 @@ public:
 		glm::mat4 EnvironmentRotation;
 	};
 
+	/// <summary>
+	/// Stores some statistics about the last frame that was rendered, lets us
+	/// see how effective our draw sorting is at removing redundant state changes
+	/// </summary>
+	struct RenderStats {
+		// The number of draw calls issued to OpenGL
+		uint32_t DrawCalls        = 0;
+		// The number of draw calls that were instanced
+		uint32_t InstancedDraws   = 0;
+		// The number of objects that were drawn as part of an instanced draw
+		uint32_t InstancedObjects = 0;
+		// The number of times we had to bind a new shader program
+		uint32_t ShaderChanges    = 0;
+		// The number of times we had to apply a new material
+		uint32_t MaterialChanges  = 0;
+		// The number of times the mesh being drawn changed
+		uint32_t VaoChanges       = 0;
+		// The number of objects that were tested against the camera frustum
+		uint32_t CullTested       = 0;
+		// The number of objects that were outside the camera frustum
+		uint32_t Culled           = 0;
+		// The number of lights in the scene
+		uint32_t Lights           = 0;
+		// The number of fullscreen lighting passes drawn (fullscreen and clustered lighting only)
+		uint32_t LightBatches     = 0;
+		// The number of light references across all clusters (clustered lighting only)
+		uint32_t ClusterLightRefs = 0;
+		// GPU time spent accumulating lighting, in milliseconds. This lags a couple of frames
+		// behind, since we don't want to stall waiting for the result
+		float    LightingGpuMs    = 0.0f;
+
+		/// <summary>
+		/// Gets the total number of state changes in the frame
+		/// </summary>
+		uint32_t StateChanges() const { return ShaderChanges + MaterialChanges + VaoChanges; }
+	};
+
 	RenderLayer();
 	virtual ~RenderLayer();
 
@@ -95,13 +169,50 @@ public:
 	void SetRenderFlags(RenderFlags value);
 	RenderFlags GetRenderFlags() const;
 
+	/// <summary>
+	/// Sets whether draws should be sorted by their render state before being submitted,
+	/// if false objects will be drawn in the order they were created
+	/// </summary>
+	void SetSortingEnabled(bool value);
+	bool IsSortingEnabled() const;
+
+	/// <summary>
+	/// Sets whether objects that share a mesh and material should be batched into
+	/// instanced draw calls. Only has an effect for shaders that support instancing
+	/// </summary>
+	void SetInstancingEnabled(bool value);
+	bool IsInstancingEnabled() const;
+
+	/// <summary>
+	/// Sets whether objects outside of the camera's frustum should be skipped. Objects
+	/// with meshes that do not have bounds are never culled
+	/// </summary>
+	void SetCullingEnabled(bool value);
+	bool IsCullingEnabled() const;
+
+	/// <summary>
+	/// Sets how deferred lighting is accumulated
+	/// </summary>
+	void SetLightingMode(LightingMode value);
+	LightingMode GetLightingMode() const;
+
+	/// <summary>
+	/// Gets the render statistics from the last frame
+	/// </summary>
+	const RenderStats& GetRenderStats() const;
+
 	const Framebuffer::Sptr& GetLightingBuffer() const;
 	const Framebuffer::Sptr& GetRenderOutput() const;
 	const Framebuffer::Sptr& GetGBuffer() const;
+	/// <summary>
+	/// Gets the number of bytes each pixel takes up across all the G-Buffer's targets, including depth
+	/// </summary>
+	uint32_t GetGBufferBytesPerPixel() const;
 
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual nlohmann::json GetDefaultConfig() override;
 	virtual void OnPreRender() override;
 	virtual void OnRender(const Framebuffer::Sptr& prevLayer) override;
 	virtual void OnPostRender() override;
@@ -114,24 +225,121 @@ protected:
 
 	ShaderProgram::Sptr _clearShader;
 	ShaderProgram::Sptr _lightAccumulationShader;
+	ShaderProgram::Sptr _clusteredLightShader;
+	ShaderProgram::Sptr _lightVolumeShader;
+	ShaderProgram::Sptr _lightVolumeStencilShader;
+	ShaderProgram::Sptr _depthCopyShader;
 	ShaderProgram::Sptr _compositingShader;
 
 	VertexArrayObject::Sptr _fullscreenQuad;
+	// A unit sphere, scaled so that it's faces fully contain the sphere
+	VertexArrayObject::Sptr _lightVolumeMesh;
 
 	bool              _blitFbo;
 	glm::vec4         _clearColor;
 	RenderFlags       _renderFlags;
 
+	// Our draw sorting info, these are kept between frames to avoid re-allocating
+	bool              _sortDraws;
+	RenderQueue       _renderQueue;
+	std::vector<RenderComponent*> _drawList;
+	std::unordered_map<const Gameplay::Material*, uint32_t> _materialIds;
+	RenderStats       _stats;
+
+	// A run of entries in the sorted render queue that will be drawn with a single call.
+	// BaseInstance is the offset into our instance buffer, or NO_INSTANCING for regular draws
+	struct DrawBatch {
+		uint32_t First;
+		uint32_t Count;
+		uint32_t BaseInstance;
+	};
+	static const uint32_t NO_INSTANCING = ~0u;
+	// The smallest number of matching objects we will bother instancing
+	static const uint32_t MIN_INSTANCE_BATCH = 2;
+
+	// Our automatic instancing info, the instance buffer is shared between all meshes
+	bool              _autoInstancing;
+	std::vector<DrawBatch>    _drawBatches;
+	std::vector<InstanceData> _instanceData;
+	VertexBuffer::Sptr        _instanceBuffer;
+
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
 
 	const int INSTANCE_UBO_BINDING = 1;
 	UniformBuffer<InstanceLevelUniforms>::Sptr _instanceUniforms;
 
+	// Per-object uniforms are allocated from here each frame, instead of updating _instanceUniforms for every draw
+	const uint32_t TRANSIENT_UNIFORM_FRAME_SIZE = 256 * 1024;
+	RingBuffer::Sptr _transientUniforms;
+
+	// Tracks where a render component is in our culling BVH
+	struct CullingProxy {
+		BoundingVolumeHierarchy::Handle Leaf;
+		// The last frame the component was seen, so we can remove components that no longer exist
+		uint32_t LastSeenFrame;
+	};
+
+	// Our frustum culling info, renderables are kept in the BVH between frames so that we
+	// only need to touch the tree when objects move
+	bool                    _frustumCulling;
+	BoundingVolumeHierarchy _cullingBvh;
+	std::unordered_map<RenderComponent*, CullingProxy> _cullingProxies;
+	std::vector<void*>      _visibleProxies;
+	uint32_t                _cullingFrame;
+
 	const int LIGHTING_UBO_BINDING = 2;
 	UniformBuffer<LightingUboStruct>::Sptr _lightingUbo;
 
+	// Shader storage slots for our light clusters, matches fragments/clustered_lights.glsl
+	const int CLUSTER_LIGHTS_SSBO_BINDING  = 0;
+	const int CLUSTER_RANGES_SSBO_BINDING  = 1;
+	const int CLUSTER_INDICES_SSBO_BINDING = 2;
+
+	LightingMode          _lightingMode;
+	LightClusterGrid::Sptr _lightClusters;
+
+	// Timer queries for measuring the lighting pass, we cycle through them so that we can read
+	// results from a few frames ago without waiting on the GPU
+	static const uint32_t LIGHTING_TIMER_COUNT = 3;
+	GLuint   _lightingTimers[LIGHTING_TIMER_COUNT];
+	uint32_t _lightingTimerFrame;
+	float    _lightingGpuMs;
+
 	void _AccumulateLighting();
+	/// <summary>
+	/// Draws all lights with fullscreen passes, MAX_LIGHTS at a time
+	/// </summary>
+	void _AccumulateFullscreenLighting();
+	/// <summary>
+	/// Draws a single fullscreen pass with the currently bound lighting shader
+	/// </summary>
+	void _DrawLightBatch();
+	/// <summary>
+	/// Bins all lights into clusters and draws them with a single fullscreen pass
+	/// </summary>
+	void _AccumulateClusteredLighting();
+	/// <summary>
+	/// Draws each light as a sphere, using the stencil buffer to only shade pixels inside the light's range
+	/// </summary>
+	void _AccumulateVolumeLighting();
 	void _Composite();
+	/// <summary>
+	/// Creates the G-Buffer with the layout selected by our render flags
+	/// </summary>
+	void _CreateGBuffer(const glm::ivec2& size);
 	void _ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers);
+	/// <summary>
+	/// Adds our instance buffer to the given VAO if it has not been added already
+	/// </summary>
+	void _AttachInstanceBuffer(VertexArrayObject* vao);
+	/// <summary>
+	/// Inserts or updates a render component in our culling BVH
+	/// </summary>
+	void _UpdateCullingProxy(RenderComponent* renderable, const AABB& bounds);
+	/// <summary>
+	/// Gets the matrix that takes a mesh's vertices into world space, including the mesh's position
+	/// transform if it has packed positions
+	/// </summary>
+	static glm::mat4 _GetModelMatrix(const Gameplay::GameObject* object, const VertexArrayObject* vao);
 };
\ No newline at end of file
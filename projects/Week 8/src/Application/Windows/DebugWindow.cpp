@@ -2,6 +2,11 @@
 #include "Application/Application.h"
 #include "Application/ApplicationLayer.h"
 #include "Application/Layers/RenderLayer.h"
+#include "Application/Layers/LightingBenchmarkLayer.h"
+#include "Benchmarks/ComponentBenchmark.h"
+#include "Benchmarks/PhysicsBenchmark.h"
+#include "Benchmarks/ObjParserBenchmark.h"
+#include "Graphics/GuiBatcher.h"
 
 DebugWindow::DebugWindow() :
 	IEditorWindow()
@@ -24,6 +29,30 @@ void DebugWindow::RenderMenuBar()
 		app.CurrentScene()->SetPhysicsDebugDrawMode(physicsDrawMode);
 	}
 
+	bool parallelUpdate = app.CurrentScene()->IsParallelUpdateEnabled();
+	if (ImGui::Checkbox("Parallel Component Updates", &parallelUpdate)) {
+		app.CurrentScene()->SetParallelUpdateEnabled(parallelUpdate);
+	}
+	ImGui::SameLine();
+	ImGui::Text("Transforms Updated: %u", app.CurrentScene()->GetLastTransformUpdateCount());
+
+	PhysicsThreadingMode physicsThreading = app.CurrentScene()->GetPhysicsThreadingMode();
+	int physicsThreads = app.CurrentScene()->GetPhysicsThreadCount();
+	bool threadingChanged = false;
+	if (ImGui::BeginCombo("Physics Threading", (~physicsThreading).c_str())) {
+		for (PhysicsThreadingMode mode : { PhysicsThreadingMode::Sequential, PhysicsThreadingMode::IslandPool, PhysicsThreadingMode::IslandPoolMt }) {
+			if (ImGui::Selectable((~mode).c_str(), mode == physicsThreading)) {
+				physicsThreading = mode;
+				threadingChanged = true;
+			}
+		}
+		ImGui::EndCombo();
+	}
+	threadingChanged |= ImGui::SliderInt("Physics Threads (0 = all)", &physicsThreads, 0, BulletTaskScheduler::Get().getMaxNumThreads());
+	if (threadingChanged) {
+		app.CurrentScene()->SetPhysicsThreading(physicsThreading, physicsThreads);
+	}
+
 	ImGui::Separator();
 
 	RenderFlags flags = renderLayer->GetRenderFlags();
@@ -33,8 +62,102 @@ void DebugWindow::RenderMenuBar()
 		changed = true;
 		flags = (flags & ~*RenderFlags::EnableColorCorrection) | (temp ? RenderFlags::EnableColorCorrection : RenderFlags::None);
 	}
+	temp = *(flags & RenderFlags::CompactGBuffer);
+	if (ImGui::Checkbox("Compact G-Buffer", &temp)) {
+		changed = true;
+		flags = (flags & ~*RenderFlags::CompactGBuffer) | (temp ? RenderFlags::CompactGBuffer : RenderFlags::None);
+	}
 
 	if (changed) {
 		renderLayer->SetRenderFlags(flags);
 	}
+
+	// Rough G-Buffer traffic, assuming every target is written once by the geometry pass and read
+	// once by lighting / compositing. Overdraw and extra reads will push the real number higher
+	const uint32_t gBufferBytes = renderLayer->GetGBufferBytesPerPixel();
+	const glm::ivec2 gBufferSize = renderLayer->GetGBuffer()->GetSize();
+	auto gBufferTrafficMb = [&](float pixels) { return pixels * gBufferBytes * 2.0f / (1024.0f * 1024.0f); };
+	ImGui::Text("G-Buffer: %u bytes/px  ~%.1f MB/frame (%dx%d)  1080p: ~%.1f MB  4K: ~%.1f MB",
+		gBufferBytes, gBufferTrafficMb(static_cast<float>(gBufferSize.x * gBufferSize.y)), gBufferSize.x, gBufferSize.y,
+		gBufferTrafficMb(1920.0f * 1080.0f), gBufferTrafficMb(3840.0f * 2160.0f));
+
+	ImGui::Separator();
+
+	GuiBatchMode guiBatchMode = GuiBatcher::GetBatchMode();
+	if (ImGui::BeginCombo("GUI Batching", (~guiBatchMode).c_str())) {
+		for (GuiBatchMode mode : { GuiBatchMode::PerTexture, GuiBatchMode::Atlas }) {
+			if (ImGui::Selectable((~mode).c_str(), mode == guiBatchMode)) {
+				GuiBatcher::SetBatchMode(mode);
+			}
+		}
+		ImGui::EndCombo();
+	}
+	const GuiAtlas::Sptr& guiAtlas = GuiBatcher::GetAtlas();
+	ImGui::Text("GUI Draws: %u  Atlas Images: %u  Atlas Usage: %.1f%%", GuiBatcher::GetDrawCallCount(),
+		guiAtlas != nullptr ? guiAtlas->GetImageCount() : 0u, guiAtlas != nullptr ? guiAtlas->GetUsage() * 100.0f : 0.0f);
+
+	bool shaderCache = ShaderProgram::IsBinaryCacheEnabled();
+	if (ImGui::Checkbox("Shader Binary Cache", &shaderCache)) {
+		ShaderProgram::SetBinaryCacheEnabled(shaderCache);
+	}
+	const ShaderProgram::BinaryCacheStats& cacheStats = ShaderProgram::GetBinaryCacheStats();
+	ImGui::Text("Shader Cache Hits: %u (%.1fms, saved ~%.1fms)  Misses: %u (%.1fms)",
+		cacheStats.Hits, cacheStats.LoadMs, cacheStats.SavedMs, cacheStats.Misses, cacheStats.CompileMs);
+
+	ImGui::Separator();
+
+	bool sortDraws = renderLayer->IsSortingEnabled();
+	if (ImGui::Checkbox("Sort Draws", &sortDraws)) {
+		renderLayer->SetSortingEnabled(sortDraws);
+	}
+	ImGui::SameLine();
+	bool instancing = renderLayer->IsInstancingEnabled();
+	if (ImGui::Checkbox("Auto Instancing", &instancing)) {
+		renderLayer->SetInstancingEnabled(instancing);
+	}
+	ImGui::SameLine();
+	bool culling = renderLayer->IsCullingEnabled();
+	if (ImGui::Checkbox("Frustum Culling", &culling)) {
+		renderLayer->SetCullingEnabled(culling);
+	}
+
+	const RenderLayer::RenderStats& stats = renderLayer->GetRenderStats();
+	ImGui::Text("Draws: %u  State Changes: %u (Shader: %u  Material: %u  VAO: %u)", 
+		stats.DrawCalls, stats.StateChanges(), stats.ShaderChanges, stats.MaterialChanges, stats.VaoChanges);
+	ImGui::Text("Instanced Draws: %u  Instanced Objects: %u", stats.InstancedDraws, stats.InstancedObjects);
+	ImGui::Text("Culling Tested: %u  Culled: %u", stats.CullTested, stats.Culled);
+
+	LightingMode lightingMode = renderLayer->GetLightingMode();
+	if (ImGui::BeginCombo("Lighting Mode", (~lightingMode).c_str())) {
+		for (LightingMode mode : { LightingMode::Fullscreen, LightingMode::Clustered, LightingMode::Volumes }) {
+			if (ImGui::Selectable((~mode).c_str(), mode == lightingMode)) {
+				renderLayer->SetLightingMode(mode);
+			}
+		}
+		ImGui::EndCombo();
+	}
+	ImGui::Text("Lights: %u  Batches: %u  Cluster Refs: %u  Lighting GPU: %.2fms", stats.Lights, stats.LightBatches, stats.ClusterLightRefs, stats.LightingGpuMs);
+
+	ImGui::Separator();
+
+	// Results are written to the log
+	if (ImGui::Button("Benchmark Components")) {
+		ComponentBenchmark::Run(10000);
+		ComponentBenchmark::Run(100000);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Benchmark Physics")) {
+		PhysicsBenchmark::Run(4000, 300, app.CurrentScene()->GetPhysicsThreadCount());
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Benchmark OBJ Parser")) {
+		ObjParserBenchmark::Run();
+	}
+	ImGui::SameLine();
+	LightingBenchmarkLayer::Sptr lightingBenchmark = app.GetLayer<LightingBenchmarkLayer>();
+	if (lightingBenchmark->IsRunning()) {
+		ImGui::Text("Benchmarking Lighting...");
+	} else if (ImGui::Button("Benchmark Lighting")) {
+		lightingBenchmark->Start();
+	}
 }
@@ -50,8 +50,11 @@ void GBufferPreviews::Render()
 	_RenderTexture2D(emissive, size, "emissive"); 
 	ImGui::NextColumn();  
 
-	_RenderTexture2D(viewspace, size, "position (viewspace)");
-	ImGui::NextColumn();
+	// The compact G-Buffer doesn't store position
+	if (viewspace != nullptr) {
+		_RenderTexture2D(viewspace, size, "position (viewspace)");
+		ImGui::NextColumn();
+	}
 
 	_RenderTexture2D(diffuse, size, "Diffuse Lighting");
 	ImGui::NextColumn();
@@ -28,16 +28,18 @@ void InspectorWindow::Render()
 
 		// Draw a textbox for the object name
 		static char nameBuff[256];
-		memcpy(nameBuff, selection->Name.c_str(), selection->Name.size());
-		nameBuff[selection->Name.size()] = '\0';
+		memcpy(nameBuff, selection->_name.c_str(), selection->_name.size());
+		nameBuff[selection->_name.size()] = '\0';
 		if (ImGui::InputText("##name", nameBuff, 256)) {
-			selection->Name = nameBuff;
+			selection->SetName(nameBuff);
 		}
 
 		ImGui::Separator();
 
 		// Render position label
-		selection->_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &selection->_position.x, 0.01f);
+		if (LABEL_LEFT(ImGui::DragFloat3, "Position", &selection->_position.x, 0.01f)) {
+			selection->_MarkTransformDirty();
+		}
 
 		// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 		glm::vec3 euler = selection->GetRotationEuler();
@@ -63,11 +65,9 @@ void InspectorWindow::Render()
 		}
 
 		// Draw the scale
-		selection->_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &selection->_scale.x, 0.01f, 0.0f);
-
-		// For if we're not in play mode
-		selection->_RecalcLocalTransform(); 
-		selection->_RecalcWorldTransform();
+		if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &selection->_scale.x, 0.01f, 0.0f)) {
+			selection->_MarkTransformDirty();
+		}
 
 		ImGui::Separator();
 
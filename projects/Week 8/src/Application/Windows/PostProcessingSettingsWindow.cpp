@@ -22,6 +22,10 @@ void PostProcessingSettingsWindow::Render()
 
 	PostProcessingLayer::Sptr layer = app.GetLayer<PostProcessingLayer>();
 
+	const RenderTargetPool::Sptr& pool = layer->GetTargetPool();
+	ImGui::Text("Pooled Targets: %u (%.1f MB)", pool->GetTargetCount(), pool->GetMemoryUsage() / (1024.0f * 1024.0f));
+	ImGui::Separator();
+
 	std::set<PostProcessingLayer::Effect::Sptr> unique (layer->GetEffects().begin(), layer->GetEffects().end());
 
 	for (const auto& effect : unique) {
@@ -0,0 +1,81 @@
+#include "Benchmarks/ComponentBenchmark.h"
+
+#include <chrono>
+#include <vector>
+#include <functional>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/RenderComponent.h"
+#include "Logging.h"
+
+using namespace Gameplay;
+
+namespace {
+	/// <summary>
+	/// Invokes a function the given number of times, and returns the average time per invocation in milliseconds
+	/// </summary>
+	template <typename Func>
+	double TimeAverage(uint32_t iterations, Func&& func) {
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t ix = 0; ix < iterations; ix++) {
+			func();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+	}
+}
+
+ComponentBenchmark::Result ComponentBenchmark::Run(uint32_t componentCount, uint32_t iterations) {
+	Result result;
+	result.ComponentCount = componentCount;
+
+	Scene::Sptr scene = std::make_shared<Scene>();
+	std::vector<RenderComponent::Sptr> renderables;
+	renderables.reserve(componentCount);
+	for (uint32_t ix = 0; ix < componentCount; ix++) {
+		GameObject::Sptr object = scene->CreateGameObject("Benchmark Object");
+		renderables.push_back(object->Add<RenderComponent>());
+	}
+
+	// The callbacks touch each component so that the loops can't be optimized out
+	uintptr_t checksum = 0;
+
+	// This is how components were stored before pools were added, we rebuild it here so we
+	// can compare against it
+	std::vector<std::weak_ptr<IComponent>> weakStore(renderables.begin(), renderables.end());
+	std::function<void(const RenderComponent::Sptr&)> weakCallback = [&](const RenderComponent::Sptr& renderable) {
+		checksum += reinterpret_cast<uintptr_t>(renderable->GetGameObject());
+	};
+	result.WeakPtrMs = TimeAverage(iterations, [&]() {
+		for (auto& wptr : weakStore) {
+			std::shared_ptr<IComponent> sptr = wptr.lock();
+			if (sptr && sptr->IsEnabled) {
+				weakCallback(std::dynamic_pointer_cast<RenderComponent>(sptr));
+			}
+		}
+	});
+
+	result.EachMs = TimeAverage(iterations, [&]() {
+		scene->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+			checksum += reinterpret_cast<uintptr_t>(renderable->GetGameObject());
+		});
+	});
+
+	result.EachRawMs = TimeAverage(iterations, [&]() {
+		scene->Components().EachRaw<RenderComponent>([&](RenderComponent* renderable) {
+			checksum += reinterpret_cast<uintptr_t>(renderable->GetGameObject());
+		});
+	});
+
+	LOG_INFO("Component iteration over {} render components ({} iterations, checksum {:x}):", componentCount, iterations, checksum);
+	LOG_INFO("\tweak_ptr store: {:.3f}ms", result.WeakPtrMs);
+	LOG_INFO("\tEach:           {:.3f}ms ({:.2f}x)", result.EachMs, result.WeakPtrMs / result.EachMs);
+	LOG_INFO("\tEachRaw:        {:.3f}ms ({:.2f}x)", result.EachRawMs, result.WeakPtrMs / result.EachRawMs);
+
+	// Release our references before the scene goes away, so the components can remove themselves from it
+	weakStore.clear();
+	renderables.clear();
+	scene = nullptr;
+
+	return result;
+}
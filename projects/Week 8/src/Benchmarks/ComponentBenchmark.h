@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+/// <summary>
+/// Microbenchmark for iterating over components in the component manager. Creates a throwaway scene
+/// with a large number of render components, and times iterating over them with the old weak pointer
+/// storage (lock + dynamic cast per component), ComponentManager::Each, and ComponentManager::EachRaw
+///
+/// Should be run from the main thread while the application is running, since it needs component types
+/// to be registered and creates a scene
+/// </summary>
+class ComponentBenchmark {
+public:
+	/// <summary>
+	/// The average time in milliseconds to iterate over all the components once, for each method
+	/// </summary>
+	struct Result {
+		uint32_t ComponentCount = 0;
+		double   WeakPtrMs      = 0.0;
+		double   EachMs         = 0.0;
+		double   EachRawMs      = 0.0;
+	};
+
+	/// <summary>
+	/// Runs the benchmark with the given number of components, and logs the results
+	/// </summary>
+	/// <param name="componentCount">The number of render components to create</param>
+	/// <param name="iterations">The number of times to iterate over the components for each method</param>
+	static Result Run(uint32_t componentCount, uint32_t iterations = 20);
+};
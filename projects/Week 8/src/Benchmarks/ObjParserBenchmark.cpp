@@ -0,0 +1,138 @@
+#include "Benchmarks/ObjParserBenchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+
+#include "Utils/ObjParser.h"
+#include "Logging.h"
+
+namespace {
+	double TimeMs(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	double ToMBps(size_t bytes, double ms) {
+		return ms > 0.0 ? (bytes / (1024.0 * 1024.0)) / (ms / 1000.0) : 0.0;
+	}
+}
+
+std::vector<ObjParserBenchmark::FileResult> ObjParserBenchmark::Run(uint32_t syntheticTriangles, uint32_t iterations) {
+	std::vector<std::string> paths = { "fenrir.obj", "monkey.obj" };
+
+	if (syntheticTriangles > 0) {
+		// Generating the file takes a while, so we keep it around between runs
+		std::error_code error;
+		std::filesystem::path synthetic = std::filesystem::temp_directory_path(error) / ("obj_benchmark_" + std::to_string(syntheticTriangles) + ".obj");
+		if (!std::filesystem::exists(synthetic)) {
+			LOG_INFO("Generating synthetic OBJ with {} triangles at \"{}\"", syntheticTriangles, synthetic.string());
+			if (!_GenerateGrid(synthetic.string(), syntheticTriangles)) {
+				LOG_WARN("Failed to write synthetic OBJ, skipping");
+			}
+		}
+		if (std::filesystem::exists(synthetic)) {
+			paths.push_back(synthetic.string());
+		}
+	}
+
+	std::vector<FileResult> results;
+	LOG_INFO("OBJ parsing ({} iterations):", iterations);
+	for (const std::string& path : paths) {
+		FileResult result;
+		if (!_RunFile(path, iterations, result)) {
+			LOG_WARN("\tFailed to parse \"{}\", skipping", path);
+			continue;
+		}
+		LOG_INFO("\t{} ({:.1f} MB, {} tris, {} verts)", result.Name, result.Bytes / (1024.0 * 1024.0), result.Triangles, result.Vertices);
+		LOG_INFO("\t\t1 thread:  {:.2f}ms ({:.1f} MB/s)", result.SingleThreadMs, result.SingleThreadMBps);
+		LOG_INFO("\t\tAll:       {:.2f}ms ({:.1f} MB/s, {:.2f}x)", result.MultiThreadMs, result.MultiThreadMBps, result.SingleThreadMs / result.MultiThreadMs);
+		results.push_back(result);
+	}
+	return results;
+}
+
+bool ObjParserBenchmark::_RunFile(const std::string& path, uint32_t iterations, FileResult& result) {
+	result.Name = std::filesystem::path(path).filename().string();
+	iterations = iterations > 0 ? iterations : 1;
+
+	for (uint32_t threads : { 1u, 0u }) {
+		double totalMs = 0.0;
+		for (uint32_t ix = 0; ix < iterations; ix++) {
+			ObjParser::Result obj;
+			auto start = std::chrono::high_resolution_clock::now();
+			if (!ObjParser::ParseFile(path, obj, threads)) {
+				return false;
+			}
+			totalMs += TimeMs(start);
+
+			result.Bytes     = obj.SourceBytes;
+			result.Triangles = static_cast<uint32_t>(obj.Indices.size() / 3);
+			result.Vertices  = static_cast<uint32_t>(obj.Vertices.size());
+		}
+
+		double averageMs = totalMs / iterations;
+		if (threads == 1) {
+			result.SingleThreadMs   = averageMs;
+			result.SingleThreadMBps = ToMBps(result.Bytes, averageMs);
+		} else {
+			result.MultiThreadMs    = averageMs;
+			result.MultiThreadMBps  = ToMBps(result.Bytes, averageMs);
+		}
+	}
+	return true;
+}
+
+bool ObjParserBenchmark::_GenerateGrid(const std::string& path, uint32_t triangles) {
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+
+	// A grid of size x size quads, split into 2 triangles each
+	const uint32_t size = static_cast<uint32_t>(std::ceil(std::sqrt(triangles / 2.0)));
+	const uint32_t rowLength = size + 1;
+
+	// Text is formatted into a buffer that gets flushed to the file when it's nearly full
+	std::vector<char> buffer(4 * 1024 * 1024);
+	size_t used = 0;
+	auto append = [&](const char* format, auto... args) {
+		if (buffer.size() - used < 256) {
+			file.write(buffer.data(), used);
+			used = 0;
+		}
+		used += snprintf(buffer.data() + used, buffer.size() - used, format, args...);
+	};
+
+	for (uint32_t y = 0; y < rowLength; y++) {
+		for (uint32_t x = 0; x < rowLength; x++) {
+			// A bit of height so that the positions aren't all trivial to parse
+			float height = std::sin(x * 0.05f) * std::cos(y * 0.05f);
+			append("v %.4f %.4f %.4f\n", x * 0.1f, height, y * 0.1f);
+		}
+	}
+	for (uint32_t y = 0; y < rowLength; y++) {
+		for (uint32_t x = 0; x < rowLength; x++) {
+			append("vt %.5f %.5f\n", x / static_cast<float>(size), y / static_cast<float>(size));
+		}
+	}
+	for (uint32_t y = 0; y < rowLength; y++) {
+		for (uint32_t x = 0; x < rowLength; x++) {
+			append("vn %.4f %.4f %.4f\n", 0.0f, 1.0f, 0.0f);
+		}
+	}
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			// OBJ indices start at 1
+			uint32_t a = y * rowLength + x + 1;
+			uint32_t b = a + 1;
+			uint32_t c = a + rowLength;
+			uint32_t d = c + 1;
+			append("f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, d, d, d);
+			append("f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, d, d, d, b, b, b);
+		}
+	}
+	file.write(buffer.data(), used);
+	return static_cast<bool>(file);
+}
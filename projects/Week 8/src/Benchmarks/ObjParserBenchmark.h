@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Throughput benchmark for the OBJ parser used when converting models to binary. Parses the models in
+/// res, as well as a large synthetic grid mesh (which is generated into the temp directory the first time
+/// it's needed), first on a single thread and then across the whole thread pool
+///
+/// Only the parsing is timed, building the final mesh and computing tangents are not included
+/// </summary>
+class ObjParserBenchmark {
+public:
+	/// <summary>
+	/// The results for a single file
+	/// </summary>
+	struct FileResult {
+		std::string Name;
+		size_t      Bytes            = 0;
+		uint32_t    Triangles        = 0;
+		uint32_t    Vertices         = 0;
+		// Average parse times, in milliseconds
+		double      SingleThreadMs   = 0.0;
+		double      MultiThreadMs    = 0.0;
+		// Throughput in megabytes per second
+		double      SingleThreadMBps = 0.0;
+		double      MultiThreadMBps  = 0.0;
+	};
+
+	/// <summary>
+	/// Runs the benchmark, and logs the results
+	/// </summary>
+	/// <param name="syntheticTriangles">The number of triangles to put in the synthetic mesh, or 0 to skip it</param>
+	/// <param name="iterations">The number of times to parse each file with each thread count</param>
+	static std::vector<FileResult> Run(uint32_t syntheticTriangles = 10000000, uint32_t iterations = 3);
+
+protected:
+	static bool _RunFile(const std::string& path, uint32_t iterations, FileResult& result);
+	/// <summary>
+	/// Writes an OBJ file containing a flat grid with at least the given number of triangles, with
+	/// positions, UVs and normals for every vertex
+	/// </summary>
+	static bool _GenerateGrid(const std::string& path, uint32_t triangles);
+};
@@ -0,0 +1,85 @@
+#include "Benchmarks/PhysicsBenchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Gameplay/Physics/Colliders/BoxCollider.h"
+#include "Logging.h"
+
+using namespace Gameplay;
+using namespace Gameplay::Physics;
+
+PhysicsBenchmark::Result PhysicsBenchmark::Run(uint32_t bodyCount, uint32_t steps, int threadCount) {
+	Result result;
+	result.BodyCount = bodyCount;
+	result.ThreadCount = threadCount > 0 ? threadCount : BulletTaskScheduler::Get().getMaxNumThreads();
+
+	result.Sequential   = _RunMode(PhysicsThreadingMode::Sequential, bodyCount, steps, threadCount);
+	result.IslandPool   = _RunMode(PhysicsThreadingMode::IslandPool, bodyCount, steps, threadCount);
+	result.IslandPoolMt = _RunMode(PhysicsThreadingMode::IslandPoolMt, bodyCount, steps, threadCount);
+
+	LOG_INFO("Physics step times for {} boxes ({} steps, {} threads):", bodyCount, steps, result.ThreadCount);
+	LOG_INFO("\tSequential:   {:.3f}ms avg, {:.3f}ms max", result.Sequential.AverageMs, result.Sequential.MaxMs);
+	LOG_INFO("\tIslandPool:   {:.3f}ms avg, {:.3f}ms max ({:.2f}x)", result.IslandPool.AverageMs, result.IslandPool.MaxMs, result.Sequential.AverageMs / result.IslandPool.AverageMs);
+	LOG_INFO("\tIslandPoolMt: {:.3f}ms avg, {:.3f}ms max ({:.2f}x)", result.IslandPoolMt.AverageMs, result.IslandPoolMt.MaxMs, result.Sequential.AverageMs / result.IslandPoolMt.AverageMs);
+
+	return result;
+}
+
+PhysicsBenchmark::ModeResult PhysicsBenchmark::_RunMode(PhysicsThreadingMode mode, uint32_t bodyCount, uint32_t steps, int threadCount) {
+	ModeResult result;
+
+	Scene::Sptr scene = std::make_shared<Scene>();
+	scene->SetPhysicsThreading(mode, threadCount);
+	// One step per call, so each DoPhysics is exactly one physics step
+	scene->SetMaxPhysicsSubSteps(1);
+	const float stepSize = 1.0f / scene->GetPhysicsStepRate();
+
+	GameObject::Sptr ground = scene->CreateGameObject("Ground");
+	{
+		RigidBody::Sptr physics = ground->Add<RigidBody>(RigidBodyType::Static);
+		physics->AddCollider(BoxCollider::Create(glm::vec3(500.0f, 500.0f, 1.0f)))->SetPosition({ 0, 0, -1 });
+	}
+
+	// Drop the boxes in layers of a square grid, with a bit of space between them so they spread out
+	// and knock into each other when they land
+	const uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(bodyCount) / 4.0f)));
+	for (uint32_t ix = 0; ix < bodyCount; ix++) {
+		uint32_t layer = ix / (gridSize * gridSize);
+		uint32_t x = ix % gridSize;
+		uint32_t y = (ix / gridSize) % gridSize;
+
+		GameObject::Sptr box = scene->CreateGameObject("Box");
+		box->SetPostion(glm::vec3(
+			(x - gridSize * 0.5f) * 2.5f + (layer % 2) * 0.5f,
+			(y - gridSize * 0.5f) * 2.5f,
+			2.0f + layer * 2.5f
+		));
+
+		RigidBody::Sptr physics = box->Add<RigidBody>(RigidBodyType::Dynamic);
+		physics->AddCollider(BoxCollider::Create(glm::vec3(0.5f)));
+	}
+
+	// Awake the objects directly rather than the whole scene, since we don't need any rendering resources
+	for (int ix = 0; ix < scene->NumObjects(); ix++) {
+		scene->GetObjectByIndex(ix)->Awake();
+	}
+	scene->IsPlaying = true;
+
+	double totalMs = 0.0;
+	for (uint32_t ix = 0; ix < steps; ix++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		scene->DoPhysics(stepSize);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double stepMs = std::chrono::duration<double, std::milli>(end - start).count();
+		totalMs += stepMs;
+		result.MaxMs = std::max(result.MaxMs, stepMs);
+	}
+	result.AverageMs = steps > 0 ? totalMs / steps : 0.0;
+
+	return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include "Gameplay/Physics/BulletTaskScheduler.h"
+
+/// <summary>
+/// Stress test for the physics world. Creates a throwaway scene with a large number of boxes dropped
+/// in a grid onto a ground plane, and times stepping the scene's physics with each threading mode
+///
+/// Should be run from the main thread while the application is running, since it needs component types
+/// to be registered and creates a scene
+/// </summary>
+class PhysicsBenchmark {
+public:
+	/// <summary>
+	/// Step timings for a single threading mode, in milliseconds
+	/// </summary>
+	struct ModeResult {
+		double AverageMs = 0.0;
+		double MaxMs     = 0.0;
+	};
+
+	struct Result {
+		uint32_t   BodyCount   = 0;
+		int        ThreadCount = 0;
+		ModeResult Sequential;
+		ModeResult IslandPool;
+		ModeResult IslandPoolMt;
+	};
+
+	/// <summary>
+	/// Runs the benchmark with the given number of boxes in each threading mode, and logs the results
+	/// </summary>
+	/// <param name="bodyCount">The number of dynamic boxes to drop</param>
+	/// <param name="steps">The number of physics steps to time for each mode</param>
+	/// <param name="threadCount">The max number of threads for the multithreaded modes, or 0 for all of them</param>
+	static Result Run(uint32_t bodyCount, uint32_t steps = 300, int threadCount = 0);
+
+protected:
+	static ModeResult _RunMode(PhysicsThreadingMode mode, uint32_t bodyCount, uint32_t steps, int threadCount);
+};
@@ -91,7 +91,7 @@ namespace Gameplay {
 		_isProjectionDirty = true;
 	}
 
-	const glm::mat4& Camera::GetView() const {
+	glm::mat4 Camera::GetView() const {
 		return GetGameObject()->GetInverseTransform();
 	}
 
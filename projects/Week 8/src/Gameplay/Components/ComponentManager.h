@@ -1,6 +1,7 @@
 #pragma once
 #include <functional>
 #include "IComponent.h"
+#include "ComponentPool.h"
 #include <typeindex>
 #include <optional>
 #include <Logging.h>
@@ -15,9 +16,14 @@ namespace Gameplay {
 	public:
 		typedef std::function<IComponent::Sptr(const nlohmann::json&)> LoadComponentFunc;
 		typedef std::function<IComponent::Sptr()> CreateComponentFunc;
+		typedef void(*ParallelUpdateFunc)(ComponentManager&, float, ThreadPool&);
+
+		// The number of components that a single worker task will update in UpdateParallel
+		static const size_t PARALLEL_UPDATE_CHUNK_SIZE = 64;
 
 		inline void Clear() {
-			_Components.clear();
+			_pools.clear();
+			_guidIndex.clear();
 		}
 
 		/// <summary>
@@ -46,7 +52,7 @@ namespace Gameplay {
 					result->_weakSelfPtr = result;
 
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_Add(result.get());
 					return result;
 				}
 			}
@@ -75,7 +81,7 @@ namespace Gameplay {
 					result->_realType = typeIndex.value();
 					result->_weakSelfPtr = result;
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_Add(result.get());
 					return result;
 				}
 			}
@@ -102,7 +108,7 @@ namespace Gameplay {
 				result->_realType = type;
 				result->_weakSelfPtr = result;
 				// Add the component to the global pools
-				_Components[result->_realType].push_back(result);
+				_Add(result.get());
 				return result;
 			}
 			return nullptr;
@@ -143,8 +149,8 @@ namespace Gameplay {
 			// Give the component a weak pointer to itself that it can upcast to a shared pointer when needed
 			component->_weakSelfPtr = component;
 
-			// Add to global component list for that type
-			_Components[type].push_back(component);
+			// Add to global component pool for that type
+			_Add(component.get());
 
 			// Return the result
 			return component;
@@ -165,24 +171,14 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Clear any dead weak pointers
-			auto removeIt = std::remove_if(_Components[type].begin(), _Components[type].end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			_Components[type].erase(removeIt, _Components[type].end());
-
-			// Search the component store for a component that matches that ID
-			auto& it = std::find_if(_Components[type].begin(), _Components[type].end(), [&](const std::weak_ptr<IComponent>& ptr) {
-				return (ptr.lock())->GetGUID() == id;
-			});
-
-			// If the component was found, return it. Otherwise return nullptr
-			if (it != _Components[type].end()) {
-				// We need to lock the weak pointer to convert it to a shared ptr
-				return std::dynamic_pointer_cast<ComponentType>((*it).lock());
-			} else {
+			// Look up the component in our GUID index, and make sure it's the type we're looking for
+			auto it = _guidIndex.find(id);
+			if (it == _guidIndex.end() || it->second->_realType != type) {
 				return nullptr;
 			}
+
+			// The type matches exactly, so we can skip the dynamic cast
+			return _ToShared(static_cast<ComponentType*>(it->second));
 		}
 
 		/// <summary>
@@ -199,15 +195,54 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Iterate over all the components in the store
-			for (auto& wptr : _Components[type]) {
-				// Lock the weak pointer to get a shared pointer (maybe)
-				std::shared_ptr<IComponent> sptr = wptr.lock();
-				// If the pointer is alive and matches our enabled criteria, invoke the callback
-				if (sptr && sptr->IsEnabled | includeDisabled) {
-					// Upcast to component type and invoke the callback
-					callback(std::dynamic_pointer_cast<ComponentType>(sptr));
+			// Iterate over all the components in the pool, the pool is already typed so we only need
+			// to grab a shared pointer from the component's self reference
+			_GetPool<ComponentType>()->Each([&](ComponentType* component) {
+				std::shared_ptr<ComponentType> sptr = _ToShared(component);
+				if (sptr != nullptr) {
+					callback(sptr);
 				}
+			}, includeDisabled);
+		}
+
+		/// <summary>
+		/// Iterates over all components of the given type and invokes a method with raw pointers to them.
+		/// This skips creating shared pointers and the std::function indirection, so it should be preferred
+		/// for per-frame loops over large numbers of components. Callbacks should not hold on to the pointers
+		/// </summary>
+		/// <typeparam name="ComponentType">The type of component to iterate on</typeparam>
+		/// <param name="callback">The callback to invoke with the components, will be passed a ComponentType*</param>
+		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
+		template <
+			typename ComponentType,
+			typename Func,
+			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
+		void EachRaw(Func&& callback, bool includeDisabled = false) {
+			LOG_ASSERT(_TypeLoadRegistry[std::type_index(typeid(ComponentType))] != nullptr, "You must register component types before creating them!");
+			_GetPool<ComponentType>()->Each(std::forward<Func>(callback), includeDisabled);
+		}
+
+		/// <summary>
+		/// Gets the number of live components of the given type
+		/// </summary>
+		/// <typeparam name="ComponentType">The type of component to count</typeparam>
+		template <
+			typename ComponentType,
+			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
+		size_t Count() {
+			return _GetPool<ComponentType>()->Size();
+		}
+
+		/// <summary>
+		/// Updates all components whose types were declared with MAKE_PARALLEL_UPDATE, spreading each type
+		/// across the given thread pool. Types are updated one after another, so two components on the same
+		/// game object will never be updated at the same time
+		/// </summary>
+		/// <param name="deltaTime">The time since the last frame, in seconds</param>
+		/// <param name="threadPool">The thread pool to run the updates on</param>
+		inline void UpdateParallel(float deltaTime, ThreadPool& threadPool) {
+			for (auto& [type, callback] : _TypeParallelUpdateRegistry) {
+				callback(*this, deltaTime, threadPool);
 			}
 		}
 
@@ -230,6 +265,10 @@ namespace Gameplay {
 				// name to type index mapping
 				_TypeLoadRegistry[type] = &ComponentManager::ParseTypeFromBlob<T>;
 				_TypeCreateRegistry[type] = &ComponentManager::_InternalCreate<T>;
+				_TypePoolRegistry[type] = &ComponentManager::_CreatePool<T>;
+				if constexpr (has_parallel_update<T>::value) {
+					_TypeParallelUpdateRegistry[type] = &ComponentManager::_UpdateParallel<T>;
+				}
 				_TypeNameMap[StringTools::SanitizeClassName(typeid(T).name())] = type;
 			}
 		}
@@ -238,7 +277,8 @@ namespace Gameplay {
 		/// Removes all components of all types from the registry, whether they are referenced elsewhere or not
 		/// </summary>
 		inline void FlushAll() {
-			_Components = std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>>();
+			_pools = std::unordered_map<std::type_index, IComponentPool::Uptr>();
+			_guidIndex = std::unordered_map<Guid, IComponent*>();
 		}
 
 	private:
@@ -253,11 +293,69 @@ namespace Gameplay {
 		inline static std::unordered_map<std::type_index, LoadComponentFunc> _TypeLoadRegistry;
 		// Stores functions to load components from JSON, indexed on the type that they load
 		inline static std::unordered_map<std::type_index, CreateComponentFunc> _TypeCreateRegistry;
+		// Stores functions to create typed component pools, indexed on the type that they store
+		inline static std::unordered_map<std::type_index, IComponentPool::Uptr(*)()> _TypePoolRegistry;
+		// Stores functions to update all components of a type in parallel, only for types declared with MAKE_PARALLEL_UPDATE
+		inline static std::unordered_map<std::type_index, ParallelUpdateFunc> _TypeParallelUpdateRegistry;
+
+		// Stores a dense pool of raw pointers for each component type. The pools do not own the components,
+		// so components will be destroyed at the correct time (when the game object releases them), and will
+		// remove themselves from the pool in their destructor
+		std::unordered_map<std::type_index, IComponentPool::Uptr> _pools;
+		// Maps component GUIDs to the components, so that components can be looked up in O(1)
+		std::unordered_map<Guid, IComponent*> _guidIndex;
+
+		/// <summary>
+		/// Adds a component to the pool for it's type, and to the GUID index
+		/// </summary>
+		inline void _Add(IComponent* component) {
+			_GetPool(component->_realType)->Add(component);
+			_guidIndex[component->GetGUID()] = component;
+			component->_isParallelUpdate = _TypeParallelUpdateRegistry.count(component->_realType) > 0;
+		}
+
+		template <typename ComponentType>
+		static void _UpdateParallel(ComponentManager& manager, float deltaTime, ThreadPool& threadPool) {
+			manager._GetPool<ComponentType>()->EachParallel(threadPool, PARALLEL_UPDATE_CHUNK_SIZE, [deltaTime](ComponentType* component) {
+				component->Update(deltaTime);
+			}, false);
+		}
+
+		template <typename T>
+		static IComponentPool::Uptr _CreatePool() {
+			return std::make_unique<ComponentPool<T>>();
+		}
+
+		/// <summary>
+		/// Gets the pool for the given component type, creating it if it does not exist
+		/// </summary>
+		inline IComponentPool* _GetPool(std::type_index type) {
+			IComponentPool::Uptr& pool = _pools[type];
+			if (pool == nullptr) {
+				auto factory = _TypePoolRegistry.find(type);
+				LOG_ASSERT(factory != _TypePoolRegistry.end(), "You must register component types before creating them!");
+				pool = factory->second();
+			}
+			return pool.get();
+		}
+
+		/// <summary>
+		/// Gets the typed pool for the given component type, creating it if it does not exist
+		/// </summary>
+		template <typename ComponentType>
+		ComponentPool<ComponentType>* _GetPool() {
+			// The pool for a type is always created by _CreatePool<ComponentType>, so this cast is safe
+			return static_cast<ComponentPool<ComponentType>*>(_GetPool(std::type_index(typeid(ComponentType))));
+		}
 
-		// Weak pointers let us store a reference to an object stored by a shared pointer, without
-		// actually increasing the reference count. Thus components will be destroyed at the correct
-		// time (when the only reference is the one stored here).
-		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _Components;  
+		/// <summary>
+		/// Gets a shared pointer to a component from it's self reference, will return nullptr if the
+		/// component is being destroyed
+		/// </summary>
+		template <typename ComponentType>
+		static std::shared_ptr<ComponentType> _ToShared(ComponentType* component) {
+			return std::static_pointer_cast<ComponentType>(component->SelfRef().lock());
+		}
 
 		template <typename T>
 		static IComponent::Sptr ParseTypeFromBlob(const nlohmann::json& blob) {
@@ -289,21 +387,16 @@ namespace Gameplay {
 		/// <param name="component">A raw pointer to the component to remove (should be called from IComponent destructor)</param>
 		/// <returns>True if the element was removed, false if not</returns>
 		inline void Remove(const IComponent* component) {
-			if (_Components.size() == 0) return;
-
-			// Make sure the component's type was one that was registered
-			LOG_ASSERT(_TypeLoadRegistry[component->_realType] != nullptr, "You must register component types before creating them!");
+			// If the pools have been flushed, there's nothing to remove from
+			auto it = _pools.find(component->_realType);
+			if (it == _pools.end() || it->second == nullptr) return;
 
-			
-			// Get a reference to the vector of components for easy access
-			std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[component->_realType];
+			it->second->Remove(component);
 
-			// Clear any dead weak pointers
-			auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-				});
-			if (it != componentStore.end()) {
-				componentStore.erase(it);
+			// Make sure we only remove the index entry if it belongs to this component
+			auto guidIt = _guidIndex.find(component->GetGUID());
+			if (guidIt != _guidIndex.end() && guidIt->second == component) {
+				_guidIndex.erase(guidIt);
 			}
 		}
 	};
@@ -0,0 +1,167 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "IComponent.h"
+#include "Utils/ThreadPool.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Type erased interface for component pools, this lets the component manager add and remove
+	/// components when it only knows their type_index (ex: when loading from JSON, or from the
+	/// IComponent destructor)
+	/// </summary>
+	class IComponentPool {
+	public:
+		typedef std::unique_ptr<IComponentPool> Uptr;
+
+		// Index stored in components that do not belong to a pool
+		static const uint32_t INVALID_INDEX = ~0u;
+
+		virtual ~IComponentPool() = default;
+
+		/// <summary>
+		/// Adds a component to the pool, the component's concrete type must match the pool's type
+		/// </summary>
+		virtual void Add(IComponent* component) = 0;
+		/// <summary>
+		/// Removes a component from the pool, does nothing if the component is not in the pool
+		/// </summary>
+		virtual void Remove(const IComponent* component) = 0;
+		/// <summary>
+		/// Gets the number of live components in the pool
+		/// </summary>
+		virtual size_t Size() const = 0;
+	};
+
+	/// <summary>
+	/// Stores pointers to all components of a single concrete type in a dense array, so that
+	/// iterating over a component type is a linear walk with no locking or casting. This is a
+	/// sparse set, where the sparse half is the index that each component stores about itself,
+	/// so adds and removes are both O(1)
+	///
+	/// The pool does not own the components, they are still owned by their game objects and
+	/// will remove themselves from the pool when destroyed
+	/// </summary>
+	/// <typeparam name="ComponentType">The concrete type of component stored in the pool</typeparam>
+	template <typename ComponentType>
+	class ComponentPool : public IComponentPool {
+	public:
+		ComponentPool() :
+			_dense(std::vector<ComponentType*>()),
+			_iterationDepth(0),
+			_holeCount(0)
+		{ }
+		virtual ~ComponentPool() = default;
+
+		virtual void Add(IComponent* component) override {
+			// The manager only ever gives us components whose _realType matches our type, so this
+			// is the only cast we need to do for the lifetime of the component
+			component->_poolIndex = static_cast<uint32_t>(_dense.size());
+			_dense.push_back(static_cast<ComponentType*>(component));
+		}
+
+		virtual void Remove(const IComponent* component) override {
+			uint32_t index = component->_poolIndex;
+			// The pool may have been flushed since the component was added, so make sure the slot
+			// still belongs to this component before touching it
+			if (index >= _dense.size() || static_cast<const IComponent*>(_dense[index]) != component) {
+				return;
+			}
+
+			// If someone is iterating over the pool, we can't move things around, so we leave a hole
+			// that gets cleaned up when the iteration finishes
+			if (_iterationDepth > 0) {
+				_dense[index] = nullptr;
+				_holeCount++;
+			}
+			// Otherwise we swap the last element into the removed slot
+			else {
+				ComponentType* last = _dense.back();
+				_dense[index] = last;
+				static_cast<IComponent*>(last)->_poolIndex = index;
+				_dense.pop_back();
+			}
+		}
+
+		virtual size_t Size() const override {
+			return _dense.size() - _holeCount;
+		}
+
+		/// <summary>
+		/// Invokes a callback for every component in the pool. Components that are added during
+		/// iteration will not be visited, and components that are removed during iteration will
+		/// be skipped if they have not been visited yet
+		/// </summary>
+		/// <param name="callback">The callback to invoke, will be passed a ComponentType*</param>
+		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
+		template <typename Func>
+		void Each(Func&& callback, bool includeDisabled) {
+			_iterationDepth++;
+			const size_t count = _dense.size();
+			for (size_t ix = 0; ix < count; ix++) {
+				ComponentType* component = _dense[ix];
+				if (component != nullptr && (component->IsEnabled || includeDisabled)) {
+					callback(component);
+				}
+			}
+			_iterationDepth--;
+
+			if (_iterationDepth == 0 && _holeCount > 0) {
+				_Compact();
+			}
+		}
+
+		/// <summary>
+		/// Invokes a callback for every component in the pool, splitting the pool into chunks that
+		/// are run across a thread pool. The callback must not add or remove components, or touch
+		/// anything shared with other components of this type
+		/// </summary>
+		/// <param name="threadPool">The thread pool to run the chunks on</param>
+		/// <param name="chunkSize">The number of components to handle in each task</param>
+		/// <param name="callback">The callback to invoke, will be passed a ComponentType*</param>
+		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
+		template <typename Func>
+		void EachParallel(ThreadPool& threadPool, size_t chunkSize, Func&& callback, bool includeDisabled) {
+			_iterationDepth++;
+			threadPool.ParallelFor(_dense.size(), chunkSize, [&](size_t begin, size_t end) {
+				for (size_t ix = begin; ix < end; ix++) {
+					ComponentType* component = _dense[ix];
+					if (component != nullptr && (component->IsEnabled || includeDisabled)) {
+						callback(component);
+					}
+				}
+			});
+			_iterationDepth--;
+
+			if (_iterationDepth == 0 && _holeCount > 0) {
+				_Compact();
+			}
+		}
+
+	protected:
+		// The components in this pool, may contain nullptrs while the pool is being iterated on
+		std::vector<ComponentType*> _dense;
+		// How many Each calls are currently running on the pool
+		uint32_t _iterationDepth;
+		// The number of nullptrs in the dense array that need to be cleaned up
+		uint32_t _holeCount;
+
+		/// <summary>
+		/// Removes any holes left by components removed during iteration, keeping the remaining
+		/// components in order
+		/// </summary>
+		void _Compact() {
+			uint32_t write = 0;
+			for (size_t read = 0; read < _dense.size(); read++) {
+				if (_dense[read] != nullptr) {
+					_dense[write] = _dense[read];
+					static_cast<IComponent*>(_dense[write])->_poolIndex = write;
+					write++;
+				}
+			}
+			_dense.resize(write);
+			_holeCount = 0;
+		}
+	};
+}
@@ -21,6 +21,7 @@ GuiText::~GuiText() = default;
 
 void GuiText::SetColor(const glm::vec4& color) {
 	_color = color;
+	_layoutCache.Invalidate();
 }
 
 const glm::vec4& GuiText::GetColor() const {
@@ -41,10 +42,7 @@ const std::wstring& GuiText::GetTextUnicode() const {
 
 void GuiText::SetTextUnicode(const std::wstring& value) {
 	_text = value;
-	
-	if (_font != nullptr) {
-		_textSize = _font->MeausureString(_text, _textScale);
-	}
+	_UpdateLayout();
 }
 
 const float GuiText::GetTextScale() const {
@@ -53,6 +51,7 @@ const float GuiText::GetTextScale() const {
 
 void GuiText::SetTextScale(float value) {
 	_textScale = value;
+	_UpdateLayout();
 }
 
 const Font::Sptr& GuiText::GetFont() const {
@@ -61,9 +60,7 @@ const Font::Sptr& GuiText::GetFont() const {
 
 void GuiText::SetFont(const Font::Sptr& font) {
 	_font = font;
-	if (_font != nullptr) {
-		_textSize = _font->MeausureString(_text, _textScale);
-	}
+	_UpdateLayout();
 }
 
 void GuiText::Awake() {
@@ -79,7 +76,7 @@ void GuiText::RenderGUI()
 	if (_font != nullptr && !_text.empty()) {
 		glm::vec2 position = _transform->GetSize() / 2.0f;
 		position -= _textSize / 2.0f;
-		GuiBatcher::RenderText(_text, _font, position, _color, _textScale);
+		GuiBatcher::RenderText(_text, _font, position, _color, _textScale, _layoutCache);
 	}
 }
 
@@ -91,15 +88,13 @@ void GuiText::RenderImGui()
 
 	if (LABEL_LEFT(ImGui::InputTextMultiline, "Text", buffer, 4096)) {
 		_text = StringConvert.from_bytes(buffer);
-		if (_font != nullptr) {
-			_textSize = _font->MeausureString(_text, _textScale);
-		}
+		_UpdateLayout();
+	}
+	if (LABEL_LEFT(ImGui::ColorEdit4, "Color", &_color.x)) {
+		_layoutCache.Invalidate();
 	}
-	LABEL_LEFT(ImGui::ColorEdit4, "Color", &_color.x);
 	if (LABEL_LEFT(ImGui::DragFloat, "Scale", &_textScale, 0.01f)) {
-		if (_font != nullptr) {
-			_textSize = _font->MeausureString(_text, _textScale);
-		}
+		_UpdateLayout();
 	}
 }
 
@@ -120,3 +115,10 @@ GuiText::Sptr GuiText::FromJson(const nlohmann::json& blob) {
 	result->_font      = ResourceManager::Get<Font>(Guid(JsonGet<std::string>(blob, "font", "null")));
 	return result;
 }
+
+void GuiText::_UpdateLayout() {
+	if (_font != nullptr) {
+		_textSize = _font->MeausureString(_text, _textScale);
+	}
+	_layoutCache.Invalidate();
+}
@@ -2,6 +2,7 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/GUI/RectTransform.h"
 #include "Graphics/Font.h"
+#include "Graphics/GuiBatcher.h"
 
 /// <summary>
 /// Renders text for UI components
@@ -81,5 +82,13 @@ protected:
 	glm::vec2       _textSize;
 	float           _textScale;
 
+	// Quads from the last time we rendered, rebuilt when the text or it's position changes
+	GuiBatcher::TextCache _layoutCache;
+
 	RectTransform::Sptr _transform;
+
+	/// <summary>
+	/// Re-measures the text and invalidates the cached layout, call when the text, font or scale changes
+	/// </summary>
+	void _UpdateLayout();
 };
\ No newline at end of file
@@ -28,10 +28,15 @@ namespace Gameplay {
 		IResource(),
 		IsEnabled(true),
 		_realType(typeid(IComponent)),
-		_context(nullptr)
+		_context(nullptr),
+		_poolIndex(~0u),
+		_isParallelUpdate(false)
 	{ }
 
 	IComponent::~IComponent() {
-		_context->GetScene()->Components().Remove(this);
+		// Components of objects that outlived their scene were already dropped from it's pools
+		if (_context != nullptr && _context->GetScene() != nullptr) {
+			_context->GetScene()->Components().Remove(this);
+		}
 	}
 }
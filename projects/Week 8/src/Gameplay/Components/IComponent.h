@@ -12,6 +12,8 @@
 namespace Gameplay {
 	// We pre-declare GameObject to avoid circular dependencies in the headers
 	class GameObject;
+	template <typename ComponentType>
+	class ComponentPool;
 
 	namespace Physics {
 		class TriggerVolume;
@@ -159,9 +161,16 @@ namespace Gameplay {
 	private:
 		friend class ComponentManager;
 		friend class GameObject;
+		template <typename ComponentType>
+		friend class ComponentPool;
 
 		std::type_index _realType;
 		GameObject* _context;
+		// Our index in the scene's component pool for our type, lets us remove ourselves in O(1)
+		uint32_t _poolIndex;
+		// True if our type was declared with MAKE_PARALLEL_UPDATE, and is updated by the scene instead of
+		// by our game object
+		bool _isParallelUpdate;
 
 		// By storing a weak pointer to ourselves, we can pass a pointer to this
 		// for things like bullet user pointers
@@ -179,9 +188,24 @@ namespace Gameplay {
 	constexpr bool is_valid_component() {
 		return std::is_base_of<IComponent, T>::value && test_json<T, const nlohmann::json&>::value;
 	}
+
+	/// <summary>
+	/// Checks whether a component type was declared with MAKE_PARALLEL_UPDATE
+	/// </summary>
+	template <typename T, typename = void>
+	struct has_parallel_update : std::false_type {};
+	template <typename T>
+	struct has_parallel_update<T, std::void_t<decltype(T::ParallelUpdate)>> : std::bool_constant<T::ParallelUpdate> {};
 }
 
 // Defines the ComponentTypeName interface to match those used elsewhere by other systems
 #define MAKE_TYPENAME(T) \
 	inline virtual std::string ComponentTypeName() const { \
 		static std::string name = StringTools::SanitizeClassName(typeid(T).name()); return name; }
+
+// Declares that a component's Update only reads and writes the component's own fields and the
+// transform of it's own game object, and never creates or destroys objects or components. The
+// scene will then update all components of the type across worker threads, instead of in order
+// on the main thread
+#define MAKE_PARALLEL_UPDATE() \
+	static constexpr bool ParallelUpdate = true;
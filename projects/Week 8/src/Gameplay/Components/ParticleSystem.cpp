@@ -7,25 +7,40 @@
 ParticleSystem::ParticleSystem() :
 	IComponent(),
 	_hasInit(false),
+	_backend(ParticleBackend::Compute),
 	_maxParticles(1000),
 	_numParticles(0),
 	_particleBuffers(),
 	_feedbackBuffers(),
-	_query(0),
+	_queries(),
+	_queryFrame(0),
 	_currentVertexBuffer(0),
 	_currentFeedbackBuffer(1),
 	_updateShader(nullptr),
 	_renderShader(nullptr),
 	_gravity({ 0, 0, -9.81f }),
-	_emitters()
+	_emitters(),
+	_sortParticles(true),
+	_computeBuffers(),
+	_sortCapacity(0),
+	_emitterTimers(),
+	_gpuEmitters(),
+	_seed(0),
+	_emitShader(nullptr),
+	_simulateShader(nullptr),
+	_sortKeyShader(nullptr),
+	_sortShader(nullptr),
+	_computeRenderShader(nullptr),
+	_emptyVao(nullptr)
 { }
 
 ParticleSystem::~ParticleSystem()
 {
-	if (_hasInit) {
+	// The compute backend's resources clean themselves up
+	if (_hasInit && _backend == ParticleBackend::TransformFeedback) {
 		glDeleteBuffers(2, _particleBuffers);
 		glDeleteTransformFeedbacks(2, _feedbackBuffers);
-		glDeleteQueries(1, &_query);
+		glDeleteQueries(QUERY_COUNT, _queries);
 		_updateShader = nullptr;
 		_renderShader = nullptr;
 	}
@@ -34,41 +49,93 @@ ParticleSystem::~ParticleSystem()
 void ParticleSystem::Update()
 {
 	// If we haven't previously initialized our data, initialize it now
-	if (!_hasInit) {
-		// Allocate some temp space for particles, so we can init the emitters
-		size_t dataSize = (_maxParticles + _emitters.size()) * sizeof(ParticleData);
-		ParticleData* data = new ParticleData[_maxParticles + _emitters.size()];
-		memset(data, 0, dataSize);
+	if (_backend == ParticleBackend::Compute) {
+		if (!_hasInit) {
+			_InitCompute();
+		}
+		_UpdateCompute();
+	} else {
+		if (!_hasInit) {
+			_InitTransformFeedback();
+		}
+		_UpdateTransformFeedback();
+	}
 
-		// Add all emitter to the the particle list at the beginning
-		for (int ix = 0; ix < _emitters.size(); ix++) {
-			data[ix] = _emitters[ix];
+	_hasInit = true;
+}
+
+void ParticleSystem::Render()
+{
+	// Make sure that we've actually initialized our stuff
+	if (_hasInit) {
+		if (_backend == ParticleBackend::Compute) {
+			_RenderCompute();
+		} else {
+			_RenderTransformFeedback();
 		}
+	}
+}
 
-		// We essentially use double buffering, hence the 2 buffers
-		glCreateTransformFeedbacks(2, _feedbackBuffers);
-		glCreateBuffers(2, _particleBuffers);
+void ParticleSystem::_InitTransformFeedback()
+{
+	// There are the things we want the feedback buffers to track
+	const char const* varyings[6] = {
+		"out_Type",  
+		"out_Position",
+		"out_Velocity",
+		"out_Color", 
+		"out_Lifetime",
+		"out_Metadata" 
+	}; 
 
-		// Set up our first transform feedback buffer to write to the first buffer
-		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[0]);
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[0]);
-		glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[0]);
+	// This is our transform feedback shader
+	_updateShader = ShaderProgram::Create();
+	_updateShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_sim_vs.glsl", ShaderPartType::Vertex);
+ 	_updateShader->LoadShaderPartFromFile("shaders/geometry_shaders/particle_sim_gs.glsl", ShaderPartType::Geometry);
+	_updateShader->RegisterVaryings(varyings, 6, true); // Here we call glTransformFeedbackVaryings, and let it know we want interleaved data
+	_updateShader->Link(); 
 
-		// Set up the second transform feedback buffer to write to the second buffer
-		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[1]);
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[1]);
-		glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[1]);
+	// This shader will render the particles
+	_renderShader = ShaderProgram::Create();
+	_renderShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_render_vs.glsl", ShaderPartType::Vertex);
+	_renderShader->LoadShaderPartFromFile("shaders/fragment_shaders/particles_render_fs.glsl", ShaderPartType::Fragment);
+	_renderShader->Link(); 
 
-		// We create a query object to track the number of particles we're simulating
-		glGenQueries(1, &_query);
+	// Allocate some temp space for particles, so we can init the emitters
+	size_t dataSize = (_maxParticles + _emitters.size()) * sizeof(ParticleData);
+	ParticleData* data = new ParticleData[_maxParticles + _emitters.size()];
+	memset(data, 0, dataSize);
 
-		// We no longer need the CPU copy
-		delete[] data;
+	// Add all emitter to the the particle list at the beginning
+	for (int ix = 0; ix < _emitters.size(); ix++) {
+		data[ix] = _emitters[ix];
 	}
 
+	// We essentially use double buffering, hence the 2 buffers
+	glCreateTransformFeedbacks(2, _feedbackBuffers);
+	glCreateBuffers(2, _particleBuffers);
+
+	// Set up our first transform feedback buffer to write to the first buffer
+	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[0]);
+	glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[0]);
 
+	// Set up the second transform feedback buffer to write to the second buffer
+	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[1]);
+	glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[1]);
+	glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[1]);
+
+	// We create query objects to track the number of particles we're simulating
+	glCreateQueries(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, QUERY_COUNT, _queries);
+
+	// We no longer need the CPU copy
+	delete[] data;
+}
+
+void ParticleSystem::_UpdateTransformFeedback()
+{
 	// Disable rasterization, this is update only
 	glEnable(GL_RASTERIZER_DISCARD);
 
@@ -99,8 +166,21 @@ void ParticleSystem::Update()
 	_updateShader->SetUniform("u_Gravity", _gravity); 
 	_updateShader->SetUniformMatrix("u_ModelMatrix", GetGameObject()->GetTransform()); 
 
+	// Grab the count from the oldest query before we re-use it. If the GPU is still behind we just
+	// keep showing the last count we got, rather than stalling until the simulation finishes
+	GLuint query = _queries[_queryFrame % QUERY_COUNT];
+	if (_queryFrame >= QUERY_COUNT) {
+		GLint available = 0;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint written = 0;
+			glGetQueryObjectuiv(query, GL_QUERY_RESULT, &written);
+			_numParticles = written >= _emitters.size() ? written - static_cast<GLuint>(_emitters.size()) : 0;
+		}
+	}
+
 	// Our particles are points that we're simulating
-	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, _query);
+	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, query);
 	glBeginTransformFeedback(GL_POINTS);
 
 	// If this is our first pass, we use drawArrays to get the initial state, otherwise we use transform feedback for rendering
@@ -114,15 +194,7 @@ void ParticleSystem::Update()
 	// End of transform feedback
 	glEndTransformFeedback();
 	glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
-
-	// Use our query to get the number of particles
-	glGetQueryObjectuiv(_query, GL_QUERY_RESULT, &_numParticles);
-	if (_numParticles >= _emitters.size()) {
-		_numParticles -= _emitters.size();
-	}
-	else {
-		_numParticles = 0;
-	}
+	_queryFrame++;
 
 	// Clean up our state
 	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
@@ -137,50 +209,223 @@ void ParticleSystem::Update()
 	// Re-enable rasterization for later OpenGL calls
 	glDisable(GL_RASTERIZER_DISCARD);
 
-	_hasInit = true;
-
 	// Double-buffering, swap which buffers we're operating on
 	_currentVertexBuffer = _currentFeedbackBuffer;
 	_currentFeedbackBuffer = (_currentFeedbackBuffer + 1) & 0x01;
 }
 
-void ParticleSystem::Render()
+void ParticleSystem::_RenderTransformFeedback()
 {
-	// Make sure that we've actually initialized our stuff
-	if (_hasInit) {
+	// We're using our particle rendering shader
+	_renderShader->Bind();
 
-		// We're using our particle rendering shader
-		_renderShader->Bind();
+	// Make sure no VAOs are bound
+	glBindVertexArray(0);
 
-		// Make sure no VAOs are bound
-		glBindVertexArray(0);
+	glEnablei(GL_BLEND, 0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-		glEnablei(GL_BLEND, 0);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// Bind the current feedback buffer as our drawing buffer
+	glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]); 
 
-		// Bind the current feedback buffer as our drawing buffer
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]); 
+	// Enable type, position and color 
+	glEnableVertexAttribArray(0); 
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(3);
+	glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ParticleData), 0); // type
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Position)); // position
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Color)); // color 
 
-		// Enable type, position and color 
-		glEnableVertexAttribArray(0); 
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(3);
-		glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ParticleData), 0); // type
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Position)); // position
-		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Color)); // color 
+	// Draw our particles using whatever data we have in transform feedback buffer
+	glDrawTransformFeedback(GL_POINTS, _feedbackBuffers[_currentVertexBuffer]);
 
-		// Draw our particles using whatever data we have in transform feedback buffer
-		glDrawTransformFeedback(GL_POINTS, _feedbackBuffers[_currentVertexBuffer]);
+	// Clean up after ourselves
+	glDisableVertexAttribArray(1);
+	glDisableVertexAttribArray(3);
+}
 
-		// Clean up after ourselves
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(3);
+void ParticleSystem::_InitCompute()
+{
+	_emitShader = ShaderProgram::Create();
+	_emitShader->LoadShaderPartFromFile("shaders/compute_shaders/particles_emit.glsl", ShaderPartType::Compute);
+	_emitShader->Link();
+
+	_simulateShader = ShaderProgram::Create();
+	_simulateShader->LoadShaderPartFromFile("shaders/compute_shaders/particles_simulate.glsl", ShaderPartType::Compute);
+	_simulateShader->Link();
+
+	_sortKeyShader = ShaderProgram::Create();
+	_sortKeyShader->LoadShaderPartFromFile("shaders/compute_shaders/particles_sort_keys.glsl", ShaderPartType::Compute);
+	_sortKeyShader->Link();
+
+	_sortShader = ShaderProgram::Create();
+	_sortShader->LoadShaderPartFromFile("shaders/compute_shaders/particles_bitonic_sort.glsl", ShaderPartType::Compute);
+	_sortShader->Link();
+
+	// Same fragment shader as the transform feedback path, but positions come from the storage buffers
+	_computeRenderShader = ShaderProgram::Create();
+	_computeRenderShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_compute_render_vs.glsl", ShaderPartType::Vertex);
+	_computeRenderShader->LoadShaderPartFromFile("shaders/fragment_shaders/particles_render_fs.glsl", ShaderPartType::Fragment);
+	_computeRenderShader->Link();
+
+	// The bitonic sort needs a power of two number of elements, and at least one work group's worth
+	_sortCapacity = SORT_BLOCK_SIZE;
+	while (_sortCapacity < _maxParticles) {
+		_sortCapacity <<= 1;
+	}
+
+	// Every particle starts out dead with no lifetime left, so the dead list holds every index
+	std::vector<glm::vec4> particles(_maxParticles, glm::vec4(0.0f));
+	std::vector<uint32_t>  indices(_sortCapacity);
+	for (uint32_t ix = 0; ix < _sortCapacity; ix++) {
+		indices[ix] = ix;
+	}
+	std::vector<float> keys(_sortCapacity, 0.0f);
+
+	for (uint32_t ix = 0; ix < Emitters; ix++) {
+		_computeBuffers[ix] = ShaderStorageBuffer::Create(BufferUsage::DynamicCopy);
+	}
+	_computeBuffers[Positions]->LoadData(particles.data(), _maxParticles);
+	_computeBuffers[Velocities]->LoadData(particles.data(), _maxParticles);
+	_computeBuffers[Colors]->LoadData(particles.data(), _maxParticles);
+	_computeBuffers[DeadList]->LoadData(indices.data(), _maxParticles);
+	_computeBuffers[AliveList]->LoadData(indices.data(), _sortCapacity);
+	_computeBuffers[SortKeys]->LoadData(keys.data(), _sortCapacity);
+
+	// The first 4 values are the arguments for glDrawArraysIndirect (count, instance count, first, base instance),
+	// followed by the number of entries in the dead list
+	const uint32_t counters[8] = { 0, 1, 0, 0, _maxParticles, 0, 0, 0 };
+	_computeBuffers[Counters]->LoadData(counters, 8);
+
+	// Emitters are re-uploaded every step, but we need something to bind until then
+	const GpuEmitter emitter = { };
+	_computeBuffers[Emitters] = ShaderStorageBuffer::Create(BufferUsage::DynamicDraw);
+	_computeBuffers[Emitters]->LoadData(&emitter, 1);
+
+	_emptyVao = VertexArrayObject::Create();
+}
+
+void ParticleSystem::_UpdateCompute()
+{
+	const float dt = Timing::Current().DeltaTime();
+
+	// Work out how many particles each emitter spawns this step on the CPU, so that emitters can be
+	// added, removed or edited at any time without touching the GPU's particle state
+	_emitterTimers.resize(_emitters.size(), 0.0f);
+	_gpuEmitters.resize(_emitters.size());
+	for (size_t ix = 0; ix < _emitters.size(); ix++) {
+		const ParticleData& emitter = _emitters[ix];
+		float& timer = _emitterTimers[ix];
+
+		uint32_t spawnCount = 0;
+		timer -= dt;
+		if (timer < 0.0f && emitter.Metadata.x > 0.0f) {
+			spawnCount = static_cast<uint32_t>(-timer / emitter.Metadata.x) + 1;
+			timer += spawnCount * emitter.Metadata.x;
+		}
+
+		GpuEmitter& data = _gpuEmitters[ix];
+		data.PositionCone  = glm::vec4(emitter.Position, emitter.Metadata.y);
+		data.Velocity      = glm::vec4(emitter.Velocity, 0.0f);
+		data.Color         = emitter.Color;
+		data.LifetimeRange = glm::vec2(emitter.Metadata.z, emitter.Metadata.w);
+		data.SpawnCount    = glm::min(spawnCount, _maxParticles);
+		data.Seed          = (_seed++) * 2654435761u;
+	}
+
+	_BindComputeBuffers();
+
+	// The simulation rebuilds the alive list from scratch
+	const uint32_t zero = 0;
+	glClearNamedBufferSubData(_computeBuffers[Counters]->GetHandle(), GL_R32UI, 0, sizeof(uint32_t), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+	// Spawn new particles into slots from the dead list, one work group per emitter
+	if (_gpuEmitters.size() > 0) {
+		_computeBuffers[Emitters]->UpdateData(_gpuEmitters.data(), sizeof(GpuEmitter), static_cast<uint32_t>(_gpuEmitters.size()));
+		_computeBuffers[Emitters]->Bind(Emitters);
+
+		_emitShader->Bind();
+		_emitShader->SetUniformMatrix("u_ModelMatrix", GetGameObject()->GetTransform());
+		_emitShader->SetUniform("u_TimeStep", dt);
+		glDispatchCompute(static_cast<GLuint>(_gpuEmitters.size()), 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	// Step every particle, dead ones exit right away
+	_simulateShader->Bind();
+	_simulateShader->SetUniform("u_Gravity", _gravity);
+	_simulateShader->SetUniform("u_TimeStep", dt);
+	glDispatchCompute((_maxParticles + SIMULATE_GROUP_SIZE - 1) / SIMULATE_GROUP_SIZE, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+void ParticleSystem::_SortCompute()
+{
+	// Calculate the depth of each alive particle, since the camera may have moved since we simulated
+	_sortKeyShader->Bind();
+	glDispatchCompute(_sortCapacity / SIMULATE_GROUP_SIZE, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Each sort work group handles SORT_BLOCK_SIZE elements in shared memory, or compares one pair
+	// per thread for steps that cross blocks
+	const GLuint groups = _sortCapacity / SORT_BLOCK_SIZE;
+	_sortShader->Bind();
+
+	// Sort each block on it's own
+	_sortShader->SetUniform("u_Mode", 0);
+	glDispatchCompute(groups, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Merge blocks together, steps that compare elements in different blocks need to go through
+	// global memory, the rest of the stage is done in shared memory again
+	for (uint32_t stage = SORT_BLOCK_SIZE * 2; stage <= _sortCapacity; stage <<= 1) {
+		_sortShader->SetUniform("u_Stage", static_cast<int>(stage));
+		for (uint32_t step = stage >> 1; step >= SORT_BLOCK_SIZE; step >>= 1) {
+			_sortShader->SetUniform("u_Mode", 1);
+			_sortShader->SetUniform("u_Step", static_cast<int>(step));
+			glDispatchCompute(groups, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+		_sortShader->SetUniform("u_Mode", 2);
+		glDispatchCompute(groups, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
+
+void ParticleSystem::_RenderCompute()
+{
+	_BindComputeBuffers();
+
+	// Sort back to front so that blending works out
+	if (_sortParticles) {
+		_SortCompute();
+	}
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+	_computeRenderShader->Bind();
+
+	glEnablei(GL_BLEND, 0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// The counter buffer starts with the draw arguments, so the vertex count is however many
+	// particles survived the last simulation step, without the CPU ever reading it back
+	_emptyVao->Bind();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _computeBuffers[Counters]->GetHandle());
+	glDrawArraysIndirect(GL_POINTS, nullptr);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	VertexArrayObject::Unbind();
+}
+
+void ParticleSystem::_BindComputeBuffers() const
+{
+	for (uint32_t ix = 0; ix < ComputeBufferCount; ix++) {
+		_computeBuffers[ix]->Bind(ix);
 	}
 }
 
 void ParticleSystem::AddEmitter(const glm::vec3& position, const glm::vec3& direction, float emitRate /*= 1.0f*/, const glm::vec4& color /*= glm::vec4(1.0f)*/)
 {
-	LOG_ASSERT(!_hasInit, "Cannot add an emitter after the particle system has been initialized");
+	LOG_ASSERT(!_hasInit || _backend == ParticleBackend::Compute, "Cannot add an emitter after a transform feedback particle system has been initialized");
 
 	ParticleData emitter;
 	emitter.Type     = ParticleType::Emitter; 
@@ -193,17 +438,70 @@ void ParticleSystem::AddEmitter(const glm::vec3& position, const glm::vec3& dire
 	_emitters.push_back(emitter); 
 }
 
+void ParticleSystem::RemoveEmitter(size_t index)
+{
+	LOG_ASSERT(!_hasInit || _backend == ParticleBackend::Compute, "Cannot remove an emitter after a transform feedback particle system has been initialized");
+	LOG_ASSERT(index < _emitters.size(), "Emitter index out of range");
+
+	_emitters.erase(_emitters.begin() + index);
+	if (index < _emitterTimers.size()) {
+		_emitterTimers.erase(_emitterTimers.begin() + index);
+	}
+}
+
+void ParticleSystem::SetMaxParticles(uint32_t value)
+{
+	if (_hasInit) {
+		LOG_WARN("Cannot change the max particle count after the particle system has been initialized");
+		return;
+	}
+	_maxParticles = glm::max(value, 1u);
+}
+
+void ParticleSystem::SetBackend(ParticleBackend value)
+{
+	if (_hasInit) {
+		LOG_WARN("Cannot change the backend after the particle system has been initialized");
+		return;
+	}
+	_backend = value;
+}
+
 void ParticleSystem::RenderImGui()
 {
-	LABEL_LEFT(ImGui::LabelText, "Particle Count", "%u", _numParticles);
+	// The backend and buffer sizes are fixed once we start simulating
+	if (!_hasInit) {
+		if (ImGui::BeginCombo("Backend", (~_backend).c_str())) {
+			for (ParticleBackend backend : { ParticleBackend::TransformFeedback, ParticleBackend::Compute }) {
+				if (ImGui::Selectable((~backend).c_str(), backend == _backend)) {
+					_backend = backend;
+				}
+			}
+			ImGui::EndCombo();
+		}
+		int maxParticles = static_cast<int>(_maxParticles);
+		if (LABEL_LEFT(ImGui::DragInt, "Max Particles", &maxParticles, 100.0f, 1, 1 << 22)) {
+			SetMaxParticles(static_cast<uint32_t>(maxParticles));
+		}
+	} else {
+		LABEL_LEFT(ImGui::LabelText, "Backend", "%s", (~_backend).c_str());
+	}
+
+	if (_backend == ParticleBackend::Compute) {
+		// The live count only exists on the GPU, as the argument to our indirect draw
+		LABEL_LEFT(ImGui::LabelText, "Max Particles", "%u", _maxParticles);
+		LABEL_LEFT(ImGui::Checkbox, "Depth Sort", &_sortParticles);
+	} else {
+		LABEL_LEFT(ImGui::LabelText, "Particle Count", "%u", _numParticles);
+	}
 
 	Application& app = Application::Get();
 
 	ImGui::Separator();
 	ImGui::Text("Emitters:");
 
-	// We can't add or edit emitters once the system has started
-	if (!app.CurrentScene()->IsPlaying) {
+	// We can't add or edit emitters once a transform feedback system has started
+	if (_backend == ParticleBackend::Compute || !app.CurrentScene()->IsPlaying) {
 		for (int ix = 0; ix < _emitters.size(); ix++) {
 			auto& emitter = _emitters[ix];
 
@@ -225,6 +523,9 @@ void ParticleSystem::RenderImGui()
 
 				if (ImGuiHelper::WarningButton("Delete")) {
 					_emitters.erase(_emitters.begin() + ix);
+					if (ix < _emitterTimers.size()) {
+						_emitterTimers.erase(_emitterTimers.begin() + ix);
+					}
 					ix--;
 				}
 			}
@@ -246,36 +547,12 @@ void ParticleSystem::RenderImGui()
 	}
 }
 
-void ParticleSystem::Awake()
-{
-	// There are the things we want the feedback buffers to track
-	const char const* varyings[6] = {
-		"out_Type",  
-		"out_Position",
-		"out_Velocity",
-		"out_Color", 
-		"out_Lifetime",
-		"out_Metadata" 
-	}; 
-
-	// This is our transform feedback shader
-	_updateShader = ShaderProgram::Create();
-	_updateShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_sim_vs.glsl", ShaderPartType::Vertex);
- 	_updateShader->LoadShaderPartFromFile("shaders/geometry_shaders/particle_sim_gs.glsl", ShaderPartType::Geometry);
-	_updateShader->RegisterVaryings(varyings, 6, true); // Here we call glTransformFeedbackVaryings, and let it know we want interleaved data
-	_updateShader->Link(); 
-
-	// This shader will render the particles
-	_renderShader = ShaderProgram::Create();
-	_renderShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_render_vs.glsl", ShaderPartType::Vertex);
-	_renderShader->LoadShaderPartFromFile("shaders/fragment_shaders/particles_render_fs.glsl", ShaderPartType::Fragment);
-	_renderShader->Link(); 
-}
-
 nlohmann::json ParticleSystem::ToJson() const {
 	nlohmann::json result = {
 		{ "gravity", _gravity },
-		{ "max_particles", _maxParticles }
+		{ "max_particles", _maxParticles },
+		{ "backend", ~_backend },
+		{ "sort", _sortParticles }
 	};
 
 	// Add emitters to the JSON data
@@ -299,7 +576,9 @@ ParticleSystem::Sptr ParticleSystem::FromJson(const nlohmann::json& blob) {
 	ParticleSystem::Sptr result = std::make_shared<ParticleSystem>();
 
 	result->_gravity = JsonGet(blob, "gravity", result->_gravity);
-	result->_maxParticles = JsonGet(blob, "max_particled", result->_maxParticles);
+	result->_maxParticles = glm::max(JsonGet(blob, "max_particles", result->_maxParticles), 1u);
+	result->_backend = JsonParseEnum(ParticleBackend, blob, "backend", result->_backend);
+	result->_sortParticles = JsonGet(blob, "sort", result->_sortParticles);
 
 	if (blob.contains("emitters") && blob["emitters"].is_array()) {
 		for (const auto& data : blob["emitters"]) {
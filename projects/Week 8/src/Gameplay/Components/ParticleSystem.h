@@ -1,16 +1,35 @@
 #pragma once
 #include "Gameplay/Components/IComponent.h"
 #include "Graphics/ShaderProgram.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/Buffers/ShaderStorageBuffer.h"
 
 ENUM(ParticleType, uint32_t,
 	Emitter       = 0,
 	Particle      = 1
 );
 
+ENUM(ParticleBackend, int,
+	// Emitters and particles share a vertex stream that a geometry shader updates via transform
+	// feedback. Emitters can spawn at most 31 particles per step, and can't change once running
+	TransformFeedback = 0,
+	// Particles are updated by compute shaders and drawn indirectly, emitters live on the CPU and
+	// can be added, removed or edited at any time
+	Compute           = 1
+);
+
 class ParticleSystem : public Gameplay::IComponent{
 public:
 	MAKE_PTRS(ParticleSystem);
 
+	// The number of threads in a work group for the simulation and sort key passes, must match
+	// particles_simulate.glsl and particles_sort_keys.glsl
+	static const uint32_t SIMULATE_GROUP_SIZE = 256;
+	// The number of threads in a work group for the bitonic sort, must match particles_bitonic_sort.glsl
+	static const uint32_t SORT_GROUP_SIZE = 512;
+	// The number of elements a sort work group handles in shared memory
+	static const uint32_t SORT_BLOCK_SIZE = SORT_GROUP_SIZE * 2;
+
 	ParticleSystem();
 	~ParticleSystem();
 
@@ -18,11 +37,27 @@ public:
 	void Render();
 
 	void AddEmitter(const glm::vec3& position, const glm::vec3& direction, float emitRate = 1.0f, const glm::vec4& color = glm::vec4(1.0f));
+	/// <summary>
+	/// Removes the emitter at the given index, only supported by the compute backend once the system is running
+	/// </summary>
+	void RemoveEmitter(size_t index);
+	size_t GetEmitterCount() const { return _emitters.size(); }
+
+	/// <summary>
+	/// Sets the max number of particles, only has an effect before the system starts simulating
+	/// </summary>
+	void SetMaxParticles(uint32_t value);
+	uint32_t GetMaxParticles() const { return _maxParticles; }
+
+	/// <summary>
+	/// Sets which backend simulates this system, only has an effect before the system starts simulating
+	/// </summary>
+	void SetBackend(ParticleBackend value);
+	ParticleBackend GetBackend() const { return _backend; }
 
 	// Inherited from IComponent
 
 	virtual void RenderImGui() override;
-	virtual void Awake() override;
 	virtual nlohmann::json ToJson() const override;
 	static ParticleSystem::Sptr FromJson(const nlohmann::json& blob);
 	MAKE_TYPENAME(ParticleSystem);
@@ -39,14 +74,44 @@ protected:
 		glm::vec4    Metadata;
 	};
 
+	// The emitter data the compute backend sends to the GPU each step, using std430 layout
+	struct GpuEmitter {
+		glm::vec4 PositionCone;  // Local position in xyz, cone angle in w
+		glm::vec4 Velocity;
+		glm::vec4 Color;
+		glm::vec2 LifetimeRange;
+		uint32_t  SpawnCount;    // The number of particles to spawn this step
+		uint32_t  Seed;
+	};
+
+	// The storage buffers used by the compute backend, in order of their binding slots in particle_buffers.glsl
+	enum ComputeBuffer : uint32_t {
+		Positions = 0,
+		Velocities,
+		Colors,
+		DeadList,
+		AliveList,
+		SortKeys,
+		Counters,
+		Emitters,
+		ComputeBufferCount
+	};
+
 	bool _hasInit;
+	ParticleBackend _backend;
 
 	uint32_t _maxParticles;
+	// The particle count from a few frames ago, only used for display
 	GLuint _numParticles;
 
 	uint32_t _particleBuffers[2];
 	uint32_t _feedbackBuffers[2];
-	uint32_t _query;
+
+	// Queries for counting how many particles we've simulated, we cycle through them so that we can
+	// read results from a few frames ago without waiting on the GPU
+	static const uint32_t QUERY_COUNT = 3;
+	uint32_t _queries[QUERY_COUNT];
+	uint32_t _queryFrame;
 
 	uint32_t _currentVertexBuffer;
 	uint32_t _currentFeedbackBuffer;
@@ -56,4 +121,31 @@ protected:
 	glm::vec3           _gravity;
 
 	std::vector<ParticleData> _emitters;
-};
\ No newline at end of file
+
+	// Compute backend state
+	bool                      _sortParticles;
+	ShaderStorageBuffer::Sptr _computeBuffers[ComputeBufferCount];
+	// The length of the alive list and sort keys, the max particle count rounded up to a power of two
+	uint32_t                  _sortCapacity;
+	// Time until each emitter's next spawn, kept separate from _emitters so they serialize unchanged
+	std::vector<float>        _emitterTimers;
+	std::vector<GpuEmitter>   _gpuEmitters;
+	uint32_t                  _seed;
+	ShaderProgram::Sptr       _emitShader;
+	ShaderProgram::Sptr       _simulateShader;
+	ShaderProgram::Sptr       _sortKeyShader;
+	ShaderProgram::Sptr       _sortShader;
+	ShaderProgram::Sptr       _computeRenderShader;
+	// Our particles are pulled from storage buffers, but we still need a VAO bound to draw
+	VertexArrayObject::Sptr   _emptyVao;
+
+	void _InitTransformFeedback();
+	void _UpdateTransformFeedback();
+	void _RenderTransformFeedback();
+
+	void _InitCompute();
+	void _UpdateCompute();
+	void _SortCompute();
+	void _RenderCompute();
+	void _BindComputeBuffers() const;
+};
@@ -2,6 +2,7 @@
 
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Gameplay/GameObject.h"
 
 
 RenderComponent::RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material) :
@@ -36,6 +37,13 @@ const Gameplay::Material::Sptr& RenderComponent::GetMaterial() const {
 	return _material;
 }
 
+AABB RenderComponent::GetWorldBounds() const {
+	if (_mesh == nullptr) {
+		return AABB();
+	}
+	return _mesh->GetBounds().Transformed(GetGameObject()->GetTransform());
+}
+
 nlohmann::json RenderComponent::ToJson() const {
 	nlohmann::json result;
 	result["mesh"] = _mesh ? _mesh->GetGUID().str() : "null";
@@ -29,6 +29,12 @@ public:
 	/// Gets the material that this renderer is using
 	/// </summary>
 	const Gameplay::Material::Sptr& GetMaterial() const;
+	/// <summary>
+	/// Gets the world space bounds of this object, based on the mesh's bounds and the
+	/// game object's transform
+	/// </summary>
+	/// <returns>The world space bounds, or an invalid AABB if the mesh has no bounds</returns>
+	AABB GetWorldBounds() const;
 
 	/// <summary>
 	/// Sets this render component's mesh resource, from which the VAO will be retrieved for rendering
@@ -19,5 +19,6 @@ public:
 	static RotatingBehaviour::Sptr FromJson(const nlohmann::json& data);
 
 	MAKE_TYPENAME(RotatingBehaviour);
+	MAKE_PARALLEL_UPDATE();
 };
 
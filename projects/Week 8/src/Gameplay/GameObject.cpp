@@ -16,64 +16,67 @@
 namespace Gameplay {
 	GameObject::GameObject() :
 		IResource(),
-		Name("Unknown"),
 		HideInHierarchy(false),
+		_name("Unknown"),
 		_components(std::vector<IComponent::Sptr>()),
 		_scene(nullptr),
 		_position(ZERO),
 		_rotation(glm::quat(glm::vec3(0.0f))),
 		_scale(ONE),
-		_localTransform(MAT4_IDENTITY),
-		_inverseLocalTransform(MAT4_IDENTITY),
-		_isLocalTransformDirty(true),
-		_worldTransform(MAT4_IDENTITY),
-		_inverseWorldTransform(MAT4_IDENTITY),
-		_isWorldTransformDirty(true),
+		_transformHandle(TransformSystem::INVALID_HANDLE),
 		_parent(WeakRef()),
 		_children(std::vector<WeakRef>())
 	{ }
 
-	void GameObject::_RecalcLocalTransform() const
-	{
-		if (_isLocalTransformDirty) {
-			_localTransform = glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
-			_inverseLocalTransform = glm::inverse(_localTransform);
-			_isLocalTransformDirty = false;
-			_isWorldTransformDirty = true;
-
-			// Dirty all the child objects world transforms
-			for (const auto& childPtr : _children) {
-				GameObject::Sptr childSptr = childPtr;
-				if (childSptr != nullptr) {
-					childSptr->_isWorldTransformDirty = true;
-				}
-			}
+	GameObject::~GameObject() {
+		if (_HasTransform()) {
+			_Transforms().Free(_transformHandle);
+			_transformHandle = TransformSystem::INVALID_HANDLE;
 		}
 	}
 
-	void GameObject::_RecalcWorldTransform() const {
-		// Start by determining our local transform if required
-		_RecalcLocalTransform();
+	const std::string& GameObject::GetName() const {
+		return _name;
+	}
 
-		// If our world transform has been marked as dirty, we need to recalculate it!
-		if (_isWorldTransformDirty) {
-			GameObject::Sptr parent = _parent;
+	void GameObject::SetName(const std::string& name) {
+		if (name == _name) {
+			return;
+		}
+		std::string oldName = _name;
+		_name = name;
+		if (_scene != nullptr) {
+			_scene->_OnObjectRenamed(_selfRef.lock(), oldName);
+		}
+	}
 
-			// If out parent exists, we apply our local transformation relative to the parent's world transformation
-			if (parent != nullptr) {
-				_worldTransform = parent->GetTransform() * _localTransform;
-				_inverseWorldTransform = glm::inverse(_worldTransform);
-			}
+	void GameObject::_MarkTransformDirty() {
+		if (_HasTransform()) {
+			_Transforms().MarkLocalDirty(_transformHandle);
+		}
+	}
 
-			// If our parent is null, we can simply use the local transform as the world transform
-			else {
-				_worldTransform = _localTransform;
-				_inverseWorldTransform = _inverseLocalTransform;
-			}
-			_isWorldTransformDirty = false;
+	TransformSystem& GameObject::_Transforms() const {
+		return _scene->_transforms;
+	}
+
+	bool GameObject::_HasTransform() const {
+		return _scene != nullptr && _transformHandle != TransformSystem::INVALID_HANDLE;
+	}
+
+	void GameObject::_DetachFromScene() {
+		_scene = nullptr;
+		_transformHandle = TransformSystem::INVALID_HANDLE;
+		// The scene's component pools are gone too, make sure our components can't reach back into them
+		for (auto& component : _components) {
+			component->_context = nullptr;
 		}
 	}
 
+	glm::mat4 GameObject::_CalculateLocalTransform() const {
+		return glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
+	}
+
 	void GameObject::_PurgeDeletedChildren() {
 		auto it = std::remove_if(_children.begin(), _children.end(), [](WeakRef child) { 
 			return child == nullptr; 
@@ -113,7 +116,7 @@ namespace Gameplay {
 
 	void GameObject::SetPostion(const glm::vec3& position) {
 		_position = position;
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	const glm::vec3& GameObject::GetPosition() const {
@@ -126,7 +129,7 @@ namespace Gameplay {
 
 	void GameObject::SetRotation(const glm::quat& value) {
 		_rotation = value;
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	const glm::quat& GameObject::GetRotation() const {
@@ -135,7 +138,7 @@ namespace Gameplay {
 
 	void GameObject::SetRotation(const glm::vec3& eulerAngles) {
 		_rotation = glm::quat(glm::radians(eulerAngles));
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	glm::vec3 GameObject::GetRotationEuler() const {
@@ -144,32 +147,32 @@ namespace Gameplay {
 
 	void GameObject::SetScale(const glm::vec3& value) {
 		_scale = value;
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	const glm::vec3& GameObject::GetScale() const {
 		return _scale;
 	}
 
-	const glm::mat4& GameObject::GetTransform() const {
-		_RecalcWorldTransform();
-		return _worldTransform;
+	glm::mat4 GameObject::GetTransform() const {
+		return _HasTransform() ? _Transforms().GetWorld(_transformHandle) : _CalculateLocalTransform();
 	}
 
-	const glm::mat4& GameObject::GetInverseTransform() const {
-		_RecalcWorldTransform();
-		return _inverseWorldTransform;
+	glm::mat4 GameObject::GetInverseTransform() const {
+		return _HasTransform() ? _Transforms().GetInverseWorld(_transformHandle) : glm::inverse(_CalculateLocalTransform());
 	}
 
-	const glm::mat4& GameObject::GetLocalTransform() const
+	glm::mat3 GameObject::GetNormalMatrix() const {
+		return _HasTransform() ? _Transforms().GetNormalMatrix(_transformHandle) : glm::transpose(glm::mat3(glm::inverse(_CalculateLocalTransform())));
+	}
+
+	glm::mat4 GameObject::GetLocalTransform() const
 	{
-		_RecalcLocalTransform();
-		return _localTransform;
+		return _HasTransform() ? _Transforms().GetLocal(_transformHandle) : _CalculateLocalTransform();
 	}
 
-	const glm::mat4& GameObject::GetInverseLocalTransform() const {
-		_RecalcLocalTransform();
-		return _inverseLocalTransform;
+	glm::mat4 GameObject::GetInverseLocalTransform() const {
+		return _HasTransform() ? _Transforms().GetInverseLocal(_transformHandle) : glm::inverse(_CalculateLocalTransform());
 	}
 
 	void GameObject::RenderGUI() {
@@ -210,14 +213,14 @@ namespace Gameplay {
 	}
 
 	void GameObject::Update(float dt) {
+		// Components that are updated in parallel are handled by the scene instead
+		bool skipParallel = _scene->IsParallelUpdateEnabled();
 		for (auto& component : _components) {
-			if (component->IsEnabled) {
+			if (component->IsEnabled && !(skipParallel && component->_isParallelUpdate)) {
 				component->Update(dt);
 			}
 		}
 
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 		_PurgeDeletedChildren();
 	}
 
@@ -279,9 +282,9 @@ namespace Gameplay {
 			// applies to the child
 			_children.push_back(child);
 			child->_parent = _selfRef.lock();
-			child->_isWorldTransformDirty = true;
+			_Transforms().SetParent(child->_transformHandle, _transformHandle);
 		} else {
-			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->Name);
+			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->GetName());
 		}
 	}
 
@@ -293,6 +296,7 @@ namespace Gameplay {
 			// Clear the object's parent and remove from our list of children
 			child->_parent.Reset();
 			_children.erase(it);
+			_Transforms().SetParent(child->_transformHandle, TransformSystem::INVALID_HANDLE);
 			return true;
 		} else {
 			return false;
@@ -315,16 +319,16 @@ namespace Gameplay {
 		ImGui::PushID(this); // Push a new ImGui ID scope for this object
 		// Since we're allowing names to change, we need to use the ### to have a static ID for the header
 		static char buffer[256];
-		sprintf_s(buffer, 256, "%s###GO_HEADER", Name.c_str());
+		sprintf_s(buffer, 256, "%s###GO_HEADER", _name.c_str());
 		if (ImGui::CollapsingHeader(buffer)) {
 			ImGui::Indent();
 
 			// Draw a textbox for our name
 			static char nameBuff[256];
-			memcpy(nameBuff, Name.c_str(), Name.size());
-			nameBuff[Name.size()] = '\0';
+			memcpy(nameBuff, _name.c_str(), _name.size());
+			nameBuff[_name.size()] = '\0';
 			if (ImGui::InputText("", nameBuff, 256)) {
-				Name = nameBuff;
+				SetName(nameBuff);
 			}
 			ImGui::SameLine();
 			if (ImGuiHelper::WarningButton("Delete")) {
@@ -354,7 +358,9 @@ namespace Gameplay {
 			}
 
 			// Render position label
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f);
+			if (LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f)) {
+				_MarkTransformDirty();
+			}
 			
 			// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 			glm::vec3 euler = GetRotationEuler();
@@ -380,7 +386,9 @@ namespace Gameplay {
 			}
 			
 			// Draw the scale
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f);
+			if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f)) {
+				_MarkTransformDirty();
+			}
 
 			ImGui::Separator();
 			ImGui::TextUnformatted("Components");
@@ -438,10 +446,6 @@ namespace Gameplay {
 			ImGui::Unindent();
 		}
 		ImGui::PopID(); // Pop the ImGui ID scope for the object
-
-		// For if we're not in play mode
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 	}
 
 	std::shared_ptr<GameObject> GameObject::SelfRef() {
@@ -454,17 +458,17 @@ namespace Gameplay {
 		// protected. We can call it here since Scene is a friend class of GameObjects
 		GameObject::Sptr result(new GameObject());
 		result->_scene = scene;
+		result->_transformHandle = scene->_transforms.Allocate(result.get());
 
 		// Load in basic info
-		result->Name = data["name"];
+		result->_name = data["name"];
 		result->_guid = Guid(data["guid"]);
 		result->_parent = WeakRef(Guid(data.contains("parent") ? data["parent"] : "null"), nullptr);
 		result->_position = (data["position"]);
 		result->_rotation = (data["rotation"]);
 		result->_scale    = (data["scale"]);
 		result->HideInHierarchy = JsonGet(data, "hide_in_inspector", false);
-		result->_isLocalTransformDirty = true;
-		result->_isWorldTransformDirty = true;
+		result->_MarkTransformDirty();
 
 		// Since our components are stored based on the type name, we iterate
 		// on the keys and values from the components object
@@ -487,7 +491,7 @@ namespace Gameplay {
 	nlohmann::json GameObject::ToJson() const {
 		GameObject::Sptr parent = _parent;
 		nlohmann::json result = {
-			{ "name", Name },
+			{ "name", _name },
 			{ "guid", _guid.str() },
 			{ "position", _position },
 			{ "rotation", _rotation },
@@ -3,6 +3,7 @@
 
 // Utils
 #include "Utils/GUID.hpp"
+#include "Gameplay/TransformSystem.h"
 
 // GLM
 #define GLM_ENABLE_EXPERIMENTAL
@@ -133,12 +134,21 @@ namespace Gameplay {
 			void Reset();
 		};
 
-		// Human readable name for the object
-		std::string             Name;
-
 		// Hack to hide instances from the hierarchy (like when adding lots of instances)
 		bool HideInHierarchy = false;
 
+		virtual ~GameObject();
+
+		/// <summary>
+		/// Gets the human readable name for this object
+		/// </summary>
+		const std::string& GetName() const;
+		/// <summary>
+		/// Renames this object, updating the scene's name lookup to match
+		/// </summary>
+		/// <param name="name">The new name for the object</param>
+		void SetName(const std::string& name);
+
 		/// <summary>
 		/// Rotates this object to look at the given point in world coordinates
 		/// </summary>
@@ -215,16 +225,25 @@ namespace Gameplay {
 		/// <summary>
 		/// Gets or recalculates and gets the object's world transform
 		/// This matrix transforms points from local space to world space
+		///
+		/// The matrices are returned by value, since the scene's transform storage moves whenever
+		/// an object is added. If the scene has been destroyed, these only reflect the object's own
+		/// position, rotation and scale
 		/// </summary>
-		const glm::mat4& GetTransform() const;
+		glm::mat4 GetTransform() const;
 		/// <summary>
 		/// Gets or recalculates the inverse of this object's world transform
 		/// This matrix transforms points from world space to local space
 		/// </summary>
-		const glm::mat4& GetInverseTransform() const;
+		glm::mat4 GetInverseTransform() const;
+		/// <summary>
+		/// Gets or recalculates the matrix used to transform normals from local space to
+		/// world space (the inverse transpose of the world transform)
+		/// </summary>
+		glm::mat3 GetNormalMatrix() const;
 
-		const glm::mat4& GetLocalTransform() const;
-		const glm::mat4& GetInverseLocalTransform() const;
+		glm::mat4 GetLocalTransform() const;
+		glm::mat4 GetInverseLocalTransform() const;
 
 		/// <summary>
 		/// Allows components to render GUI elements to the screen
@@ -339,6 +358,9 @@ namespace Gameplay {
 		friend class InspectorWindow;
 		friend class HierarchyWindow;
 
+		// Human readable name for the object, only changed through SetName so the scene's name index stays current
+		std::string _name;
+
 		// Rotation of the object as a quaternion
 		glm::quat _rotation;
 		// Position of the object
@@ -346,14 +368,8 @@ namespace Gameplay {
 		// The scale of the object
 		glm::vec3 _scale;
 
-		// The object's world transform
-		mutable glm::mat4 _localTransform;
-		mutable glm::mat4 _inverseLocalTransform;
-		mutable bool _isLocalTransformDirty;
-
-		mutable glm::mat4 _worldTransform;
-		mutable glm::mat4 _inverseWorldTransform;
-		mutable bool _isWorldTransformDirty;
+		// Our transform matrices are stored in the scene's transform system, this is our handle into it
+		TransformSystem::Handle _transformHandle;
 
 		// For the hierarchy
 		WeakRef _parent;
@@ -365,7 +381,8 @@ namespace Gameplay {
 
 		// Pointer to the scene, we use raw pointers since 
 		// this will always be set by the scene on creation
-		// or load, we don't need to worry about ref counting
+		// or load, we don't need to worry about ref counting.
+		// If we outlive the scene, it sets this back to nullptr
 		Scene* _scene;
 
 		/// <summary>
@@ -373,9 +390,27 @@ namespace Gameplay {
 		/// </summary>
 		GameObject();
 
-		// Recalculates the transform matrix for the object when required
-		void _RecalcLocalTransform() const;
-		void _RecalcWorldTransform() const;
+		/// <summary>
+		/// Lets the transform system know that our position, rotation or scale has changed
+		/// </summary>
+		void _MarkTransformDirty();
+		/// <summary>
+		/// Gets the transform system that stores our matrices
+		/// </summary>
+		TransformSystem& _Transforms() const;
+		/// <summary>
+		/// Returns true if we have a transform in a scene's transform system
+		/// </summary>
+		bool _HasTransform() const;
+		/// <summary>
+		/// Invoked by the scene when it is destroyed while we're still alive, so that we stop
+		/// referring to it's storage
+		/// </summary>
+		void _DetachFromScene();
+		/// <summary>
+		/// Calculates our local transform without going through the transform system
+		/// </summary>
+		glm::mat4 _CalculateLocalTransform() const;
 
 		void _PurgeDeletedChildren();
 	};
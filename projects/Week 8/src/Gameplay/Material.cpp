@@ -61,7 +61,11 @@ namespace Gameplay {
 	}
 
 	void Material::Apply() {
-		if (_shader != nullptr) {
+		Apply(_shader);
+	}
+
+	void Material::Apply(const ShaderProgram::Sptr& shader) {
+		if (shader != nullptr) {
 			// Skip the reserved # of texture slots
 			int textureSlot = 0;
 			
@@ -85,13 +89,13 @@ namespace Gameplay {
 							ITexture::Unbind(textureSlot);
 						}
 						// Send the slot to the shader
-						_shader->SetUniform(data.Location, data.Type, &textureSlot);
+						shader->SetUniform(data.Location, data.Type, &textureSlot);
 						textureSlot++;
 					}
 				}
 				// The uniform is a plain ol' value type, send it in
 				else {
-					_shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
+					shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
 				}
 			}
 		}
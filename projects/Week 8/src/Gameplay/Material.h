@@ -65,6 +65,12 @@ namespace Gameplay {
 		/// Will bind the shader, update material uniforms, and bind textures
 		/// </summary>
 		virtual void Apply();
+		/// <summary>
+		/// Applies this material's uniforms and textures to another shader, which must have the
+		/// same uniform layout as the material's shader (ex: its instanced variant)
+		/// </summary>
+		/// <param name="shader">The shader to send the material parameters to</param>
+		void Apply(const ShaderProgram::Sptr& shader);
 
 		/// <summary>
 		/// Renders some UI controls for manipulating a material at runtime
@@ -2,6 +2,9 @@
 #include <filesystem>
 
 #include "Utils/ObjLoader.h"
+#ifdef OPTIMIZED_OBJ_LOADER
+#include "Utils/OptimizedObjLoader.h"
+#endif
 
 namespace Gameplay {
 	MeshResource::MeshResource() :
@@ -66,6 +69,63 @@ namespace Gameplay {
 		return result;
 	}
 
+	std::function<MeshResource::Sptr()> MeshResource::DecodeFromJson(const nlohmann::json& blob)
+	{
+		// Generated meshes are built here, only the bake needs to happen on the main thread
+		if (blob.contains("params") && blob["params"].is_array()) {
+			std::vector<nlohmann::json> meshbuilderParams = blob["params"].get<std::vector<nlohmann::json>>();
+			std::vector<MeshBuilderParam> params;
+			std::shared_ptr<MeshBuilder<VertexPosNormTexColTangents>> mesh = std::make_shared<MeshBuilder<VertexPosNormTexColTangents>>();
+			for (int ix = 0; ix < meshbuilderParams.size(); ix++) {
+				MeshBuilderParam p = MeshBuilderParam::FromJson(meshbuilderParams[ix]);
+				params.push_back(p);
+				MeshFactory::AddParameterized(*mesh, p);
+			}
+			MeshFactory::CalculateTBN(*mesh);
+
+			return [params, mesh]() {
+				MeshResource::Sptr result = std::make_shared<MeshResource>();
+				result->MeshBuilderParams = params;
+				result->Mesh = mesh->Bake();
+				return result;
+			};
+		}
+
+		// Like FromJson, meshes that fail to load still create a resource, it just won't have a VAO
+		std::string filename = JsonGet<std::string>(blob, "filename", "null");
+		bool hasFile = filename != "null" && std::filesystem::exists(filename);
+
+		#ifdef OPTIMIZED_OBJ_LOADER
+		std::shared_ptr<OptimizedObjLoader::MeshData> data = nullptr;
+		if (hasFile) {
+			data = std::make_shared<OptimizedObjLoader::MeshData>();
+			if (!OptimizedObjLoader::DecodeFile(filename, *data)) {
+				data = nullptr;
+			}
+		}
+
+		return [filename, data]() {
+			MeshResource::Sptr result = std::make_shared<MeshResource>();
+			result->Filename = filename;
+			result->Mesh = data != nullptr ? OptimizedObjLoader::UploadMesh(*data) : nullptr;
+			return result;
+		};
+		#else
+		std::shared_ptr<MeshBuilder<VertexPosNormTexColTangents>> mesh = nullptr;
+		if (hasFile) {
+			mesh = std::make_shared<MeshBuilder<VertexPosNormTexColTangents>>();
+			ObjLoader::LoadMesh(filename, *mesh);
+		}
+
+		return [filename, mesh]() {
+			MeshResource::Sptr result = std::make_shared<MeshResource>();
+			result->Filename = filename;
+			result->Mesh = mesh != nullptr ? mesh->Bake() : nullptr;
+			return result;
+		};
+		#endif
+	}
+
 	void MeshResource::GenerateMesh() {
 		MeshBuilder<VertexPosNormTexColTangents> mesh;
 		for (auto& param : MeshBuilderParams) {
@@ -78,4 +138,8 @@ namespace Gameplay {
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
 		MeshBuilderParams.push_back(param);
 	}
+
+	AABB MeshResource::GetBounds() const {
+		return Mesh != nullptr ? Mesh->GetBounds() : AABB();
+	}
 }
\ No newline at end of file
@@ -61,9 +61,20 @@ namespace Gameplay {
 		/// <param name="param">The parameter to add</param>
 		void AddParam(const MeshBuilderParam& param);
 
+		/// <summary>
+		/// Gets the model space bounds of the mesh, calculated when the mesh was loaded or generated
+		/// </summary>
+		/// <returns>The mesh bounds, or an invalid AABB if there is no mesh</returns>
+		AABB GetBounds() const;
+
 		// Inherited from IResource
 
 		virtual nlohmann::json ToJson() const override;
 		static MeshResource::Sptr FromJson(const nlohmann::json& blob);
+		/// <summary>
+		/// Loads or generates the mesh's geometry on the calling thread, and returns a function that
+		/// will create the VAO on the main thread. See ResourceManager::LoadAsync
+		/// </summary>
+		static std::function<MeshResource::Sptr()> DecodeFromJson(const nlohmann::json& blob);
 	};
 }
\ No newline at end of file
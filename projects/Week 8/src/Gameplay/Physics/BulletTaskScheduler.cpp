@@ -0,0 +1,84 @@
+#include "Gameplay/Physics/BulletTaskScheduler.h"
+#include <algorithm>
+#include <vector>
+
+#include "Utils/ThreadPool.h"
+
+namespace {
+	/// <summary>
+	/// Empty loop body, used to check whether bullet is calling into the scheduler
+	/// </summary>
+	struct NullParallelForBody : public btIParallelForBody {
+		virtual void forLoop(int, int) const override { }
+	};
+}
+
+BulletTaskScheduler::BulletTaskScheduler() :
+	btITaskScheduler("ThreadPool"),
+	_threadPool(ThreadPool::Get()),
+	_taskCount(1),
+	_dispatchCount(0)
+{
+	_taskCount = getMaxNumThreads();
+}
+
+BulletTaskScheduler& BulletTaskScheduler::Get() {
+	static BulletTaskScheduler instance;
+	return instance;
+}
+
+bool BulletTaskScheduler::IsDispatching() {
+	uint32_t before = GetDispatchCount();
+	btParallelFor(0, 2, 1, NullParallelForBody());
+	return GetDispatchCount() != before;
+}
+
+int BulletTaskScheduler::getMaxNumThreads() const {
+	// The thread that calls parallelFor will also run chunks
+	int threads = static_cast<int>(_threadPool.GetThreadCount()) + 1;
+	return std::min(threads, static_cast<int>(BT_MAX_THREAD_COUNT));
+}
+
+int BulletTaskScheduler::getNumThreads() const {
+	// Any of the threads in the pool can pick up our chunks, so bullet needs to allocate storage for all of them
+	return getMaxNumThreads();
+}
+
+void BulletTaskScheduler::setNumThreads(int numThreads) {
+	_taskCount = std::clamp(numThreads, 1, getMaxNumThreads());
+}
+
+size_t BulletTaskScheduler::_GetChunkSize(int count, int grainSize) const {
+	size_t perTask = (static_cast<size_t>(count) + _taskCount - 1) / _taskCount;
+	return std::max<size_t>(perTask, std::max(grainSize, 1));
+}
+
+void BulletTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) {
+	_dispatchCount.fetch_add(1, std::memory_order_relaxed);
+	if (iEnd <= iBegin) return;
+
+	const int count = iEnd - iBegin;
+	_threadPool.ParallelFor(count, _GetChunkSize(count, grainSize), [&](size_t begin, size_t end) {
+		body.forLoop(iBegin + static_cast<int>(begin), iBegin + static_cast<int>(end));
+	});
+}
+
+btScalar BulletTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) {
+	_dispatchCount.fetch_add(1, std::memory_order_relaxed);
+	if (iEnd <= iBegin) return btScalar(0);
+
+	const int count = iEnd - iBegin;
+	const size_t chunkSize = _GetChunkSize(count, grainSize);
+
+	// Each chunk writes to it's own slot, so we don't need any locking
+	std::vector<btScalar> partialSums((count + chunkSize - 1) / chunkSize, btScalar(0));
+	_threadPool.ParallelFor(count, chunkSize, [&](size_t begin, size_t end) {
+		partialSums[begin / chunkSize] = body.sumLoop(iBegin + static_cast<int>(begin), iBegin + static_cast<int>(end));
+	});
+
+	btScalar result = btScalar(0);
+	for (btScalar sum : partialSums) {
+		result += sum;
+	}
+	return result;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <LinearMath/btThreads.h>
+#include <EnumToString.h>
+
+/// <summary>
+/// Represents the options for how a scene's physics world is stepped
+/// </summary>
+ENUM(PhysicsThreadingMode, int,
+	// A regular btDiscreteDynamicsWorld, everything runs on the main thread
+	Sequential   = 0,
+	// A btDiscreteDynamicsWorldMt, where simulation islands are solved in parallel by a pool
+	// of solvers, and broadphase pairs and integration are split across threads
+	IslandPool   = 1,
+	// As above, but islands that are too large to be worth handing to a single solver are solved
+	// across all threads with btSequentialImpulseConstraintSolverMt
+	IslandPoolMt = 2
+);
+
+class ThreadPool;
+
+/// <summary>
+/// Implements bullet's btITaskScheduler interface on top of our shared thread pool, so that
+/// multithreaded physics worlds don't need to spin up their own set of threads
+///
+/// Bullet only has a single global task scheduler, so this is a singleton
+/// </summary>
+class BulletTaskScheduler : public btITaskScheduler {
+public:
+	BulletTaskScheduler(const BulletTaskScheduler& other) = delete;
+	BulletTaskScheduler(BulletTaskScheduler&& other) = delete;
+	BulletTaskScheduler& operator =(const BulletTaskScheduler& other) = delete;
+	BulletTaskScheduler& operator =(BulletTaskScheduler&& other) = delete;
+
+	virtual ~BulletTaskScheduler() = default;
+
+	/// <summary>
+	/// Gets the task scheduler, which is created on first use
+	/// </summary>
+	static BulletTaskScheduler& Get();
+
+	/// <summary>
+	/// Returns true if bullet is actually handing work to the active task scheduler. If the bullet
+	/// libraries were built without BT_THREADSAFE, the Mt classes will silently run everything on
+	/// the calling thread. Only valid while this is the active scheduler
+	/// </summary>
+	bool IsDispatching();
+
+	/// <summary>
+	/// Gets the total number of loops that bullet has handed to this scheduler
+	/// </summary>
+	uint32_t GetDispatchCount() const { return _dispatchCount.load(std::memory_order_relaxed); }
+
+	// Inherited from btITaskScheduler
+
+	/// <summary>
+	/// Gets the number of threads that may run bullet tasks, bullet uses this to size it's per
+	/// thread storage, so this includes every thread in our pool as well as the calling thread
+	/// </summary>
+	virtual int getMaxNumThreads() const override;
+	virtual int getNumThreads() const override;
+	/// <summary>
+	/// Limits the number of threads that a single loop will be split across
+	/// </summary>
+	virtual void setNumThreads(int numThreads) override;
+	virtual void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override;
+	virtual btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override;
+
+protected:
+	BulletTaskScheduler();
+
+	ThreadPool&           _threadPool;
+	// The max number of chunks we split a loop into
+	int                   _taskCount;
+	std::atomic<uint32_t> _dispatchCount;
+
+	/// <summary>
+	/// Gets the chunk size to use when splitting a loop, so that we end up with at most one chunk per
+	/// thread, but never less than bullet's requested grain size
+	/// </summary>
+	size_t _GetChunkSize(int count, int grainSize) const;
+};
@@ -6,6 +6,7 @@
 #include "Gameplay/Components/RenderComponent.h"
 
 #include "Utils/GlmBulletConversions.h"
+#include <GLM/gtc/type_precision.hpp>
 
 namespace Gameplay::Physics {
 	ConvexMeshCollider::Sptr ConvexMeshCollider::Create() {
@@ -111,6 +112,19 @@ namespace Gameplay::Physics {
 					}
 				};
 
+				// Helper for extracting a position from a raw vertex buffer datastore. Packed positions are unorm16
+				// and need the VAO's position transform to get back to model space
+				const bool isPacked = posAttrib.Type == AttributeType::UShort && posAttrib.Normalized;
+				const glm::mat4& positionTransform = vao->GetPositionTransform();
+				auto getPosition = [&](uint8_t* dataStore, size_t vertex) {
+					uint8_t* element = dataStore + (posAttrib.Stride * vertex) + posAttrib.Offset;
+					if (isPacked) {
+						glm::vec3 packed = glm::vec3(*reinterpret_cast<glm::u16vec3*>(element)) / 65535.0f;
+						return glm::vec3(positionTransform * glm::vec4(packed, 1.0f));
+					}
+					return *reinterpret_cast<glm::vec3*>(element);
+				};
+
 				// Allocate some space to read data from OpenGL and read our buffer data back into CPU memory
 				uint8_t* vertexStore = reinterpret_cast<uint8_t*>(malloc(vertexBuff->GetTotalSize()));
 				glGetNamedBufferSubData(vertexBuff->GetHandle(), 0, vertexBuff->GetTotalSize(), vertexStore);
@@ -130,9 +144,9 @@ namespace Gameplay::Physics {
 						int i3 = getBufferIndex(indexBuff, indexStore, static_cast<int>(ix + 2));
 
 						// Find the positions for the indices
-						glm::vec3 p1 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i1) + posAttrib.Offset);
-						glm::vec3 p2 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i2) + posAttrib.Offset);
-						glm::vec3 p3 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i3) + posAttrib.Offset);
+						glm::vec3 p1 = getPosition(vertexStore, i1);
+						glm::vec3 p2 = getPosition(vertexStore, i2);
+						glm::vec3 p3 = getPosition(vertexStore, i3);
 
 						// Add the triangle
 						_triMesh->addTriangle(ToBt(p1), ToBt(p2), ToBt(p3));
@@ -146,9 +160,9 @@ namespace Gameplay::Physics {
 				else {
 					// Iterate over triangles, and add each to the mesh
 					for (size_t ix = 0; ix < vertexBuff->GetElementCount(); ix+=3) {
-						glm::vec3 p1 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 0) * posAttrib.Stride) + posAttrib.Offset);
-						glm::vec3 p2 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 1) * posAttrib.Stride) + posAttrib.Offset);
-						glm::vec3 p3 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 2) * posAttrib.Stride) + posAttrib.Offset);
+						glm::vec3 p1 = getPosition(vertexStore, ix + 0);
+						glm::vec3 p2 = getPosition(vertexStore, ix + 1);
+						glm::vec3 p3 = getPosition(vertexStore, ix + 2);
 						_triMesh->addTriangle(ToBt(p1), ToBt(p2), ToBt(p3));
 					}
 				}
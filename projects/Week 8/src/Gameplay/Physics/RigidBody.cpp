@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
 
 #include "Gameplay/GameObject.h"
 #include "Gameplay/Scene.h"
@@ -27,7 +28,11 @@ namespace Gameplay::Physics {
 		_angularVelocity(btVector3(0, 0, 0)),
 		_angularVelocityDirty(false),
 		_angularFactor(btVector3(1,1,1)),
-		_angularFactorDirty(false)
+		_angularFactorDirty(false),
+		_previousTransform(btTransform::getIdentity()),
+		_interpolatedPosition(glm::vec3(0.0f)),
+		_interpolatedRotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f)),
+		_hasInterpolatedState(false)
 	{ }
 
 	RigidBody::~RigidBody() {
@@ -164,7 +169,17 @@ namespace Gameplay::Physics {
 
 			// Copy to body and to it's motion state
 			if (_type == RigidBodyType::Dynamic) {
-				_body->setWorldTransform(transform);
+				// Our game object is normally showing an interpolated state, so we only push it back into
+				// the body if something else has moved it since the last post step (ex: teleporting)
+				GameObject* context = GetGameObject();
+				if (!_hasInterpolatedState || 
+					context->GetPosition() != _interpolatedPosition || 
+					context->GetRotation() != _interpolatedRotation) 
+				{
+					_body->setWorldTransform(transform);
+					_previousTransform = transform;
+					_hasInterpolatedState = false;
+				}
 			} else {
 				// Kinematics prefer to be driven my motion state for some reason :|
 				_body->getMotionState()->setWorldTransform(transform); 
@@ -172,11 +187,27 @@ namespace Gameplay::Physics {
 		}
 	}
 
+	void RigidBody::PhysicsStoreState() {
+		if (_type == RigidBodyType::Dynamic && _body != nullptr) {
+			_previousTransform = _body->getWorldTransform();
+		}
+	}
+
 	void RigidBody::PhysicsPostStep(float dt) {
 		// Kinematics are driven externally and statics don't move, so only need to get data out for dynamics!
-		if (_type == RigidBodyType::Dynamic && _body->isActive()) {
-			btTransform transform = _body->getWorldTransform();
-			_CopyGameobjectTransformFrom(transform);
+		// Note that we still need to do this for sleeping bodies, since we may not have finished 
+		// interpolating to the state it fell asleep in
+		if (_type == RigidBodyType::Dynamic) {
+			const btTransform& current = _body->getWorldTransform();
+			float alpha = _scene->GetPhysicsInterpolation();
+
+			_interpolatedPosition = glm::mix(ToGlm(_previousTransform.getOrigin()), ToGlm(current.getOrigin()), alpha);
+			_interpolatedRotation = glm::slerp(ToGlm(_previousTransform.getRotation()), ToGlm(current.getRotation()), alpha);
+			_hasInterpolatedState = true;
+
+			GameObject* context = GetGameObject();
+			context->SetPostion(_interpolatedPosition);
+			context->SetRotation(_interpolatedRotation);
 
 			// Store a copy of our velocities
 			_linearVelocity = _body->getLinearVelocity();
@@ -2,6 +2,7 @@
 #include <EnumToString.h>
 #include <btBulletCollisionCommon.h>
 #include <btBulletDynamicsCommon.h>
+#include <GLM/gtc/quaternion.hpp>
 
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Physics/ICollider.h"
@@ -164,6 +165,11 @@ namespace Gameplay::Physics {
 		/// </summary>
 		/// <param name="dt">The time in seconds since the last frame</param>
 		virtual void PhysicsPostStep(float dt) override;
+		/// <summary>
+		/// Invoked for each RigidBody right before each fixed physics step, stores the body's
+		/// current transform so that we can interpolate from it after the step
+		/// </summary>
+		void PhysicsStoreState();
 
 		// Inherited from IComponent
 		virtual void Awake() override;
@@ -198,6 +204,14 @@ namespace Gameplay::Physics {
 		btVector3        _angularFactor;
 		bool             _angularFactorDirty;
 
+		// The body's transform before the most recent physics step, we render between this and the current transform
+		btTransform      _previousTransform;
+		// The interpolated position and rotation that we last gave to our game object, used to detect
+		// when something else has moved the object
+		glm::vec3        _interpolatedPosition;
+		glm::quat        _interpolatedRotation;
+		bool             _hasInterpolatedState;
+
 		// Handles resolving any dirty state stuff for our object
 		void _HandleStateDirty();
 
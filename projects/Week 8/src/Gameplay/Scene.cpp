@@ -6,6 +6,11 @@
 
 #include "Utils/FileHelpers.h"
 #include "Utils/GlmBulletConversions.h"
+#include "Utils/JsonGlmHelpers.h"
+
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
 
 #include "Gameplay/Physics/RigidBody.h"
 #include "Gameplay/Physics/TriggerVolume.h"
@@ -21,18 +26,27 @@ namespace Gameplay {
 	Scene::Scene() :
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
+		_guidIndex(std::unordered_map<Guid, std::weak_ptr<GameObject>>()),
+		_nameIndex(std::unordered_map<std::string, std::weak_ptr<GameObject>>()),
 		IsPlaying(false),
 		IsDestroyed(false),
 		MainCamera(nullptr),
 		DefaultMaterial(nullptr),
 		_isAwake(false),
+		_parallelUpdate(true),
 		_filePath(""),
 		_skyboxShader(nullptr),
 		_skyboxMesh(nullptr),
 		_skyboxTexture(nullptr),
 		_skyboxRotation(glm::mat3(1.0f)),
 		_ambientLight(glm::vec3(0.1f)),
-		_gravity(glm::vec3(0.0f, 0.0f, -9.81f))
+		_gravity(glm::vec3(0.0f, 0.0f, -9.81f)),
+		_fixedTimeStep(1.0f / 60.0f),
+		_maxSubSteps(5),
+		_physicsAccumulator(0.0f),
+		_physicsInterpolation(0.0f),
+		_physicsThreading(PhysicsThreadingMode::Sequential),
+		_physicsThreadCount(0)
 	{
 		GameObject::Sptr mainCam = CreateGameObject("Main Camera");		
 		MainCamera = mainCam->Add<Camera>();
@@ -47,12 +61,78 @@ namespace Gameplay {
 		_skyboxShader = nullptr;
 		_skyboxMesh = nullptr;
 		_skyboxTexture = nullptr;
-		_objects.clear();
+		_ClearObjects();
 		_components.Clear();
+		// Anything still holding onto one of our objects keeps it alive past this point, so make sure
+		// those objects don't try to reach into our transform storage once it's gone
+		_transforms.EachOwner([](GameObject* object) {
+			object->_DetachFromScene();
+		});
 		_CleanupPhysics();
 		IsDestroyed = true;
 	}
 
+	void Scene::SetParallelUpdateEnabled(bool enabled) {
+		_parallelUpdate = enabled;
+	}
+
+	bool Scene::IsParallelUpdateEnabled() const {
+		return _parallelUpdate;
+	}
+
+	void Scene::SetPhysicsStepRate(float stepsPerSecond) {
+		LOG_ASSERT(stepsPerSecond > 0.0f, "Physics step rate must be greater than zero!");
+		_fixedTimeStep = 1.0f / stepsPerSecond;
+	}
+
+	float Scene::GetPhysicsStepRate() const {
+		return 1.0f / _fixedTimeStep;
+	}
+
+	void Scene::SetMaxPhysicsSubSteps(int maxSteps) {
+		_maxSubSteps = glm::max(maxSteps, 1);
+	}
+
+	int Scene::GetMaxPhysicsSubSteps() const {
+		return _maxSubSteps;
+	}
+
+	float Scene::GetPhysicsInterpolation() const {
+		return _physicsInterpolation;
+	}
+
+	void Scene::SetPhysicsThreading(PhysicsThreadingMode mode, int threadCount) {
+		threadCount = glm::max(threadCount, 0);
+		if (mode == _physicsThreading && threadCount == _physicsThreadCount) {
+			return;
+		}
+
+		// The solver pool is sized for the thread count when it's created, so the multithreaded modes need
+		// a new world when the count changes too
+		bool rebuild = mode != _physicsThreading || mode != PhysicsThreadingMode::Sequential;
+		_physicsThreading = mode;
+		_physicsThreadCount = threadCount;
+		if (rebuild) {
+			_RebuildPhysicsWorld();
+		}
+	}
+
+	PhysicsThreadingMode Scene::GetPhysicsThreadingMode() const {
+		return _physicsThreading;
+	}
+
+	int Scene::GetPhysicsThreadCount() const {
+		return _physicsThreadCount;
+	}
+
+	void Scene::UpdateTransforms() {
+		_transforms.Update();
+	}
+
+	uint32_t Scene::GetLastTransformUpdateCount() const {
+		return _transforms.GetLastUpdateCount();
+	}
+
 	void Scene::SetPhysicsDebugDrawMode(BulletDebugMode mode) {
 		_bulletDebugDraw->setDebugMode((btIDebugDraw::DebugDrawModes)mode);
 	}
@@ -96,10 +176,11 @@ namespace Gameplay {
 	GameObject::Sptr Scene::CreateGameObject(const std::string& name)
 	{
 		GameObject::Sptr result(new GameObject());
-		result->Name = name;
+		result->_name = name;
 		result->_scene = this;
+		result->_transformHandle = _transforms.Allocate(result.get());
 		result->_selfRef = result;
-		_objects.push_back(result);
+		_AddObject(result);
 		return result;
 	}
 
@@ -108,17 +189,15 @@ namespace Gameplay {
 	}
 
 	GameObject::Sptr Scene::FindObjectByName(const std::string name) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->Name == name;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		// Names can only change through SetName, which keeps the index current along with _AddObject and the
+		// delete queue, so a miss means no object has this name
+		auto it = _nameIndex.find(name);
+		return it == _nameIndex.end() ? nullptr : it->second.lock();
 	}
 
 	GameObject::Sptr Scene::FindObjectByGUID(Guid id) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->_guid == id;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto it = _guidIndex.find(id);
+		return it == _guidIndex.end() ? nullptr : it->second.lock();
 	}
 
 	void Scene::SetAmbientLight(const glm::vec3& value) {
@@ -154,21 +233,44 @@ namespace Gameplay {
 	}
 
 	void Scene::DoPhysics(float dt) {
-		_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+		_components.EachRaw<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
 			body->PhysicsPreStep(dt);
 		});
-		_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+		_components.EachRaw<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 			body->PhysicsPreStep(dt);
 		});
 
 		if (IsPlaying) {
+			// Bullet only has one task scheduler, so make sure it's using our thread count
+			if (_physicsThreading != PhysicsThreadingMode::Sequential) {
+				BulletTaskScheduler& scheduler = BulletTaskScheduler::Get();
+				scheduler.setNumThreads(_physicsThreadCount > 0 ? _physicsThreadCount : scheduler.getMaxNumThreads());
+			}
+
+			// Step the world at a fixed rate, so that the simulation behaves the same regardless of frame rate
+			_physicsAccumulator += dt;
+			int steps = 0;
+			while (_physicsAccumulator >= _fixedTimeStep && steps < _maxSubSteps) {
+				_components.EachRaw<Gameplay::Physics::RigidBody>([](Gameplay::Physics::RigidBody* body) {
+					body->PhysicsStoreState();
+				});
+				// We handle the substepping ourselves, so bullet should take exactly one step of the given size
+				_physicsWorld->stepSimulation(_fixedTimeStep, 0);
+				_physicsAccumulator -= _fixedTimeStep;
+				steps++;
+			}
 
-			_physicsWorld->stepSimulation(dt, 1);
+			// If we hit the step cap, drop the time we couldn't simulate, otherwise a slow frame will cause
+			// more steps next frame, which makes that frame slower, and so on
+			if (_physicsAccumulator >= _fixedTimeStep) {
+				_physicsAccumulator = glm::mod(_physicsAccumulator, _fixedTimeStep);
+			}
+			_physicsInterpolation = _physicsAccumulator / _fixedTimeStep;
 
-			_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+			_components.EachRaw<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
 				body->PhysicsPostStep(dt);
 			});
-			_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+			_components.EachRaw<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 				body->PhysicsPostStep(dt);
 			});
 		}
@@ -184,6 +286,11 @@ namespace Gameplay {
 	void Scene::Update(float dt) {
 		_FlushDeleteQueue();
 		if (IsPlaying) {
+			// Components that declared their updates as parallel safe go first, across all our worker
+			// threads. Everything else is updated in order on the main thread afterwards
+			if (_parallelUpdate) {
+				_components.UpdateParallel(dt, ThreadPool::Get());
+			}
 			for (int i = 0; i < _objects.size(); i++) {
 				_objects[i]->Update(dt);
 			}
@@ -210,13 +317,19 @@ namespace Gameplay {
 
 		Scene::Sptr result = std::make_shared<Scene>();
 		result->MainCamera = nullptr;
-		result->_objects.clear();
+		result->_ClearObjects();
 		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
 
 		if (data.contains("ambient")) {
 			result->SetAmbientLight((data["ambient"]));
 		}
 
+		// Needs to happen before any objects are loaded, so we aren't moving bodies between worlds
+		result->SetPhysicsThreading(
+			ParsePhysicsThreadingMode(JsonGet<std::string>(data, "physics_threading", ~PhysicsThreadingMode::Sequential), PhysicsThreadingMode::Sequential),
+			JsonGet(data, "physics_threads", 0)
+		);
+
 		if (data.contains("skybox") && data["skybox"].is_object()) {
 			nlohmann::json& blob = data["skybox"].get<nlohmann::json>();
 			result->_skyboxMesh = ResourceManager::Get<MeshResource>(Guid(blob["mesh"]));
@@ -232,7 +345,7 @@ namespace Gameplay {
 			obj->_scene = result.get();
 			obj->_parent.SceneContext = result.get();
 			obj->_selfRef = obj;
-			result->_objects.push_back(obj);
+			result->_AddObject(obj);
 		}
 
 		// Re-build the parent hierarchy 
@@ -256,6 +369,9 @@ namespace Gameplay {
 
 		blob["ambient"] = GetAmbientLight();
 
+		blob["physics_threading"] = ~_physicsThreading;
+		blob["physics_threads"] = _physicsThreadCount;
+
 		blob["skybox"] = nlohmann::json();
 		blob["skybox"]["mesh"] = _skyboxMesh ? _skyboxMesh->GetGUID().str() : "null";
 		blob["skybox"]["shader"] = _skyboxShader ? _skyboxShader->GetGUID().str() : "null";
@@ -302,18 +418,48 @@ namespace Gameplay {
 	}
 
 	void Scene::_InitPhysics() {
-		_collisionConfig = new btDefaultCollisionConfiguration();
-		_collisionDispatcher = new btCollisionDispatcher(_collisionConfig);
 		_broadphaseInterface = new btDbvtBroadphase();
 		_ghostCallback = new btGhostPairCallback();
 		_broadphaseInterface->getOverlappingPairCache()->setInternalGhostPairCallback(_ghostCallback);
-		_constraintSolver = new btSequentialImpulseConstraintSolver();
-		_physicsWorld = new btDiscreteDynamicsWorld(
-			_collisionDispatcher,
-			_broadphaseInterface,
-			_constraintSolver,
-			_collisionConfig
-		);
+
+		if (_physicsThreading == PhysicsThreadingMode::Sequential) {
+			_collisionConfig = new btDefaultCollisionConfiguration();
+			_collisionDispatcher = new btCollisionDispatcher(_collisionConfig);
+			_constraintSolver = new btSequentialImpulseConstraintSolver();
+			_solverPool = nullptr;
+			_physicsWorld = new btDiscreteDynamicsWorld(
+				_collisionDispatcher,
+				_broadphaseInterface,
+				_constraintSolver,
+				_collisionConfig
+			);
+		} else {
+			// The Mt classes grab the task scheduler when they're created, so it needs to be set first
+			BulletTaskScheduler& scheduler = BulletTaskScheduler::Get();
+			btSetTaskScheduler(&scheduler);
+			if (!scheduler.IsDispatching()) {
+				LOG_WARN("Bullet was not built with BT_THREADSAFE, multithreaded physics will run on a single thread");
+			}
+			int threadCount = _physicsThreadCount > 0 ? _physicsThreadCount : scheduler.getMaxNumThreads();
+
+			// Collision algorithms and manifolds are allocated from pools that can't grow while running
+			// on multiple threads, so we give them a lot more room than the defaults
+			btDefaultCollisionConstructionInfo constructionInfo;
+			constructionInfo.m_defaultMaxPersistentManifoldPoolSize = 80000;
+			constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+			_collisionConfig = new btDefaultCollisionConfiguration(constructionInfo);
+			_collisionDispatcher = new btCollisionDispatcherMt(_collisionConfig);
+			_solverPool = new btConstraintSolverPoolMt(threadCount);
+			_constraintSolver = _physicsThreading == PhysicsThreadingMode::IslandPoolMt ? new btSequentialImpulseConstraintSolverMt() : nullptr;
+			_physicsWorld = new btDiscreteDynamicsWorldMt(
+				_collisionDispatcher,
+				_broadphaseInterface,
+				_solverPool,
+				_constraintSolver,
+				_collisionConfig
+			);
+		}
+
 		_physicsWorld->setGravity(ToBt(_gravity));
 		// TODO bullet debug drawing
 		_bulletDebugDraw = new BulletDebugDraw();
@@ -321,27 +467,120 @@ namespace Gameplay {
 		_bulletDebugDraw->setDebugMode(btIDebugDraw::DBG_NoDebug);
 	}
 
+	void Scene::_RebuildPhysicsWorld() {
+		// Pull everything out of the old world, remembering the collision filters they were added with
+		struct CollisionObjectEntry {
+			btCollisionObject* Object;
+			int                Group;
+			int                Mask;
+		};
+		std::vector<CollisionObjectEntry> entries;
+		btCollisionObjectArray& objects = _physicsWorld->getCollisionObjectArray();
+		entries.reserve(objects.size());
+		while (objects.size() > 0) {
+			btCollisionObject* object = objects[objects.size() - 1];
+			btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+			entries.push_back({ object, proxy->m_collisionFilterGroup, proxy->m_collisionFilterMask });
+
+			btRigidBody* body = btRigidBody::upcast(object);
+			if (body != nullptr) {
+				_physicsWorld->removeRigidBody(body);
+			} else {
+				_physicsWorld->removeCollisionObject(object);
+			}
+		}
+
+		int debugMode = _bulletDebugDraw->getDebugMode();
+		_CleanupPhysics();
+		_InitPhysics();
+		_bulletDebugDraw->setDebugMode(debugMode);
+
+		// Add them back in the order they were originally added
+		for (auto it = entries.rbegin(); it != entries.rend(); it++) {
+			btRigidBody* body = btRigidBody::upcast(it->Object);
+			if (body != nullptr) {
+				_physicsWorld->addRigidBody(body, it->Group, it->Mask);
+			} else {
+				_physicsWorld->addCollisionObject(it->Object, it->Group, it->Mask);
+			}
+		}
+	}
+
 	void Scene::_CleanupPhysics() {
 		delete _physicsWorld;
 		delete _constraintSolver;
+		delete _solverPool;
 		delete _broadphaseInterface;
 		delete _ghostCallback;
 		delete _collisionDispatcher;
 		delete _collisionConfig;
+		delete _bulletDebugDraw;
 	}
 
 
 	void Scene::_FlushDeleteQueue() {
 		for (auto& weakPtr : _deletionQueue) {
 			if (weakPtr.expired()) continue;
-			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
+			GameObject::Sptr object = weakPtr.lock();
+			auto it = std::find(_objects.begin(), _objects.end(), object);
 			if (it != _objects.end()) {
 				_objects.erase(it);
+
+				// Only remove index entries that still point to this object
+				auto guidIt = _guidIndex.find(object->_guid);
+				if (guidIt != _guidIndex.end() && guidIt->second.lock() == object) {
+					_guidIndex.erase(guidIt);
+				}
+				auto nameIt = _nameIndex.find(object->_name);
+				if (nameIt != _nameIndex.end() && nameIt->second.lock() == object) {
+					_ReindexName(object->_name);
+				}
 			}
 		}
 		_deletionQueue.clear();
 	}
 
+	void Scene::_AddObject(const GameObject::Sptr& object) {
+		_objects.push_back(object);
+		_guidIndex[object->_guid] = object;
+		// Names aren't unique, and lookups return the first match, so don't replace existing entries
+		_nameIndex.emplace(object->_name, object);
+	}
+
+	void Scene::_OnObjectRenamed(const GameObject::Sptr& object, const std::string& oldName) {
+		if (object == nullptr) {
+			return;
+		}
+
+		// If we were the indexed object for our old name, another object may still be using it
+		auto oldIt = _nameIndex.find(oldName);
+		if (oldIt != _nameIndex.end() && oldIt->second.lock() == object) {
+			_ReindexName(oldName);
+		}
+
+		auto newIt = _nameIndex.find(object->_name);
+		if (newIt == _nameIndex.end() || newIt->second.expired()) {
+			_nameIndex[object->_name] = object;
+		}
+	}
+
+	void Scene::_ReindexName(const std::string& name) const {
+		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
+			return obj->_name == name;
+		});
+		if (it == _objects.end()) {
+			_nameIndex.erase(name);
+		} else {
+			_nameIndex[name] = *it;
+		}
+	}
+
+	void Scene::_ClearObjects() {
+		_objects.clear();
+		_guidIndex.clear();
+		_nameIndex.clear();
+	}
+
 	void Scene::DrawAllGameObjectGUIs()
 	{
 		for (auto& object : _objects) {
@@ -6,11 +6,13 @@
 #include "Gameplay/GameObject.h"
 
 #include "Physics/BulletDebugDraw.h"
+#include "Physics/BulletTaskScheduler.h"
 
 #include "Graphics/Buffers/UniformBuffer.h"
 #include "Graphics/Textures/Texture3D.h"
 
 struct GLFWwindow;
+class btConstraintSolverPoolMt;
 
 class TextureCube;
 class ShaderProgram;
@@ -52,6 +54,53 @@ namespace Gameplay {
 		void SetPhysicsDebugDrawMode(BulletDebugMode mode);
 		BulletDebugMode GetPhysicsDebugDrawMode() const;
 
+		/// <summary>
+		/// Sets whether components declared with MAKE_PARALLEL_UPDATE are updated across worker threads,
+		/// when disabled they are updated by their game objects like all other components
+		/// </summary>
+		void SetParallelUpdateEnabled(bool enabled);
+		bool IsParallelUpdateEnabled() const;
+
+		/// <summary>
+		/// Sets how many times per second the physics world is stepped. Physics always steps with
+		/// the same timestep, independent of the frame rate, and bodies are interpolated between
+		/// the last two physics states when rendering
+		/// </summary>
+		/// <param name="stepsPerSecond">The number of physics steps per second, ex: 60 or 120</param>
+		void SetPhysicsStepRate(float stepsPerSecond);
+		float GetPhysicsStepRate() const;
+		/// <summary>
+		/// Sets the maximum number of physics steps that can be taken in a single frame. If a frame
+		/// takes longer than this many steps, the extra time is dropped and physics will slow down
+		/// rather than falling further and further behind
+		/// </summary>
+		void SetMaxPhysicsSubSteps(int maxSteps);
+		int GetMaxPhysicsSubSteps() const;
+		/// <summary>
+		/// Gets how far we are between the last physics step and the next one, from 0 to 1
+		/// </summary>
+		float GetPhysicsInterpolation() const;
+
+		/// <summary>
+		/// Selects how the physics world is stepped. Changing the mode, or the thread count of a multithreaded
+		/// mode, rebuilds the physics world. All bodies in the scene are moved over to the new world
+		/// </summary>
+		/// <param name="mode">The threading mode for the physics world</param>
+		/// <param name="threadCount">The max number of threads to use when stepping, or 0 to use all available threads</param>
+		void SetPhysicsThreading(PhysicsThreadingMode mode, int threadCount = 0);
+		PhysicsThreadingMode GetPhysicsThreadingMode() const;
+		int GetPhysicsThreadCount() const;
+
+		/// <summary>
+		/// Recalculates the transforms of all objects that have moved since the last call, should be
+		/// called once per frame after all game logic and physics has been updated
+		/// </summary>
+		void UpdateTransforms();
+		/// <summary>
+		/// Gets the number of transforms that were recalculated by the last call to UpdateTransforms
+		/// </summary>
+		uint32_t GetLastTransformUpdateCount() const;
+
 		void SetSkyboxShader(const std::shared_ptr<ShaderProgram>& shader);
 		std::shared_ptr<ShaderProgram> GetSkyboxShader() const;
 
@@ -87,13 +136,16 @@ namespace Gameplay {
 		/// Searches all objects in the scene and returns the first
 		/// one who's name matches the one given, or nullptr if no object
 		/// is found
+		/// 
+		/// This is an O(1) lookup into the scene's name index, which is kept up to date as
+		/// objects are added, removed, or renamed via GameObject::SetName
 		/// </summary>
 		/// <param name="name">The name of the object to find</param>
 		GameObject::Sptr FindObjectByName(const std::string name) const;
 		/// <summary>
 		/// Searches all render objects in the scene and returns the first
 		/// one who's guid matches the one given, or nullptr if no object
-		/// is found
+		/// is found. This is an O(1) lookup into the scene's GUID index
 		/// </summary>
 		/// <param name="id">The guid of the object to find</param>
 		GameObject::Sptr FindObjectByGUID(Guid id) const;
@@ -193,6 +245,8 @@ namespace Gameplay {
 
 		// The component manager will store all components for objects in this scene
 		ComponentManager _components;
+		// Stores the transform matrices for all objects in this scene
+		TransformSystem  _transforms;
 
 		// Bullet physics stuff world
 		btDynamicsWorld*          _physicsWorld;
@@ -202,8 +256,11 @@ namespace Gameplay {
 		btCollisionDispatcher*    _collisionDispatcher;
 		// Provides rough broadphase (AABB) checks to improve performance
 		btBroadphaseInterface*    _broadphaseInterface;
-		// Resolves contraints (ex: hinge constraints, angle axis, etc...)
+		// Resolves contraints (ex: hinge constraints, angle axis, etc...), in multithreaded worlds
+		// this is only used for large islands, and may be null
 		btConstraintSolver*       _constraintSolver;
+		// Solves islands in parallel for multithreaded worlds, null otherwise
+		btConstraintSolverPoolMt* _solverPool;
 		// this is what allows us to get our pairs from the trigger volumes
 		btGhostPairCallback*      _ghostCallback;
 
@@ -215,9 +272,24 @@ namespace Gameplay {
 		// Our physics scene's global gravity, default matches earth's gravity (m/s^2)
 		glm::vec3 _gravity;
 
+		// The fixed timestep for physics, and how many steps we'll take per frame before giving up
+		float _fixedTimeStep;
+		int   _maxSubSteps;
+		// Time that has passed but has not been simulated yet
+		float _physicsAccumulator;
+		// How far we are between the previous and current physics state, 0-1
+		float _physicsInterpolation;
+		// How our physics world is stepped, and the max threads to use (0 for all)
+		PhysicsThreadingMode _physicsThreading;
+		int                  _physicsThreadCount;
+
 		// Stores all the objects in our scene
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
+		// Lookup tables for finding objects, kept up to date as objects are added, removed and renamed.
+		// The name index maps each name to one object using it, names aren't required to be unique
+		std::unordered_map<Guid, std::weak_ptr<GameObject>>                _guidIndex;
+		mutable std::unordered_map<std::string, std::weak_ptr<GameObject>> _nameIndex;
 
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
@@ -231,12 +303,35 @@ namespace Gameplay {
 		Texture3D::Sptr               _colorCorrection;
 
 		bool                       _isAwake;
+		bool                       _parallelUpdate;
+
+		/// <summary>
+		/// Adds an object to the end of the object list, and adds it to our lookup indices
+		/// </summary>
+		void _AddObject(const GameObject::Sptr& object);
+		/// <summary>
+		/// Removes all objects from the scene, and clears the lookup indices
+		/// </summary>
+		void _ClearObjects();
+		/// <summary>
+		/// Invoked by GameObject::SetName to move an object to it's new name in the lookup index
+		/// </summary>
+		void _OnObjectRenamed(const GameObject::Sptr& object, const std::string& oldName);
+		/// <summary>
+		/// Points the name index entry for the given name at an object still using it, or removes
+		/// the entry if none are. This is O(n), and only used when the indexed object goes away
+		/// </summary>
+		void _ReindexName(const std::string& name) const;
 
 		/// <summary>
 		/// Handles configuring our bullet physics stuff
 		/// </summary>
 		void _InitPhysics();
 		/// <summary>
+		/// Re-creates our physics world, moving all of the collision objects from the old world into the new one
+		/// </summary>
+		void _RebuildPhysicsWorld();
+		/// <summary>
 		/// Handles cleaning up bullet physics for this scene
 		/// </summary>
 		void _CleanupPhysics();
@@ -0,0 +1,301 @@
+#include "Gameplay/TransformSystem.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include "GLM/gtc/matrix_transform.hpp"
+#include "GLM/gtc/quaternion.hpp"
+
+#include "Gameplay/GameObject.h"
+#include "Utils/GlmDefines.h"
+#include "Logging.h"
+
+namespace Gameplay {
+	namespace {
+		/// <summary>
+		/// Re-orders the elements of an array so that element ix of the result is element order[ix] of the input
+		/// </summary>
+		template <typename T>
+		void Permute(std::vector<T>& data, const std::vector<uint32_t>& order) {
+			std::vector<T> result;
+			result.reserve(order.size());
+			for (uint32_t index : order) {
+				result.push_back(data[index]);
+			}
+			data.swap(result);
+		}
+	}
+
+	TransformSystem::TransformSystem() :
+		_local(std::vector<glm::mat4>()),
+		_inverseLocal(std::vector<glm::mat4>()),
+		_world(std::vector<glm::mat4>()),
+		_inverseWorld(std::vector<glm::mat4>()),
+		_normal(std::vector<glm::mat3>()),
+		_parent(std::vector<uint32_t>()),
+		_version(std::vector<uint32_t>()),
+		_parentVersion(std::vector<uint32_t>()),
+		_localDirty(std::vector<uint8_t>()),
+		_worldDirty(std::vector<uint8_t>()),
+		_owners(std::vector<GameObject*>()),
+		_indexToHandle(std::vector<Handle>()),
+		_handleToIndex(std::vector<uint32_t>()),
+		_freeHandles(std::vector<Handle>()),
+		_orderDirty(false),
+		_deadCount(0),
+		_lastUpdateCount(0)
+	{ }
+
+	TransformSystem::Handle TransformSystem::Allocate(GameObject* owner) {
+		Handle handle;
+		if (_freeHandles.size() > 0) {
+			handle = _freeHandles.back();
+			_freeHandles.pop_back();
+		} else {
+			handle = static_cast<Handle>(_handleToIndex.size());
+			_handleToIndex.push_back(0);
+		}
+
+		// New transforms don't have a parent, so they can always go at the end
+		uint32_t index = static_cast<uint32_t>(_owners.size());
+		_handleToIndex[handle] = index;
+
+		_local.push_back(MAT4_IDENTITY);
+		_inverseLocal.push_back(MAT4_IDENTITY);
+		_world.push_back(MAT4_IDENTITY);
+		_inverseWorld.push_back(MAT4_IDENTITY);
+		_normal.push_back(MAT3_IDENTITY);
+		_parent.push_back(NO_PARENT);
+		_version.push_back(0);
+		_parentVersion.push_back(0);
+		_localDirty.push_back(1);
+		_worldDirty.push_back(1);
+		_owners.push_back(owner);
+		_indexToHandle.push_back(handle);
+
+		return handle;
+	}
+
+	void TransformSystem::Free(Handle handle) {
+		uint32_t index = _handleToIndex[handle];
+
+		// We leave the slot in place so that we don't break the ordering, it will be removed the
+		// next time the order is rebuilt. Children will notice that their parent is gone when updated
+		_owners[index] = nullptr;
+		_parent[index] = NO_PARENT;
+		_handleToIndex[handle] = NO_PARENT;
+		_freeHandles.push_back(handle);
+		_deadCount++;
+
+		// Don't let dead transforms build up forever
+		if (_deadCount > 64 && _deadCount * 4 > _owners.size()) {
+			_orderDirty = true;
+		}
+	}
+
+	void TransformSystem::SetParent(Handle child, Handle parent) {
+		uint32_t childIndex = _handleToIndex[child];
+		uint32_t parentIndex = parent == INVALID_HANDLE ? NO_PARENT : _handleToIndex[parent];
+
+		_parent[childIndex] = parentIndex;
+		_worldDirty[childIndex] = 1;
+
+		// Our single pass update relies on parents being before their children, so if that's no longer
+		// true, we need to re-sort before the next update. Any children of the child will still come after it
+		if (parentIndex != NO_PARENT && parentIndex > childIndex) {
+			_orderDirty = true;
+		}
+	}
+
+	void TransformSystem::MarkLocalDirty(Handle handle) {
+		_localDirty[_handleToIndex[handle]] = 1;
+	}
+
+	void TransformSystem::Update() {
+		if (_orderDirty) {
+			_RebuildOrder();
+		}
+
+		_lastUpdateCount = 0;
+		const uint32_t count = static_cast<uint32_t>(_owners.size());
+		for (uint32_t ix = 0; ix < count; ix++) {
+			if (_owners[ix] != nullptr && _NeedsUpdate(ix)) {
+				_RecalcWorld(ix);
+				_lastUpdateCount++;
+			}
+		}
+	}
+
+	glm::mat4 TransformSystem::GetLocal(Handle handle) {
+		uint32_t index = _handleToIndex[handle];
+		if (_localDirty[index]) {
+			_RecalcLocal(index);
+		}
+		return _local[index];
+	}
+
+	glm::mat4 TransformSystem::GetInverseLocal(Handle handle) {
+		uint32_t index = _handleToIndex[handle];
+		if (_localDirty[index]) {
+			_RecalcLocal(index);
+		}
+		return _inverseLocal[index];
+	}
+
+	glm::mat4 TransformSystem::GetWorld(Handle handle) {
+		uint32_t index = _handleToIndex[handle];
+		_EnsureUpdated(index);
+		return _world[index];
+	}
+
+	glm::mat4 TransformSystem::GetInverseWorld(Handle handle) {
+		uint32_t index = _handleToIndex[handle];
+		_EnsureUpdated(index);
+		return _inverseWorld[index];
+	}
+
+	glm::mat3 TransformSystem::GetNormalMatrix(Handle handle) {
+		uint32_t index = _handleToIndex[handle];
+		_EnsureUpdated(index);
+		return _normal[index];
+	}
+
+	void TransformSystem::EachOwner(const std::function<void(GameObject*)>& callback) const {
+		for (GameObject* owner : _owners) {
+			if (owner != nullptr) {
+				callback(owner);
+			}
+		}
+	}
+
+	void TransformSystem::_RebuildOrder() {
+		const uint32_t count = static_cast<uint32_t>(_owners.size());
+
+		// Build a flattened list of children for each transform, so we can walk the hierarchy
+		std::vector<uint32_t> childStart(count + 1, 0);
+		for (uint32_t ix = 0; ix < count; ix++) {
+			uint32_t parent = _parent[ix];
+			if (_owners[ix] != nullptr && parent != NO_PARENT && _owners[parent] != nullptr) {
+				childStart[parent + 1]++;
+			}
+		}
+		for (uint32_t ix = 0; ix < count; ix++) {
+			childStart[ix + 1] += childStart[ix];
+		}
+		std::vector<uint32_t> children(childStart[count]);
+		std::vector<uint32_t> writeHead(childStart.begin(), childStart.end() - 1);
+		for (uint32_t ix = 0; ix < count; ix++) {
+			uint32_t parent = _parent[ix];
+			if (_owners[ix] != nullptr && parent != NO_PARENT && _owners[parent] != nullptr) {
+				children[writeHead[parent]++] = ix;
+			}
+		}
+
+		// Walk each tree depth first, so that all transforms in a subtree end up next to each other
+		std::vector<uint32_t> order;
+		order.reserve(count - _deadCount);
+		std::vector<uint32_t> stack;
+		for (uint32_t ix = 0; ix < count; ix++) {
+			uint32_t parent = _parent[ix];
+			bool isRoot = parent == NO_PARENT || _owners[parent] == nullptr;
+			if (_owners[ix] == nullptr || !isRoot) continue;
+
+			stack.push_back(ix);
+			while (stack.size() > 0) {
+				uint32_t current = stack.back();
+				stack.pop_back();
+				order.push_back(current);
+				// Push in reverse so that children are visited in the order they were added
+				for (uint32_t child = childStart[current + 1]; child > childStart[current]; child--) {
+					stack.push_back(children[child - 1]);
+				}
+			}
+		}
+
+		// Any transform that we didn't reach is part of a cycle, which shouldn't be possible
+		LOG_ASSERT(order.size() == count - _deadCount, "Transform hierarchy contains a cycle!");
+
+		// Parent indices need to be remapped to the new order, children of freed transforms become roots
+		std::vector<uint32_t> newIndex(count, NO_PARENT);
+		for (uint32_t ix = 0; ix < order.size(); ix++) {
+			newIndex[order[ix]] = ix;
+		}
+		for (uint32_t ix = 0; ix < count; ix++) {
+			uint32_t parent = _parent[ix];
+			if (parent != NO_PARENT && _owners[parent] == nullptr) {
+				_worldDirty[ix] = 1;
+			}
+			_parent[ix] = parent == NO_PARENT ? NO_PARENT : newIndex[parent];
+		}
+
+		Permute(_local, order);
+		Permute(_inverseLocal, order);
+		Permute(_world, order);
+		Permute(_inverseWorld, order);
+		Permute(_normal, order);
+		Permute(_parent, order);
+		Permute(_version, order);
+		Permute(_parentVersion, order);
+		Permute(_localDirty, order);
+		Permute(_worldDirty, order);
+		Permute(_owners, order);
+		Permute(_indexToHandle, order);
+
+		for (uint32_t ix = 0; ix < order.size(); ix++) {
+			_handleToIndex[_indexToHandle[ix]] = ix;
+		}
+
+		_deadCount = 0;
+		_orderDirty = false;
+	}
+
+	bool TransformSystem::_NeedsUpdate(uint32_t index) {
+		uint32_t parent = _parent[index];
+
+		// If our parent has been freed, we become a root
+		if (parent != NO_PARENT && _owners[parent] == nullptr) {
+			_parent[index] = NO_PARENT;
+			return true;
+		}
+
+		return _localDirty[index] || _worldDirty[index] || (parent != NO_PARENT && _parentVersion[index] != _version[parent]);
+	}
+
+	void TransformSystem::_EnsureUpdated(uint32_t index) {
+		uint32_t parent = _parent[index];
+		if (parent != NO_PARENT && _owners[parent] != nullptr) {
+			_EnsureUpdated(parent);
+		}
+		if (_NeedsUpdate(index)) {
+			_RecalcWorld(index);
+		}
+	}
+
+	void TransformSystem::_RecalcLocal(uint32_t index) {
+		const GameObject* owner = _owners[index];
+		_local[index] = glm::translate(MAT4_IDENTITY, owner->GetPosition()) * glm::mat4_cast(owner->GetRotation()) * glm::scale(MAT4_IDENTITY, owner->GetScale());
+		_inverseLocal[index] = glm::inverse(_local[index]);
+		_localDirty[index] = 0;
+		// The world transform is no longer up to date with our local transform
+		_worldDirty[index] = 1;
+	}
+
+	void TransformSystem::_RecalcWorld(uint32_t index) {
+		if (_localDirty[index]) {
+			_RecalcLocal(index);
+		}
+
+		uint32_t parent = _parent[index];
+		if (parent != NO_PARENT) {
+			_world[index] = _world[parent] * _local[index];
+			_inverseWorld[index] = glm::inverse(_world[index]);
+			_parentVersion[index] = _version[parent];
+		} else {
+			_world[index] = _local[index];
+			_inverseWorld[index] = _inverseLocal[index];
+		}
+
+		// The inverse transpose of the upper 3x3 is the transpose of the upper 3x3 of the inverse
+		_normal[index] = glm::transpose(glm::mat3(_inverseWorld[index]));
+		_worldDirty[index] = 0;
+		_version[index]++;
+	}
+}
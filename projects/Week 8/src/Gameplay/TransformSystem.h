@@ -0,0 +1,139 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <GLM/glm.hpp>
+
+#include "Utils/Macros.h"
+
+namespace Gameplay {
+	class GameObject;
+
+	/// <summary>
+	/// Stores the transform matrices for all game objects in a scene in contiguous arrays,
+	/// sorted so that parents always come before their children
+	///
+	/// Game objects still own their position, rotation and scale, and mark their transform as
+	/// dirty when they change. Once per frame, Update walks the arrays in order and recalculates
+	/// every transform that is dirty or whose parent changed, so deep hierarchies are updated
+	/// in a single pass without any recursion or pointer chasing
+	///
+	/// Transforms can also be queried between updates, in which case only the chain of parents
+	/// above the transform is brought up to date
+	/// </summary>
+	class TransformSystem {
+	public:
+		NO_COPY(TransformSystem);
+		NO_MOVE(TransformSystem);
+
+		typedef uint32_t Handle;
+		inline static const Handle INVALID_HANDLE = ~0u;
+
+		TransformSystem();
+		~TransformSystem() = default;
+
+		/// <summary>
+		/// Allocates a new transform for the given game object, with no parent
+		/// </summary>
+		/// <param name="owner">The game object to read position, rotation and scale from</param>
+		/// <returns>A handle to the transform, which stays valid until it is freed</returns>
+		Handle Allocate(GameObject* owner);
+		/// <summary>
+		/// Releases a transform, any children of the transform will become roots
+		/// </summary>
+		void Free(Handle handle);
+
+		/// <summary>
+		/// Sets the parent of a transform
+		/// </summary>
+		/// <param name="child">The transform to re-parent</param>
+		/// <param name="parent">The new parent, or INVALID_HANDLE to make the transform a root</param>
+		void SetParent(Handle child, Handle parent);
+
+		/// <summary>
+		/// Marks that the owner's position, rotation or scale has changed. This only touches the given
+		/// transform, so it is safe to call for different transforms from multiple threads
+		/// </summary>
+		void MarkLocalDirty(Handle handle);
+
+		/// <summary>
+		/// Brings all transforms up to date in a single pass
+		/// </summary>
+		void Update();
+
+		// Matrices are returned by value, since the arrays move around whenever a transform is allocated
+		// or the order is rebuilt
+
+		glm::mat4 GetLocal(Handle handle);
+		glm::mat4 GetInverseLocal(Handle handle);
+		glm::mat4 GetWorld(Handle handle);
+		glm::mat4 GetInverseWorld(Handle handle);
+		/// <summary>
+		/// Gets the matrix for transforming normals into world space (the inverse transpose of the world
+		/// transform), this is cached so that renderers don't need to invert the world matrix per draw
+		/// </summary>
+		glm::mat3 GetNormalMatrix(Handle handle);
+
+		/// <summary>
+		/// Invokes a callback for the owner of every transform that hasn't been freed
+		/// </summary>
+		void EachOwner(const std::function<void(GameObject*)>& callback) const;
+
+		/// <summary>
+		/// Gets the number of live transforms in the system
+		/// </summary>
+		uint32_t Size() const { return static_cast<uint32_t>(_owners.size()) - _deadCount; }
+		/// <summary>
+		/// Gets the number of transforms that were recalculated in the last call to Update
+		/// </summary>
+		uint32_t GetLastUpdateCount() const { return _lastUpdateCount; }
+
+	protected:
+		inline static const uint32_t NO_PARENT = ~0u;
+
+		// All of the arrays below are indexed by position in the sorted order, handles map into them
+		std::vector<glm::mat4>   _local;
+		std::vector<glm::mat4>   _inverseLocal;
+		std::vector<glm::mat4>   _world;
+		std::vector<glm::mat4>   _inverseWorld;
+		std::vector<glm::mat3>   _normal;
+		// Index of the parent transform, always less than the transform's index unless the order is dirty
+		std::vector<uint32_t>    _parent;
+		// Incremented whenever a world transform is recalculated
+		std::vector<uint32_t>    _version;
+		// The version of the parent's world transform that our world transform was calculated from
+		std::vector<uint32_t>    _parentVersion;
+		std::vector<uint8_t>     _localDirty;
+		std::vector<uint8_t>     _worldDirty;
+		// The game object for each transform, or nullptr if the transform has been freed
+		std::vector<GameObject*> _owners;
+		std::vector<Handle>      _indexToHandle;
+
+		std::vector<uint32_t>    _handleToIndex;
+		std::vector<Handle>      _freeHandles;
+
+		// True when a transform has been parented to something after it in the arrays
+		bool     _orderDirty;
+		// The number of freed transforms that are still in the arrays
+		uint32_t _deadCount;
+		uint32_t _lastUpdateCount;
+
+		/// <summary>
+		/// Sorts the arrays so that all children come after their parents (in depth first order),
+		/// and removes any freed transforms
+		/// </summary>
+		void _RebuildOrder();
+
+		/// <summary>
+		/// Returns true if the world transform at the given index needs to be recalculated, assuming
+		/// that it's parent is up to date
+		/// </summary>
+		bool _NeedsUpdate(uint32_t index);
+		/// <summary>
+		/// Brings the transform at the given index up to date, along with any of it's parents
+		/// </summary>
+		void _EnsureUpdated(uint32_t index);
+		void _RecalcLocal(uint32_t index);
+		void _RecalcWorld(uint32_t index);
+	};
+}
@@ -0,0 +1,63 @@
+#include "Graphics/BoundingVolumeHierarchy.h"
+#include <BulletCollision/BroadphaseCollision/btDbvt.h>
+
+// Converts one of our bounding boxes to a volume that Bullet can use
+inline btDbvtVolume ToVolume(const AABB& bounds) {
+	return btDbvtVolume::FromMM(
+		btVector3(bounds.Min.x, bounds.Min.y, bounds.Min.z),
+		btVector3(bounds.Max.x, bounds.Max.y, bounds.Max.z)
+	);
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(float margin) :
+	_tree(std::make_unique<btDbvt>()),
+	_margin(margin)
+{ }
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() = default;
+
+BoundingVolumeHierarchy::Handle BoundingVolumeHierarchy::Insert(const AABB& bounds, void* userData) {
+	// Insert with the margin already applied, so small movements won't need to touch the tree
+	btDbvtVolume volume = ToVolume(bounds);
+	volume.Expand(btVector3(_margin, _margin, _margin));
+	return _tree->insert(volume, userData);
+}
+
+void BoundingVolumeHierarchy::Update(Handle leaf, const AABB& bounds) {
+	// Bullet will only re-insert the leaf if the new volume is not inside the old one
+	btDbvtVolume volume = ToVolume(bounds);
+	_tree->update(leaf, volume, _margin);
+}
+
+void BoundingVolumeHierarchy::Remove(Handle leaf) {
+	_tree->remove(leaf);
+}
+
+void BoundingVolumeHierarchy::Clear() {
+	_tree->clear();
+}
+
+int BoundingVolumeHierarchy::GetLeafCount() const {
+	return _tree->m_leaves;
+}
+
+void BoundingVolumeHierarchy::Query(const Frustum& frustum, std::vector<void*>& results) const {
+	// Collects the user data from every leaf that the tree finds
+	struct Collector : btDbvt::ICollide {
+		std::vector<void*>& Results;
+		Collector(std::vector<void*>& results) : Results(results) { }
+		void Process(const btDbvtNode* leaf) { Results.push_back(leaf->data); }
+	};
+
+	// Bullet treats planes as inside when dot(normal, point) + offset >= 0, which matches our frustum planes
+	btVector3 normals[Frustum::PLANE_COUNT];
+	btScalar  offsets[Frustum::PLANE_COUNT];
+	for (int ix = 0; ix < Frustum::PLANE_COUNT; ix++) {
+		const glm::vec4& plane = frustum.GetPlane(ix);
+		normals[ix] = btVector3(plane.x, plane.y, plane.z);
+		offsets[ix] = plane.w;
+	}
+
+	Collector collector(results);
+	btDbvt::collideKDOP(_tree->m_root, normals, offsets, Frustum::PLANE_COUNT, collector);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Utils/AABB.h"
+#include "Utils/Macros.h"
+#include "Graphics/Frustum.h"
+
+// Bullet dynamic tree pre-declarations
+struct btDbvt;
+struct btDbvtNode;
+
+/// <summary>
+/// A dynamic bounding volume hierarchy that we can use to quickly find which objects are visible
+/// to a camera. This wraps around Bullet's btDbvt (the same tree that the physics broadphase uses),
+/// which supports cheap updates for moving objects and frustum queries
+///
+/// Each object is stored as a leaf with a user data pointer, which is returned from queries
+/// </summary>
+class BoundingVolumeHierarchy {
+public:
+	NO_COPY(BoundingVolumeHierarchy);
+	NO_MOVE(BoundingVolumeHierarchy);
+
+	// Handle to a leaf in the tree, returned from Insert
+	typedef btDbvtNode* Handle;
+
+	/// <summary>
+	/// Creates a new empty tree
+	/// </summary>
+	/// <param name="margin">
+	/// How much to fatten each leaf's bounds by, objects that move less than this will not need to
+	/// be re-inserted into the tree
+	/// </param>
+	BoundingVolumeHierarchy(float margin = 0.1f);
+	~BoundingVolumeHierarchy();
+
+	/// <summary>
+	/// Adds a new leaf to the tree
+	/// </summary>
+	/// <param name="bounds">The world space bounds of the object</param>
+	/// <param name="userData">The pointer that will be returned by queries that find this leaf</param>
+	/// <returns>A handle to the leaf, used for updating and removing it</returns>
+	Handle Insert(const AABB& bounds, void* userData);
+	/// <summary>
+	/// Updates the bounds of a leaf in the tree, the leaf will only be moved if the
+	/// bounds have left the leaf's fattened volume
+	/// </summary>
+	/// <param name="leaf">The leaf to update</param>
+	/// <param name="bounds">The new world space bounds of the object</param>
+	void Update(Handle leaf, const AABB& bounds);
+	/// <summary>
+	/// Removes a leaf from the tree, the handle will be invalid after this call
+	/// </summary>
+	void Remove(Handle leaf);
+	/// <summary>
+	/// Removes all leaves from the tree
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Gets the number of leaves in the tree
+	/// </summary>
+	int GetLeafCount() const;
+
+	/// <summary>
+	/// Finds all leaves whose bounds intersect the given frustum
+	/// </summary>
+	/// <param name="frustum">The frustum to test against</param>
+	/// <param name="results">The vector to append the user data of all visible leaves to</param>
+	void Query(const Frustum& frustum, std::vector<void*>& results) const;
+
+protected:
+	std::unique_ptr<btDbvt> _tree;
+	float                   _margin;
+};
@@ -5,7 +5,8 @@ IBuffer::IBuffer(BufferType type, BufferUsage usage) :
 	IGraphicsResource(),
 	_elementCount(0),
 	_elementSize(0),
-	_size(0)
+	_size(0),
+	_isImmutable(false)
 {
 	_type = type;
 	_usage = usage;
@@ -24,6 +25,10 @@ IBuffer::~IBuffer() {
 }
 
 void IBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	if (_isImmutable) {
+		_RecreateBuffer();
+	}
+
 	// Note, this is part of the bindless state access stuff added in 4.5
 	glNamedBufferData(_rendererId, (GLsizeiptr)elementSize * elementCount, data, (GLenum)_usage);
 
@@ -32,8 +37,32 @@ void IBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementC
 	_size = elementCount * elementSize;
 }
 
+void IBuffer::LoadStorage(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	// Immutable storage can't be re-specified, so we need a new buffer if we already have one
+	if (_size > 0 || _isImmutable) {
+		_RecreateBuffer();
+	}
+
+	// No flags, the data is only ever touched by the GPU from now on
+	glNamedBufferStorage(_rendererId, (GLsizeiptr)elementSize * elementCount, data, 0);
+
+	_elementCount = elementCount;
+	_elementSize = elementSize;
+	_size = elementCount * elementSize;
+	_isImmutable = true;
+}
+
+void IBuffer::_RecreateBuffer() {
+	glDeleteBuffers(1, &_rendererId);
+	glCreateBuffers(1, &_rendererId);
+	_isImmutable = false;
+	_size = 0;
+}
+
 void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize /*= true*/)
 {
+	LOG_ASSERT(!_isImmutable, "Cannot update a buffer with immutable storage, use LoadData or LoadStorage instead");
+
 	if (elementSize * elementCount > _size) {
 		if (allowResize) {
 			glNamedBufferData(_rendererId, (GLsizeiptr)elementSize * elementCount, data, (GLenum)_usage);
@@ -43,6 +43,23 @@ public:
 	/// <param name="elementCount">The number of elements to upload</param>
 	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount);
 
+	/// <summary>
+	/// Loads data into this buffer as immutable storage with glNamedBufferStorage. The data can be read
+	/// straight out of a memory mapped file, since GL copies it before returning
+	/// 
+	/// The buffer can't be resized or updated afterwards, loading new data will create a new OpenGL buffer,
+	/// so any VAOs using this buffer would need to be rebuilt
+	/// </summary>
+	/// <param name="data">The data that you want to load into the buffer</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	virtual void LoadStorage(const void* data, uint32_t elementSize, uint32_t elementCount);
+
+	/// <summary>
+	/// Returns true if this buffer was created with immutable storage
+	/// </summary>
+	bool IsImmutable() const { return _isImmutable; }
+
 	/// <summary>
 	/// Updates data within the buffer, optionally resizing the buffer
 	/// </summary>
@@ -134,4 +151,10 @@ protected:
 	uint32_t _size; // The size of the buffer in bytes
 	BufferUsage _usage; // The buffer usage mode (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
 	BufferType _type; // The buffer type (ex GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER)
+	bool _isImmutable; // True if the buffer's storage was allocated with glNamedBufferStorage
+
+	/// <summary>
+	/// Replaces our OpenGL buffer with a new one, needed to re-specify immutable storage
+	/// </summary>
+	void _RecreateBuffer();
 };
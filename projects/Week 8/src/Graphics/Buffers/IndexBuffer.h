@@ -43,6 +43,18 @@ public:
 		_elementType = elementType;
 	}
 
+	/// <summary>
+	/// Loads some data into our index buffer as immutable storage, see IBuffer::LoadStorage
+	/// </summary>
+	/// <param name="data">The pointer to the data to load in</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	/// <param name="elementType">The type of elements you are storing (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT)</param>
+	inline void LoadStorage(const void* data, uint32_t elementSize, uint32_t elementCount, IndexType elementType) {
+		IBuffer::LoadStorage(data, elementSize, elementCount);
+		_elementType = elementType;
+	}
+
 	/// <summary>
 	/// Loads data of a known type into this index buffer
 	/// </summary>
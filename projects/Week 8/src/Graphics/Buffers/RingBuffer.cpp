@@ -0,0 +1,144 @@
+#include "RingBuffer.h"
+#include "Logging.h"
+
+RingBuffer::RingBuffer(BufferType type, uint32_t frameSize) :
+	IBuffer(type, BufferUsage::StreamDraw),
+	_mappedData(nullptr),
+	_frameSize(0),
+	_alignment(16),
+	_frameIndex(0),
+	_head(0),
+	_overflowed(false),
+	_fences()
+{
+	// Uniform buffers have a driver defined alignment for offsets that we need to respect
+	if (type == BufferType::Uniform) {
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		_alignment = alignment > 0 ? static_cast<uint32_t>(alignment) : _alignment;
+	} else if (type == BufferType::ShaderStorage) {
+		GLint alignment = 0;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		_alignment = alignment > 0 ? static_cast<uint32_t>(alignment) : _alignment;
+	}
+
+	_CreateStorage(frameSize);
+}
+
+RingBuffer::~RingBuffer() {
+	for (uint32_t ix = 0; ix < FRAME_COUNT; ix++) {
+		if (_fences[ix] != nullptr) {
+			glDeleteSync(_fences[ix]);
+			_fences[ix] = nullptr;
+		}
+	}
+	if (_mappedData != nullptr) {
+		glUnmapNamedBuffer(_rendererId);
+		_mappedData = nullptr;
+	}
+}
+
+void RingBuffer::BeginFrame() {
+	// If we ran out of space last frame, double the size of our frames. Since the storage is immutable
+	// we need to make sure the GPU is done with all of it before replacing it
+	if (_overflowed) {
+		for (uint32_t ix = 0; ix < FRAME_COUNT; ix++) {
+			_WaitForFrame(ix);
+		}
+		LOG_INFO("Expanding ring buffer frames from {} bytes to {} bytes", _frameSize, _frameSize * 2);
+		_CreateStorage(_frameSize * 2);
+		_overflowed = false;
+	}
+
+	// Make sure the GPU is done reading from the region we're about to overwrite
+	_WaitForFrame(_frameIndex);
+	_head = 0;
+}
+
+void RingBuffer::EndFrame() {
+	// Place a fence after all the commands that read from this frame, then move on to the next region
+	if (_fences[_frameIndex] != nullptr) {
+		glDeleteSync(_fences[_frameIndex]);
+	}
+	_fences[_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_frameIndex = (_frameIndex + 1) % FRAME_COUNT;
+}
+
+RingBuffer::Allocation RingBuffer::Allocate(uint32_t size, uint32_t alignment) {
+	alignment = alignment == 0 ? _alignment : alignment;
+
+	// Round the head up to the next multiple of the alignment
+	uint32_t offset = ((_head + alignment - 1) / alignment) * alignment;
+
+	Allocation result;
+	if (offset + size > _frameSize) {
+		_overflowed = true;
+		return result;
+	}
+
+	_head = offset + size;
+
+	result.Offset = _frameIndex * _frameSize + offset;
+	result.Size   = size;
+	result.Data   = _mappedData + result.Offset;
+	return result;
+}
+
+void RingBuffer::BindRange(const Allocation& allocation, uint32_t slot) const {
+	glBindBufferRange((GLenum)_type, slot, _rendererId, allocation.Offset, allocation.Size);
+}
+
+void RingBuffer::LoadData(const void*, uint32_t, uint32_t) {
+	LOG_ASSERT(false, "Ring buffers do not support LoadData, use Allocate instead");
+}
+
+void RingBuffer::UpdateData(const void*, uint32_t, uint32_t, bool) {
+	LOG_ASSERT(false, "Ring buffers do not support UpdateData, use Allocate instead");
+}
+
+void RingBuffer::_CreateStorage(uint32_t frameSize) {
+	// Immutable storage can't be re-specified, so we need a new buffer if we already have one
+	if (_mappedData != nullptr) {
+		glUnmapNamedBuffer(_rendererId);
+		glDeleteBuffers(1, &_rendererId);
+		glCreateBuffers(1, &_rendererId);
+		_mappedData = nullptr;
+	}
+
+	// Keep each frame's region aligned, so that the first allocation in every frame is aligned too
+	_frameSize = ((frameSize + _alignment - 1) / _alignment) * _alignment;
+	_elementSize = 1;
+	_elementCount = _frameSize * FRAME_COUNT;
+	_size = _frameSize * FRAME_COUNT;
+
+	// Persistent and coherent mapping means we can write to the pointer at any time, and the GPU will
+	// see the results without us needing to flush or unmap
+	BufferMapMode flags = BufferMapMode::Write | BufferMapMode::Persistent | BufferMapMode::Coherent;
+	glNamedBufferStorage(_rendererId, _size, nullptr, *flags);
+	_mappedData = reinterpret_cast<uint8_t*>(glMapNamedBufferRange(_rendererId, 0, _size, *flags));
+	LOG_ASSERT(_mappedData != nullptr, "Failed to map ring buffer!");
+}
+
+void RingBuffer::_WaitForFrame(uint32_t frameIndex) {
+	GLsync& fence = _fences[frameIndex];
+	if (fence == nullptr) {
+		return;
+	}
+
+	// Wait in 1ms chunks, flushing on the first wait so that the fence is guaranteed to be signalled eventually
+	GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true) {
+		GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+			break;
+		}
+		if (result == GL_WAIT_FAILED) {
+			LOG_ERROR("Failed to wait on ring buffer fence");
+			break;
+		}
+		waitFlags = 0;
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "IBuffer.h"
+#include <memory>
+
+/// <summary>
+/// A ring buffer is a persistently mapped buffer that is split into a number of frames,
+/// and is used for data that only needs to live for a single frame (ex: per object uniforms)
+///
+/// Each frame, data is allocated linearly from the current frame's region and written directly
+/// into mapped memory. A fence is placed at the end of each frame, and we only wait on that
+/// fence when the region comes back around, so the CPU can keep writing while the GPU is still
+/// reading the previous frames
+///
+/// Systems that want transient data should own a ring buffer, call BeginFrame before allocating,
+/// and call EndFrame once all draws that use the frame's allocations have been issued
+/// </summary>
+/// <see>https://www.khronos.org/opengl/wiki/Buffer_Object_Streaming#Persistent_mapping</see>
+class RingBuffer : public IBuffer {
+public:
+	typedef std::shared_ptr<RingBuffer> Sptr;
+
+	/// <summary>
+	/// The number of frames that the buffer is split into, we use 3 so that the CPU can be
+	/// writing one frame while the GPU still has up to 2 frames queued
+	/// </summary>
+	static const uint32_t FRAME_COUNT = 3;
+
+	/// <summary>
+	/// Represents a block of memory that has been allocated from the ring buffer
+	/// </summary>
+	struct Allocation {
+		// Pointer to the mapped memory that the data should be written to
+		void*    Data   = nullptr;
+		// The offset in bytes from the start of the buffer
+		uint32_t Offset = 0;
+		// The size of the allocation in bytes
+		uint32_t Size   = 0;
+
+		/// <summary>
+		/// Returns true if the allocation succeeded
+		/// </summary>
+		bool IsValid() const { return Data != nullptr; }
+
+		/// <summary>
+		/// Gets the allocated memory as a pointer to the given type
+		/// </summary>
+		template <typename T>
+		T* As() const { return reinterpret_cast<T*>(Data); }
+	};
+
+	static inline Sptr Create(BufferType type, uint32_t frameSize) {
+		return std::make_shared<RingBuffer>(type, frameSize);
+	}
+
+	/// <summary>
+	/// Creates a new ring buffer with the given type and frame size
+	/// </summary>
+	/// <param name="type">The type of buffer, this determines the alignment of allocations and what BindRange binds to</param>
+	/// <param name="frameSize">The number of bytes available to each frame, will grow if a frame runs out of space</param>
+	RingBuffer(BufferType type, uint32_t frameSize);
+	virtual ~RingBuffer();
+
+	/// <summary>
+	/// Starts a new frame, waiting for the GPU to finish with the region we are about to
+	/// write to if needed
+	/// </summary>
+	void BeginFrame();
+	/// <summary>
+	/// Ends the current frame, placing a fence so we know when the GPU is done with it
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Allocates a block of memory from the current frame. If the frame is out of space, an invalid
+	/// allocation is returned, and the buffer will be grown on the next call to BeginFrame
+	/// </summary>
+	/// <param name="size">The size of the allocation in bytes</param>
+	/// <param name="alignment">The alignment of the allocation in bytes, or 0 to use the buffer type's alignment</param>
+	/// <returns>The allocation, check IsValid before using</returns>
+	Allocation Allocate(uint32_t size, uint32_t alignment = 0);
+
+	/// <summary>
+	/// Allocates space for a value from the current frame and copies it into the buffer
+	/// </summary>
+	/// <typeparam name="T">The type of data to write</typeparam>
+	/// <param name="value">The value to copy into the buffer</param>
+	/// <returns>The allocation, check IsValid before using</returns>
+	template <typename T>
+	Allocation Write(const T& value) {
+		Allocation result = Allocate(sizeof(T));
+		if (result.IsValid()) {
+			*result.As<T>() = value;
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Binds an allocation to an indexed binding slot for the buffer type (ex: a uniform block binding),
+	/// using glBindBufferRange
+	/// </summary>
+	/// <param name="allocation">The allocation to bind</param>
+	/// <param name="slot">The binding slot to bind to</param>
+	void BindRange(const Allocation& allocation, uint32_t slot) const;
+
+	/// <summary>
+	/// Gets the number of bytes available to each frame
+	/// </summary>
+	uint32_t GetFrameSize() const { return _frameSize; }
+	/// <summary>
+	/// Gets the number of bytes that have been allocated in the current frame
+	/// </summary>
+	uint32_t GetBytesUsed() const { return _head; }
+
+	/// <summary>
+	/// Ring buffers use immutable storage, use Allocate instead
+	/// </summary>
+	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override;
+	/// <summary>
+	/// Ring buffers use immutable storage, use Allocate instead
+	/// </summary>
+	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true) override;
+
+protected:
+	// Pointer to the start of our persistently mapped memory
+	uint8_t* _mappedData;
+	// The number of bytes in each frame's region
+	uint32_t _frameSize;
+	// The minimum alignment for offsets into this buffer
+	uint32_t _alignment;
+	// The frame that we are currently writing to
+	uint32_t _frameIndex;
+	// The offset of the next allocation within the current frame
+	uint32_t _head;
+	// True if an allocation failed this frame, so we should grow the buffer
+	bool     _overflowed;
+	// The fences for each frame's region, or nullptr if the GPU isn't using it
+	GLsync   _fences[FRAME_COUNT];
+
+	/// <summary>
+	/// Creates the underlying storage with the given frame size and maps it
+	/// </summary>
+	void _CreateStorage(uint32_t frameSize);
+	/// <summary>
+	/// Waits for the fence for the given frame, if it exists, and deletes it
+	/// </summary>
+	void _WaitForFrame(uint32_t frameIndex);
+};
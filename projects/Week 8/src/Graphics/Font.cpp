@@ -26,7 +26,8 @@ Font::Font(const std::string& fontPath, float size) :
 	_emToPixel(0.0f),
 	_pixelHeightScale(0.0f),
 	_fontInfo(stbtt_fontinfo()),
-	_defaultGlyph(GlyphInfo()),
+	_glyphTable(1, GlyphInfo()),
+	_revision(0),
 	_atlasWidth(256),
 	_atlasHeight(256)
 {
@@ -190,14 +191,39 @@ void Font::Bake() {
 	_atlas->LoadData(desc.Width, desc.Height, PixelFormat::Red, PixelType::UByte, atlasData);
 	delete[] atlasData;
 
+	// Rebuild the glyph lookups, leaving room for the default glyph at the start of the table
+	_glyphTable.assign(1, GlyphInfo());
+	_glyphTable.reserve(codePoints.size() + 1);
+	_glyphIndices.clear();
+	_glyphMap.clear();
+
+	uint32_t maxBmpCodepoint = 0;
+	for (uint32_t codepoint : codePoints) {
+		if (codepoint <= 0xFFFFu) {
+			maxBmpCodepoint = glm::max(maxBmpCodepoint, codepoint);
+		}
+	}
+	_glyphIndices.assign(codePoints.empty() ? 0 : maxBmpCodepoint + 1, 0);
+
 	uint32_t index = 0;
 	for (uint32_t codepoint : codePoints) {
-		_glyphMap[codepoint] = __CreateGlyph(index);
+		uint32_t tableIndex = static_cast<uint32_t>(_glyphTable.size());
+		_glyphTable.push_back(__CreateGlyph(index));
 		index++;
 
+		// Every BMP codepoint has a glyph, plus the default, won't fit in 16 bits. Fonts that big
+		// won't fit in our atlas anyways, but make sure we don't wrap around
+		if (codepoint <= 0xFFFFu && tableIndex <= 0xFFFFu) {
+			_glyphIndices[codepoint] = static_cast<uint16_t>(tableIndex);
+		} else {
+			_glyphMap[codepoint] = tableIndex;
+		}
+
 		if (codepoint == 0xE000u)
-			_defaultGlyph = _glyphMap[codepoint];
+			_glyphTable[0] = _glyphTable[tableIndex];
 	}
+
+	_revision++;
 }
 
 const Texture2D::Sptr& Font::GetAtlas() {
@@ -206,8 +232,7 @@ const Texture2D::Sptr& Font::GetAtlas() {
 
 GlyphInfo Font::GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const {
 	// Try and get glyph info from the codepoint, otherwise grab the default glyph
-	auto it = _glyphMap.find(codePoint);		
-	GlyphInfo result = it == _glyphMap.end() ? _defaultGlyph : it->second;
+	GlyphInfo result = GetGlyph(codePoint);
 
 	result.OffsetX += offsetX;
 	result.OffsetY += offsetY;
@@ -215,6 +240,11 @@ GlyphInfo Font::GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const
 	return result;
 }
 
+const GlyphInfo& Font::__GetGlyphSlow(uint32_t codePoint) const {
+	auto it = _glyphMap.find(codePoint);
+	return it == _glyphMap.end() ? _glyphTable[0] : _glyphTable[it->second];
+}
+
 float Font::GetKerning(int char1, int char2) const {
 	return stbtt_GetCodepointKernAdvance(&_fontInfo, char1, char2) * _pixelHeightScale;
 }
@@ -62,6 +62,18 @@
 		/// <param name="offsetY">The y position of the glyph</param>
 		GlyphInfo GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const;
 		/// <summary>
+		/// Gets the glyph for the given codepoint, relative to the origin. Codepoints in the basic
+		/// multilingual plane are a direct table lookup, anything missing returns the default glyph
+		/// </summary>
+		/// <param name="codePoint">The unicode codepoint to attempt to lookup</param>
+		inline const GlyphInfo& GetGlyph(uint32_t codePoint) const {
+			// Index 0 is either a missing glyph, or one whose table index didn't fit in 16 bits
+			if (codePoint < _glyphIndices.size() && _glyphIndices[codePoint] != 0) {
+				return _glyphTable[_glyphIndices[codePoint]];
+			}
+			return __GetGlyphSlow(codePoint);
+		}
+		/// <summary>
 		/// Gets the kerning (horizontal space) between 2 unicode characters
 		/// </summary>
 		/// <param name="char1">The left character</param>
@@ -72,6 +84,11 @@
 		/// Returns the vertical height of a line of text for this font
 		/// </summary>
 		float  GetLineHeight() const;
+		/// <summary>
+		/// Gets a counter that changes every time the font is baked, anything that caches
+		/// glyph positions or UVs should be rebuilt when this changes
+		/// </summary>
+		uint32_t GetRevision() const { return _revision; }
 
 		/// <summary>
 		/// Measures the size of a string using this font
@@ -94,8 +111,14 @@
 
 	protected:
 		std::vector<glm::uvec2> _glyphRanges;
-		std::map<uint32_t, GlyphInfo> _glyphMap;
-		GlyphInfo                     _defaultGlyph;
+		// Baked glyphs, the first entry is always the default glyph
+		std::vector<GlyphInfo>        _glyphTable;
+		// Maps codepoints in the BMP to an index in the glyph table (0 for missing glyphs),
+		// sized to the highest codepoint we baked
+		std::vector<uint16_t>         _glyphIndices;
+		// Glyphs outside of the BMP, which are too sparse for a flat table
+		std::map<uint32_t, uint32_t>  _glyphMap;
+		uint32_t                      _revision;
 		Texture2D::Sptr   _atlas;
 		std::string       _fontPath;
 		std::string       _fontData;
@@ -114,4 +137,5 @@
 		stbtt_fontinfo    _fontInfo;
 
 		GlyphInfo __CreateGlyph(uint32_t index);
+		const GlyphInfo& __GetGlyphSlow(uint32_t codePoint) const;
 	};
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "Graphics/Frustum.h"
+
+Frustum::Frustum() :
+	_planes()
+{ }
+
+Frustum::Frustum(const glm::mat4& viewProjection) :
+	_planes()
+{
+	Update(viewProjection);
+}
+
+void Frustum::Update(const glm::mat4& viewProjection) {
+	// GLM matrices are column major, so we need to pull out the rows ourselves
+	glm::vec4 rows[4];
+	for (int ix = 0; ix < 4; ix++) {
+		rows[ix] = glm::vec4(viewProjection[0][ix], viewProjection[1][ix], viewProjection[2][ix], viewProjection[3][ix]);
+	}
+
+	// Each plane is the w row plus or minus one of the other rows, since OpenGL clip space goes from -w to w
+	_planes[0] = rows[3] + rows[0]; // Left
+	_planes[1] = rows[3] - rows[0]; // Right
+	_planes[2] = rows[3] + rows[1]; // Bottom
+	_planes[3] = rows[3] - rows[1]; // Top
+	_planes[4] = rows[3] + rows[2]; // Near
+	_planes[5] = rows[3] - rows[2]; // Far
+
+	// Normalize the planes so that the offsets are actual distances
+	for (int ix = 0; ix < PLANE_COUNT; ix++) {
+		_planes[ix] /= glm::length(glm::vec3(_planes[ix]));
+	}
+}
+
+bool Frustum::Intersects(const AABB& bounds) const {
+	for (int ix = 0; ix < PLANE_COUNT; ix++) {
+		const glm::vec4& plane = _planes[ix];
+
+		// Find the corner of the box that is furthest along the plane's normal, if even that corner
+		// is behind the plane then the whole box is outside
+		glm::vec3 corner = glm::vec3(
+			plane.x >= 0.0f ? bounds.Max.x : bounds.Min.x,
+			plane.y >= 0.0f ? bounds.Max.y : bounds.Min.y,
+			plane.z >= 0.0f ? bounds.Max.z : bounds.Min.z
+		);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
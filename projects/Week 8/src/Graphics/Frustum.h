@@ -0,0 +1,42 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include "Utils/AABB.h"
+
+/// <summary>
+/// Represents a view frustum as a set of 6 planes, extracted from a view projection matrix
+/// using the Gribb-Hartmann method
+/// </summary>
+class Frustum {
+public:
+	static const int PLANE_COUNT = 6;
+
+	Frustum();
+	/// <summary>
+	/// Creates a frustum from the given view projection matrix
+	/// </summary>
+	/// <param name="viewProjection">The combined view projection matrix (ex: Camera::GetViewProjection())</param>
+	explicit Frustum(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Re-extracts the planes of the frustum from the given view projection matrix
+	/// </summary>
+	/// <param name="viewProjection">The combined view projection matrix (ex: Camera::GetViewProjection())</param>
+	void Update(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Gets one of the frustum planes, stored as a normal (xyz) pointing into the frustum and
+	/// an offset (w), such that points inside satisfy dot(normal, point) + offset >= 0
+	/// </summary>
+	const glm::vec4& GetPlane(int index) const { return _planes[index]; }
+
+	/// <summary>
+	/// Returns true if any part of the given box may be inside the frustum. This is conservative,
+	/// some boxes near the corners of the frustum will pass even if they are outside
+	/// </summary>
+	/// <param name="bounds">The box to test, in the same space as the view projection matrix expects</param>
+	bool Intersects(const AABB& bounds) const;
+
+protected:
+	// Left, right, bottom, top, near, far
+	glm::vec4 _planes[PLANE_COUNT];
+};
@@ -17,6 +17,7 @@ ENUM(ShaderPartType, GLint,
 	 TessControl  = GL_TESS_CONTROL_SHADER,
 	 TessEval     = GL_TESS_EVALUATION_SHADER,
 	 Geometry     = GL_GEOMETRY_SHADER,
+	 Compute      = GL_COMPUTE_SHADER,
 	 Unknown      = GL_NONE // Usually good practice to have an "unknown" or "none" state for enums
 )
 
@@ -746,9 +747,10 @@ ENUM(BlendEquation, uint32_t,
 /// </summary>
 /// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glBufferData.xhtml</see>
 ENUM(BufferType, GLenum,
-	Vertex  = GL_ARRAY_BUFFER,
-	Index   = GL_ELEMENT_ARRAY_BUFFER,
-	Uniform = GL_UNIFORM_BUFFER
+	Vertex        = GL_ARRAY_BUFFER,
+	Index         = GL_ELEMENT_ARRAY_BUFFER,
+	Uniform       = GL_UNIFORM_BUFFER,
+	ShaderStorage = GL_SHADER_STORAGE_BUFFER
 )
 
 /// <summary>
@@ -811,10 +813,28 @@ ENUM(AttributeType, GLenum,
 	 Int     = GL_INT,
 	 UInt    = GL_UNSIGNED_INT,
 	 Float   = GL_FLOAT,
+	 HalfFloat = GL_HALF_FLOAT,
 	 Double  = GL_DOUBLE,
 	 Unknown = GL_NONE
 )
 
+inline size_t GetAttributeTypeSize(AttributeType type) {
+	switch (type) {
+		case AttributeType::Byte:
+		case AttributeType::UByte:  return sizeof(uint8_t);
+		case AttributeType::Short:
+		case AttributeType::UShort:
+		case AttributeType::HalfFloat: return sizeof(uint16_t);
+		case AttributeType::Int:
+		case AttributeType::UInt:   return sizeof(uint32_t);
+		case AttributeType::Float:  return sizeof(float);
+		case AttributeType::Double: return sizeof(double);
+		case AttributeType::Unknown:
+		default:
+			return 0;
+	}
+}
+
 /// <summary>
 /// Represents the mode in which a VAO will be drawn
 /// </summary>
@@ -863,6 +883,7 @@ ENUM(RenderTargetType, uint32_t,
 	 ColorRgb10   = GL_RGB10,
 	 ColorRgb8    = GL_RGB8,
 	 ColorRG8     = GL_RG8,
+	 ColorRG16    = GL_RG16,
 	 ColorRed8    = GL_R8,
 	 ColorRgb16F  = GL_RGB16F,
 	 ColorRgba16F = GL_RGBA16F,
@@ -875,6 +896,37 @@ ENUM(RenderTargetType, uint32_t,
 	 Stencil16    = GL_STENCIL_INDEX16
 )
 
+/**
+ * Gets the number of bytes that a single pixel of a render target type takes up
+ */
+constexpr size_t GetRenderTargetTexelSize(RenderTargetType type) {
+	switch (type) {
+		case RenderTargetType::ColorRed8:
+		case RenderTargetType::Stencil4:
+		case RenderTargetType::Stencil8:
+			return 1;
+		case RenderTargetType::ColorRG8:
+		case RenderTargetType::Depth16:
+		case RenderTargetType::Stencil16:
+			return 2;
+		case RenderTargetType::ColorRgb8:
+			return 3;
+		case RenderTargetType::ColorRgba8:
+		case RenderTargetType::ColorRgb10:
+		case RenderTargetType::ColorRG16:
+		case RenderTargetType::DepthStencil:
+		case RenderTargetType::Depth24:
+		case RenderTargetType::Depth32:
+			return 4;
+		case RenderTargetType::ColorRgb16F:
+			return 6;
+		case RenderTargetType::ColorRgba16F:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
 /**
  * Enumerates the possible options for the glBindFramebuffer command
  */
@@ -0,0 +1,174 @@
+#include "Graphics/GuiAtlas.h"
+#include <glad/glad.h>
+#include <Logging.h>
+
+GuiAtlas::GuiAtlas() :
+	_texture(0),
+	_readFbo(0),
+	_drawFbo(0),
+	_entries(),
+	_shelves(),
+	_layerHeights(),
+	_usedArea(0),
+	_repackPending(false)
+{
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &_texture);
+	glTextureStorage3D(_texture, 1, GL_RGBA8, LAYER_SIZE, LAYER_SIZE, LAYER_COUNT);
+	glTextureParameteri(_texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(_texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(_texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(_texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glObjectLabel(GL_TEXTURE, _texture, -1, "GUI Atlas");
+
+	// Images are copied in with blits, which handle format conversion for us
+	glCreateFramebuffers(1, &_readFbo);
+	glCreateFramebuffers(1, &_drawFbo);
+
+	Clear();
+}
+
+GuiAtlas::~GuiAtlas() {
+	glDeleteFramebuffers(1, &_readFbo);
+	glDeleteFramebuffers(1, &_drawFbo);
+	glDeleteTextures(1, &_texture);
+}
+
+bool GuiAtlas::GetRegion(const Texture2D::Sptr& texture, Region& result) {
+	auto it = _entries.find(texture.get());
+	if (it != _entries.end()) {
+		if (it->second.Texture.lock() == texture) {
+			result = it->second.Bounds;
+			return true;
+		}
+		// The old texture was destroyed and a new one took it's address, we lose the old space until the next clear
+		_entries.erase(it);
+	}
+
+	const uint32_t width = texture->GetWidth();
+	const uint32_t height = texture->GetHeight();
+	if (width == 0 || height == 0 || texture->GetDescription().MultisampleCount > 1) {
+		return false;
+	}
+
+	uint32_t layer, x, y;
+	if (!_Allocate(width + PADDING * 2, height + PADDING * 2, layer, x, y)) {
+		// If any of our images have been destroyed, we can repack the live ones to make room. Geometry that's
+		// already been batched this frame refers to the current layout, so that has to wait for the next frame,
+		// and the texture gets drawn on it's own until then
+		if (!_repackPending) {
+			for (const auto& [key, entry] : _entries) {
+				_repackPending |= entry.Texture.expired();
+			}
+		}
+		return false;
+	}
+
+	x += PADDING;
+	y += PADDING;
+	_Copy(texture, layer, x, y);
+
+	Entry& entry = _entries[texture.get()];
+	entry.Texture = texture;
+	entry.Bounds.UvMin = glm::vec2(x, y) / (float)LAYER_SIZE;
+	entry.Bounds.UvMax = glm::vec2(x + width, y + height) / (float)LAYER_SIZE;
+	entry.Bounds.Layer = layer;
+	result = entry.Bounds;
+	return true;
+}
+
+void GuiAtlas::BeginFrame() {
+	// Live images are copied back in as they're requested
+	if (_repackPending) {
+		Clear();
+	}
+}
+
+void GuiAtlas::Clear() {
+	_entries.clear();
+	_shelves.clear();
+	for (uint32_t ix = 0; ix < LAYER_COUNT; ix++) {
+		_layerHeights[ix] = 0;
+	}
+	_usedArea = 0;
+	_repackPending = false;
+}
+
+void GuiAtlas::Bind(int slot) const {
+	glBindTextureUnit(slot, _texture);
+}
+
+float GuiAtlas::GetUsage() const {
+	return static_cast<float>(static_cast<double>(_usedArea) / (static_cast<double>(LAYER_SIZE) * LAYER_SIZE * LAYER_COUNT));
+}
+
+bool GuiAtlas::_Allocate(uint32_t width, uint32_t height, uint32_t& layer, uint32_t& x, uint32_t& y) {
+	if (width > LAYER_SIZE || height > LAYER_SIZE) {
+		return false;
+	}
+
+	// Find the shelf that fits us with the least wasted height
+	Shelf* best = nullptr;
+	for (Shelf& shelf : _shelves) {
+		if (shelf.Height >= height && shelf.Width + width <= LAYER_SIZE) {
+			if (best == nullptr || shelf.Height < best->Height) {
+				best = &shelf;
+			}
+		}
+	}
+
+	// Don't stick small images into shelves that are much taller than they are, start a new shelf if we can
+	if (best == nullptr || best->Height > height * 2) {
+		for (uint32_t ix = 0; ix < LAYER_COUNT; ix++) {
+			if (_layerHeights[ix] + height <= LAYER_SIZE) {
+				_shelves.push_back({ ix, _layerHeights[ix], height, 0 });
+				_layerHeights[ix] += height;
+				best = &_shelves.back();
+				break;
+			}
+		}
+	}
+
+	if (best == nullptr) {
+		return false;
+	}
+
+	layer = best->Layer;
+	x = best->Width;
+	y = best->Y;
+	best->Width += width;
+	_usedArea += static_cast<uint64_t>(width) * height;
+	return true;
+}
+
+void GuiAtlas::_Copy(const Texture2D::Sptr& texture, uint32_t layer, uint32_t x, uint32_t y) {
+	const GLint width = texture->GetWidth();
+	const GLint height = texture->GetHeight();
+
+	glNamedFramebufferTexture(_readFbo, GL_COLOR_ATTACHMENT0, texture->GetHandle(), 0);
+	glNamedFramebufferReadBuffer(_readFbo, GL_COLOR_ATTACHMENT0);
+	glNamedFramebufferTextureLayer(_drawFbo, GL_COLOR_ATTACHMENT0, _texture, 0, layer);
+	glNamedFramebufferDrawBuffer(_drawFbo, GL_COLOR_ATTACHMENT0);
+
+	// Blits respect the scissor test, which the GUI may have enabled
+	GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+	glDisable(GL_SCISSOR_TEST);
+
+	// Stretch the image over it's padded area first, with nearest filtering the border texels end up
+	// as copies of the image's edges. Then copy the image itself over the middle
+	const GLint pad = PADDING;
+	glBlitNamedFramebuffer(_readFbo, _drawFbo,
+		0, 0, width, height,
+		x - pad, y - pad, x + width + pad, y + height + pad,
+		GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBlitNamedFramebuffer(_readFbo, _drawFbo,
+		0, 0, width, height,
+		x, y, x + width, y + height,
+		GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+	if (scissor) {
+		glEnable(GL_SCISSOR_TEST);
+	}
+
+	// Detach so we don't keep the texture alive in the framebuffer
+	glNamedFramebufferTexture(_readFbo, GL_COLOR_ATTACHMENT0, 0, 0);
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Textures/Texture2D.h"
+
+/// <summary>
+/// Packs the textures used by the GUI into the layers of a single texture array, so that images
+/// and fonts can all be drawn from one binding. Textures are copied in on the GPU the first time
+/// they're requested, and packed into rows (shelves) of similar height
+///
+/// Each image gets a border of PADDING texels copied from it's own edges, so that linear filtering
+/// doesn't pull in neighbouring images. Since everything is stored as RGBA8, single channel
+/// textures (ex: font atlases) end up in the red channel
+/// </summary>
+class GuiAtlas {
+public:
+	typedef std::shared_ptr<GuiAtlas> Sptr;
+
+	// The width and height of each layer, in texels
+	static const uint32_t LAYER_SIZE = 1024;
+	// The number of layers in the array
+	static const uint32_t LAYER_COUNT = 4;
+	// The border around each image, in texels
+	static const uint32_t PADDING = 1;
+
+	/// <summary>
+	/// Describes where an image lives in the atlas
+	/// </summary>
+	struct Region {
+		glm::vec2 UvMin;
+		glm::vec2 UvMax;
+		uint32_t  Layer;
+
+		/// <summary>
+		/// Converts a UV coordinate within the source image into atlas space
+		/// </summary>
+		glm::vec3 Transform(const glm::vec2& uv) const {
+			return glm::vec3(UvMin + uv * (UvMax - UvMin), (float)Layer);
+		}
+
+		bool operator ==(const Region& other) const {
+			return UvMin == other.UvMin && UvMax == other.UvMax && Layer == other.Layer;
+		}
+		bool operator !=(const Region& other) const {
+			return !(*this == other);
+		}
+	};
+
+	static inline Sptr Create() {
+		return std::make_shared<GuiAtlas>();
+	}
+
+	GuiAtlas();
+	~GuiAtlas();
+
+	GuiAtlas(const GuiAtlas& other) = delete;
+	GuiAtlas& operator =(const GuiAtlas& other) = delete;
+
+	/// <summary>
+	/// Gets the region of the atlas that stores the given texture, copying the texture in if this is the first
+	/// time we've seen it. Returns false if the texture can't be stored in the atlas (too large, multisampled,
+	/// or the atlas is full), in which case it should be drawn on it's own
+	/// </summary>
+	/// <param name="texture">The texture to look up</param>
+	/// <param name="result">Set to the texture's region on success</param>
+	bool GetRegion(const Texture2D::Sptr& texture, Region& result);
+
+	/// <summary>
+	/// Should be called at the start of each frame, before any regions are requested. If the atlas filled up
+	/// during the last frame and some of it's images have since been destroyed, repacks the live images
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// Removes all images from the atlas, they will be copied in again as they are requested. Needed if
+	/// a texture's contents change after it's been added. Any regions handed out before this are invalid,
+	/// so this should only be called between frames
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Binds the texture array to the given texture slot
+	/// </summary>
+	void Bind(int slot) const;
+
+	/// <summary>
+	/// Gets the number of images stored in the atlas
+	/// </summary>
+	uint32_t GetImageCount() const { return static_cast<uint32_t>(_entries.size()); }
+	/// <summary>
+	/// Gets the fraction of the atlas's area that has been allocated, between 0 and 1
+	/// </summary>
+	float GetUsage() const;
+
+protected:
+	struct Entry {
+		// So we can tell if a new texture has been allocated at the same address
+		std::weak_ptr<Texture2D> Texture;
+		Region                   Bounds;
+	};
+
+	// A row of images within a layer, images are added left to right
+	struct Shelf {
+		uint32_t Layer;
+		uint32_t Y;
+		uint32_t Height;
+		uint32_t Width;
+	};
+
+	uint32_t _texture;
+	uint32_t _readFbo;
+	uint32_t _drawFbo;
+
+	std::unordered_map<Texture2D*, Entry> _entries;
+	std::vector<Shelf> _shelves;
+	// The top of the last shelf in each layer
+	uint32_t _layerHeights[LAYER_COUNT];
+	uint64_t _usedArea;
+	// Set when we ran out of space while holding destroyed images, we repack at the start of the next frame
+	bool     _repackPending;
+
+	/// <summary>
+	/// Finds space for an image of the given size (including padding), returns false if there's no room
+	/// </summary>
+	bool _Allocate(uint32_t width, uint32_t height, uint32_t& layer, uint32_t& x, uint32_t& y);
+	/// <summary>
+	/// Copies a texture into the atlas, with it's top-left texel at the given position in the layer
+	/// </summary>
+	void _Copy(const Texture2D::Sptr& texture, uint32_t layer, uint32_t x, uint32_t y);
+};
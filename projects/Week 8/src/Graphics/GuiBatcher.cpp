@@ -6,7 +6,18 @@
 #include <codecvt>
 
 
-std::unordered_map<Texture2D*, GuiBatcher::MeshData> GuiBatcher::_meshBuilders;
+const std::vector<BufferAttribute> GuiBatcher::VertexGui::V_DECL = {
+	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexGui), offsetof(VertexGui, Position), AttribUsage::Position),
+	BufferAttribute(1, 4, AttributeType::Float, sizeof(VertexGui), offsetof(VertexGui, Color), AttribUsage::Color),
+	BufferAttribute(3, 3, AttributeType::Float, sizeof(VertexGui), offsetof(VertexGui, UV), AttribUsage::Texture),
+	BufferAttribute(4, 1, AttributeType::Float, sizeof(VertexGui), offsetof(VertexGui, IsFont), AttribUsage::User0),
+};
+
+MeshBuilder<GuiBatcher::VertexGui> GuiBatcher::__mesh;
+std::vector<GuiBatcher::DrawBatch> GuiBatcher::__batches;
+GuiBatchMode GuiBatcher::__batchMode = GuiBatchMode::Atlas;
+GuiAtlas::Sptr GuiBatcher::__atlas = nullptr;
+uint32_t GuiBatcher::__drawCallCount = 0;
 
 VertexArrayObject::Sptr GuiBatcher::__vao = nullptr;
 IndexBuffer::Sptr GuiBatcher::__ibo = nullptr;
@@ -16,7 +27,6 @@ int GuiBatcher::__defaultEdgeRadius = 0;
 
 VertexBuffer::Sptr GuiBatcher::__vbo = nullptr;
 ShaderProgram::Sptr GuiBatcher::__shader = nullptr;
-ShaderProgram::Sptr GuiBatcher::__fontShader = nullptr;
 glm::ivec2 GuiBatcher::__windowSize = {0, 0};
 glm::mat4 GuiBatcher::__projection = glm::mat4(1.0f);
 glm::mat3 GuiBatcher::__model = glm::mat3(1.0f);
@@ -24,34 +34,39 @@ std::vector<glm::mat3> GuiBatcher::__modelTransformStack = std::vector<glm::mat3
 std::vector<GuiBatcher::IRect> GuiBatcher::__scissorRects = std::vector<GuiBatcher::IRect>();
 
 void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, const glm::vec2 uvMin, const glm::vec2 uvMax) {
-	// Create vertices and transform positions
-	VertexPosColTex verts[4];
-	verts[0].Position = __model * glm::vec3(min.x, min.y, 1.0f);
-	verts[1].Position = __model * glm::vec3(min.x, max.y, 1.0f);
-	verts[2].Position = __model * glm::vec3(max.x, max.y, 1.0f);
-	verts[3].Position = __model * glm::vec3(max.x, min.y, 1.0f);
-		
-	// Grab mesh info for the texture batch
-	MeshData& mesh = _meshBuilders[tex.get()];
-	// We can use the vertex count for depth, so that things drawn later have a bit of spacing
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
-
-	// Copy in all color and set depth 
-	for (int ix = 0; ix < 4; ix++) {
-		verts[ix].Color = color;
-		verts[ix].Position.z = depth;
+	if (tex == nullptr) {
+		return;
 	}
 
+	// Work out where we're sampling from, this may start a new batch
+	GuiAtlas::Region region;
+	bool inAtlas = __BeginBatch(tex, region);
+
+	// Create vertices and transform positions. Depth testing is off, so later geometry
+	// is drawn over top of earlier geometry
+	VertexGui verts[4];
+	verts[0].Position = glm::vec3(glm::vec2(__model * glm::vec3(min.x, min.y, 1.0f)), 0.0f);
+	verts[1].Position = glm::vec3(glm::vec2(__model * glm::vec3(min.x, max.y, 1.0f)), 0.0f);
+	verts[2].Position = glm::vec3(glm::vec2(__model * glm::vec3(max.x, max.y, 1.0f)), 0.0f);
+	verts[3].Position = glm::vec3(glm::vec2(__model * glm::vec3(max.x, min.y, 1.0f)), 0.0f);
+
 	// Copy over UV coords
-	verts[0].UV = glm::vec2(uvMin.x, uvMax.y);
-	verts[1].UV = glm::vec2(uvMin.x, uvMin.y);
-	verts[2].UV = glm::vec2(uvMax.x, uvMin.y);
-	verts[3].UV = glm::vec2(uvMax.x, uvMax.y);
+	const glm::vec2 uvs[4] = {
+		glm::vec2(uvMin.x, uvMax.y),
+		glm::vec2(uvMin.x, uvMin.y),
+		glm::vec2(uvMax.x, uvMin.y),
+		glm::vec2(uvMax.x, uvMax.y)
+	};
+	for (int ix = 0; ix < 4; ix++) {
+		verts[ix].Color  = color;
+		verts[ix].UV     = inAtlas ? region.Transform(uvs[ix]) : glm::vec3(uvs[ix], -1.0f);
+		verts[ix].IsFont = 0.0f;
+	}
 
 	// Add vertices and indices to range
-	uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 1);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 3, ix + 2);
+	uint32_t ix = __mesh.AddVertexRange(verts, 4);
+	__mesh.AddIndexTri(ix + 0, ix + 2, ix + 1);
+	__mesh.AddIndexTri(ix + 0, ix + 3, ix + 2);
 }
 
 void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, int edgeRadius)
@@ -98,8 +113,97 @@ void GuiBatcher::SetProjection(const glm::mat4& projection) {
 }
 
 void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/) {
+	// Gets the texture used to render the font, and work out where we're sampling it from
+	GuiAtlas::Region region;
+	bool inAtlas = __BeginBatch(font->GetAtlas(), region);
+
+	// Lay the text out into a scratch buffer that we re-use between calls
+	static std::vector<VertexGui> scratch;
+	scratch.clear();
+	__LayoutText(text, font, position, color, scale, inAtlas, region, scratch);
+	__PushQuads(scratch);
+}
+
+void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale, TextCache& cache) {
+	GuiAtlas::Region region;
+	bool inAtlas = __BeginBatch(font->GetAtlas(), region);
+
+	// The owner tracks text, color and scale, we need to check everything else that ends up in the vertices
+	bool dirty = !cache._isValid ||
+		cache._font != font.get() || cache._fontRevision != font->GetRevision() ||
+		cache._model != __model || cache._position != position ||
+		cache._inAtlas != inAtlas || (inAtlas && cache._region != region);
+
+	if (dirty) {
+		cache._vertices.clear();
+		__LayoutText(text, font, position, color, scale, inAtlas, region, cache._vertices);
+		cache._isValid      = true;
+		cache._font         = font.get();
+		cache._fontRevision = font->GetRevision();
+		cache._model        = __model;
+		cache._position     = position;
+		cache._inAtlas      = inAtlas;
+		cache._region       = region;
+	}
+
+	__PushQuads(cache._vertices);
+}
+
+void GuiBatcher::RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/)
+{
+	static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+	RenderText(converter.from_bytes(text), font, position, color, scale);
+}
+
+void GuiBatcher::BeginFrame()
+{
+	ResetStats();
+	if (__atlas != nullptr) {
+		__atlas->BeginFrame();
+	}
+}
+
+void GuiBatcher::Flush()
+{
+	__StaticInit();
+
+	if (__mesh.GetIndexCount() > 0) {
+		// Upload everything at once, each batch draws it's own range of indices
+		__vbo->UpdateData(__mesh.GetVertexDataPtr(), sizeof(VertexGui), static_cast<uint32_t>(__mesh.GetVertexCount()), true);
+		__ibo->UpdateData(__mesh.GetIndexDataPtr(), sizeof(uint32_t), static_cast<uint32_t>(__mesh.GetIndexCount()), true);
+
+		__shader->Bind();
+		__shader->SetUniformMatrix(0, &__projection, 1, false);
+		if (__atlas != nullptr) {
+			__atlas->Bind(0);
+		}
+
+		__vao->Bind();
+		for (size_t ix = 0; ix < __batches.size(); ix++) {
+			const DrawBatch& batch = __batches[ix];
+			uint32_t end = ix + 1 < __batches.size() ? __batches[ix + 1].IndexOffset : static_cast<uint32_t>(__mesh.GetIndexCount());
+			if (end == batch.IndexOffset) {
+				continue;
+			}
+
+			if (batch.Texture != nullptr) {
+				batch.Texture->Bind(1);
+			}
+			glDrawElements(GL_TRIANGLES, end - batch.IndexOffset, GL_UNSIGNED_INT, (const void*)(batch.IndexOffset * sizeof(uint32_t)));
+			__drawCallCount++;
+		}
+		VertexArrayObject::Unbind();
+	}
+
+	// Clear mesh
+	__mesh.Reset();
+	__batches.clear();
+}
+
+void GuiBatcher::__LayoutText(const std::wstring& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale, bool inAtlas, const GuiAtlas::Region& region, std::vector<VertexGui>& result) {
 	// How many characters we have
 	size_t length = text.size();
+	result.reserve(result.size() + length * 4);
 
 	// Tracks the offset of the character
 	glm::vec2 offset = glm::vec2(0.0f);
@@ -107,26 +211,17 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 	// Transform the origin based off the model transform
 	glm::vec2 origin = position;
 
-	// Gets the texture used to render the font
-	Texture2D::Sptr atlas = font->GetAtlas();
-
-	// Grab the mesh builder and make sure it's a texture batch
-	MeshData& mesh = _meshBuilders[atlas.get()];
-	mesh.IsFont = true;
-
 	// Allocate some space for the vertices
-	VertexPosColTex verts[4];
-	verts[0].Color = color;
-	verts[1].Color = color;
-	verts[2].Color = color;
-	verts[3].Color = color;
-
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
+	VertexGui verts[4];
+	for (int ix = 0; ix < 4; ix++) {
+		verts[ix].Color  = color;
+		verts[ix].IsFont = 1.0f;
+	}
 
 	// Iterate over all characters in string
-	for (int i = 0; i < length; i++) {
+	for (size_t i = 0; i < length; i++) {
 		// Grab the glyph data for the character
-		GlyphInfo glyph = font->GetGlyph(text[i], offset.x, offset.y);
+		const GlyphInfo& glyph = font->GetGlyph(text[i]);
 
 		// A newline will advance to the next line and return to the start of the line
 		if (text[i] == '\n') {
@@ -139,30 +234,19 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 		}
 		// A tab character is 4 spaces
 		else if (text[i] == '\t') {
-			float xOffTemp{ 0 }, yOffTemp{ 0 };
-			glyph = font->GetGlyph(' ', xOffTemp, yOffTemp);
-			offset.x += glyph.OffsetX * 4;
+			offset.x += font->GetGlyph(' ').OffsetX * 4;
 		}
 		// All other characters get rendered
 		else {
-			verts[0].Position = __model * glm::vec3(origin + (offset + glyph.Positions[0]) * scale, 1.0f);
-			verts[1].Position = __model * glm::vec3(origin + (offset + glyph.Positions[1]) * scale, 1.0f);
-			verts[2].Position = __model * glm::vec3(origin + (offset + glyph.Positions[2]) * scale, 1.0f);
-			verts[3].Position = __model * glm::vec3(origin + (offset + glyph.Positions[3]) * scale, 1.0f);
-			verts[0].UV = glyph.UVs[0];
-			verts[1].UV = glyph.UVs[1];
-			verts[2].UV = glyph.UVs[2];
-			verts[3].UV = glyph.UVs[3];
-
-			verts[0].Position.z = verts[1].Position.z = verts[2].Position.z = verts[3].Position.z = depth;
-
-			uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 1, ix + 2);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 3);
+			for (int iv = 0; iv < 4; iv++) {
+				verts[iv].Position = glm::vec3(glm::vec2(__model * glm::vec3(origin + (offset + glyph.Positions[iv]) * scale, 1.0f)), 0.0f);
+				verts[iv].UV = inAtlas ? region.Transform(glyph.UVs[iv]) : glm::vec3(glyph.UVs[iv], -1.0f);
+			}
+			result.insert(result.end(), verts, verts + 4);
 
 			// Advance the offset based on the size of the glyph
-			offset.x = glyph.OffsetX;
-			offset.y = glyph.OffsetY;
+			offset.x += glyph.OffsetX;
+			offset.y += glyph.OffsetY;
 
 			// If we have more characters, see if there's any kerning between the
 			// current and next character and add it to the x offset
@@ -171,44 +255,42 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 				offset.x += kerning;
 			}
 		}
-
 	}
-
 }
 
-void GuiBatcher::RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/)
-{
-	static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-	RenderText(converter.from_bytes(text), font, position, color, scale);
+void GuiBatcher::__PushQuads(const std::vector<VertexGui>& vertices) {
+	if (vertices.empty()) {
+		return;
+	}
+
+	// Vertices go in with a single copy, we just need to generate 2 triangles per quad
+	uint32_t start = __mesh.AddVertexRange(vertices.data(), static_cast<uint32_t>(vertices.size()));
+	for (uint32_t ix = start; ix < start + vertices.size(); ix += 4) {
+		__mesh.AddIndexTri(ix + 0, ix + 1, ix + 2);
+		__mesh.AddIndexTri(ix + 0, ix + 2, ix + 3);
+	}
 }
 
-void GuiBatcher::Flush()
+bool GuiBatcher::__BeginBatch(const Texture2D::Sptr& tex, GuiAtlas::Region& region)
 {
-	__StaticInit();
-
-	// Iterate over each texture and it's mesh
-	for (auto&[key, value] : _meshBuilders) {
-		Texture2D* tex = key;
-		// If the texture exists and the mesh has data
-		if (tex != nullptr && value.Builder.GetIndexCount() > 0) {
-			// Update the VAO and it's buffers
-			__vao->Bind();
-			__vbo->UpdateData(value.Builder.GetVertexDataPtr(), sizeof(VertexPosColTex), value.Builder.GetVertexCount(), true);
-			__ibo->UpdateData(value.Builder.GetIndexDataPtr(), sizeof(uint32_t), value.Builder.GetIndexCount(), true);
-
-			// Bind texture, send uniforms to shader
-			tex->Bind(0);
-			ShaderProgram::Sptr shader = value.IsFont ? __fontShader : __shader;
-			shader->Bind();
-			shader->SetUniformMatrix(0, &__projection, 1, false);
-
-			// Draw geometry
-			__vao->Draw();
-
-			// Clear mesh
-			value.Builder.Reset();
+	Texture2D::Sptr binding = tex;
+	bool inAtlas = false;
+	if (__batchMode == GuiBatchMode::Atlas) {
+		if (__atlas == nullptr) {
+			__atlas = GuiAtlas::Create();
+		}
+		inAtlas = __atlas->GetRegion(tex, region);
+		if (inAtlas) {
+			binding = nullptr;
 		}
 	}
+
+	// We only need to break the batch when the texture we have to bind changes, so everything
+	// still draws in the order it was pushed
+	if (__batches.empty() || __batches.back().Texture != binding) {
+		__batches.push_back({ binding, static_cast<uint32_t>(__mesh.GetIndexCount()) });
+	}
+	return inAtlas;
 }
 
 void GuiBatcher::PushModelTransform(const glm::mat3& transform) {
@@ -235,74 +317,56 @@ void GuiBatcher::__StaticInit()
 		__shader->LoadShaderPart(R"LIT(#version 460
 					layout(location = 0) in vec3 inPos;
 					layout(location = 1) in vec4 inColor;
-					layout(location = 3) in vec2 inUV;
+					layout(location = 3) in vec3 inUV;
+					layout(location = 4) in float inIsFont;
 
 					layout(location = 0) out vec4 outColor;
-					layout(location = 1) out vec2 outUV;
+					layout(location = 1) out vec3 outUV;
+					layout(location = 2) flat out float outIsFont;
 
 					layout(location = 0) uniform mat4 u_Projection;
 
 					void main() {
 						outColor = inColor;
 						outUV = inUV;
+						outIsFont = inIsFont;
 						gl_Position = u_Projection * vec4(inPos, 1);
 					}
 				)LIT", ShaderPartType::Vertex);
 
 		__shader->LoadShaderPart(R"LIT(#version 460
 					layout(location = 0) in vec4 inColor;
-					layout(location = 1) in vec2 inUV;
+					layout(location = 1) in vec3 inUV;
+					layout(location = 2) flat in float inIsFont;
 
 					layout(location = 0) out vec4 outColor;
 
-					uniform layout(binding=0) sampler2D s_Texture;
+					uniform layout(binding=0) sampler2DArray s_Atlas;
+					uniform layout(binding=1) sampler2D s_Texture;
 
 					void main() {
-						outColor = texture(s_Texture, inUV) * inColor;
+						// A negative layer means this batch has it's own texture bound instead of using the atlas.
+						// We sample both so that we're never sampling in non-uniform control flow
+						vec4 atlasColor = texture(s_Atlas, inUV);
+						vec4 texColor = texture(s_Texture, inUV.xy);
+						vec4 texel = inUV.z < 0 ? texColor : atlasColor;
+
+						// Fonts only store coverage, in the red channel
+						if (inIsFont > 0.5) {
+							outColor = vec4(inColor.rgb, texel.r);
+						} else {
+							outColor = texel * inColor;
+						}
 					}
 				)LIT", ShaderPartType::Fragment);
 
 		__shader->Link();
 
-		__fontShader = ShaderProgram::Create();
-		__fontShader->LoadShaderPart(R"LIT(#version 460
-					layout(location = 0) in vec3 inPos;
-					layout(location = 1) in vec4 inColor;
-					layout(location = 3) in vec2 inUV;
-
-					layout(location = 0) out vec4 outColor;
-					layout(location = 1) out vec2 outUV;
-
-					layout(location = 0) uniform mat4 u_Projection;
-
-					void main() {
-						outColor = inColor;
-						outUV = inUV;
-						gl_Position = u_Projection * vec4(inPos, 1);
-					}
-				)LIT", ShaderPartType::Vertex);
-
-		__fontShader->LoadShaderPart(R"LIT(#version 460
-					layout(location = 0) in vec4 inColor;
-					layout(location = 1) in vec2 inUV;
-
-					layout(location = 0) out vec4 outColor;
-
-					uniform layout(binding=0) sampler2D s_Texture;
-
-					void main() {
-						float fontPow = texture(s_Texture, inUV).r;
-						outColor = vec4(inColor.rgb, fontPow);
-					}
-				)LIT" , ShaderPartType::Fragment);
-
-		__fontShader->Link();
-
 		__vbo = VertexBuffer::Create(BufferUsage::DynamicDraw);
 		__ibo = IndexBuffer::Create(BufferUsage::DynamicDraw, IndexType::UInt);
 
 		__vao = VertexArrayObject::Create();
-		__vao->AddVertexBuffer(__vbo, VertexPosColTex::V_DECL);
+		__vao->AddVertexBuffer(__vbo, VertexGui::V_DECL);
 		__vao->SetIndexBuffer(__ibo);
 
 		// Generate a simple white texture with a black border
@@ -389,3 +453,23 @@ void GuiBatcher::SetDefaultBorderRadius(int value) {
 int GuiBatcher::GetDefaultBorderRadius() {
 	return __defaultEdgeRadius;
 }
+
+void GuiBatcher::SetBatchMode(GuiBatchMode value) {
+	__batchMode = value;
+}
+
+GuiBatchMode GuiBatcher::GetBatchMode() {
+	return __batchMode;
+}
+
+const GuiAtlas::Sptr& GuiBatcher::GetAtlas() {
+	return __atlas;
+}
+
+uint32_t GuiBatcher::GetDrawCallCount() {
+	return __drawCallCount;
+}
+
+void GuiBatcher::ResetStats() {
+	__drawCallCount = 0;
+}
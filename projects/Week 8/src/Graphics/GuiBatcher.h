@@ -7,8 +7,21 @@
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
 #include "Graphics/Font.h"
+#include "Graphics/GuiAtlas.h"
 #include "Utils/MeshBuilder.h"
-#include <unordered_map>
+#include <EnumToString.h>
+
+	/// <summary>
+	/// Determines how the GUI batcher groups geometry into draw calls. Either way, geometry
+	/// is drawn in the order it was pushed
+	/// </summary>
+	ENUM(GuiBatchMode, int,
+		// Each texture is bound on it's own, a new draw starts whenever the texture changes
+		PerTexture = 0,
+		// Textures are copied into a shared texture array the first time they're used, so most of
+		// the GUI (including text) draws in a single call. Textures that don't fit are drawn on their own
+		Atlas      = 1
+	);
 
 	/// <summary>
 	/// The GUI Batcher class provides utilities for drawing rectangles and
@@ -56,6 +69,20 @@
 		/// <param name="scale">The scaling to apply to the text</param>
 		static void RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale = 1.0f);
 
+		class TextCache;
+		/// <summary>
+		/// Renders a left-aligned line of text at the given position using a font, re-using the quads
+		/// stored in the cache if nothing has changed since they were generated. Callers are responsible
+		/// for invalidating the cache when the text, color or scale changes, everything else is checked here
+		/// </summary>
+		/// <param name="text">The unicode text to render</param>
+		/// <param name="font">The font to render with</param>
+		/// <param name="position">The position of the text in model space</param>
+		/// <param name="color">The color of the text</param>
+		/// <param name="scale">The scaling to apply to the text</param>
+		/// <param name="cache">The cache to store the generated quads in</param>
+		static void RenderText(const std::wstring& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale, TextCache& cache);
+
 		/// <summary>
 		/// Sets the projection matrix to use for rendering, should ideally be an orthographic
 		/// projection that matches the screen size
@@ -66,6 +93,11 @@
 		/// </summary>
 		static void SetWindowSize(const glm::ivec2& size);
 		/// <summary>
+		/// Prepares for a new frame, should be called before anything is pushed. Resets the stats
+		/// and does any atlas maintenance that can't happen while geometry is batched
+		/// </summary>
+		static void BeginFrame();
+		/// <summary>
 		/// Draws all geometry to the screen and prepares for the next batch
 		/// </summary>
 		static void Flush();
@@ -112,15 +144,51 @@
 		/// </summary>
 		static int GetDefaultBorderRadius();
 
+		/// <summary>
+		/// Sets how geometry is grouped into draw calls, takes effect from the next push
+		/// </summary>
+		static void SetBatchMode(GuiBatchMode value);
+		/// <summary>
+		/// Gets how geometry is grouped into draw calls
+		/// </summary>
+		static GuiBatchMode GetBatchMode();
+		/// <summary>
+		/// Gets the atlas that textures are packed into in GuiBatchMode::Atlas, or nullptr
+		/// if it hasn't been needed yet
+		/// </summary>
+		static const GuiAtlas::Sptr& GetAtlas();
+
+		/// <summary>
+		/// Gets the number of draw calls issued since the last call to ResetStats
+		/// </summary>
+		static uint32_t GetDrawCallCount();
+		/// <summary>
+		/// Resets the draw call counter, should be called at the start of each frame
+		/// </summary>
+		static void ResetStats();
+
 	private:
 		struct IRect {
 			glm::ivec2 Min;
 			glm::ivec2 Max;
 		};
 
-		struct MeshData {
-			MeshBuilder<VertexPosColTex> Builder;
-			bool IsFont;
+		struct VertexGui {
+			glm::vec3 Position;
+			glm::vec4 Color;
+			// UV in xy, atlas layer in z, or -1 to sample the batch's own texture
+			glm::vec3 UV;
+			// 1 for font glyphs, which only store coverage in the red channel
+			float     IsFont;
+
+			static const std::vector<BufferAttribute> V_DECL;
+		};
+
+		// A run of indices that can be drawn with the same texture bound, and ends where the next one starts
+		struct DrawBatch {
+			// The texture to bind, or nullptr when drawing from the atlas
+			Texture2D::Sptr Texture;
+			uint32_t        IndexOffset;
 		};
 
 		static glm::ivec2 __windowSize;
@@ -129,8 +197,11 @@
 		static std::vector<glm::mat3> __modelTransformStack;
 		static std::vector<IRect> __scissorRects;
 		static ShaderProgram::Sptr __shader;
-		static ShaderProgram::Sptr __fontShader;
-		static std::unordered_map<Texture2D*, MeshData> _meshBuilders;
+		static MeshBuilder<VertexGui> __mesh;
+		static std::vector<DrawBatch> __batches;
+		static GuiBatchMode __batchMode;
+		static GuiAtlas::Sptr __atlas;
+		static uint32_t __drawCallCount;
 		static VertexArrayObject::Sptr __vao;
 		static VertexBuffer::Sptr __vbo;
 		static IndexBuffer::Sptr __ibo;
@@ -139,4 +210,48 @@
 		static int __defaultEdgeRadius;
 
 		static void __StaticInit();
+		/// <summary>
+		/// Makes sure the current batch can draw from the given texture, starting a new batch if needed.
+		/// Returns true if the texture should be sampled from the atlas, in which case region is set
+		/// to the texture's location in the atlas
+		/// </summary>
+		static bool __BeginBatch(const Texture2D::Sptr& tex, GuiAtlas::Region& region);
+		/// <summary>
+		/// Lays out a string of text, appending 4 vertices per visible glyph to result
+		/// </summary>
+		static void __LayoutText(const std::wstring& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale, bool inAtlas, const GuiAtlas::Region& region, std::vector<VertexGui>& result);
+		/// <summary>
+		/// Copies a list of quads (4 vertices each) into the current batch
+		/// </summary>
+		static void __PushQuads(const std::vector<VertexGui>& vertices);
+	};
+
+	/// <summary>
+	/// Stores the quads generated for a block of text, so that text that hasn't changed
+	/// can be copied straight into the batch instead of being laid out again each frame
+	/// </summary>
+	class GuiBatcher::TextCache {
+	public:
+		/// <summary>
+		/// Forces the text to be laid out again the next time it's rendered
+		/// </summary>
+		void Invalidate() { _isValid = false; }
+		/// <summary>
+		/// Gets the number of glyph quads currently stored in the cache
+		/// </summary>
+		uint32_t GetGlyphCount() const { return static_cast<uint32_t>(_vertices.size() / 4); }
+
+	private:
+		friend class GuiBatcher;
+
+		std::vector<VertexGui> _vertices;
+		bool                   _isValid = false;
+
+		// The state the vertices were generated with, which the owner of the cache can't track
+		const Font*            _font = nullptr;
+		uint32_t               _fontRevision = 0;
+		glm::mat3              _model = glm::mat3(1.0f);
+		glm::vec2              _position = glm::vec2(0.0f);
+		bool                   _inAtlas = false;
+		GuiAtlas::Region       _region = GuiAtlas::Region();
 	};
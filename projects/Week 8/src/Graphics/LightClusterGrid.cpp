@@ -0,0 +1,152 @@
+#include "Graphics/LightClusterGrid.h"
+#include <algorithm>
+#include <cmath>
+
+LightClusterGrid::LightClusterGrid() :
+	_lights(std::vector<ClusterLight>()),
+	_lightBounds(std::vector<ClusterBounds>()),
+	_clusterRanges(std::vector<glm::uvec2>()),
+	_lightIndices(std::vector<uint32_t>()),
+	_sliceScaleBias(glm::vec2(0.0f)),
+	_lightBuffer(nullptr),
+	_rangeBuffer(nullptr),
+	_indexBuffer(nullptr)
+{
+	_lightBuffer = ShaderStorageBuffer::Create(BufferUsage::DynamicDraw);
+	_rangeBuffer = ShaderStorageBuffer::Create(BufferUsage::DynamicDraw);
+	_indexBuffer = ShaderStorageBuffer::Create(BufferUsage::DynamicDraw);
+}
+
+void LightClusterGrid::Clear() {
+	_lights.clear();
+}
+
+void LightClusterGrid::AddLight(const glm::vec3& viewPosition, float radius, const glm::vec3& color, float intensity) {
+	ClusterLight light;
+	light.PositionRadius = glm::vec4(viewPosition, radius);
+	light.ColorIntensity = glm::vec4(color, intensity);
+	_lights.push_back(light);
+}
+
+void LightClusterGrid::Build(const glm::mat4& projection, float zNear, float zFar) {
+	// Slices are spaced exponentially, so slice = log(depth) * scale + bias
+	float logRatio = std::log(zFar / zNear);
+	_sliceScaleBias.x = SLICES / logRatio;
+	_sliceScaleBias.y = -(SLICES * std::log(zNear)) / logRatio;
+
+	_clusterRanges.assign(CLUSTER_COUNT, glm::uvec2(0));
+	_lightBounds.resize(_lights.size());
+
+	// First pass, find the clusters for each light and count how many lights land in each cluster
+	for (size_t ix = 0; ix < _lights.size(); ix++) {
+		ClusterBounds& bounds = _lightBounds[ix];
+		if (!_CalcClusterBounds(_lights[ix], projection, zNear, zFar, bounds)) {
+			// Empty range, so the loops below skip this light
+			bounds.Min = glm::uvec3(1);
+			bounds.Max = glm::uvec3(0);
+			continue;
+		}
+
+		for (uint32_t z = bounds.Min.z; z <= bounds.Max.z; z++) {
+			for (uint32_t y = bounds.Min.y; y <= bounds.Max.y; y++) {
+				for (uint32_t x = bounds.Min.x; x <= bounds.Max.x; x++) {
+					_clusterRanges[x + TILES_X * (y + TILES_Y * z)].y++;
+				}
+			}
+		}
+	}
+
+	// Turn the counts into offsets into the index list
+	uint32_t offset = 0;
+	for (glm::uvec2& range : _clusterRanges) {
+		range.x = offset;
+		offset += range.y;
+		range.y = 0;
+	}
+	_lightIndices.resize(offset);
+
+	// Second pass, fill in the index list. Each cluster's count is rebuilt as we go
+	for (size_t ix = 0; ix < _lights.size(); ix++) {
+		const ClusterBounds& bounds = _lightBounds[ix];
+		for (uint32_t z = bounds.Min.z; z <= bounds.Max.z; z++) {
+			for (uint32_t y = bounds.Min.y; y <= bounds.Max.y; y++) {
+				for (uint32_t x = bounds.Min.x; x <= bounds.Max.x; x++) {
+					glm::uvec2& range = _clusterRanges[x + TILES_X * (y + TILES_Y * z)];
+					_lightIndices[range.x + range.y] = static_cast<uint32_t>(ix);
+					range.y++;
+				}
+			}
+		}
+	}
+
+	// Empty buffers can't be bound, so we always upload at least one element
+	static const ClusterLight emptyLight = { glm::vec4(0.0f), glm::vec4(0.0f) };
+	static const uint32_t emptyIndex = 0;
+	if (_lights.size() > 0) {
+		_lightBuffer->UpdateData(_lights.data(), sizeof(ClusterLight), static_cast<uint32_t>(_lights.size()));
+	} else {
+		_lightBuffer->UpdateData(&emptyLight, sizeof(ClusterLight), 1);
+	}
+	_rangeBuffer->UpdateData(_clusterRanges.data(), sizeof(glm::uvec2), CLUSTER_COUNT);
+	if (_lightIndices.size() > 0) {
+		_indexBuffer->UpdateData(_lightIndices.data(), sizeof(uint32_t), static_cast<uint32_t>(_lightIndices.size()));
+	} else {
+		_indexBuffer->UpdateData(&emptyIndex, sizeof(uint32_t), 1);
+	}
+}
+
+void LightClusterGrid::Bind(uint32_t lightSlot, uint32_t rangeSlot, uint32_t indexSlot) const {
+	_lightBuffer->Bind(lightSlot);
+	_rangeBuffer->Bind(rangeSlot);
+	_indexBuffer->Bind(indexSlot);
+}
+
+bool LightClusterGrid::_CalcClusterBounds(const ClusterLight& light, const glm::mat4& projection, float zNear, float zFar, ClusterBounds& result) const {
+	const glm::vec3 center = glm::vec3(light.PositionRadius);
+	const float radius = light.PositionRadius.w;
+
+	// View space looks down -Z, so depth in front of the camera is -z
+	float minDepth = -center.z - radius;
+	float maxDepth = -center.z + radius;
+	if (maxDepth < zNear || minDepth > zFar) {
+		return false;
+	}
+	minDepth = glm::max(minDepth, zNear);
+	maxDepth = glm::min(maxDepth, zFar);
+
+	// Project the corners of the light's bounding box to find it's extents on screen. Corners
+	// behind the near plane are pulled up to it, which only makes the bounds larger
+	glm::vec2 ndcMin = glm::vec2(1.0f);
+	glm::vec2 ndcMax = glm::vec2(-1.0f);
+	for (int ix = 0; ix < 8; ix++) {
+		glm::vec4 corner = glm::vec4(
+			center.x + ((ix & 1) ? radius : -radius),
+			center.y + ((ix & 2) ? radius : -radius),
+			(ix & 4) ? -maxDepth : -minDepth,
+			1.0f
+		);
+		glm::vec4 clip = projection * corner;
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+		ndcMin = glm::min(ndcMin, ndc);
+		ndcMax = glm::max(ndcMax, ndc);
+	}
+	if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f) {
+		return false;
+	}
+
+	// Convert from NDC to tile indices, clamping to the edges of the screen
+	const glm::vec2 tileCount = glm::vec2(TILES_X, TILES_Y);
+	glm::vec2 tileMin = glm::floor((glm::clamp(ndcMin, -1.0f, 1.0f) * 0.5f + 0.5f) * tileCount);
+	glm::vec2 tileMax = glm::floor((glm::clamp(ndcMax, -1.0f, 1.0f) * 0.5f + 0.5f) * tileCount);
+	tileMin = glm::min(tileMin, tileCount - 1.0f);
+	tileMax = glm::min(tileMax, tileCount - 1.0f);
+
+	result.Min = glm::uvec3(glm::uvec2(tileMin), _GetSlice(minDepth));
+	result.Max = glm::uvec3(glm::uvec2(tileMax), _GetSlice(maxDepth));
+	return true;
+}
+
+uint32_t LightClusterGrid::_GetSlice(float depth) const {
+	float slice = std::floor(std::log(depth) * _sliceScaleBias.x + _sliceScaleBias.y);
+	return static_cast<uint32_t>(glm::clamp(slice, 0.0f, static_cast<float>(SLICES - 1)));
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Buffers/ShaderStorageBuffer.h"
+
+/// <summary>
+/// Bins point lights into a grid of clusters that subdivide the camera's view frustum, so that
+/// lighting shaders only need to consider the lights that can actually reach a pixel
+///
+/// The frustum is split into TILES_X by TILES_Y screen space tiles, and SLICES depth slices that
+/// are spaced exponentially between the near and far planes (so clusters stay roughly cube shaped).
+/// Each frame lights are added in view space, then Build assigns each light to every cluster that
+/// it's bounding box overlaps, and uploads the results to shader storage buffers:
+///  - The lights, as a ClusterLight array
+///  - The range of the light index list that belongs to each cluster, as a uvec2 (offset, count)
+///  - The light index list itself
+///
+/// Layout matches fragments/clustered_lights.glsl
+/// </summary>
+class LightClusterGrid {
+public:
+	typedef std::shared_ptr<LightClusterGrid> Sptr;
+
+	static const uint32_t TILES_X = 16;
+	static const uint32_t TILES_Y = 9;
+	static const uint32_t SLICES  = 24;
+	static const uint32_t CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+
+	/// <summary>
+	/// The GPU representation of a light, using std430 layout
+	/// </summary>
+	struct ClusterLight {
+		// View space position in xyz, range in w
+		glm::vec4 PositionRadius;
+		// Color in rgb, intensity in w
+		glm::vec4 ColorIntensity;
+	};
+
+	static inline Sptr Create() {
+		return std::make_shared<LightClusterGrid>();
+	}
+
+	LightClusterGrid();
+	~LightClusterGrid() = default;
+
+	/// <summary>
+	/// Removes all lights from the grid, should be called at the start of each frame
+	/// </summary>
+	void Clear();
+	/// <summary>
+	/// Adds a light to be binned in the next call to Build
+	/// </summary>
+	/// <param name="viewPosition">The position of the light in view space</param>
+	/// <param name="radius">The distance at which the light no longer has any effect</param>
+	/// <param name="color">The color of the light</param>
+	/// <param name="intensity">The light's intensity</param>
+	void AddLight(const glm::vec3& viewPosition, float radius, const glm::vec3& color, float intensity);
+
+	/// <summary>
+	/// Bins all the lights that have been added into clusters, and uploads the results to the GPU
+	/// </summary>
+	/// <param name="projection">The camera's projection matrix</param>
+	/// <param name="zNear">The camera's near plane</param>
+	/// <param name="zFar">The camera's far plane</param>
+	void Build(const glm::mat4& projection, float zNear, float zFar);
+
+	/// <summary>
+	/// Binds the lights, cluster ranges and light indices to the given shader storage slots
+	/// </summary>
+	void Bind(uint32_t lightSlot, uint32_t rangeSlot, uint32_t indexSlot) const;
+
+	/// <summary>
+	/// Gets the scale (x) and bias (y) that convert log(view depth) into a slice index,
+	/// these need to be passed to the lighting shader
+	/// </summary>
+	const glm::vec2& GetSliceScaleBias() const { return _sliceScaleBias; }
+
+	/// <summary>
+	/// Gets the number of lights added since the last clear
+	/// </summary>
+	uint32_t GetLightCount() const { return static_cast<uint32_t>(_lights.size()); }
+	/// <summary>
+	/// Gets the total number of light references across all clusters in the last build,
+	/// divide by CLUSTER_COUNT for the average number of lights per cluster
+	/// </summary>
+	uint32_t GetLightReferenceCount() const { return static_cast<uint32_t>(_lightIndices.size()); }
+
+protected:
+	// Inclusive ranges of clusters that a light overlaps, stored between the counting and filling passes
+	struct ClusterBounds {
+		glm::uvec3 Min;
+		glm::uvec3 Max;
+	};
+
+	std::vector<ClusterLight>  _lights;
+	std::vector<ClusterBounds> _lightBounds;
+	std::vector<glm::uvec2>    _clusterRanges;
+	std::vector<uint32_t>      _lightIndices;
+	glm::vec2                  _sliceScaleBias;
+
+	ShaderStorageBuffer::Sptr  _lightBuffer;
+	ShaderStorageBuffer::Sptr  _rangeBuffer;
+	ShaderStorageBuffer::Sptr  _indexBuffer;
+
+	/// <summary>
+	/// Calculates which clusters a light's bounding box overlaps, returns false if the
+	/// light is entirely outside of the view frustum
+	/// </summary>
+	bool _CalcClusterBounds(const ClusterLight& light, const glm::mat4& projection, float zNear, float zFar, ClusterBounds& result) const;
+	/// <summary>
+	/// Gets the depth slice that contains the given view depth (distance in front of the camera)
+	/// </summary>
+	uint32_t _GetSlice(float depth) const;
+};
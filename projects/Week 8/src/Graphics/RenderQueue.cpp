@@ -0,0 +1,83 @@
+#include "Graphics/RenderQueue.h"
+#include <algorithm>
+
+RenderQueue::RenderQueue() :
+	_entries(std::vector<Entry>()),
+	_scratch(std::vector<Entry>())
+{ }
+
+uint64_t RenderQueue::MakeKey(uint32_t shaderId, uint32_t materialId, uint32_t vaoId, float depth) {
+	// Quantize the depth into the bits we have available
+	const uint64_t depthMax = (1ull << DEPTH_BITS) - 1;
+	float clamped = std::clamp(depth, 0.0f, 1.0f);
+	uint64_t depthBits = static_cast<uint64_t>(clamped * static_cast<float>(depthMax));
+
+	uint64_t result = 0;
+	result |= (static_cast<uint64_t>(shaderId)   & ((1ull << SHADER_BITS) - 1));
+	result <<= MATERIAL_BITS;
+	result |= (static_cast<uint64_t>(materialId) & ((1ull << MATERIAL_BITS) - 1));
+	result <<= VAO_BITS;
+	result |= (static_cast<uint64_t>(vaoId)      & ((1ull << VAO_BITS) - 1));
+	result <<= DEPTH_BITS;
+	result |= depthBits;
+	return result;
+}
+
+void RenderQueue::Clear() {
+	_entries.clear();
+}
+
+void RenderQueue::Push(uint64_t key, uint32_t index) {
+	_entries.push_back({ key, index });
+}
+
+void RenderQueue::Sort() {
+	const size_t count = _entries.size();
+	if (count < 2) return;
+
+	_scratch.resize(count);
+
+	// We'll do an LSD radix sort with 8 bit digits, so 8 passes over the keys
+	// First we build all the histograms in a single pass over the data
+	uint32_t histograms[8][256] = { };
+	for (const Entry& entry : _entries) {
+		for (int pass = 0; pass < 8; pass++) {
+			histograms[pass][(entry.Key >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	Entry* src = _entries.data();
+	Entry* dst = _scratch.data();
+
+	for (int pass = 0; pass < 8; pass++) {
+		uint32_t* histogram = histograms[pass];
+
+		// If every key has the same digit for this pass, there's nothing to do. This is
+		// very common, since most scenes use far less than the full range of IDs
+		uint32_t firstDigit = (src[0].Key >> (pass * 8)) & 0xFF;
+		if (histogram[firstDigit] == count) {
+			continue;
+		}
+
+		// Convert the counts into starting offsets for each bucket
+		uint32_t offset = 0;
+		for (int ix = 0; ix < 256; ix++) {
+			uint32_t bucketSize = histogram[ix];
+			histogram[ix] = offset;
+			offset += bucketSize;
+		}
+
+		// Scatter the entries into their buckets, this keeps the sort stable
+		for (size_t ix = 0; ix < count; ix++) {
+			uint32_t digit = (src[ix].Key >> (pass * 8)) & 0xFF;
+			dst[histogram[digit]++] = src[ix];
+		}
+
+		std::swap(src, dst);
+	}
+
+	// If we had an odd number of passes, the result is sitting in our scratch buffer
+	if (src != _entries.data()) {
+		_entries.swap(_scratch);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// A render queue stores a list of packed 64 bit sort keys, each with an index into
+/// some external array of draw data (for instance, a list of render components)
+///
+/// Keys are sorted with an LSD radix sort, so that draws that share the same state end
+/// up next to each other and the renderer can skip redundant shader, material and VAO
+/// changes
+/// </summary>
+class RenderQueue {
+public:
+	/// <summary>
+	/// A single entry in the queue, we keep these small so that sorting
+	/// only needs to shuffle 16 bytes per draw
+	/// </summary>
+	struct Entry {
+		uint64_t Key;
+		uint32_t Index;
+	};
+
+	// Number of bits allocated to each section of the sort key, from most to least significant
+	static const uint32_t SHADER_BITS   = 10;
+	static const uint32_t MATERIAL_BITS = 14;
+	static const uint32_t VAO_BITS      = 16;
+	static const uint32_t DEPTH_BITS    = 24;
+
+	RenderQueue();
+	~RenderQueue() = default;
+
+	/// <summary>
+	/// Packs the given state IDs into a single sort key. IDs that exceed the number of bits
+	/// available to them are truncated, which will only affect how well draws are grouped
+	/// </summary>
+	/// <param name="shaderId">The ID of the shader program used by the draw</param>
+	/// <param name="materialId">The ID of the material used by the draw</param>
+	/// <param name="vaoId">The ID of the vertex array used by the draw</param>
+	/// <param name="depth">The normalized depth of the draw in the 0-1 range, smaller values are drawn first</param>
+	/// <returns>A key that can be pushed into the queue</returns>
+	static uint64_t MakeKey(uint32_t shaderId, uint32_t materialId, uint32_t vaoId, float depth);
+
+	/// <summary>
+	/// Removes all entries from the queue, keeping the allocated storage for the next frame
+	/// </summary>
+	void Clear();
+	/// <summary>
+	/// Adds a new entry to the end of the queue
+	/// </summary>
+	/// <param name="key">The sort key for the entry, see MakeKey</param>
+	/// <param name="index">The index of the draw data that this entry refers to</param>
+	void Push(uint64_t key, uint32_t index);
+	/// <summary>
+	/// Sorts all entries in the queue by their key in ascending order. The sort is stable,
+	/// so entries with equal keys will stay in the order they were pushed
+	/// </summary>
+	void Sort();
+
+	/// <summary>
+	/// Gets the number of entries in the queue
+	/// </summary>
+	size_t Size() const { return _entries.size(); }
+	/// <summary>
+	/// Gets the entries in the queue, will only be in sorted order after calling Sort
+	/// </summary>
+	const std::vector<Entry>& GetEntries() const { return _entries; }
+
+protected:
+	std::vector<Entry> _entries;
+	// Scratch storage for the radix sort, kept around to avoid re-allocating every frame
+	std::vector<Entry> _scratch;
+};
@@ -0,0 +1,91 @@
+#include "Graphics/RenderTargetPool.h"
+#include <algorithm>
+
+RenderTargetPool::RenderTargetPool() :
+	_targets(std::vector<PooledTarget>()),
+	_frame(0),
+	_evictUnused(false)
+{ }
+
+Framebuffer::Sptr RenderTargetPool::Acquire(const glm::ivec2& size, RenderTargetType format) {
+	// We only ever have a handful of targets, so a linear search is plenty fast
+	for (PooledTarget& target : _targets) {
+		if (!target.InUse && target.Format == format && target.Buffer->GetSize() == size) {
+			target.InUse = true;
+			target.LastUsedFrame = _frame;
+			return target.Buffer;
+		}
+	}
+
+	FramebufferDescriptor descriptor = FramebufferDescriptor();
+	descriptor.Width  = size.x;
+	descriptor.Height = size.y;
+	descriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(format);
+
+	PooledTarget target;
+	target.Buffer = std::make_shared<Framebuffer>(descriptor);
+	target.Format = format;
+	target.InUse = true;
+	target.LastUsedFrame = _frame;
+	_targets.push_back(target);
+
+	return target.Buffer;
+}
+
+void RenderTargetPool::Release(const Framebuffer::Sptr& target) {
+	for (PooledTarget& pooled : _targets) {
+		if (pooled.Buffer == target) {
+			pooled.InUse = false;
+			return;
+		}
+	}
+}
+
+void RenderTargetPool::EndFrame() {
+	for (PooledTarget& target : _targets) {
+		target.InUse = false;
+	}
+
+	// Anything that hasn't been asked for in a while is no longer needed (ex: the effect was disabled). After
+	// a resize, anything that wasn't asked for this frame no longer matches the sizes passes are using
+	_targets.erase(std::remove_if(_targets.begin(), _targets.end(), [&](const PooledTarget& target) {
+		return _frame - target.LastUsedFrame > MAX_IDLE_FRAMES || (_evictUnused && target.LastUsedFrame != _frame);
+	}), _targets.end());
+
+	_evictUnused = false;
+	_frame++;
+}
+
+void RenderTargetPool::Resize(const glm::ivec2& oldSize, const glm::ivec2& newSize) {
+	if (oldSize.x * oldSize.y == 0) {
+		// We can't work out the scale of each target, so let them be re-created at the right size
+		Clear();
+		return;
+	}
+
+	const glm::vec2 scale = glm::vec2(newSize) / glm::vec2(oldSize);
+	for (PooledTarget& target : _targets) {
+		glm::ivec2 size = glm::max(glm::ivec2(glm::round(glm::vec2(target.Buffer->GetSize()) * scale)), glm::ivec2(1));
+		target.Buffer->Resize(size);
+	}
+
+	// Passes work out their own sizes (ex: halving for each downsample), which won't always land on
+	// the same size as our rounding, so anything that isn't re-used next frame is dropped
+	_evictUnused = true;
+}
+
+void RenderTargetPool::Clear() {
+	_targets.clear();
+}
+
+uint32_t RenderTargetPool::GetTargetCount() const {
+	return static_cast<uint32_t>(_targets.size());
+}
+
+size_t RenderTargetPool::GetMemoryUsage() const {
+	size_t result = 0;
+	for (const PooledTarget& target : _targets) {
+		result += static_cast<size_t>(target.Buffer->GetWidth()) * target.Buffer->GetHeight() * GetRenderTargetTexelSize(target.Format);
+	}
+	return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Framebuffer.h"
+
+/// <summary>
+/// Hands out framebuffers with a single color target for transient passes such as post processing,
+/// re-using targets with a matching size and format instead of every pass owning it's own
+///
+/// Targets should be released as soon as the pass that reads them has finished, so that later passes
+/// can re-use them. A chain of passes that releases it's input after each pass will only ever need two
+/// targets, ping-ponging between them. Targets that go unused for MAX_IDLE_FRAMES are destroyed
+/// </summary>
+class RenderTargetPool {
+public:
+	typedef std::shared_ptr<RenderTargetPool> Sptr;
+
+	// The number of frames a target can go unused before we destroy it
+	static const uint32_t MAX_IDLE_FRAMES = 120;
+
+	static inline Sptr Create() {
+		return std::make_shared<RenderTargetPool>();
+	}
+
+	RenderTargetPool();
+	~RenderTargetPool() = default;
+
+	/// <summary>
+	/// Gets a free target with the given size and format, creating one if none are available.
+	/// The target is reserved until it is passed to Release, or until the end of the frame
+	/// </summary>
+	/// <param name="size">The size of the target in pixels</param>
+	/// <param name="format">The format for the target's color attachment</param>
+	Framebuffer::Sptr Acquire(const glm::ivec2& size, RenderTargetType format);
+	/// <summary>
+	/// Returns a target to the pool so that it can be handed out again
+	/// </summary>
+	void Release(const Framebuffer::Sptr& target);
+
+	/// <summary>
+	/// Releases any targets that are still reserved, and destroys targets that have been idle
+	/// for too long. Should be called once all passes for the frame have finished
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Resizes all pooled targets in proportion to a change in the screen size, so that scaled
+	/// targets keep their scale. Targets that aren't acquired in the next frame are destroyed at
+	/// the end of it, since their size no longer matches what passes are asking for
+	/// </summary>
+	void Resize(const glm::ivec2& oldSize, const glm::ivec2& newSize);
+	/// <summary>
+	/// Destroys all targets in the pool
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Gets the number of targets that the pool is holding on to
+	/// </summary>
+	uint32_t GetTargetCount() const;
+	/// <summary>
+	/// Gets the approximate number of bytes used by the pooled targets
+	/// </summary>
+	size_t GetMemoryUsage() const;
+
+protected:
+	struct PooledTarget {
+		Framebuffer::Sptr Buffer;
+		RenderTargetType  Format;
+		bool              InUse;
+		uint32_t          LastUsedFrame;
+	};
+
+	std::vector<PooledTarget> _targets;
+	uint32_t                  _frame;
+	// Set by Resize, destroys any targets that aren't used in the next frame
+	bool                      _evictUnused;
+};
@@ -3,20 +3,90 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
 
+namespace {
+	// Bump this whenever the layout of the cache files changes
+	const uint32_t BINARY_CACHE_VERSION = 1;
+	const uint32_t BINARY_CACHE_MAGIC   = 0x43425053; // "SPBC"
+	// Program binaries are typically well under a megabyte, anything larger than this is a corrupt header
+	const uint32_t MAX_BINARY_CACHE_SIZE = 64 * 1024 * 1024;
+
+	// Written at the start of every file in the program binary cache
+	struct BinaryCacheHeader {
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t SourceHash;
+		// Hash of the GL vendor, renderer and version strings, binaries are only valid for the driver that made them
+		uint64_t DriverHash;
+		uint32_t BinaryFormat;
+		uint32_t BinarySize;
+		// How long the program took to compile and link from source
+		float    CompileMs;
+		uint32_t Reserved;
+	};
+
+	// 64 bit FNV-1a, we only need to detect changes, not resist collisions on purpose
+	uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t ix = 0; ix < size; ix++) {
+			hash ^= bytes[ix];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint64_t GetDriverHash() {
+		static uint64_t result = 0;
+		if (result == 0) {
+			for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+				const char* value = reinterpret_cast<const char*>(glGetString(name));
+				if (value != nullptr) {
+					result = HashBytes(value, strlen(value), result == 0 ? 14695981039346656037ull : result);
+				}
+			}
+		}
+		return result;
+	}
+
+	// Some drivers don't support any binary formats, in which case there's no point in trying
+	bool AreBinariesSupported() {
+		static int formatCount = -1;
+		if (formatCount == -1) {
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+			if (formatCount == 0) {
+				LOG_WARN("Driver does not support program binaries, shader cache disabled");
+			}
+		}
+		return formatCount > 0;
+	}
+}
+
+bool ShaderProgram::__binaryCacheEnabled = true;
+std::string ShaderProgram::__binaryCachePath = "cache/shaders/";
+ShaderProgram::BinaryCacheStats ShaderProgram::__binaryCacheStats = { 0, 0, 0.0, 0.0, 0.0 };
+
 ShaderProgram::ShaderProgram() : 
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_varyingsInterleaved(true),
+	_instancedVariant(nullptr),
+	_instancedVariantResolved(false)
 {
 	_rendererId = glCreateProgram();
 }
 
 ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths) :
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_varyingsInterleaved(true),
+	_instancedVariant(nullptr),
+	_instancedVariantResolved(false)
 {
 	_rendererId = glCreateProgram();
 	for (auto& [type, path] : filePaths) {
@@ -33,11 +103,51 @@ ShaderProgram::~ShaderProgram() {
 }
 
 bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
+	if (source == nullptr || source[0] == '\0') {
+		LOG_WARN("Ignoring empty source for {} shader part", ~type);
+		return false;
+	}
+
+	// If we're overwriting, warn before we store
+	if (_sources.find(type) != _sources.end()) {
+		LOG_WARN("Another shader has been attached to this slot, overwriting");
+	}
+	_sources[type] = source;
+
+	// Store info about where we got this data from
+	_fileSourceMap[type].IsFilePath = false;
+	_fileSourceMap[type].Source = source;
+
+	return true;
+}
+
+bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
+	// Make sure that the file exists before we try reading
+	if (std::filesystem::exists(path)) {
+		// Load the source from the file, using our helper that will
+		// resolve #include directives
+		std::string source = FileHelpers::ReadResolveIncludes(path);
+		// Pass off to LoadShaderPart
+		bool result =  LoadShaderPart(source.c_str(), type);
+		_fileSourceMap[type].IsFilePath = true;
+		_fileSourceMap[type].Source = path;
+		if (result == false) {
+			LOG_ERROR("Source File: {}", path);
+		}
+		return result; 
+	} else {
+		LOG_WARN("Could not open file at \"{}\"", path);
+		return false;
+	}
+}
+
+GLuint ShaderProgram::_CompilePart(ShaderPartType type, const std::string& source) {
 	// Creates a new shader part (VS, FS, GS, etc...)
 	GLuint handle = glCreateShader((GLenum)type);
 
 	// Load the GLSL source and compile it
-	glShaderSource(handle, 1, &source, nullptr);
+	const char* sourcePtr = source.c_str();
+	glShaderSource(handle, 1, &sourcePtr, nullptr);
 	glCompileShader(handle);
 
 	// Get the compilation status for the shader part
@@ -57,76 +167,80 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 
 		// Dump error log
 		LOG_ERROR("Failed to compile shader part:\n{}", log);
+		if (_fileSourceMap[type].IsFilePath) {
+			LOG_ERROR("Source File: {}", _fileSourceMap[type].Source);
+		}
 
 		// Clean up our log memory
 		delete[] log;
 
 		// Delete the broken shader result
 		glDeleteShader(handle);
-		handle = 0;
-
-		return false;
+		return 0;
 	}
 
-	// If we're overwriting, warn and clean up the old program before we store
-	if (_handles[type] != 0) {
-		LOG_WARN("Another shader has been attached to this slot, overwriting");
-		glDeleteShader(_handles[type]);
+	if (_fileSourceMap[type].IsFilePath) {
+		glObjectLabel(GL_SHADER, handle, -1, _fileSourceMap[type].Source.c_str());
 	}
-	_handles[type] = handle;
-
-	// Store info about where we got this data from
-	_fileSourceMap[type].IsFilePath = false;
-	_fileSourceMap[type].Source = source;
-
-	return status != GL_FALSE;
+	return handle;
 }
 
-bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
-	// Make sure that the file exists before we try reading
-	if (std::filesystem::exists(path)) {
-		// Load the source from the file, using our helper that will
-		// resolve #include directives
-		std::string source = FileHelpers::ReadResolveIncludes(path);
-		// Pass off to LoadShaderPart
-		bool result =  LoadShaderPart(source.c_str(), type);
-		_fileSourceMap[type].IsFilePath = true;
-		_fileSourceMap[type].Source = path;
-		if (result == false) {
-			LOG_ERROR("Source File: {}", path);
+bool ShaderProgram::Link() {
+	using Clock = std::chrono::high_resolution_clock;
+	auto start = Clock::now();
+
+	// See if we've built this exact program before
+	const bool useCache = __binaryCacheEnabled && AreBinariesSupported();
+	const uint64_t hash = useCache ? _HashSources() : 0;
+	std::string cachePath;
+	if (useCache) {
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(hash));
+		cachePath = __binaryCachePath + fileName;
+
+		float originalMs = 0.0f;
+		if (_LoadBinary(cachePath, hash, originalMs)) {
+			double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			__binaryCacheStats.Hits++;
+			__binaryCacheStats.LoadMs  += loadMs;
+			__binaryCacheStats.SavedMs += std::max(0.0, originalMs - loadMs);
+			LOG_INFO("Shader cache hit for {} ({:.2f}ms, saved ~{:.2f}ms)", _GetLogName(), loadMs, std::max(0.0, originalMs - loadMs));
+
+			_sources.clear();
+			_Introspect();
+			return true;
 		}
-		glObjectLabel(GL_SHADER, _handles[type], -1, path);
-		return result; 
-	} else {
-		LOG_WARN("Could not open file at \"{}\"", path);
-		return false;
 	}
-}
-
-bool ShaderProgram::Link() {
 
 	LOG_TRACE("Starting shader link:");
-	
-	// Attach all our shaders
-	for (auto& [type, id] : _handles) {
-		if (id != 0) {
-			glAttachShader(_rendererId, id);
+
+	// Compile and attach all our shaders
+	std::vector<GLuint> handles;
+	handles.reserve(_sources.size());
+	for (auto& [type, source] : _sources) {
+		GLuint handle = _CompilePart(type, source);
+		if (handle != 0) {
+			glAttachShader(_rendererId, handle);
+			handles.push_back(handle);
 			LOG_TRACE("\t{} - {}", ~type, _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
 		}
 	}
 
+	// Let the driver know we want to read the binary back out
+	if (useCache) {
+		glProgramParameteri(_rendererId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
 	// Perform linking
 	glLinkProgram(_rendererId);
 
 	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
-	for (auto& [type, id] : _handles) { 
-		if (id != 0) {
-			glDetachShader(_rendererId, id);
-			glDeleteShader(id);
-		}
+	for (GLuint handle : handles) { 
+		glDetachShader(_rendererId, handle);
+		glDeleteShader(handle);
 	}
-	// Remove all the handles so we don't accidentally use them
-	_handles.clear();
+	// Remove all the sources so we don't accidentally link them again
+	_sources.clear();
 
 	GLint status = 0;
 	glGetProgramiv(_rendererId, GL_LINK_STATUS, &status);
@@ -149,6 +263,16 @@ bool ShaderProgram::Link() {
 		}
 	} else {
 		LOG_TRACE("Linking complete, starting introspection");
+
+		// Only successfully linked programs go in the cache. Note that this includes the time it takes
+		// for glLinkProgram to return, some drivers defer the actual work until the program is first used
+		if (useCache) {
+			float compileMs = static_cast<float>(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+			__binaryCacheStats.Misses++;
+			__binaryCacheStats.CompileMs += compileMs;
+			LOG_INFO("Shader cache miss for {} (compiled in {:.2f}ms)", _GetLogName(), compileMs);
+			_SaveBinary(cachePath, hash, compileMs);
+		}
 	}
 
 	// Perform our uniform introspection to see what uniforms are in the shader
@@ -157,6 +281,146 @@ bool ShaderProgram::Link() {
 	return status != GL_FALSE;
 }
 
+uint64_t ShaderProgram::_HashSources() const {
+	// unordered_map has no set order, so hash the stages in order of their enum value
+	std::vector<std::pair<ShaderPartType, const std::string*>> stages;
+	stages.reserve(_sources.size());
+	for (auto& [type, source] : _sources) {
+		stages.push_back({ type, &source });
+	}
+	std::sort(stages.begin(), stages.end(), [](const auto& a, const auto& b) { return (GLenum)a.first < (GLenum)b.first; });
+
+	uint64_t hash = HashBytes(&BINARY_CACHE_VERSION, sizeof(uint32_t));
+	for (auto& [type, source] : stages) {
+		GLenum stage = (GLenum)type;
+		hash = HashBytes(&stage, sizeof(GLenum), hash);
+		hash = HashBytes(source->data(), source->size(), hash);
+	}
+	for (const std::string& varying : _varyings) {
+		hash = HashBytes(varying.c_str(), varying.size() + 1, hash);
+	}
+	hash = HashBytes(&_varyingsInterleaved, sizeof(bool), hash);
+	return hash;
+}
+
+bool ShaderProgram::_LoadBinary(const std::string& path, uint64_t hash, float& compileMs) {
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	BinaryCacheHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(BinaryCacheHeader)) ||
+		header.Magic != BINARY_CACHE_MAGIC || header.Version != BINARY_CACHE_VERSION || header.SourceHash != hash) {
+		LOG_WARN("Ignoring invalid shader cache file \"{}\"", path);
+		return false;
+	}
+	// Driver updates and GPU changes invalidate binaries, we'll overwrite it once we've recompiled
+	if (header.DriverHash != GetDriverHash()) {
+		LOG_INFO("Shader cache for {} was built by a different driver, recompiling", _GetLogName());
+		return false;
+	}
+
+	// Make sure the size is sane before we allocate anything for it, a damaged file could claim to be gigabytes
+	const std::streamoff headerEnd = file.tellg();
+	file.seekg(0, std::ios::end);
+	const std::streamoff remaining = file.tellg() - headerEnd;
+	file.seekg(headerEnd, std::ios::beg);
+	if (header.BinarySize == 0 || header.BinarySize > MAX_BINARY_CACHE_SIZE || static_cast<std::streamoff>(header.BinarySize) > remaining) {
+		LOG_WARN("Shader cache file \"{}\" has an invalid binary size ({} bytes, {} in file), discarding it", path, header.BinarySize, remaining);
+		file.close();
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		return false;
+	}
+
+	std::vector<char> binary(header.BinarySize);
+	if (!file.read(binary.data(), header.BinarySize)) {
+		LOG_WARN("Shader cache file \"{}\" is truncated", path);
+		return false;
+	}
+
+	// The driver is still allowed to reject the binary, in which case the program is left unlinked and we can
+	// fall back to compiling it from source
+	glProgramBinary(_rendererId, header.BinaryFormat, binary.data(), header.BinarySize);
+	GLint status = 0;
+	glGetProgramiv(_rendererId, GL_LINK_STATUS, &status);
+	if (status == GL_FALSE) {
+		LOG_INFO("Driver rejected cached binary for {}, recompiling", _GetLogName());
+		return false;
+	}
+
+	compileMs = header.CompileMs;
+	return true;
+}
+
+void ShaderProgram::_SaveBinary(const std::string& path, uint64_t hash, float compileMs) {
+	GLint length = 0;
+	glGetProgramiv(_rendererId, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0 || static_cast<uint32_t>(length) > MAX_BINARY_CACHE_SIZE) {
+		return;
+	}
+
+	BinaryCacheHeader header;
+	header.Magic        = BINARY_CACHE_MAGIC;
+	header.Version      = BINARY_CACHE_VERSION;
+	header.SourceHash   = hash;
+	header.DriverHash   = GetDriverHash();
+	header.BinaryFormat = 0;
+	header.BinarySize   = 0;
+	header.CompileMs    = compileMs;
+	header.Reserved     = 0;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(_rendererId, length, &length, &format, binary.data());
+	header.BinaryFormat = format;
+	header.BinarySize   = static_cast<uint32_t>(length);
+
+	std::error_code error;
+	std::filesystem::create_directories(__binaryCachePath, error);
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file) {
+		LOG_WARN("Failed to write shader cache file \"{}\"", path);
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryCacheHeader));
+	file.write(binary.data(), header.BinarySize);
+}
+
+std::string ShaderProgram::_GetLogName() const {
+	if (!_debugName.empty()) {
+		return "\"" + _debugName + "\"";
+	}
+	// Resources get their names after they're created, so fall back to the files we loaded from
+	std::string result;
+	for (auto& [type, source] : _fileSourceMap) {
+		if (source.IsFilePath) {
+			result += result.empty() ? source.Source : ", " + source.Source;
+		}
+	}
+	return result.empty() ? "<from source>" : "[" + result + "]";
+}
+
+void ShaderProgram::SetBinaryCacheEnabled(bool value) {
+	__binaryCacheEnabled = value;
+}
+
+bool ShaderProgram::IsBinaryCacheEnabled() {
+	return __binaryCacheEnabled;
+}
+
+void ShaderProgram::SetBinaryCachePath(const std::string& path) {
+	__binaryCachePath = path;
+	if (!__binaryCachePath.empty() && __binaryCachePath.back() != '/' && __binaryCachePath.back() != '\\') {
+		__binaryCachePath += '/';
+	}
+}
+
+const ShaderProgram::BinaryCacheStats& ShaderProgram::GetBinaryCacheStats() {
+	return __binaryCacheStats;
+}
+
 void ShaderProgram::Bind() {
 	// Simply calls glUseProgram with our shader handle
 	glUseProgram(_rendererId);
@@ -167,6 +431,65 @@ void ShaderProgram::Unbind() {
 	glUseProgram(0);
 }
 
+const ShaderProgram::Sptr& ShaderProgram::GetInstancedVariant() {
+	// We only ever try to build the variant once, if it fails we remember that it's not supported
+	if (_instancedVariantResolved) {
+		return _instancedVariant;
+	}
+	_instancedVariantResolved = true;
+
+	// Load the source for all our stages, resolving includes for the ones that came from files
+	std::unordered_map<ShaderPartType, std::string> sources;
+	for (auto& [type, source] : _fileSourceMap) {
+		sources[type] = source.IsFilePath ? FileHelpers::ReadResolveIncludes(source.Source) : source.Source;
+	}
+
+	// Only vertex shaders that know about the INSTANCED define (usually by including vs_common.glsl) can be instanced
+	auto vertexSource = sources.find(ShaderPartType::Vertex);
+	if (vertexSource == sources.end() || vertexSource->second.find("INSTANCED") == std::string::npos) {
+		return _instancedVariant;
+	}
+
+	// The define needs to go after the #version directive, or at the very start if there isn't one
+	std::string& source = vertexSource->second;
+	size_t insertPos = 0;
+	size_t versionPos = source.find("#version");
+	if (versionPos != std::string::npos) {
+		insertPos = source.find('\n', versionPos);
+		insertPos = insertPos == std::string::npos ? source.size() : insertPos + 1;
+	}
+	source.insert(insertPos, "#define INSTANCED\n");
+
+	Sptr result = std::make_shared<ShaderProgram>();
+	result->SetDebugName(_debugName + " (instanced)");
+	for (auto& [type, partSource] : sources) {
+		if (!result->LoadShaderPart(partSource.c_str(), type)) {
+			LOG_WARN("Failed to compile instanced variant of shader \"{}\"", _debugName);
+			return _instancedVariant;
+		}
+	}
+	if (!result->Link()) {
+		LOG_WARN("Failed to link instanced variant of shader \"{}\"", _debugName);
+		return _instancedVariant;
+	}
+
+	// Materials set their uniforms by location, so the variant needs to match our layout exactly
+	for (auto& [name, uniform] : _uniforms) {
+		// Failed lookups by name leave placeholder entries in the map, we can skip them
+		if (uniform.Location == -1) {
+			continue;
+		}
+		UniformInfo other;
+		if (!result->FindUniform(name, &other) || other.Location != uniform.Location || other.Type != uniform.Type) {
+			LOG_WARN("Uniform layout of instanced variant of shader \"{}\" does not match, instancing disabled", _debugName);
+			return _instancedVariant;
+		}
+	}
+
+	_instancedVariant = result;
+	return _instancedVariant;
+}
+
 void ShaderProgram::SetUniformMatrix(int location, const glm::mat3* value, int count, bool transposed) {
 	glProgramUniformMatrix3fv(_rendererId, location, count, transposed, glm::value_ptr(*value));
 }
@@ -404,6 +727,12 @@ void ShaderProgram::_IntrospectUniforms() {
 		// Store the uniform info
 		_uniforms[e.Name] = e;
 	}
+
+	// The renderer sets these whenever the shader or mesh changes, so look them up once here
+	auto packedNormals = _uniforms.find("u_PackedNormals");
+	_vertexFormatUniforms.PackedNormals = packedNormals == _uniforms.end() ? -1 : packedNormals->second.Location;
+	auto positionTransform = _uniforms.find("u_PositionTransform");
+	_vertexFormatUniforms.PositionTransform = positionTransform == _uniforms.end() ? -1 : positionTransform->second.Location;
 }
 
 void ShaderProgram::_IntrospectUnifromBlocks() {
@@ -520,5 +849,7 @@ GlResourceType ShaderProgram::GetResourceClass() const {
 
 void ShaderProgram::RegisterVaryings(const char* const* names, int numVaryings, bool interleaved /*= true*/)
 {
+	_varyings.assign(names, names + numVaryings);
+	_varyingsInterleaved = interleaved;
 	glTransformFeedbackVaryings(_rendererId, numVaryings, names, interleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
 }
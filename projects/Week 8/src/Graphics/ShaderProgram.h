@@ -57,6 +57,19 @@ public:
 
 		std::vector<UniformInfo> SubUniforms;
 	};
+
+	/// <summary>
+	/// Locations of the uniforms that the renderer sets to describe a mesh's vertex format
+	/// (see vs_common.glsl), resolved once during introspection. -1 if the shader doesn't use them
+	/// </summary>
+	struct VertexFormatUniforms {
+		int PackedNormals;
+		int PositionTransform;
+
+		VertexFormatUniforms() :
+			PackedNormals(-1),
+			PositionTransform(-1) {}
+	};
 	
 public:
 	/// <summary>
@@ -69,8 +82,25 @@ public:
 	// Note, we don't need to make this virtual since this class is marked final (basically it can't be used as a base class)
 	~ShaderProgram();
 
+	/// <summary>
+	/// Stores statistics about the program binary cache since the application started
+	/// </summary>
+	struct BinaryCacheStats {
+		uint32_t Hits;
+		uint32_t Misses;
+		// Time spent compiling and linking programs that weren't in the cache
+		double   CompileMs;
+		// Time spent loading programs from the cache
+		double   LoadMs;
+		// How long the cached programs took to compile when they were first built, minus the time it took to load them
+		double   SavedMs;
+	};
+
 	/// <summary>
 	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader)
+	/// 
+	/// Compilation is deferred until Link, so that we can skip it entirely if there is a cached program
+	/// binary for the same source. Compile errors are reported when linking
 	/// </summary>
 	/// <param name="source">The source code of the shader to load</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
@@ -93,11 +123,32 @@ public:
 	void RegisterVaryings(const char* const* names, int numVaryings, bool interleaved = true);
 
 	/// <summary>
-	/// Links the vertex and fragment shader, and allows this shader program to be used
+	/// Compiles and links all the loaded shader stages, and allows this shader program to be used
+	/// 
+	/// If the binary cache is enabled, the fully resolved source of all stages is hashed and used to look
+	/// up a program binary from a previous run. If there's no binary or the driver rejects it, the program is
+	/// compiled from source and the result is written back to the cache
 	/// </summary>
 	/// <returns>True if the linking was successful, false if otherwise</returns>
 	bool Link();
 
+	/// <summary>
+	/// Enables or disables the on-disk program binary cache, enabled by default
+	/// </summary>
+	static void SetBinaryCacheEnabled(bool value);
+	/// <summary>
+	/// Returns true if shader programs will be loaded from and saved to the program binary cache
+	/// </summary>
+	static bool IsBinaryCacheEnabled();
+	/// <summary>
+	/// Sets the directory that cached program binaries are stored in, default is "cache/shaders/"
+	/// </summary>
+	static void SetBinaryCachePath(const std::string& path);
+	/// <summary>
+	/// Gets the hit/miss counts and timings for the program binary cache
+	/// </summary>
+	static const BinaryCacheStats& GetBinaryCacheStats();
+
 	/// <summary>
 	/// Binds this shader for use
 	/// </summary>
@@ -108,6 +159,15 @@ public:
 	static void Unbind();
 
 	const std::unordered_map<std::string, UniformInfo>& GetUniforms() const { return _uniforms; }
+	const VertexFormatUniforms& GetVertexFormatUniforms() const { return _vertexFormatUniforms; }
+
+	/// <summary>
+	/// Gets a version of this shader that was compiled with INSTANCED defined in the vertex stage,
+	/// which pulls the per-object matrices from instanced vertex attributes (see vs_common.glsl).
+	/// The variant is compiled the first time this is called
+	/// </summary>
+	/// <returns>The instanced variant, or nullptr if this shader does not support instancing</returns>
+	const Sptr& GetInstancedVariant();
 
 	// Inherited from IGraphicsResource
 
@@ -177,13 +237,17 @@ public:
 	void BindUniformBlockToSlot(const std::string& name, int uboSlot);
 
 protected:
-	// Stores all the handles to our shaders until we
+	// Stores the resolved source for each stage until we
 	// are ready to compile them into a program
-	std::unordered_map<ShaderPartType, int> _handles;
+	std::unordered_map<ShaderPartType, std::string> _sources;
+	// Transform feedback outputs, these change the linked program so they are part of the cache key
+	std::vector<std::string> _varyings;
+	bool                     _varyingsInterleaved;
 	
 	// Map access to look up uniform locations and blocks
 	std::unordered_map<std::string, UniformInfo> _uniforms;
 	std::unordered_map<std::string, UniformBlockInfo> _uniformBlocks;
+	VertexFormatUniforms _vertexFormatUniforms;
 
 	// Stores information about the source of our shader parts
 	// EX: if a VS shader is loaded from a file, will contain
@@ -194,6 +258,10 @@ protected:
 	};
 	std::unordered_map<ShaderPartType, ShaderSource> _fileSourceMap;
 
+	// The instanced version of this shader, and whether we've tried to create it yet
+	Sptr _instancedVariant;
+	bool _instancedVariantResolved;
+
 	/// <summary>
 	/// Performs program introspection, where we examine the uniforms that
 	/// the program contains
@@ -210,4 +278,30 @@ protected:
 	void _IntrospectUnifromBlocks();
 
 	int __GetUniformLocation(const std::string& name);
+
+	/// <summary>
+	/// Compiles a single shader stage from our stored source, returning the handle or 0 if it failed
+	/// </summary>
+	GLuint _CompilePart(ShaderPartType type, const std::string& source);
+	/// <summary>
+	/// Hashes the source of all stages and the transform feedback varyings, this is the key for the binary cache
+	/// </summary>
+	uint64_t _HashSources() const;
+	/// <summary>
+	/// Attempts to load the program from the binary cache, returning true on success. On success,
+	/// compileMs is set to how long the program took to build when it was added to the cache
+	/// </summary>
+	bool _LoadBinary(const std::string& path, uint64_t hash, float& compileMs);
+	/// <summary>
+	/// Writes the linked program to the binary cache
+	/// </summary>
+	void _SaveBinary(const std::string& path, uint64_t hash, float compileMs);
+	/// <summary>
+	/// Gets a name for this shader to use in log messages
+	/// </summary>
+	std::string _GetLogName() const;
+
+	static bool             __binaryCacheEnabled;
+	static std::string      __binaryCachePath;
+	static BinaryCacheStats __binaryCacheStats;
 };
\ No newline at end of file
@@ -47,14 +47,7 @@ nlohmann::json Texture2D::ToJson() const {
 
 Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 {
-	Texture2DDescription descr = Texture2DDescription();
-	descr.Filename = data["filename"];
-	descr.HorizontalWrap = JsonParseEnum(WrapMode, data, "wrap_s", WrapMode::ClampToEdge);
-	descr.VerticalWrap   = JsonParseEnum(WrapMode, data, "wrap_t", WrapMode::ClampToEdge);
-	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
-	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
-	descr.MaxAnisotropic      = JsonGet(data, "anisotropic", 0.0f);
-	descr.GenerateMipMaps     = JsonGet(data, "generate_mipmaps", false);
+	Texture2DDescription descr = _ParseDescription(data);
 
 	Texture2D::Sptr result = std::make_shared<Texture2D>(descr);
 
@@ -73,6 +66,46 @@ Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 	return result;
 }
 
+std::function<Texture2D::Sptr()> Texture2D::DecodeFromJson(const nlohmann::json& data)
+{
+	Texture2DDescription descr = _ParseDescription(data);
+
+	// Embedded data is already in memory, so there's nothing to gain from decoding it here
+	if (descr.Filename.empty()) {
+		return [data]() { return FromJson(data); };
+	}
+
+	// Like FromJson, an image that fails to decode still creates an (empty) texture
+	DecodedImage image;
+	bool decoded = _DecodeFile(descr.Filename, descr.FormatHint, image);
+
+	return [descr, image, decoded]() {
+		// Create the texture without a filename so that the constructor doesn't load the file again
+		Texture2DDescription emptyDescr = descr;
+		emptyDescr.Filename = "";
+		Texture2D::Sptr result = std::make_shared<Texture2D>(emptyDescr);
+
+		result->_description.Filename = descr.Filename;
+		if (decoded) {
+			result->_UploadImage(image);
+		}
+		return result;
+	};
+}
+
+Texture2DDescription Texture2D::_ParseDescription(const nlohmann::json& data)
+{
+	Texture2DDescription descr = Texture2DDescription();
+	descr.Filename = JsonGet<std::string>(data, "filename", "");
+	descr.HorizontalWrap = JsonParseEnum(WrapMode, data, "wrap_s", WrapMode::ClampToEdge);
+	descr.VerticalWrap   = JsonParseEnum(WrapMode, data, "wrap_t", WrapMode::ClampToEdge);
+	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
+	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
+	descr.MaxAnisotropic      = JsonGet(data, "anisotropic", 0.0f);
+	descr.GenerateMipMaps     = JsonGet(data, "generate_mipmaps", false);
+	return descr;
+}
+
 Texture2D::Texture2D(const Texture2DDescription& description) : 
 	ITexture(TextureType::_2D),
 	_description(description),
@@ -150,52 +183,65 @@ void Texture2D::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
 	if (!_description.Filename.empty()) {
-		// Variables that will store properties about our image
-		int width, height, numChannels;
-		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
-
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
-
-		// If we could not load any data, warn and return null
-		if (data == nullptr) {
-			LOG_WARN("STBI Failed to load image from \"{}\"", _description.Filename);
-			return ;
+		DecodedImage image;
+		if (!_DecodeFile(_description.Filename, _description.FormatHint, image)) {
+			return;
 		}
+		_UploadImage(image);
+	}
+}
 
-		// We should estimate a good format for our data
-
-		// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
-		if (targetChannels != 0)
-			numChannels = targetChannels;
+bool Texture2D::_DecodeFile(const std::string& filename, PixelFormat formatHint, DecodedImage& result) {
+	// Variables that will store properties about our image
+	int width, height, numChannels;
+	const int targetChannels = GetTexelComponentCount(formatHint);
 
-		// We'll determine a recommended format for the image based on number of channels
-		// We hinted that we wanted a certain number of channels, but we're not guaranteed
-		// that all those channels exist (ex: loading an RGB image but requesting RGBA)
-		InternalFormat internal_format = GetInternalFormatForChannels8(numChannels);
-		PixelFormat    image_format = GetPixelFormatForChannels(numChannels);
+	// Use STBI to load the image. Note that the flip flag is global, but every loader sets it to
+	// true so it's fine for multiple threads to be decoding at once
+	stbi_set_flip_vertically_on_load(true);
+	uint8_t* data = stbi_load(filename.c_str(), &width, &height, &numChannels, targetChannels);
 
-		// This is one of those poorly documented things in OpenGL
-		if ((numChannels * width) % 4 != 0) {
-			LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
-		}
+	// If we could not load any data, warn and return null
+	if (data == nullptr) {
+		LOG_WARN("STBI Failed to load image from \"{}\"", filename);
+		return false;
+	}
 
-		// Update our description to match what we loaded
-		_description.Format = internal_format;
-		_description.Width = width;
-		_description.Height = height;
+	// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
+	if (targetChannels != 0)
+		numChannels = targetChannels;
 
-		// Allocates our memory
-		_SetTextureParams();
+	result.Width = width;
+	result.Height = height;
+	result.NumChannels = numChannels;
+	// The STBI data is freed along with the last copy of the image
+	result.Pixels = std::shared_ptr<uint8_t>(data, stbi_image_free);
+	return true;
+}
 
-		// Upload data to our texture
-		LoadData(width, height, image_format, PixelType::UByte, data);
+void Texture2D::_UploadImage(const DecodedImage& image) {
+	// We'll determine a recommended format for the image based on number of channels
+	// We hinted that we wanted a certain number of channels, but we're not guaranteed
+	// that all those channels exist (ex: loading an RGB image but requesting RGBA)
+	InternalFormat internal_format = GetInternalFormatForChannels8(image.NumChannels);
+	PixelFormat    image_format = GetPixelFormatForChannels(image.NumChannels);
 
-		// We now have data in the image, we can clear the STBI data
-		stbi_image_free(data);
+	// This is one of those poorly documented things in OpenGL
+	if ((image.NumChannels * image.Width) % 4 != 0) {
+		LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
 	}
-	
+
+	// Update our description to match what we loaded
+	_description.Format = internal_format;
+	_description.Width = image.Width;
+	_description.Height = image.Height;
+
+	// Allocates our memory
+	_SetTextureParams();
+
+	// Upload data to our texture
+	LoadData(image.Width, image.Height, image_format, PixelType::UByte, image.Pixels.get());
+
 	SetDebugName(_description.Filename);
 }
 
@@ -143,17 +143,49 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static Texture2D::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Decodes the texture's image on the calling thread, and returns a function that will create
+	/// the texture on the main thread. See ResourceManager::LoadAsync
+	/// </summary>
+	static std::function<Texture2D::Sptr()> DecodeFromJson(const nlohmann::json& data);
 
 protected:
 	Texture2DDescription _description;
 	PixelType _pixelType;
 
+	/// <summary>
+	/// Image data that has been decoded by STBI, but not uploaded to OpenGL
+	/// </summary>
+	struct DecodedImage {
+		int                      Width = 0;
+		int                      Height = 0;
+		// The number of channels in Pixels, which may differ from the file if a format hint was given
+		int                      NumChannels = 0;
+		std::shared_ptr<uint8_t> Pixels = nullptr;
+	};
+
 	/// <summary>
 	/// Loads this texture from the file specified in the description
 	/// Will overwrite description size
 	/// </summary>
 	void _LoadDataFromFile();
 	/// <summary>
+	/// Decodes an image file without touching OpenGL, so it's safe to call from any thread
+	/// </summary>
+	/// <param name="filename">The path to the image to load</param>
+	/// <param name="formatHint">The format to convert the image to, or Unknown to use the file's format</param>
+	/// <param name="result">Will be filled with the decoded image</param>
+	/// <returns>True if the image was decoded, false if otherwise</returns>
+	static bool _DecodeFile(const std::string& filename, PixelFormat formatHint, DecodedImage& result);
+	/// <summary>
+	/// Allocates this texture's storage to match a decoded image and uploads it's pixels
+	/// </summary>
+	void _UploadImage(const DecodedImage& image);
+	/// <summary>
+	/// Reads a texture description from a JSON blob
+	/// </summary>
+	static Texture2DDescription _ParseDescription(const nlohmann::json& data);
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
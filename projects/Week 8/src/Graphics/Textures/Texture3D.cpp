@@ -99,21 +99,7 @@ nlohmann::json Texture3D::ToJson() const
 
 Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
 {
-	Texture3DDescription description = Texture3DDescription();
-	description.Filename = JsonGet<std::string>(data, "filename", "");
-
-	description.Width  = JsonGet(data, "size_x", description.Width);
-	description.Height = JsonGet(data, "size_y", description.Height);
-	description.Depth  = JsonGet(data, "size_z", description.Depth);
-
-	description.WrapS  = JsonParseEnum(WrapMode, data, "wrap_s", description.WrapS);
-	description.WrapT  = JsonParseEnum(WrapMode, data, "wrap_t", description.WrapT);
-	description.WrapR  = JsonParseEnum(WrapMode, data, "wrap_r", description.WrapR);
-
-	description.MinificationFilter = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
-	description.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
-	description.GenerateMipMaps = JsonGet(data, "generate_mipmaps", false);
-	description.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::Unknown);
+	Texture3DDescription description = _ParseDescription(data);
 
 	Texture3D::Sptr result = std::make_shared<Texture3D>(description);
 
@@ -132,6 +118,57 @@ Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
 	return result;
 }
 
+std::function<Texture3D::Sptr()> Texture3D::DecodeFromJson(const nlohmann::json& data)
+{
+	Texture3DDescription description = _ParseDescription(data);
+
+	// Only .cube files have any work we can move off of the main thread
+	std::string extension = std::filesystem::path(description.Filename).extension().string();
+	StringTools::ToLower(extension);
+	if (extension.compare(".cube") != 0) {
+		return [data]() { return FromJson(data); };
+	}
+
+	// Like FromJson, a LUT that fails to parse still creates an (empty) texture
+	std::shared_ptr<CubeLut> lut = std::make_shared<CubeLut>();
+	if (!_ParseCubeFile(description.Filename, *lut)) {
+		lut = nullptr;
+	}
+
+	return [description, lut]() {
+		// Create the texture without a filename so that the constructor doesn't parse the file again
+		Texture3DDescription emptyDescription = description;
+		emptyDescription.Filename = "";
+		Texture3D::Sptr result = std::make_shared<Texture3D>(emptyDescription);
+
+		result->_description.Filename = description.Filename;
+		if (lut != nullptr) {
+			result->_UploadCubeLut(*lut);
+		}
+		return result;
+	};
+}
+
+Texture3DDescription Texture3D::_ParseDescription(const nlohmann::json& data)
+{
+	Texture3DDescription description = Texture3DDescription();
+	description.Filename = JsonGet<std::string>(data, "filename", "");
+
+	description.Width  = JsonGet(data, "size_x", description.Width);
+	description.Height = JsonGet(data, "size_y", description.Height);
+	description.Depth  = JsonGet(data, "size_z", description.Depth);
+
+	description.WrapS  = JsonParseEnum(WrapMode, data, "wrap_s", description.WrapS);
+	description.WrapT  = JsonParseEnum(WrapMode, data, "wrap_t", description.WrapT);
+	description.WrapR  = JsonParseEnum(WrapMode, data, "wrap_r", description.WrapR);
+
+	description.MinificationFilter = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
+	description.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
+	description.GenerateMipMaps = JsonGet(data, "generate_mipmaps", false);
+	description.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::Unknown);
+	return description;
+}
+
 void Texture3D::_LoadDataFromFile()
 {
 	LOG_ASSERT(_description.Width + _description.Height + _description.Depth == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
@@ -149,14 +186,21 @@ void Texture3D::_LoadDataFromFile()
 
 void Texture3D::_LoadCubeFile()
 {
-	std::ifstream inFile(_description.Filename);
+	CubeLut lut;
+	if (_ParseCubeFile(_description.Filename, lut)) {
+		_UploadCubeLut(lut);
+	}
+}
+
+bool Texture3D::_ParseCubeFile(const std::string& filename, CubeLut& result)
+{
+	std::ifstream inFile(filename);
 
 	if (!inFile.is_open()) {
-		LOG_WARN("Failed to open file .cube file: {}", _description.Filename);
-		return;
+		LOG_WARN("Failed to open file .cube file: {}", filename);
+		return false;
 	}
 
-	glm::u8vec3* textureData = nullptr;
 	uint32_t lutSize{ 0 };
 	uint32_t ix{ 0 };
 	glm::vec3 rgb { 0, 0, 0 };
@@ -185,18 +229,12 @@ void Texture3D::_LoadCubeFile()
 			std::stringstream lReader(line.substr(12));
 			lReader >> lutSize;
 
-			// Update the description's size
-			_description.Width = _description.Height = _description.Depth = lutSize;
+			// Update the LUT's size
+			result.Size = lutSize;
 
-			// If the size we read is non-zero, allocate our data!
+			// If the size we read is non-zero, allocate our data! This will replace any data we had already
 			if (lutSize > 0) {
-				// If we had data already, delete it
-				if (textureData != nullptr) {
-					delete[] textureData;
-				} 
-
-				// Allocate data to store texels in
-				textureData = new glm::u8vec3[(size_t)lutSize * lutSize * lutSize];
+				result.Texels.assign((size_t)lutSize * lutSize * lutSize, glm::u8vec3(0));
 				ix = 0;
 			}
 		}
@@ -210,8 +248,8 @@ void Texture3D::_LoadCubeFile()
 			// Trim any excess whitespace
 			StringTools::Trim(name);
 
-			// We'll store this in the debug name
-			SetDebugName(name);
+			// We'll store this for the debug name
+			result.Title = name;
 		}
 
 		else if (line.find("DOMAIN_MIN") != std::string::npos)
@@ -224,11 +262,12 @@ void Texture3D::_LoadCubeFile()
 		{ /* ignore for now */ }
 
 		// Reading data lines
-		else if (!line.empty() && textureData != nullptr) {
+		else if (!line.empty() && !result.Texels.empty()) {
 
 			// Make sure we don't case a write access violation
-			if (ix >= (lutSize * lutSize * lutSize) && lutSize > 0) {
+			if (ix >= result.Texels.size()) {
 				LOG_ASSERT(false, "Attempting to write outside the bounds of the LUT");
+				break;
 			}
 
 			// Read RGB from the line
@@ -238,31 +277,38 @@ void Texture3D::_LoadCubeFile()
 			rgb = glm::clamp(rgb, glm::vec3(0), glm::vec3(1));
 
 			// Store in the array, converting to the correct scale for bytes
-			textureData[ix].r = static_cast<uint8_t>(rgb.r * 255);
-			textureData[ix].g = static_cast<uint8_t>(rgb.g * 255);
-			textureData[ix].b = static_cast<uint8_t>(rgb.b * 255);
+			result.Texels[ix].r = static_cast<uint8_t>(rgb.r * 255);
+			result.Texels[ix].g = static_cast<uint8_t>(rgb.g * 255);
+			result.Texels[ix].b = static_cast<uint8_t>(rgb.b * 255);
 
 			// Move to the next texel
 			ix++;
 		}
 	} 
 
-	if (textureData != nullptr) {
-		// Set the pixel format
-		_description.Format = InternalFormat::RGB8;
-		// We need to clamp to edge for LUTS
-		_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
+	if (result.Texels.empty()) {
+		LOG_WARN("Failed to load cube file: \"{}\"", filename);
+		return false;
+	}
+	return true;
+}
 
-		// Allocate data and configure params
-		_SetTextureParams();
-		// Load data
-		LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, PixelType::UByte, textureData);
+void Texture3D::_UploadCubeLut(const CubeLut& lut)
+{
+	// Update the description's size
+	_description.Width = _description.Height = _description.Depth = lut.Size;
+	// Set the pixel format
+	_description.Format = InternalFormat::RGB8;
+	// We need to clamp to edge for LUTS
+	_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
+
+	// Allocate data and configure params
+	_SetTextureParams();
+	// Load data
+	LoadData(lut.Size, lut.Size, lut.Size, PixelFormat::RGB, PixelType::UByte, const_cast<glm::u8vec3*>(lut.Texels.data()));
 
-		// Clean up after ourselves
-		delete[] textureData;
-	}
-	else {
-		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
+	if (!lut.Title.empty()) {
+		SetDebugName(lut.Title);
 	}
 }
 
@@ -145,11 +145,25 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static Texture3D::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Parses the texture's .cube file on the calling thread, and returns a function that will
+	/// create the texture on the main thread. See ResourceManager::LoadAsync
+	/// </summary>
+	static std::function<Texture3D::Sptr()> DecodeFromJson(const nlohmann::json& data);
 
 protected:
 	Texture3DDescription _description;
 	PixelType _pixelType;
 
+	/// <summary>
+	/// A 3D LUT that has been read from a .cube file, but not uploaded to OpenGL
+	/// </summary>
+	struct CubeLut {
+		uint32_t                 Size = 0;
+		std::string              Title;
+		std::vector<glm::u8vec3> Texels;
+	};
+
 	/// <summary>
 	/// Loads this texture from the file specified in the description
 	/// Will overwrite description size
@@ -160,6 +174,21 @@ protected:
 	/// </summary>
 	void _LoadCubeFile();
 	/// <summary>
+	/// Reads a 3D LUT from a .cube file without touching OpenGL, so it's safe to call from any thread
+	/// </summary>
+	/// <param name="filename">The path to the .cube file</param>
+	/// <param name="result">Will be filled with the LUT's contents</param>
+	/// <returns>True if the file contained a LUT, false if otherwise</returns>
+	static bool _ParseCubeFile(const std::string& filename, CubeLut& result);
+	/// <summary>
+	/// Allocates this texture's storage to match a LUT and uploads it's texels
+	/// </summary>
+	void _UploadCubeLut(const CubeLut& lut);
+	/// <summary>
+	/// Reads a texture description from a JSON blob
+	/// </summary>
+	static Texture3DDescription _ParseDescription(const nlohmann::json& data);
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
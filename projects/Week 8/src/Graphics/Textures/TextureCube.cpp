@@ -3,6 +3,11 @@
 #include "stb_image.h"
 #include "Utils/JsonGlmHelpers.h"
 
+TextureCube::TextureCube() :
+	ITexture(TextureType::Cubemap),
+	_description(TextureCubeDescription())
+{ }
+
 TextureCube::TextureCube(const std::string& baseFilename) :
 	ITexture(TextureType::Cubemap),
 	_description(TextureCubeDescription())
@@ -45,6 +50,39 @@ nlohmann::json TextureCube::ToJson() const
 }
 
 TextureCube::Sptr TextureCube::FromJson(const nlohmann::json& data)
+{
+	return std::make_shared<TextureCube>(_ParseDescription(data));
+}
+
+std::function<TextureCube::Sptr()> TextureCube::DecodeFromJson(const nlohmann::json& data)
+{
+	TextureCubeDescription descr = _ParseDescription(data);
+	_ResolveFaceFilenames(descr);
+
+	// Like FromJson, a cube that fails to load still creates an (empty) texture
+	std::shared_ptr<std::vector<uint8_t>> faces = nullptr;
+
+	// If we don't have 6 faces for our cube, something has gone horribly wrong (or the files don't exist)
+	if (descr.FaceFileNames.size() != 6) {
+		LOG_ERROR("TextureCube was not given 6 faces, aborting load");
+	} else {
+		faces = std::make_shared<std::vector<uint8_t>>();
+		if (!_DecodeImages(descr, *faces)) {
+			faces = nullptr;
+		}
+	}
+
+	return [descr, faces]() {
+		TextureCube::Sptr result = TextureCube::Sptr(new TextureCube());
+		result->_description = descr;
+		if (faces != nullptr) {
+			result->_UploadImages(*faces);
+		}
+		return result;
+	};
+}
+
+TextureCubeDescription TextureCube::_ParseDescription(const nlohmann::json& data)
 {
 	TextureCubeDescription descr = TextureCubeDescription();
 	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
@@ -58,15 +96,29 @@ TextureCube::Sptr TextureCube::FromJson(const nlohmann::json& data)
 			}
 		}
 	}
-	return std::make_shared<TextureCube>(descr);
+	return descr;
 }
 
 void TextureCube::_LoadFromDescription()
+{
+	_ResolveFaceFilenames(_description);
+
+	// If we don't have 6 faces for our cube, something has gone horribly wrong (or the files don't exist)
+	if (_description.FaceFileNames.size() != 6) {
+		LOG_ERROR("TextureCube was not given 6 faces, aborting load");
+		return;
+	}
+
+	// Load all the images into the texture
+	_LoadImages(_description.FaceFileNames);
+}
+
+void TextureCube::_ResolveFaceFilenames(TextureCubeDescription& description)
 {
 	// If we weren't passed face filenames but WERE passed a base filename, try and get the 6 face files
-	if (_description.FaceFileNames.empty() && !_description.Filename.empty()) {
+	if (description.FaceFileNames.empty() && !description.Filename.empty()) {
 		// Get the file path and it's directory to extract the root file name w/o extension
-		std::filesystem::path baseName = std::filesystem::absolute(std::filesystem::path(_description.Filename));
+		std::filesystem::path baseName = std::filesystem::absolute(std::filesystem::path(description.Filename));
 		std::filesystem::path directory = baseName.parent_path();
 		std::filesystem::path rootFileName = directory / baseName.stem();
 
@@ -83,25 +135,22 @@ void TextureCube::_LoadFromDescription()
 
 			// If the file exists, store it in the description
 			if (std::filesystem::exists(targetPath)) {
-				_description.FaceFileNames[face] = targetPath.string();
+				description.FaceFileNames[face] = targetPath.string();
 			}
 		}
 	}
+}
 
-	// If we don't have 6 faces for our cube, something has gone horribly wrong (or the files don't exist)
-	if (_description.FaceFileNames.size() != 6) {
-		LOG_ERROR("TextureCube was not given 6 faces, aborting load");
-		return;
+void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames)
+{
+	std::vector<uint8_t> datastore;
+	if (_DecodeImages(_description, datastore)) {
+		_UploadImages(datastore);
 	}
-
-	// Load all the images into the texture
-	_LoadImages(_description.FaceFileNames);
 }
 
-void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames)
+bool TextureCube::_DecodeImages(TextureCubeDescription& description, std::vector<uint8_t>& result)
 {
-	// Will store all of our texture data, back to back in memory
-	uint8_t* datastore = nullptr;
 	// The size of a single face's texture, in bytes
 	size_t textureDataSize = 0;
 
@@ -112,60 +161,63 @@ void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>
 	for (int ix = 0; ix < 6; ix++) {
 		CubeMapFace face = (CubeMapFace)ix;
 		
-		const std::string& filename = _description.FaceFileNames[face];
+		const std::string& filename = description.FaceFileNames[face];
 		int fileWidth, fileHeight, fileNumChannels;
 
-		// Use STBI to load the image
+		// Use STBI to load the image. Note that the flip flag is global, but every loader sets it to
+		// true so it's fine for multiple threads to be decoding at once
 		stbi_set_flip_vertically_on_load(true);
 		uint8_t* data = stbi_load(filename.c_str(), &fileWidth, &fileHeight, &fileNumChannels, 0);
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
-			if (data != nullptr) { delete[] datastore; }
 			LOG_ERROR("STBI Failed to load image from \"{}\"", filename);
-			return;
+			return false;
 		}
 		// If the texture is not square, warn and abort
 		if (fileWidth != fileHeight) {
-			if (data != nullptr) { delete[] datastore; }
 			LOG_ERROR("Image loaded from \"{}\" was not square", filename);
 			stbi_image_free(data);
-			return;
+			return false;
 		}
-		// If the dataStore is empty, this is the first texture we loaded
-		if (datastore == nullptr) {
+		// If the data store is empty, this is the first texture we loaded
+		if (ix == 0) {
 			// Store the size and number of channels
-			_description.Size = fileWidth;
+			description.Size = fileWidth;
 			numChannels = fileNumChannels;
 
 			// Get the format and pixel format for the number of channels
-			_description.Format = GetInternalFormatForChannels8(numChannels);
-			_description.FormatHint = GetPixelFormatForChannels(numChannels);
+			description.Format = GetInternalFormatForChannels8(numChannels);
+			description.FormatHint = GetPixelFormatForChannels(numChannels);
 
 			// Determine how many bytes we'll need to store a single face worth of data
-			textureDataSize = ((size_t)_description.Size * _description.Size * GetTexelSize(_description.FormatHint, PixelType::Byte));
+			textureDataSize = ((size_t)description.Size * description.Size * GetTexelSize(description.FormatHint, PixelType::Byte));
 
 			// This is one of those poorly documented things in OpenGL
-			if ((GetTexelSize(_description.FormatHint, PixelType::Byte) * _description.Size) % 4 != 0) {
+			if ((GetTexelSize(description.FormatHint, PixelType::Byte) * description.Size) % 4 != 0) {
 				LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
 			}
 
 			// Allocate the data store for our image data
-			datastore = new uint8_t[textureDataSize * 6];
+			result.resize(textureDataSize * 6);
 		}
 		// If this is NOT the first image, and it does not match previous images, abort
-		else if (fileWidth != _description.Size || fileNumChannels != numChannels) {
-			delete[] datastore;
+		else if (fileWidth != description.Size || fileNumChannels != numChannels) {
 			LOG_WARN("Image \"{}\" did not match size or format of texture cube", filename);
 			stbi_image_free(data);
-			return;
+			return false;
 		}
 
 		// Copy the data we loaded into the corresponding location in the data store
-		memcpy(datastore + textureDataSize * ix, data, textureDataSize);
+		memcpy(result.data() + textureDataSize * ix, data, textureDataSize);
 		stbi_image_free(data);
 	}
 
+	return true;
+}
+
+void TextureCube::_UploadImages(const std::vector<uint8_t>& data)
+{
 	// Allocate memory and set up initial parameters
 	_SetTextureParams();
 
@@ -173,8 +225,7 @@ void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
 	// Upload our data to our image (note that the custom enum tools let us convert to base type [GLenum] with the * operator)
-	glTextureSubImage3D(_rendererId, 0, 0, 0, 0, _description.Size, _description.Size, 6, *_description.FormatHint, *PixelType::UByte, datastore);
-	delete[] datastore;
+	glTextureSubImage3D(_rendererId, 0, 0, 0, 0, _description.Size, _description.Size, 6, *_description.FormatHint, *PixelType::UByte, data.data());
 }
 
 void TextureCube::_SetTextureParams(){
@@ -110,13 +110,44 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static TextureCube::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Decodes the cubemap's faces on the calling thread, and returns a function that will create
+	/// the texture on the main thread. See ResourceManager::LoadAsync
+	/// </summary>
+	static std::function<TextureCube::Sptr()> DecodeFromJson(const nlohmann::json& data);
 
 protected:
 	TextureCubeDescription _description;
 
+	/// <summary>
+	/// Creates a cubemap without loading anything, used to upload faces that were decoded ahead of time
+	/// </summary>
+	TextureCube();
+
 	virtual void _LoadFromDescription();
 	virtual void _LoadImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames);
 
+	/// <summary>
+	/// Fills in the face filenames from the base filename if they weren't provided
+	/// </summary>
+	static void _ResolveFaceFilenames(TextureCubeDescription& description);
+	/// <summary>
+	/// Decodes all 6 faces without touching OpenGL, so it's safe to call from any thread. Updates
+	/// the description's size and format to match the images
+	/// </summary>
+	/// <param name="description">The description with the face filenames to load</param>
+	/// <param name="result">Will be filled with the data for all 6 faces, back to back</param>
+	/// <returns>True if all faces were loaded, false if otherwise</returns>
+	static bool _DecodeImages(TextureCubeDescription& description, std::vector<uint8_t>& result);
+	/// <summary>
+	/// Allocates our texture's memory and uploads the decoded faces
+	/// </summary>
+	void _UploadImages(const std::vector<uint8_t>& data);
+	/// <summary>
+	/// Reads a cubemap description from a JSON blob
+	/// </summary>
+	static TextureCubeDescription _ParseDescription(const nlohmann::json& data);
+
 	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
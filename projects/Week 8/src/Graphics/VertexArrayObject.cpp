@@ -2,13 +2,21 @@
 #include "Buffers/IndexBuffer.h"
 #include "Buffers/VertexBuffer.h"
 #include "Logging.h"
+#include <algorithm>
 
 VertexArrayObject::VertexArrayObject() :
 	_indexBuffer(nullptr),
 	_handle(0),
 	_vertexCount(0),
 	_elementCount(0),
-	_vertexBuffers(std::vector<VertexBufferBinding*>())
+	_vertexBuffers(std::vector<VertexBufferBinding*>()),
+	_bounds(AABB()),
+	_positionTransform(glm::mat4(1.0f)),
+	_hasPositionTransform(false),
+	_hasPackedNormals(false),
+	_subMeshes(std::vector<SubMesh>()),
+	_lod(0),
+	_lodCount(1)
 {
 	glCreateVertexArrays(1, &_handle);
 }
@@ -43,7 +51,8 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const
 			_elementCount = _vertexCount;
 		}
 	} 
-	else if (buffer->GetElementCount() != _vertexCount) {
+	// Instanced buffers hold one element per instance, so they don't need to match our vertex count
+	else if (!instanced && buffer->GetElementCount() != _vertexCount) {
 		LOG_WARN("Buffer element count does not match vertex count of this VAO!!!");
 	}
 
@@ -103,7 +112,14 @@ void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const
 
 void VertexArrayObject::Draw(DrawMode mode) {
 	Bind();
-	if (_indexBuffer == nullptr) {
+	if (_indexBuffer != nullptr && _subMeshes.size() > 0) {
+		const uint32_t indexSize = _indexBuffer->GetElementSize();
+		for (const SubMesh& subMesh : _subMeshes) {
+			if (subMesh.Lod != _lod) continue;
+			glDrawElementsBaseVertex((GLenum)mode, subMesh.IndexCount, (GLenum)_indexBuffer->GetElementType(),
+				(void*)((size_t)subMesh.IndexOffset * indexSize), subMesh.BaseVertex);
+		}
+	} else if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
 		glDrawArrays((GLenum)mode, 0, elements);
 	} else {
@@ -113,16 +129,24 @@ void VertexArrayObject::Draw(DrawMode mode) {
 	Unbind();
 }
 
-void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
+void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/, uint32_t baseInstance /*= 0*/)
 {
 	Bind();
-	if (_indexBuffer == nullptr) {
+	if (_indexBuffer != nullptr && _subMeshes.size() > 0) {
+		const uint32_t indexSize = _indexBuffer->GetElementSize();
+		for (const SubMesh& subMesh : _subMeshes) {
+			if (subMesh.Lod != _lod) continue;
+			glDrawElementsInstancedBaseVertexBaseInstance((GLenum)mode, subMesh.IndexCount, (GLenum)_indexBuffer->GetElementType(),
+				(void*)((size_t)subMesh.IndexOffset * indexSize), instanceCount, subMesh.BaseVertex, baseInstance);
+		}
+	}
+	else if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
-		glDrawArraysInstanced((GLenum)mode, 0, elements, instanceCount);
+		glDrawArraysInstancedBaseInstance((GLenum)mode, 0, elements, instanceCount, baseInstance);
 	}
 	else {
 		uint32_t elements = _elementCount == 0 ? _indexBuffer->GetElementCount() : _elementCount;
-		glDrawElementsInstanced((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount);
+		glDrawElementsInstancedBaseInstance((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount, baseInstance);
 	}
 	Unbind();
 	
@@ -138,12 +162,45 @@ void VertexArrayObject::Unbind() {
 
 void VertexArrayObject::SetVDecl(const VertexDeclaration& vDecl) {
 	_vDecl = vDecl;
+
+	// 2 component normals are octahedral encoded, everything else can be read as-is
+	_hasPackedNormals = std::any_of(_vDecl.begin(), _vDecl.end(), [](const BufferAttribute& attrib) {
+		return attrib.Usage == AttribUsage::Normal && attrib.Size == 2;
+	});
+}
+
+void VertexArrayObject::SetPositionTransform(const glm::mat4& transform) {
+	_positionTransform = transform;
+	_hasPositionTransform = transform != glm::mat4(1.0f);
 }
 
 const VertexArrayObject::VertexDeclaration& VertexArrayObject::GetVDecl() {
 	return _vDecl;
 }
 
+void VertexArrayObject::SetBounds(const AABB& bounds) {
+	_bounds = bounds;
+}
+
+const AABB& VertexArrayObject::GetBounds() const {
+	return _bounds;
+}
+
+void VertexArrayObject::SetSubMeshes(const std::vector<SubMesh>& subMeshes) {
+	LOG_ASSERT(subMeshes.size() == 0 || _indexBuffer != nullptr, "Submeshes require an index buffer!");
+	_subMeshes = subMeshes;
+
+	_lodCount = 1;
+	for (const SubMesh& subMesh : _subMeshes) {
+		_lodCount = std::max(_lodCount, subMesh.Lod + 1);
+	}
+	SetLod(_lod);
+}
+
+void VertexArrayObject::SetLod(uint32_t lod) {
+	_lod = std::min(lod, _lodCount - 1);
+}
+
 GlResourceType VertexArrayObject::GetResourceClass() const {
 	return GlResourceType::VertexArray;
 }
@@ -163,6 +220,15 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::GetBufferBinding(Attr
 	return nullptr;
 }
 
+bool VertexArrayObject::HasVertexBuffer(const VertexBuffer::Sptr& buffer) const {
+	for (const auto& binding : _vertexBuffers) {
+		if (binding->Buffer == buffer) {
+			return true;
+		}
+	}
+	return false;
+}
+
 VertexArrayObject::Sptr VertexArrayObject::Clone() const
 {
 	VertexArrayObject::Sptr result = Create();
@@ -177,6 +243,10 @@ VertexArrayObject::Sptr VertexArrayObject::Clone() const
 	}
 
 	result->SetVDecl(_vDecl);
+	result->SetBounds(_bounds);
+	result->SetPositionTransform(_positionTransform);
+	result->SetSubMeshes(_subMeshes);
+	result->SetLod(_lod);
 
 	return result;
 }
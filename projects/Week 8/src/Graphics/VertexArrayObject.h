@@ -9,6 +9,7 @@
 #include "Graphics/Buffers/IndexBuffer.h"
 #include "Graphics/GlEnums.h"
 #include "Graphics/IGraphicsResource.h"
+#include "Utils/AABB.h"
 
 /// <summary>
 /// This structure will represent the parameters passed to the glVertexAttribPointer commands
@@ -76,6 +77,28 @@ public:
 		std::vector<BufferAttribute> Attributes;
 		bool Instanced;
 	};
+
+	/// <summary>
+	/// Describes a range of the index buffer that can be drawn on it's own, meshes loaded
+	/// from BOBJ files can contain multiple of these, and multiple levels of detail
+	/// </summary>
+	struct SubMesh {
+		// The first index in the index buffer that belongs to this submesh
+		uint32_t IndexOffset;
+		// The number of indices in this submesh
+		uint32_t IndexCount;
+		// The value that gets added to each index before fetching vertices
+		int32_t  BaseVertex;
+		// The level of detail this submesh belongs to, with 0 being the highest detail
+		uint32_t Lod;
+		// The model space bounds of this submesh
+		AABB     Bounds;
+
+		SubMesh() :
+			IndexOffset(0), IndexCount(0), BaseVertex(0), Lod(0), Bounds(AABB()) { }
+		SubMesh(uint32_t indexOffset, uint32_t indexCount, int32_t baseVertex = 0, uint32_t lod = 0, const AABB& bounds = AABB()) :
+			IndexOffset(indexOffset), IndexCount(indexCount), BaseVertex(baseVertex), Lod(lod), Bounds(bounds) { }
+	};
 	
 public:
 	/// <summary>
@@ -119,6 +142,12 @@ public:
 	/// <param name="usage">The attribute usage hint to search for</param>
 	/// <returns>A const pointer to the binding, or nullptr if none is found</returns>
 	VertexBufferBinding* GetBufferBinding(AttribUsage usage);
+	/// <summary>
+	/// Checks whether the given buffer has already been added to this VAO
+	/// </summary>
+	/// <param name="buffer">The buffer to search for</param>
+	/// <returns>True if the buffer is bound to this VAO, false if otherwise</returns>
+	bool HasVertexBuffer(const VertexBuffer::Sptr& buffer) const;
 
 	/// <summary>
 	/// Renders this VAO, using the specified draw mode
@@ -132,7 +161,8 @@ public:
 	/// </summary>
 	/// <param name="instanceCount">The number of instances to render</param>
 	/// <param name="mode">The primitive mode for rendering the mesh</param>
-	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList);
+	/// <param name="baseInstance">The index of the first element to read from instanced buffers</param>
+	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList, uint32_t baseInstance = 0);
 
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
@@ -151,6 +181,59 @@ public:
 	void SetVDecl(const VertexDeclaration& vDecl);
 	const VertexDeclaration& GetVDecl();
 
+	/// <summary>
+	/// Sets the model space bounds of the mesh, this should be set by whatever creates the mesh
+	/// since the vertex data only lives on the GPU
+	/// </summary>
+	void SetBounds(const AABB& bounds);
+	/// <summary>
+	/// Gets the model space bounds of the mesh, will be invalid if they were never set
+	/// </summary>
+	const AABB& GetBounds() const;
+
+	/// <summary>
+	/// Sets the transform that takes the positions stored in this VAO's vertices into model space, used by
+	/// meshes with quantized positions (see VertexPackedPosNormTexColTangents). The renderer applies this
+	/// before the model matrix, the bounds should still be in model space
+	/// </summary>
+	void SetPositionTransform(const glm::mat4& transform);
+	/// <summary>
+	/// Gets the transform from stored vertex positions to model space, identity unless positions are quantized
+	/// </summary>
+	const glm::mat4& GetPositionTransform() const { return _positionTransform; }
+	/// <summary>
+	/// Returns true if this VAO has a position transform that needs to be applied
+	/// </summary>
+	bool HasPositionTransform() const { return _hasPositionTransform; }
+	/// <summary>
+	/// Returns true if the normals and tangents in this VAO are octahedral encoded (2 components), which
+	/// the vertex shader needs to know about. Determined from the vertex declaration
+	/// </summary>
+	bool HasPackedNormals() const { return _hasPackedNormals; }
+
+	/// <summary>
+	/// Sets the submeshes that make up this VAO. When submeshes are present, Draw and DrawInstanced
+	/// will only draw the submeshes in the active level of detail. Only valid for indexed meshes
+	/// </summary>
+	void SetSubMeshes(const std::vector<SubMesh>& subMeshes);
+	/// <summary>
+	/// Gets the submeshes that make up this VAO, empty if the whole index buffer is drawn at once
+	/// </summary>
+	const std::vector<SubMesh>& GetSubMeshes() const { return _subMeshes; }
+
+	/// <summary>
+	/// Selects which level of detail will be rendered, clamped to the levels that exist in the submeshes
+	/// </summary>
+	void SetLod(uint32_t lod);
+	/// <summary>
+	/// Gets the level of detail that is being rendered
+	/// </summary>
+	uint32_t GetLod() const { return _lod; }
+	/// <summary>
+	/// Gets the number of levels of detail in this VAO, will always be at least 1
+	/// </summary>
+	uint32_t GetLodCount() const { return _lodCount; }
+
 protected:
 	
 	// The index buffer bound to this VAO
@@ -162,6 +245,19 @@ protected:
 	// defined in VertexTypes.cpp
 	VertexDeclaration _vDecl;
 
+	// The model space bounds of the vertices in this VAO
+	AABB _bounds;
+
+	// Undoes position quantization, applied before the model matrix
+	glm::mat4 _positionTransform;
+	bool      _hasPositionTransform;
+	bool      _hasPackedNormals;
+
+	// Ranges of the index buffer to draw, if empty we draw everything
+	std::vector<SubMesh> _subMeshes;
+	uint32_t _lod;
+	uint32_t _lodCount;
+
 	uint32_t _vertexCount;
 	uint32_t _elementCount;
 
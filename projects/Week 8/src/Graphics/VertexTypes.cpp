@@ -1,4 +1,7 @@
 #include "VertexTypes.h"
+#include <cmath>
+#include <GLM/gtc/packing.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
 #pragma warning( push )
 
 VertexPosCol* VPC = nullptr;
@@ -7,6 +10,7 @@ VertexPosNormCol* VPNC = nullptr;
 VertexPosNormTex* VPNT = nullptr;
 VertexPosNormTexCol* VPNTC = nullptr;
 VertexPosNormTexColTangents* VPNTCT = nullptr;
+VertexPackedPosNormTexColTangents* VPPNTCT = nullptr;
 
 const std::vector<BufferAttribute> VertexPosCol::V_DECL = {
 	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosCol), (size_t)&VPC->Position, AttribUsage::Position),
@@ -41,4 +45,88 @@ const std::vector<BufferAttribute> VertexPosNormTexColTangents::V_DECL ={
 	BufferAttribute(4, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->Tangent, AttribUsage::Tangent),
 	BufferAttribute(5, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->BiTangent, AttribUsage::BiTangent)
 };
-#pragma warning(pop)
\ No newline at end of file
+const std::vector<BufferAttribute> VertexPackedPosNormTexColTangents::V_DECL ={
+	BufferAttribute(0, 3, AttributeType::UShort, sizeof(VertexPackedPosNormTexColTangents), (size_t)&VPPNTCT->Position, AttribUsage::Position, true),
+	BufferAttribute(1, 4, AttributeType::UByte, sizeof(VertexPackedPosNormTexColTangents), (size_t)&VPPNTCT->Color, AttribUsage::Color, true),
+	BufferAttribute(2, 2, AttributeType::Short, sizeof(VertexPackedPosNormTexColTangents), (size_t)&VPPNTCT->Normal, AttribUsage::Normal, true),
+	BufferAttribute(3, 2, AttributeType::HalfFloat, sizeof(VertexPackedPosNormTexColTangents), (size_t)&VPPNTCT->UV, AttribUsage::Texture),
+	BufferAttribute(4, 2, AttributeType::Short, sizeof(VertexPackedPosNormTexColTangents), (size_t)&VPPNTCT->Tangent, AttribUsage::Tangent, true),
+	// Only the sign of the bitangent, stored in the position's W
+	BufferAttribute(5, 1, AttributeType::UShort, sizeof(VertexPackedPosNormTexColTangents), (size_t)&VPPNTCT->Position.w, AttribUsage::BiTangent, true)
+};
+#pragma warning(pop)
+
+namespace {
+	// Maps a unit vector onto an octahedron, then unfolds it into the [-1, 1] square
+	glm::vec2 OctahedralEncode(const glm::vec3& value) {
+		float length = std::abs(value.x) + std::abs(value.y) + std::abs(value.z);
+		if (length <= 0.0f) {
+			return glm::vec2(0.0f, 0.0f);
+		}
+		glm::vec3 n = value / length;
+		glm::vec2 result = glm::vec2(n.x, n.y);
+		if (n.z < 0.0f) {
+			glm::vec2 signs = glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+			result = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * signs;
+		}
+		return result;
+	}
+
+	// Inverse of OctahedralEncode, matches DecodeOctahedral in vs_common.glsl
+	glm::vec3 OctahedralDecode(const glm::vec2& value) {
+		glm::vec3 n = glm::vec3(value.x, value.y, 1.0f - std::abs(value.x) - std::abs(value.y));
+		if (n.z < 0.0f) {
+			glm::vec2 signs = glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+			glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * signs;
+			n.x = folded.x;
+			n.y = folded.y;
+		}
+		return glm::normalize(n);
+	}
+
+	glm::i16vec2 PackSnorm16(const glm::vec2& value) {
+		return glm::i16vec2(glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	glm::vec2 UnpackSnorm16(const glm::i16vec2& value) {
+		return glm::max(glm::vec2(value) / 32767.0f, -1.0f);
+	}
+}
+
+VertexPackedPosNormTexColTangents VertexPackedPosNormTexColTangents::Pack(const VertexPosNormTexColTangents& vertex, const AABB& bounds) {
+	VertexPackedPosNormTexColTangents result;
+
+	// Flat axes (ex a plane) have no extent, so everything on them packs to 0
+	glm::vec3 extents = bounds.Max - bounds.Min;
+	glm::vec3 scale = glm::vec3(
+		extents.x > 0.0f ? 1.0f / extents.x : 0.0f,
+		extents.y > 0.0f ? 1.0f / extents.y : 0.0f,
+		extents.z > 0.0f ? 1.0f / extents.z : 0.0f
+	);
+	glm::vec3 position = glm::round(glm::clamp((vertex.Position - bounds.Min) * scale, 0.0f, 1.0f) * 65535.0f);
+
+	// The shader rebuilds the bitangent as cross(normal, tangent), so we just need to know if it needs flipping
+	bool flipped = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.BiTangent) < 0.0f;
+	result.Position = glm::u16vec4(glm::u16vec3(position), flipped ? 0 : 65535);
+
+	result.Normal  = PackSnorm16(OctahedralEncode(vertex.Normal));
+	result.Tangent = PackSnorm16(OctahedralEncode(vertex.Tangent));
+	result.UV      = glm::u16vec2(glm::packHalf1x16(vertex.UV.x), glm::packHalf1x16(vertex.UV.y));
+	result.Color   = glm::u8vec4(glm::round(glm::clamp(vertex.Color, 0.0f, 1.0f) * 255.0f));
+	return result;
+}
+
+VertexPosNormTexColTangents VertexPackedPosNormTexColTangents::Unpack(const AABB& bounds) const {
+	VertexPosNormTexColTangents result;
+	result.Position  = bounds.Min + glm::vec3(Position.x, Position.y, Position.z) / 65535.0f * (bounds.Max - bounds.Min);
+	result.Normal    = OctahedralDecode(UnpackSnorm16(Normal));
+	result.Tangent   = OctahedralDecode(UnpackSnorm16(Tangent));
+	result.BiTangent = glm::cross(result.Normal, result.Tangent) * (Position.w > 0 ? 1.0f : -1.0f);
+	result.UV        = glm::vec2(glm::unpackHalf1x16(UV.x), glm::unpackHalf1x16(UV.y));
+	result.Color     = glm::vec4(Color) / 255.0f;
+	return result;
+}
+
+glm::mat4 VertexPackedPosNormTexColTangents::GetPositionTransform(const AABB& bounds) {
+	return glm::scale(glm::translate(glm::mat4(1.0f), bounds.Min), bounds.Max - bounds.Min);
+}
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <GLM/glm.hpp>
+#include <GLM/gtc/type_precision.hpp>
 #include "VertexArrayObject.h"
+#include "Utils/AABB.h"
 
 
 struct VertexPosCol {
@@ -116,4 +118,52 @@ struct VertexPosNormTexColTangents {
 	{}
 
 	static const std::vector<BufferAttribute> V_DECL;
-};
\ No newline at end of file
+};
+
+/// <summary>
+/// A compressed version of VertexPosNormTexColTangents for large static meshes, 24 bytes instead of 80
+///  - Position is unorm16, relative to the bounds the mesh was packed with. The VAO needs the matching
+///    position transform (see VertexArrayObject::SetPositionTransform) so the renderer can undo it
+///  - Normal and tangent are octahedral encoded snorm16 pairs, decoded in vs_common.glsl
+///  - The bitangent is rebuilt from the normal and tangent in the shader, we only store which way it
+///    points, in the unused w component of the position
+///  - UV is half float, and color is unorm8
+/// </summary>
+struct VertexPackedPosNormTexColTangents {
+	// XYZ is the position, W is 0 or 1 for the bitangent's sign
+	glm::u16vec4 Position;
+	glm::i16vec2 Normal;
+	glm::i16vec2 Tangent;
+	// Half float bits
+	glm::u16vec2 UV;
+	glm::u8vec4  Color;
+
+	VertexPackedPosNormTexColTangents() :
+		Position(glm::u16vec4(0)),
+		Normal(glm::i16vec2(0)),
+		Tangent(glm::i16vec2(0)),
+		UV(glm::u16vec2(0)),
+		Color(glm::u8vec4(0, 0, 0, 255))
+	{}
+
+	/// <summary>
+	/// Packs a full size vertex
+	/// </summary>
+	/// <param name="vertex">The vertex to pack</param>
+	/// <param name="bounds">The bounds of the mesh the vertex belongs to, positions are stored relative to this</param>
+	static VertexPackedPosNormTexColTangents Pack(const VertexPosNormTexColTangents& vertex, const AABB& bounds);
+	/// <summary>
+	/// Unpacks this vertex into a full size vertex, the bitangent is rebuilt from the normal and tangent
+	/// </summary>
+	/// <param name="bounds">The bounds that were used when packing</param>
+	VertexPosNormTexColTangents Unpack(const AABB& bounds) const;
+
+	/// <summary>
+	/// Gets the transform from packed positions back to model space, this is what should be given to
+	/// VertexArrayObject::SetPositionTransform for meshes made of these vertices
+	/// </summary>
+	/// <param name="bounds">The bounds that were used when packing</param>
+	static glm::mat4 GetPositionTransform(const AABB& bounds);
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
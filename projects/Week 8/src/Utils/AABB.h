@@ -0,0 +1,64 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <limits>
+
+/// <summary>
+/// Represents an axis aligned bounding box, used for culling and other broad checks
+///
+/// A default constructed AABB is empty (min > max), and will become valid as soon as a
+/// point is added to it
+/// </summary>
+struct AABB {
+	glm::vec3 Min;
+	glm::vec3 Max;
+
+	AABB() :
+		Min(glm::vec3(std::numeric_limits<float>::max())),
+		Max(glm::vec3(std::numeric_limits<float>::lowest())) { }
+	AABB(const glm::vec3& min, const glm::vec3& max) :
+		Min(min), Max(max) { }
+
+	/// <summary>
+	/// Returns true if this box contains at least one point
+	/// </summary>
+	bool IsValid() const { return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z; }
+
+	/// <summary>
+	/// Gets the center of the box
+	/// </summary>
+	glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+	/// <summary>
+	/// Gets the half size of the box along each axis
+	/// </summary>
+	glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+	/// <summary>
+	/// Grows the box to contain the given point
+	/// </summary>
+	void Expand(const glm::vec3& point) {
+		Min = glm::min(Min, point);
+		Max = glm::max(Max, point);
+	}
+	/// <summary>
+	/// Grows the box to contain another box
+	/// </summary>
+	void Expand(const AABB& other) {
+		Min = glm::min(Min, other.Min);
+		Max = glm::max(Max, other.Max);
+	}
+
+	/// <summary>
+	/// Gets the box that contains this box after it has been transformed by the given matrix. Rather
+	/// than transforming all 8 corners, we transform the center and project the extents onto each axis
+	/// </summary>
+	/// <param name="transform">The transform to apply, usually a model matrix</param>
+	AABB Transformed(const glm::mat4& transform) const {
+		if (!IsValid()) {
+			return *this;
+		}
+		glm::vec3 center  = transform * glm::vec4(GetCenter(), 1.0f);
+		glm::mat3 absBasis = glm::mat3(glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])));
+		glm::vec3 extents = absBasis * GetExtents();
+		return AABB(center - extents, center + extents);
+	}
+};
@@ -0,0 +1,156 @@
+#include "Utils/MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile() :
+	_data(nullptr),
+	_size(0),
+	_isOpen(false),
+	_fileHandle(nullptr),
+	_mappingHandle(nullptr)
+{ }
+
+MappedFile::MappedFile(const std::string& filename) :
+	MappedFile()
+{
+	Open(filename);
+}
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+	MappedFile()
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+		std::swap(_isOpen, other._isOpen);
+		std::swap(_fileHandle, other._fileHandle);
+		std::swap(_mappingHandle, other._mappingHandle);
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filename) {
+	Close();
+
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return false;
+	}
+	_fileHandle = file;
+	_size = static_cast<size_t>(size.QuadPart);
+	_isOpen = true;
+
+	// Zero sized files can't be mapped, but are still valid files
+	if (_size == 0) {
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		Close();
+		return false;
+	}
+	_mappingHandle = mapping;
+
+	_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_data == nullptr) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close() {
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mappingHandle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(_mappingHandle));
+	}
+	if (_fileHandle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(_fileHandle));
+	}
+	_data = nullptr;
+	_size = 0;
+	_isOpen = false;
+	_fileHandle = nullptr;
+	_mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filename) {
+	Close();
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+	// Store the descriptor offset by one, so that descriptor 0 isn't confused with no file
+	_fileHandle = reinterpret_cast<void*>(static_cast<intptr_t>(fd) + 1);
+	_size = static_cast<size_t>(info.st_size);
+	_isOpen = true;
+
+	// Zero sized files can't be mapped, but are still valid files
+	if (_size == 0) {
+		return true;
+	}
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	madvise(data, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const uint8_t*>(data);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (_data != nullptr) {
+		munmap(const_cast<uint8_t*>(_data), _size);
+	}
+	if (_fileHandle != nullptr) {
+		close(static_cast<int>(reinterpret_cast<intptr_t>(_fileHandle) - 1));
+	}
+	_data = nullptr;
+	_size = 0;
+	_isOpen = false;
+	_fileHandle = nullptr;
+	_mappingHandle = nullptr;
+}
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// A read-only view of a file that has been mapped into memory. Pages are loaded by the OS as
+/// they are touched, so large files can be parsed without reading them into a buffer first
+///
+/// The mapping stays valid until the MappedFile is closed or destroyed
+/// </summary>
+class MappedFile {
+public:
+	MappedFile();
+	/// <summary>
+	/// Creates a new mapped file and attempts to open the file at the given path, check IsOpen for the result
+	/// </summary>
+	explicit MappedFile(const std::string& filename);
+	~MappedFile();
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator =(const MappedFile& other) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator =(MappedFile&& other) noexcept;
+
+	/// <summary>
+	/// Maps the file at the given path into memory, closing any file that was already open
+	/// </summary>
+	/// <param name="filename">The path to the file to map</param>
+	/// <returns>True if the file was mapped, false if it could not be opened</returns>
+	bool Open(const std::string& filename);
+	/// <summary>
+	/// Unmaps the file, any pointers into the file's data are no longer valid
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// Returns true if a file is currently mapped. Note that empty files can be open with a null data pointer
+	/// </summary>
+	bool IsOpen() const { return _isOpen; }
+	/// <summary>
+	/// Gets a pointer to the start of the file's contents
+	/// </summary>
+	const uint8_t* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the file, in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+
+protected:
+	const uint8_t* _data;
+	size_t         _size;
+	bool           _isOpen;
+
+	// Platform handles, these are HANDLEs on windows and a file descriptor elsewhere
+	void*          _fileHandle;
+	void*          _mappingHandle;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "Graphics/VertexArrayObject.h"
+#include "Utils/MeshOptimizer.h"
 
 /// <summary>
 /// A utility class that lets us add vertices and indices, then bake it into a final mesh, using interleaved
@@ -138,9 +139,64 @@ public:
 		// Store our vertex type in the VAO's vertex declaration
 		result->SetVDecl(VertType::V_DECL);
 
+		// Calculate the bounds while we still have the vertices on the CPU
+		AABB bounds;
+		for (const VertType& vertex : _vertices) {
+			bounds.Expand(vertex.Position);
+		}
+		result->SetBounds(bounds);
+
 		return result;
 	}
 	
+	/// <summary>
+	/// Reorders the triangles and vertices in this mesh to make better use of the GPU's vertex caches,
+	/// and optionally to reduce overdraw. This is fairly slow, so it should be done when converting
+	/// meshes rather than every time they are loaded. Only works on indexed triangle lists
+	/// </summary>
+	/// <param name="options">The optimizations to perform</param>
+	/// <returns>The vertex cache statistics from before and after optimizing</returns>
+	MeshOptimizer::Stats Optimize(const MeshOptimizer::Options& options = MeshOptimizer::Options()) {
+		MeshOptimizer::Stats stats;
+		if (_indices.size() < 3) {
+			return stats;
+		}
+		stats.Before = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size(), options.CacheSize);
+
+		std::vector<uint32_t> clusters;
+		MeshOptimizer::OptimizeVertexCache(_indices.data(), _indices.size(), _vertices.size(), options.CacheSize, options.OptimizeOverdraw ? &clusters : nullptr);
+
+		if (options.OptimizeOverdraw) {
+			std::vector<glm::vec3> positions;
+			positions.reserve(_vertices.size());
+			for (const VertType& vertex : _vertices) {
+				positions.push_back(vertex.Position);
+			}
+			stats.ClusterCount = MeshOptimizer::OptimizeOverdraw(_indices.data(), _indices.size(), positions.data(), positions.size(),
+																 clusters, options.CacheSize, options.OverdrawThreshold);
+		}
+
+		if (options.OptimizeFetch) {
+			std::vector<uint32_t> remap;
+			MeshOptimizer::OptimizeVertexFetch(remap, _indices.data(), _indices.size(), _vertices.size());
+
+			// Invert the remap so we can copy the vertices in their new order
+			std::vector<uint32_t> order(remap.size());
+			for (size_t ix = 0; ix < remap.size(); ix++) {
+				order[remap[ix]] = static_cast<uint32_t>(ix);
+			}
+			std::vector<VertType> vertices;
+			vertices.reserve(_vertices.size());
+			for (uint32_t ix : order) {
+				vertices.push_back(_vertices[ix]);
+			}
+			_vertices.swap(vertices);
+		}
+
+		stats.After = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size(), options.CacheSize);
+		return stats;
+	}
+
 	/// <summary>
 	/// Resets this mesh, removing all vertices and indices
 	/// </summary>
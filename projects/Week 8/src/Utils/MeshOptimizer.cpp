@@ -0,0 +1,300 @@
+#include "Utils/MeshOptimizer.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+	/// <summary>
+	/// A FIFO post-transform cache, using timestamps so that resetting or checking it is O(1).
+	/// A vertex is in the cache if it was transformed within the last cacheSize misses
+	/// </summary>
+	struct CacheSimulator {
+		std::vector<uint32_t> Timestamps;
+		uint32_t              Time;
+		uint32_t              CacheSize;
+
+		CacheSimulator(size_t vertexCount, uint32_t cacheSize) :
+			Timestamps(vertexCount, 0),
+			Time(cacheSize + 1),
+			CacheSize(cacheSize) { }
+
+		/// <summary>
+		/// Processes a vertex, returns true if it was a cache miss
+		/// </summary>
+		bool Access(uint32_t vertex) {
+			if (Time - Timestamps[vertex] > CacheSize) {
+				Timestamps[vertex] = Time++;
+				return true;
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// Empties the cache
+		/// </summary>
+		void Flush() {
+			Time += CacheSize + 1;
+		}
+	};
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	CacheStats result;
+	if (indexCount < 3 || vertexCount == 0) {
+		return result;
+	}
+
+	CacheSimulator cache(vertexCount, cacheSize);
+	std::vector<bool> referenced(vertexCount, false);
+	uint32_t uniqueVertices = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t vertex = indices[ix];
+		result.Misses += cache.Access(vertex) ? 1 : 0;
+		if (!referenced[vertex]) {
+			referenced[vertex] = true;
+			uniqueVertices++;
+		}
+	}
+
+	result.ACMR = result.Misses / static_cast<float>(indexCount / 3);
+	result.ATVR = result.Misses / static_cast<float>(uniqueVertices);
+	return result;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>* clusters) {
+	if (clusters != nullptr) {
+		clusters->clear();
+	}
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0) {
+		return;
+	}
+
+	// Build the vertex to triangle adjacency, stored as one flat list with an offset per vertex.
+	// The number of triangles that still need to be emitted for each vertex starts at the full count
+	std::vector<uint32_t> liveCounts(vertexCount, 0);
+	for (size_t ix = 0; ix < triangleCount * 3; ix++) {
+		liveCounts[indices[ix]]++;
+	}
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		offsets[ix + 1] = offsets[ix] + liveCounts[ix];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+		for (size_t ix = 0; ix < triangleCount * 3; ix++) {
+			adjacency[cursors[indices[ix]]++] = static_cast<uint32_t>(ix / 3);
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(triangleCount * 3);
+	std::vector<bool>     emitted(triangleCount, false);
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	std::vector<uint32_t> deadEnds;
+	deadEnds.reserve(triangleCount * 3);
+	std::vector<uint32_t> candidates;
+	candidates.reserve(64);
+
+	const int64_t k = cacheSize;
+	uint32_t time = cacheSize + 1;
+	size_t   cursor = 0;
+
+	// Finds the next vertex that still has triangles, in input order
+	auto nextLiveVertex = [&]() -> int64_t {
+		for (; cursor < vertexCount; cursor++) {
+			if (liveCounts[cursor] > 0) {
+				return static_cast<int64_t>(cursor);
+			}
+		}
+		return -1;
+	};
+
+	if (clusters != nullptr) {
+		clusters->push_back(0);
+	}
+
+	int64_t fanning = nextLiveVertex();
+	while (fanning >= 0) {
+		candidates.clear();
+
+		// Emit all the remaining triangles around the fanning vertex
+		for (uint32_t ix = offsets[fanning]; ix < offsets[fanning + 1]; ix++) {
+			uint32_t triangle = adjacency[ix];
+			if (emitted[triangle]) continue;
+
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[triangle * 3 + corner];
+				result.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCounts[vertex]--;
+				if (time - timestamps[vertex] > cacheSize) {
+					timestamps[vertex] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// Pick the candidate that will still be in the cache after it's triangles are emitted, preferring
+		// the one that's been in the cache the longest (since it will be evicted soonest)
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates) {
+			if (liveCounts[vertex] == 0) continue;
+
+			int64_t age = static_cast<int64_t>(time) - timestamps[vertex];
+			int64_t priority = age + 2 * static_cast<int64_t>(liveCounts[vertex]) <= k ? age : 0;
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+
+		// Dead end, fall back to recently used vertices, then to the input order. The cache is most likely
+		// cold after this, so it's where we start a new cluster
+		if (best < 0) {
+			while (!deadEnds.empty()) {
+				uint32_t vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveCounts[vertex] > 0) {
+					best = vertex;
+					break;
+				}
+			}
+			if (best < 0) {
+				best = nextLiveVertex();
+			}
+			if (best >= 0 && clusters != nullptr) {
+				clusters->push_back(static_cast<uint32_t>(result.size() / 3));
+			}
+		}
+
+		fanning = best;
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+uint32_t MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount,
+										 const std::vector<uint32_t>& clusters, uint32_t cacheSize, float threshold)
+{
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0 || clusters.empty()) {
+		return 0;
+	}
+
+	// Split the hard clusters from tipsify into smaller soft clusters wherever the ACMR so far is about
+	// as good as the ACMR for the whole cluster, smaller clusters can be sorted more accurately
+	std::vector<uint32_t> softClusters;
+	softClusters.reserve(clusters.size() * 2);
+	CacheSimulator cache(vertexCount, cacheSize);
+	for (size_t clusterIx = 0; clusterIx < clusters.size(); clusterIx++) {
+		const uint32_t start = clusters[clusterIx];
+		const uint32_t end = clusterIx + 1 < clusters.size() ? clusters[clusterIx + 1] : static_cast<uint32_t>(triangleCount);
+
+		cache.Flush();
+		uint32_t clusterMisses = 0;
+		for (uint32_t triangle = start; triangle < end; triangle++) {
+			for (int corner = 0; corner < 3; corner++) {
+				clusterMisses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+			}
+		}
+		const float target = clusterMisses / static_cast<float>(end - start) * threshold;
+
+		cache.Flush();
+		softClusters.push_back(start);
+		uint32_t softStart = start;
+		uint32_t misses = 0;
+		for (uint32_t triangle = start; triangle < end; triangle++) {
+			for (int corner = 0; corner < 3; corner++) {
+				misses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+			}
+
+			// Split after this triangle, resetting the cache since the next cluster could be drawn after anything
+			if (triangle + 1 < end && misses / static_cast<float>(triangle + 1 - softStart) <= target) {
+				softClusters.push_back(triangle + 1);
+				softStart = triangle + 1;
+				misses = 0;
+				cache.Flush();
+			}
+		}
+	}
+
+	// Find the area weighted centroid of the whole mesh, and each cluster's centroid and average normal
+	struct ClusterInfo {
+		uint32_t Start;
+		uint32_t End;
+		float    SortKey;
+	};
+	std::vector<ClusterInfo> infos(softClusters.size());
+	std::vector<glm::vec3> centroids(softClusters.size());
+	std::vector<glm::vec3> normals(softClusters.size());
+	glm::vec3 meshCentroid = glm::vec3(0.0f);
+	float meshArea = 0.0f;
+	for (size_t clusterIx = 0; clusterIx < softClusters.size(); clusterIx++) {
+		ClusterInfo& info = infos[clusterIx];
+		info.Start = softClusters[clusterIx];
+		info.End = clusterIx + 1 < softClusters.size() ? softClusters[clusterIx + 1] : static_cast<uint32_t>(triangleCount);
+
+		glm::vec3 centroid = glm::vec3(0.0f);
+		glm::vec3 normal = glm::vec3(0.0f);
+		float area = 0.0f;
+		for (uint32_t triangle = info.Start; triangle < info.End; triangle++) {
+			const glm::vec3& a = positions[indices[triangle * 3 + 0]];
+			const glm::vec3& b = positions[indices[triangle * 3 + 1]];
+			const glm::vec3& c = positions[indices[triangle * 3 + 2]];
+
+			// The cross product's length is twice the triangle's area, so summing it gives an area weighted normal
+			glm::vec3 cross = glm::cross(b - a, c - a);
+			float triangleArea = glm::length(cross) * 0.5f;
+			centroid += (a + b + c) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+
+		meshCentroid += centroid;
+		meshArea += area;
+		centroids[clusterIx] = area > 0.0f ? centroid / area : glm::vec3(0.0f);
+		normals[clusterIx] = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f);
+	}
+	meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+	// Clusters that face away from the center of the mesh are more likely to occlude the rest, so we draw them first
+	for (size_t clusterIx = 0; clusterIx < infos.size(); clusterIx++) {
+		infos[clusterIx].SortKey = glm::dot(centroids[clusterIx] - meshCentroid, normals[clusterIx]);
+	}
+	std::stable_sort(infos.begin(), infos.end(), [](const ClusterInfo& a, const ClusterInfo& b) {
+		return a.SortKey > b.SortKey;
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(triangleCount * 3);
+	for (const ClusterInfo& info : infos) {
+		result.insert(result.end(), indices + info.Start * 3, indices + info.End * 3);
+	}
+	std::copy(result.begin(), result.end(), indices);
+
+	return static_cast<uint32_t>(infos.size());
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& remap, uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	const uint32_t unused = std::numeric_limits<uint32_t>::max();
+	remap.assign(vertexCount, unused);
+
+	uint32_t next = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& vertex = remap[indices[ix]];
+		if (vertex == unused) {
+			vertex = next++;
+		}
+		indices[ix] = vertex;
+	}
+
+	// Keep unused vertices around at the end, so the vertex count doesn't change
+	for (uint32_t& vertex : remap) {
+		if (vertex == unused) {
+			vertex = next++;
+		}
+	}
+}
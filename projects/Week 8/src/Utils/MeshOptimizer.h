@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Offline optimizations for indexed triangle lists, these are run when meshes are converted to
+/// binary files so the cost is only paid once. See MeshBuilder::Optimize for the typical usage
+///
+/// There are 3 stages, each of which only reorders data (the mesh renders exactly the same):
+///  - Vertex cache: triangles are reordered with Tipsify (Sander et al. 2007), so vertices that were
+///    just transformed are reused from the GPU's post-transform cache instead of being shaded again
+///  - Overdraw: the clusters that Tipsify produced are split further wherever it barely affects the
+///    cache hit rate, then sorted so that outward facing clusters are drawn first, which lets early
+///    depth testing reject more of the fragments behind them
+///  - Vertex fetch: vertices are reordered to match the order they are first used in the index
+///    buffer, so vertex fetches walk forwards through memory
+///
+/// Cache efficiency is reported as ACMR (average cache miss ratio, transformed vertices per triangle,
+/// 0.5 is ideal for large grids and 3 is the worst case) and ATVR (average transform to vertex ratio,
+/// transformed vertices per unique vertex, 1.0 is ideal)
+/// </summary>
+class MeshOptimizer {
+public:
+	/// <summary>
+	/// Settings for MeshBuilder::Optimize
+	/// </summary>
+	struct Options {
+		// The size of the post-transform cache to optimize for, smaller values hurt less on hardware
+		// with a bigger cache than the other way around
+		uint32_t CacheSize = 16;
+		// True to reorder triangle clusters to reduce overdraw
+		bool     OptimizeOverdraw = true;
+		// How much worse a cluster's ACMR can be than the ACMR Tipsify gave it before we stop splitting
+		// it for overdraw ordering, 1.0 keeps the cache results from Tipsify intact
+		float    OverdrawThreshold = 1.05f;
+		// True to reorder vertices to match the order they are used in
+		bool     OptimizeFetch = true;
+	};
+
+	/// <summary>
+	/// The results of simulating a FIFO post-transform cache over a mesh
+	/// </summary>
+	struct CacheStats {
+		// The number of vertices that had to be transformed
+		uint32_t Misses = 0;
+		// Average cache miss ratio, misses per triangle
+		float    ACMR = 0.0f;
+		// Average transform to vertex ratio, misses per referenced vertex
+		float    ATVR = 0.0f;
+	};
+
+	/// <summary>
+	/// The results of a call to MeshBuilder::Optimize
+	/// </summary>
+	struct Stats {
+		CacheStats Before;
+		CacheStats After;
+		// The number of clusters used for overdraw ordering, 0 if overdraw was not optimized
+		uint32_t   ClusterCount = 0;
+	};
+
+	MeshOptimizer() = delete;
+
+	/// <summary>
+	/// Simulates a FIFO post-transform cache of the given size over a triangle list
+	/// </summary>
+	/// <param name="indices">The triangle list to analyze</param>
+	/// <param name="indexCount">The number of indices, should be a multiple of 3</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <param name="cacheSize">The number of entries in the simulated cache</param>
+	static CacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+	/// <summary>
+	/// Reorders the triangles in a triangle list with Tipsify to improve post-transform cache hits
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder, in place</param>
+	/// <param name="indexCount">The number of indices, should be a multiple of 3</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <param name="cacheSize">The size of the cache to optimize for</param>
+	/// <param name="clusters">If not null, will be filled with the index of the first triangle in each cluster, for OptimizeOverdraw</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16, std::vector<uint32_t>* clusters = nullptr);
+
+	/// <summary>
+	/// Reorders clusters of triangles so that outward facing clusters are drawn first. Should be run
+	/// after OptimizeVertexCache, using the clusters that it output
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder, in place</param>
+	/// <param name="indexCount">The number of indices, should be a multiple of 3</param>
+	/// <param name="positions">The positions of the vertices</param>
+	/// <param name="vertexCount">The number of vertices in positions</param>
+	/// <param name="clusters">The first triangle of each cluster, from OptimizeVertexCache</param>
+	/// <param name="cacheSize">The size of the cache that was optimized for</param>
+	/// <param name="threshold">How much clusters can be split, see Options::OverdrawThreshold</param>
+	/// <returns>The number of clusters that were sorted</returns>
+	static uint32_t OptimizeOverdraw(uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount,
+									 const std::vector<uint32_t>& clusters, uint32_t cacheSize = 16, float threshold = 1.05f);
+
+	/// <summary>
+	/// Finds the order vertices should be in so that they are stored in the order they are first used,
+	/// and rewrites the indices to match. Vertices that are never used are moved to the end
+	/// </summary>
+	/// <param name="remap">Will be filled with the new location of each vertex</param>
+	/// <param name="indices">The triangle list to rewrite, in place</param>
+	/// <param name="indexCount">The number of indices</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	static void OptimizeVertexFetch(std::vector<uint32_t>& remap, uint32_t* indices, size_t indexCount, size_t vertexCount);
+};
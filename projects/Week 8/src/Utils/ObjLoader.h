@@ -18,6 +18,16 @@ public:
 	template <typename VertexType = VertexPosNormTexColTangents>
 	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, bool calcTangents = true);
 
+	/// <summary>
+	/// Loads an OBJ file into a mesh builder without creating any OpenGL objects, so it can be
+	/// called from worker threads. Call Bake on the main thread to create the VAO
+	/// </summary>
+	/// <param name="filename">The path to the OBJ file to load</param>
+	/// <param name="mesh">The mesh builder to add the vertices and indices to</param>
+	/// <param name="calcTangents">True to calculate tangents and bitangents for the mesh</param>
+	template <typename VertexType = VertexPosNormTexColTangents>
+	static void LoadMesh(const std::string& filename, MeshBuilder<VertexType>& mesh, bool calcTangents = true);
+
 protected:
 	ObjLoader() = default;
 	~ObjLoader() = default;
@@ -26,6 +36,15 @@ protected:
 
 template <typename VertexType>
 VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename, bool calcTangents) {
+	MeshBuilder<VertexType> mesh = MeshBuilder<VertexType>();
+	LoadMesh(filename, mesh, calcTangents);
+
+	// Move our data into a VAO and return it
+	return mesh.Bake();
+}
+
+template <typename VertexType>
+void ObjLoader::LoadMesh(const std::string& filename, MeshBuilder<VertexType>& mesh, bool calcTangents) {
 	// Open our file in binary mode
 	std::ifstream file;
 	file.open(filename, std::ios::binary);
@@ -52,10 +71,6 @@ VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename, boo
 	// has been added to the mesh already
 	std::unordered_map<uint64_t, uint32_t> vertexMap;
 
-	// We'll use the mesh builder since it supports easily adding
-	// vertices and indices
-	MeshBuilder<VertexType> mesh = MeshBuilder<VertexType>();
-
 	// Storage for temporary data
 	std::string line;
 	glm::vec3 vecData;
@@ -186,7 +201,4 @@ VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename, boo
 	// Calculate and trace out how long it took us to load
 	float endTime = static_cast<float>(glfwGetTime());
 	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, mesh.GetVertexCount(), mesh.GetIndexCount());
-
-	// Move our data into a VAO and return it
-	return mesh.Bake();
 }
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include "Utils/ObjParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include "Utils/MappedFile.h"
+#include "Utils/ThreadPool.h"
+#include "Logging.h"
+
+namespace {
+	// Chunks smaller than this aren't worth handing to another thread
+	const size_t MIN_CHUNK_BYTES = 256 * 1024;
+	// How many chunks we make per thread, a few extra lets the pool balance out uneven chunks
+	const size_t CHUNKS_PER_THREAD = 4;
+
+	inline bool IsSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* SkipSpace(const char* p, const char* end) {
+		while (p < end && IsSpace(*p)) p++;
+		return p;
+	}
+
+	inline const char* SkipToken(const char* p, const char* end) {
+		while (p < end && !IsSpace(*p)) p++;
+		return p;
+	}
+
+	inline const char* FindLineEnd(const char* p, const char* end) {
+		const char* result = static_cast<const char*>(memchr(p, '\n', end - p));
+		return result != nullptr ? result : end;
+	}
+
+	enum class LineType {
+		Other,
+		Position,
+		UV,
+		Normal,
+		Face
+	};
+
+	// Works out what a line contains from it's first token, p should point to the start of the token
+	inline LineType GetLineType(const char* p, const char* lineEnd) {
+		size_t length = lineEnd - p;
+		if (length < 2) return LineType::Other;
+		if (p[0] == 'v') {
+			if (IsSpace(p[1])) return LineType::Position;
+			if (length > 2 && IsSpace(p[2])) {
+				if (p[1] == 't') return LineType::UV;
+				if (p[1] == 'n') return LineType::Normal;
+			}
+		}
+		else if (p[0] == 'f' && IsSpace(p[1])) {
+			return LineType::Face;
+		}
+		return LineType::Other;
+	}
+
+	inline const char* ParseFloat(const char* p, const char* end, float& result) {
+		p = SkipSpace(p, end);
+		// from_chars doesn't accept a leading plus
+		if (p < end && *p == '+') p++;
+		std::from_chars_result parsed = std::from_chars(p, end, result);
+		if (parsed.ec != std::errc()) {
+			result = 0.0f;
+			return SkipToken(p, end);
+		}
+		return parsed.ptr;
+	}
+
+	// Parses a single OBJ index, returning 0 if there is no number (ex: the middle of v//vn)
+	inline const char* ParseIndex(const char* p, const char* end, int64_t& result) {
+		result = 0;
+		if (p < end && *p == '+') p++;
+		std::from_chars_result parsed = std::from_chars(p, end, result);
+		return parsed.ec == std::errc() ? parsed.ptr : p;
+	}
+
+	// Converts a 1 based (or negative relative) OBJ index into a 0 based index, or -1 if it
+	// wasn't specified. Out of range indices come back as -2
+	inline int ResolveIndex(int64_t index, size_t countSoFar, size_t total) {
+		if (index == 0) return -1;
+		int64_t resolved = index > 0 ? index - 1 : static_cast<int64_t>(countSoFar) + index;
+		return resolved >= 0 && resolved < static_cast<int64_t>(total) && resolved <= INT32_MAX ? static_cast<int>(resolved) : -2;
+	}
+
+	inline uint32_t HashCorner(const glm::ivec3& corner) {
+		uint64_t hash = static_cast<uint32_t>(corner.x) * 0x9E3779B97F4A7C15ull;
+		hash ^= static_cast<uint32_t>(corner.y) * 0xC2B2AE3D27D4EB4Full;
+		hash ^= static_cast<uint32_t>(corner.z) * 0x165667B19E3779F9ull;
+		hash ^= hash >> 29;
+		return static_cast<uint32_t>(hash ^ (hash >> 32));
+	}
+
+	inline size_t NextPowerOfTwo(size_t value) {
+		size_t result = 16;
+		while (result < value) result <<= 1;
+		return result;
+	}
+}
+
+bool ObjParser::ParseFile(const std::string& filename, Result& result, uint32_t threadCount) {
+	MappedFile file;
+	if (!file.Open(filename)) {
+		LOG_ERROR("Failed to open OBJ file \"{}\"", filename);
+		return false;
+	}
+	bool success = Parse(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), result, threadCount);
+	if (!success) {
+		LOG_ERROR("Source File: {}", filename);
+	}
+	return success;
+}
+
+bool ObjParser::Parse(const char* data, size_t size, Result& result, uint32_t threadCount) {
+	result = Result();
+	result.SourceBytes = size;
+	if (data == nullptr || size == 0) {
+		return true;
+	}
+
+	// Conversions started from a loader thread stay on the loader pool, rather than competing with
+	// the per-frame work on the shared pool
+	ThreadPool& pool = ThreadPool::Current();
+	if (threadCount == 0) {
+		// Threads calling ParallelFor help out, so we get one more than the pool size
+		threadCount = pool.GetThreadCount() + 1;
+	}
+
+	// Split the file into chunks that start at the beginning of a line
+	const char* end = data + size;
+	size_t chunkTarget = threadCount > 1 ? threadCount * CHUNKS_PER_THREAD : 1;
+	size_t chunkBytes = std::max(size / chunkTarget + 1, MIN_CHUNK_BYTES);
+	std::vector<Chunk> chunks;
+	chunks.reserve(chunkTarget + 1);
+	for (const char* begin = data; begin < end; ) {
+		const char* chunkEnd = begin + std::min<size_t>(chunkBytes, end - begin);
+		if (chunkEnd < end) {
+			chunkEnd = FindLineEnd(chunkEnd, end);
+			chunkEnd = chunkEnd < end ? chunkEnd + 1 : end;
+		}
+		Chunk chunk;
+		memset(&chunk, 0, sizeof(Chunk));
+		chunk.Begin = begin;
+		chunk.End = chunkEnd;
+		chunks.push_back(chunk);
+		begin = chunkEnd;
+	}
+
+	auto forEachChunk = [&](const auto& func) {
+		if (threadCount == 1 || chunks.size() == 1) {
+			for (Chunk& chunk : chunks) func(chunk);
+		} else {
+			pool.ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t ix = begin; ix < end; ix++) func(chunks[ix]);
+			});
+		}
+	};
+
+	// First pass, count everything so we can allocate our arrays exactly once
+	forEachChunk([](Chunk& chunk) { _CountChunk(chunk); });
+
+	// Work out where each chunk writes it's data
+	size_t positions = 0, uvs = 0, normals = 0, indices = 0;
+	for (Chunk& chunk : chunks) {
+		chunk.PositionOffset = positions;
+		chunk.UVOffset       = uvs;
+		chunk.NormalOffset   = normals;
+		chunk.IndexOffset    = indices;
+		positions += chunk.PositionCount;
+		uvs       += chunk.UVCount;
+		normals   += chunk.NormalCount;
+		indices   += chunk.IndexCount;
+	}
+	if (indices > UINT32_MAX) {
+		LOG_ERROR("OBJ file has too many faces ({} indices)", indices);
+		return false;
+	}
+	result.Positions.resize(positions);
+	result.UVs.resize(uvs);
+	result.Normals.resize(normals);
+
+	// Second pass, parse into the merged arrays. Faces are stored as resolved attribute indices for now
+	std::vector<glm::ivec3> corners(indices);
+	forEachChunk([&](Chunk& chunk) { _ParseChunk(chunk, result, corners); });
+
+	for (const Chunk& chunk : chunks) {
+		if (chunk.HasError) {
+			LOG_ERROR("OBJ file contains faces that reference attributes that do not exist");
+			result = Result();
+			return false;
+		}
+	}
+
+	// Finally, find the unique vertices
+	_Deduplicate(corners, result);
+	return true;
+}
+
+void ObjParser::_CountChunk(Chunk& chunk) {
+	for (const char* line = chunk.Begin; line < chunk.End; ) {
+		const char* lineEnd = FindLineEnd(line, chunk.End);
+		const char* p = SkipSpace(line, lineEnd);
+		line = lineEnd + 1;
+
+		switch (GetLineType(p, lineEnd)) {
+			case LineType::Position: chunk.PositionCount++; break;
+			case LineType::UV:       chunk.UVCount++; break;
+			case LineType::Normal:   chunk.NormalCount++; break;
+			case LineType::Face: {
+				// Count the corners, polygons get split into a fan of triangles
+				size_t cornerCount = 0;
+				for (p = SkipSpace(p + 1, lineEnd); p < lineEnd; p = SkipSpace(SkipToken(p, lineEnd), lineEnd)) {
+					cornerCount++;
+				}
+				if (cornerCount >= 3) {
+					chunk.IndexCount += (cornerCount - 2) * 3;
+				}
+				break;
+			}
+			default: break;
+		}
+	}
+}
+
+void ObjParser::_ParseChunk(Chunk& chunk, Result& result, std::vector<glm::ivec3>& corners) {
+	size_t position = chunk.PositionOffset;
+	size_t uv       = chunk.UVOffset;
+	size_t normal   = chunk.NormalOffset;
+	size_t index    = chunk.IndexOffset;
+
+	for (const char* line = chunk.Begin; line < chunk.End; ) {
+		const char* lineEnd = FindLineEnd(line, chunk.End);
+		const char* p = SkipSpace(line, lineEnd);
+		line = lineEnd + 1;
+
+		LineType type = GetLineType(p, lineEnd);
+		if (type == LineType::Position) {
+			glm::vec3& value = result.Positions[position++];
+			p = ParseFloat(p + 1, lineEnd, value.x);
+			p = ParseFloat(p, lineEnd, value.y);
+			p = ParseFloat(p, lineEnd, value.z);
+		}
+		else if (type == LineType::UV) {
+			glm::vec2& value = result.UVs[uv++];
+			p = ParseFloat(p + 2, lineEnd, value.x);
+			p = ParseFloat(p, lineEnd, value.y);
+		}
+		else if (type == LineType::Normal) {
+			glm::vec3& value = result.Normals[normal++];
+			p = ParseFloat(p + 2, lineEnd, value.x);
+			p = ParseFloat(p, lineEnd, value.y);
+			p = ParseFloat(p, lineEnd, value.z);
+		}
+		else if (type == LineType::Face) {
+			glm::ivec3 first = glm::ivec3(-1), previous = glm::ivec3(-1);
+			int cornerIx = 0;
+			for (p = SkipSpace(p + 1, lineEnd); p < lineEnd; p = SkipSpace(p, lineEnd), cornerIx++) {
+				// Corners are pos, pos/uv, pos//normal or pos/uv/normal
+				int64_t raw[3] = { 0, 0, 0 };
+				p = ParseIndex(p, lineEnd, raw[0]);
+				for (int ix = 1; ix < 3 && p < lineEnd && *p == '/'; ix++) {
+					p = ParseIndex(p + 1, lineEnd, raw[ix]);
+				}
+				// Skip anything else in the token that we didn't understand
+				p = SkipToken(p, lineEnd);
+
+				glm::ivec3 corner = glm::ivec3(
+					ResolveIndex(raw[0], position, result.Positions.size()),
+					ResolveIndex(raw[1], uv, result.UVs.size()),
+					ResolveIndex(raw[2], normal, result.Normals.size())
+				);
+				if (corner.x < 0 || corner.y == -2 || corner.z == -2) {
+					chunk.HasError = true;
+					corner = glm::ivec3(0, -1, -1);
+				}
+
+				// Fan triangulation, each corner after the second makes a triangle with the first and previous corners
+				if (cornerIx == 0) {
+					first = corner;
+				} else if (cornerIx >= 2) {
+					corners[index++] = first;
+					corners[index++] = previous;
+					corners[index++] = corner;
+				}
+				previous = corner;
+			}
+		}
+	}
+}
+
+void ObjParser::_Deduplicate(const std::vector<glm::ivec3>& corners, Result& result) {
+	// Most meshes have about as many vertices as whichever attribute they have the most of, size the
+	// table for double that so probes stay short, and grow it if we were wrong
+	size_t expected = std::max({ result.Positions.size(), result.UVs.size(), result.Normals.size() });
+	expected = std::min(expected, corners.size());
+	size_t capacity = NextPowerOfTwo(expected * 2);
+
+	// Slots store vertex index + 1, so that 0 can mean empty
+	std::vector<uint32_t> slots(capacity, 0);
+	size_t mask = capacity - 1;
+
+	result.Vertices.reserve(expected);
+	result.Indices.resize(corners.size());
+
+	for (size_t ix = 0; ix < corners.size(); ix++) {
+		const glm::ivec3& corner = corners[ix];
+		size_t slot = HashCorner(corner) & mask;
+		while (slots[slot] != 0 && result.Vertices[slots[slot] - 1] != corner) {
+			slot = (slot + 1) & mask;
+		}
+
+		if (slots[slot] != 0) {
+			result.Indices[ix] = slots[slot] - 1;
+			continue;
+		}
+
+		uint32_t vertex = static_cast<uint32_t>(result.Vertices.size());
+		result.Vertices.push_back(corner);
+		slots[slot] = vertex + 1;
+		result.Indices[ix] = vertex;
+
+		// Keep the load factor under 70%, rehashing from the vertex list if we go over
+		if (result.Vertices.size() * 10 > capacity * 7) {
+			capacity *= 2;
+			mask = capacity - 1;
+			slots.assign(capacity, 0);
+			for (uint32_t existing = 0; existing < result.Vertices.size(); existing++) {
+				size_t target = HashCorner(result.Vertices[existing]) & mask;
+				while (slots[target] != 0) {
+					target = (target + 1) & mask;
+				}
+				slots[target] = existing + 1;
+			}
+		}
+	}
+}
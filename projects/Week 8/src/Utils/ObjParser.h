@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// A fast parser for Wavefront OBJ files, used by the OptimizedObjLoader when converting models
+///
+/// The file is memory mapped and split into line aligned chunks that are parsed in parallel on the
+/// shared thread pool. Parsing happens in two passes over each chunk:
+///  - The first pass only counts attributes and face corners, which gives us the final size of every
+///    array, and the offset that each chunk writes to (so merging the chunks is free)
+///  - The second pass parses numbers with std::from_chars straight into those arrays
+///
+/// Unique position/uv/normal combinations are then found with an open addressing hash table sized from
+/// the first pass counts. Nothing is allocated per line, and there is no limit on attribute counts
+/// beyond the 32 bit indices in the output
+///
+/// Supports v, vt, vn and f (with any number of corners, which are fan triangulated, and negative
+/// relative indices). Everything else (groups, materials, smoothing) is ignored
+/// </summary>
+class ObjParser {
+public:
+	/// <summary>
+	/// The data extracted from an OBJ file
+	/// </summary>
+	struct Result {
+		std::vector<glm::vec3>  Positions;
+		std::vector<glm::vec2>  UVs;
+		std::vector<glm::vec3>  Normals;
+		// The unique combinations of attributes used by faces, as 0 based indices into the attribute
+		// arrays (position, uv, normal). Attributes that a face did not specify are -1
+		std::vector<glm::ivec3> Vertices;
+		// Triangle list, indexing into Vertices
+		std::vector<uint32_t>   Indices;
+		// The size of the source text, in bytes
+		size_t                  SourceBytes = 0;
+	};
+
+	ObjParser() = delete;
+
+	/// <summary>
+	/// Memory maps and parses an OBJ file
+	/// </summary>
+	/// <param name="filename">The path to the file to load</param>
+	/// <param name="result">Will be filled with the contents of the file</param>
+	/// <param name="threadCount">The number of threads to split parsing across, 0 to use the whole thread pool, or 1 to parse on the calling thread</param>
+	/// <returns>True if the file was parsed, false if it could not be opened or contained invalid faces</returns>
+	static bool ParseFile(const std::string& filename, Result& result, uint32_t threadCount = 0);
+	/// <summary>
+	/// Parses OBJ data that has already been loaded into memory
+	/// </summary>
+	/// <param name="data">The text of the OBJ file, does not need to be null terminated</param>
+	/// <param name="size">The size of data, in bytes</param>
+	/// <param name="result">Will be filled with the contents of the file</param>
+	/// <param name="threadCount">The number of threads to split parsing across, 0 to use the whole thread pool, or 1 to parse on the calling thread</param>
+	/// <returns>True if the data was parsed, false if it contained invalid faces</returns>
+	static bool Parse(const char* data, size_t size, Result& result, uint32_t threadCount = 0);
+
+protected:
+	// A line aligned section of the file
+	struct Chunk {
+		const char* Begin;
+		const char* End;
+		// Counts from the first pass
+		size_t      PositionCount;
+		size_t      UVCount;
+		size_t      NormalCount;
+		size_t      IndexCount;
+		// Where this chunk's data starts in the merged arrays
+		size_t      PositionOffset;
+		size_t      UVOffset;
+		size_t      NormalOffset;
+		size_t      IndexOffset;
+		// Set if a face referenced an attribute that does not exist
+		bool        HasError;
+	};
+
+	static void _CountChunk(Chunk& chunk);
+	static void _ParseChunk(Chunk& chunk, Result& result, std::vector<glm::ivec3>& corners);
+	static void _Deduplicate(const std::vector<glm::ivec3>& corners, Result& result);
+};
@@ -1,12 +1,16 @@
 #include "Utils/OptimizedObjLoader.h"
 
 #include "ObjLoader.h"
+#include "Utils/ObjParser.h"
+#include "Utils/MappedFile.h"
 
 #include <string>
-#include <sstream>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 #include "Utils/StringUtils.h"
 #include "GLFW/glfw3.h"
@@ -17,7 +21,27 @@ const std::string binaryExtension = ".bin";
 
 namespace fs = std::filesystem;
 
+OptimizedObjLoader::ConversionSettings OptimizedObjLoader::__conversionSettings = OptimizedObjLoader::ConversionSettings();
+std::mutex OptimizedObjLoader::__conversionMutex;
+std::unordered_map<std::string, std::shared_ptr<std::mutex>> OptimizedObjLoader::__conversionsInFlight;
+
+void OptimizedObjLoader::SetConversionSettings(const ConversionSettings& settings) {
+	__conversionSettings = settings;
+}
+
+const OptimizedObjLoader::ConversionSettings& OptimizedObjLoader::GetConversionSettings() {
+	return __conversionSettings;
+}
+
 VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename) {
+	MeshData data;
+	if (!DecodeFile(filename, data)) {
+		return nullptr;
+	}
+	return UploadMesh(data);
+}
+
+bool OptimizedObjLoader::DecodeFile(const std::string& filename, MeshData& result) {
 	// Get the file extension and lowercase it
 	fs::path filePath = std::filesystem::path(filename);
 	std::string extension = filePath.extension().string();
@@ -29,20 +53,49 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 		fs::path binPath = filePath.replace_extension(binaryExtension);
 		// If the file does not exist, convert the OBJ file to a binary file
 		if (!fs::exists(binPath)) {
-			ConvertToBinary(filename, binPath.string());
+			_ConvertIfMissing(filename, binPath);
 		}
 		// Load the corresponding binary file
-		return _LoadFromBinFile(binPath.string());
+		return _DecodeBinFile(binPath.string(), result);
 	} 
 	// Load our fancy binary files
 	else if (extension == ".bin") {
-		return _LoadFromBinFile(filename);
+		return _DecodeBinFile(filename, result);
 	}
 	// We've never met this extension in our life
 	else {
 		LOG_WARN("Cannot load model from \"{}\"", filename);
-		return nullptr;
+		return false;
+	}
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::UploadMesh(const MeshData& data) {
+	// Hand the mapped data straight to OpenGL, immutable storage lets the driver skip keeping our data around for resizes
+	IndexBuffer::Sptr indices = nullptr;
+	if (data.NumIndices > 0) {
+		indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+		indices->LoadStorage(data.IndexData, (uint32_t)GetIndexTypeSize(data.IndicesType), data.NumIndices, data.IndicesType);
 	}
+	VertexBuffer::Sptr vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	vertices->LoadStorage(data.VertexData, data.VertexStride, data.NumVertices);
+
+	// Create the VAO and attach our index and vertex buffers
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->SetIndexBuffer(indices);
+	result->AddVertexBuffer(vertices, data.VertexDeclaration);
+	result->SetVDecl(data.VertexDeclaration);
+	result->SetBounds(data.Bounds);
+	// Packed positions are relative to the bounds, so the renderer needs to scale them back out
+	if (data.PackedPositions) {
+		result->SetPositionTransform(VertexPackedPosNormTexColTangents::GetPositionTransform(data.Bounds));
+	}
+	// A single submesh covering everything is the same as no submeshes, so we can skip the base vertex draws
+	const std::vector<VertexArrayObject::SubMesh>& subMeshes = data.SubMeshes;
+	if (indices != nullptr && (subMeshes.size() > 1 || (subMeshes.size() == 1 && (subMeshes[0].IndexOffset != 0 || subMeshes[0].IndexCount != data.NumIndices || subMeshes[0].BaseVertex != 0)))) {
+		result->SetSubMeshes(subMeshes);
+	}
+
+	return result;
 }
 
 void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::string& outFile) {
@@ -51,6 +104,14 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 
 	float startTime = static_cast<float>(glfwGetTime());
 
+	// Reorder the mesh for the GPU, since we only do this once per model we can afford to be thorough
+	if (__conversionSettings.OptimizeMesh) {
+		MeshOptimizer::Stats stats = mesh->Optimize(__conversionSettings.Optimizer);
+		float optimizeTime = static_cast<float>(glfwGetTime());
+		LOG_INFO("Optimized \"{}\" in {} seconds: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f} ({} overdraw clusters)", inFile, optimizeTime - startTime,
+			stats.Before.ACMR, stats.After.ACMR, stats.Before.ATVR, stats.After.ATVR, stats.ClusterCount);
+	}
+
 	// If we didn't get an output path, just take the input and replace the extension
 	std::string outFileName = outFile;
 	if (outFileName.empty()) { 
@@ -62,163 +123,106 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 		outFileName = path.string();
 	}
 
-	// Save the mesh to the file
-	SaveBinaryFile(*mesh, outFileName);
+	// Save the mesh to the file, packing the vertices first if we need to
+	if (__conversionSettings.VertexFormat == BinaryVertexFormat::Packed) {
+		AABB bounds;
+		const VertexPosNormTexColTangents* vertices = mesh->GetVertexDataPtr();
+		for (size_t ix = 0; ix < mesh->GetVertexCount(); ix++) {
+			bounds.Expand(vertices[ix].Position);
+		}
+
+		MeshBuilder<VertexPackedPosNormTexColTangents> packed;
+		packed.ReserveVertexSpace(mesh->GetVertexCount());
+		for (size_t ix = 0; ix < mesh->GetVertexCount(); ix++) {
+			packed.AddVertex(VertexPackedPosNormTexColTangents::Pack(vertices[ix], bounds));
+		}
+		packed.ReserveIndexSpace(mesh->GetIndexCount());
+		const uint32_t* indices = mesh->GetIndexDataPtr();
+		for (size_t ix = 0; ix < mesh->GetIndexCount(); ix++) {
+			packed.AddIndex(indices[ix]);
+		}
+		SaveBinaryFile(packed, outFileName, {}, bounds);
+	} else {
+		SaveBinaryFile(*mesh, outFileName);
+	}
 
 	float endTime = static_cast<float>(glfwGetTime());
-	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices, {} vertex format)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount(),
+		~__conversionSettings.VertexFormat);
 
 	// We no longer need the mesh data, free it
 	delete mesh;
 }
 
+void OptimizedObjLoader::_ConvertIfMissing(const std::string& inFile, const fs::path& outFile) {
+	// Grab the lock for this output file, anyone else converting the same file will share it
+	const std::string key = fs::absolute(outFile).lexically_normal().string();
+	std::shared_ptr<std::mutex> fileLock;
+	{
+		std::lock_guard<std::mutex> lock(__conversionMutex);
+		std::shared_ptr<std::mutex>& entry = __conversionsInFlight[key];
+		if (entry == nullptr) {
+			entry = std::make_shared<std::mutex>();
+		}
+		fileLock = entry;
+	}
+
+	// Releases our hold on the file's lock, removing it once nobody else is waiting on it
+	auto release = [&]() {
+		std::lock_guard<std::mutex> lock(__conversionMutex);
+		auto it = __conversionsInFlight.find(key);
+		fileLock = nullptr;
+		if (it != __conversionsInFlight.end() && it->second.use_count() == 1) {
+			__conversionsInFlight.erase(it);
+		}
+	};
+
+	try {
+		std::lock_guard<std::mutex> lock(*fileLock);
+		// Someone else may have finished converting while we were waiting
+		if (!fs::exists(outFile)) {
+			ConvertToBinary(inFile, outFile.string());
+		}
+	}
+	catch (...) {
+		release();
+		throw;
+	}
+	release();
+}
+
 MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(const std::string& filename) {
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
+	float startTime = static_cast<float>(glfwGetTime());
 
-	// If our file fails to open, we will throw an error
-	if (!file) {
-		throw std::runtime_error("Failed to open file");
+	// Parse the file, this will memory map it and split the work across the thread pool
+	ObjParser::Result obj;
+	if (!ObjParser::ParseFile(filename, obj)) {
+		throw std::runtime_error("Failed to load OBJ file");
 	}
 
+	float parseTime = static_cast<float>(glfwGetTime());
+
 	// Could also take this in as a parameter
 	glm::vec4 color = glm::vec4(1.0f);
 
-	// Our attributes
-	std::vector<glm::vec3>  positions;
-	std::vector<glm::vec3>  normals;
-	std::vector<glm::vec2>  uvs;
-	std::vector<glm::ivec3> vertices;
-	std::vector<uint32_t>   indices;
-
-	// Maps a key generated from obj indices to a vertex index that
-	// has been added to the mesh already
-	std::unordered_map<uint64_t, uint32_t> vertexMap;
-
 	// We'll use the mesh builder since it supports easily adding
 	// vertices and indices
 	MeshBuilder<VertexPosNormTexColTangents>* mesh = new MeshBuilder<VertexPosNormTexColTangents>();
 
-	// Storage for temporary data
-	std::string line;
-	glm::vec3 vecData;
-	glm::ivec3 vertexIndices;
-
-	float startTime = static_cast<float>(glfwGetTime());
-
-	// Read and process the entire file
-	while (file.peek() != EOF) {
-		// Read in the first part of the line (ex: f, v, vn, etc...)
-		std::string command;
-		file >> command;
-
-		// We will ignore the rest of the line for comment lines
-		if (command == "#") {
-			std::getline(file, line);
-		}
-
-		// The v command defines a vertex's position
-		else if (command == "v") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			positions.push_back(vecData);
-		}
-		// TODO: handle normals and textures
-		else if (command == "vn") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			normals.push_back(vecData);
-		} else if (command == "vt") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y;
-			uvs.push_back(vecData);
-		}
-
-		// The f command defines a polygon in the mesh
-		// NOTE: make sure you triangulate in blender, otherwise it will
-		// output quads instead of triangles
-		else if (command == "f") {
-			// Read the rest of the line from the file
-			std::getline(file, line);
-			// Trim whitespace from either end of the line
-			StringTools::Trim(line);
-			// Create a string stream so we can use streaming operators on it
-			std::stringstream stream = std::stringstream(line);
-
-			uint32_t edges[4];
-			int ix = 0;
-			// Iterate over up to 4 sets of attributes
-			for (; ix < 4; ix++) {
-				if (stream.peek() != EOF) {
-					// Load in the faces, split up by slashes
-					char tempChar;
-					vertexIndices = glm::ivec3(0);
-					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
-					// The OBJ format can have negative values, which are a reference from the last added attributes
-					if (vertexIndices.x < 0) { vertexIndices.x = positions.size() + 1 + vertexIndices.x; }
-					if (vertexIndices.y < 0) { vertexIndices.y = uvs.size()       + 1 + vertexIndices.y; }
-					if (vertexIndices.z < 0) { vertexIndices.z = normals.size()   + 1 + vertexIndices.z; }
-
-					// We can construct a key using a bitmask of the attribute indices
-					// This let's us quickly look up a combination of attributes to see if it's already been added
-					// Note that this limits us to 2,097,150 unique attributes for positions, normals and textures
-					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
-					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
-
-					// Find the index associated with the combination of attributes
-					auto it = vertexMap.find(key);
-
-					// If it exists, we push the index to our indices
-					if (it != vertexMap.end()) {
-						edges[ix] = it->second;
-					} else {
-						vertices.push_back(vertexIndices - glm::ivec3(1));
-						uint32_t index = static_cast<uint32_t>(vertices.size()) - 1;
-
-						// Cache the index based on our key
-						vertexMap[key] = index;
-						// Add index to mesh, and add to edges list for if we are using quads
-						edges[ix] = index;
-					}
-				}
-				// We've reached the end of the line, break out of the loop
-				else { break; }
-			}
-
-			// Handling for triangle faces
-			if (ix == 3) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-			}
-			// Handling for quad faces
-			else if (ix == 4) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-
-				indices.push_back(edges[0]);
-				indices.push_back(edges[2]);
-				indices.push_back(edges[3]);
-			}
-		}
-	}
-
-	mesh->ReserveVertexSpace(vertices.size());
-	for (const auto& vertexIndices : vertices) {
-		// Construct a new vertex using the indices for the vertex
+	mesh->ReserveVertexSpace(obj.Vertices.size());
+	for (const glm::ivec3& vertexIndices : obj.Vertices) {
+		// Construct a new vertex using the indices for the vertex, missing attributes are -1
 		VertexPosNormTexColTangents vertex;
-		vertex.Position = positions[vertexIndices.x];
-		vertex.UV       = vertexIndices.y != 0 ? uvs[vertexIndices.y] : glm::vec2(0.0f);
-		vertex.Normal   = vertexIndices.z != 0 ? normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
+		vertex.Position = obj.Positions[vertexIndices.x];
+		vertex.UV       = vertexIndices.y >= 0 ? obj.UVs[vertexIndices.y] : glm::vec2(0.0f);
+		vertex.Normal   = vertexIndices.z >= 0 ? obj.Normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
 		vertex.Color    = color;
 
 		// Add to the mesh, get index of the added vertex
 		mesh->AddVertex(vertex);
 	}
-	mesh->ReserveIndexSpace(indices.size());
-	for (uint32_t ix : indices) {
+	mesh->ReserveIndexSpace(obj.Indices.size());
+	for (uint32_t ix : obj.Indices) {
 		mesh->AddIndex(ix);
 	}
 
@@ -227,102 +231,407 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 
 	// Calculate and trace out how long it took us to load
 	float endTime = static_cast<float>(glfwGetTime());
-	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+	float parseSeconds = parseTime - startTime;
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices, parsed at {:.1f} MB/s)", filename, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount(),
+		parseSeconds > 0.0f ? obj.SourceBytes / (1024.0 * 1024.0) / parseSeconds : 0.0);
 
 	// Move our data into a VAO and return it
 	return mesh;
 }
 
-VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
-
-	// Open the output file
-	std::ifstream file(filename, std::ios::binary);
+bool OptimizedObjLoader::_DecodeBinFile(const std::string& filename, MeshData& result) {
+	// Map the file rather than reading it, the index and vertex data goes straight from the
+	// mapped pages to OpenGL without a copy on our heap
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
 	// If our file fails to open, we will throw an error
-	if (!file) { throw std::runtime_error("Failed to open file"); }
+	if (!file->Open(filename)) { throw std::runtime_error("Failed to open file"); }
 
-	float startTime = static_cast<float>(glfwGetTime());
+	// Read the magic and version, which are the same for all versions
+	BinaryHeaderCommon common = BinaryHeaderCommon();
+	if (file->GetSize() >= sizeof(BinaryHeaderCommon)) {
+		memcpy(&common, file->GetData(), sizeof(BinaryHeaderCommon));
+	} else {
+		LOG_ERROR("Not enough data in the file \"{}\"!", filename);
+		return false;
+	}
+
+	if (memcmp(common.HeaderBytes, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0) {
+		LOG_ERROR("\"{}\" is not a BOBJ file!", filename);
+		return false;
+	}
 
-	// Get the file size so we can avoid reading past the end
-	file.seekg(0, std::ios::end);
-	size_t size = file.tellg();
-	file.seekg(0, std::ios::beg);
+	// Handle our version
+	bool success = false;
+	switch (common.Version) {
+		case 0x01: success = _DecodeBinV1(filename, file->GetData(), file->GetSize(), result); break;
+		case 0x02: success = _DecodeBinV2(filename, file->GetData(), file->GetSize(), result); break;
+		default:
+			LOG_ERROR("Unsupported BOBJ version {} in \"{}\"", common.Version, filename);
+			return false;
+	}
+	if (!success) {
+		return false;
+	}
+
+	// Touch every page of the bulk data, so that reading it from disk happens on this thread (which is a
+	// worker for async loads) instead of in the middle of the upload
+	const size_t pageSize = 4096;
+	uint8_t touched = 0;
+	const size_t indexBytes = result.NumIndices * GetIndexTypeSize(result.IndicesType);
+	for (size_t offset = 0; offset < indexBytes; offset += pageSize) {
+		touched ^= result.IndexData[offset];
+	}
+	const size_t vertexBytes = result.NumVertices * (size_t)result.VertexStride;
+	for (size_t offset = 0; offset < vertexBytes; offset += pageSize) {
+		touched ^= result.VertexData[offset];
+	}
+	volatile uint8_t sink = touched;
+	(void)sink;
+
+	result.Filename = filename;
+	result.File = file;
+	return true;
+}
+
+bool OptimizedObjLoader::_DecodeBinV1(const std::string& filename, const uint8_t* data, size_t size, MeshData& result) {
+	float startTime = static_cast<float>(glfwGetTime());
 
 	// Read the header from the file
 	BinaryHeader header = BinaryHeader();
 	if (size >= sizeof(BinaryHeader)) {
-		file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
+		memcpy(&header, data, sizeof(BinaryHeader));
 	} else {
 		LOG_ERROR("Not enough data in the file!");
-		return nullptr;
+		return false;
 	}
 
-	// TODO: validate header
+	// Validate the header before we trust any of the sizes in it
+	if (header.NumIndices > 0 && GetIndexTypeSize(header.IndicesType) == 0) {
+		LOG_ERROR("Invalid index type in \"{}\"", filename);
+		return false;
+	}
+	if (header.NumVertices == 0 || header.VertexStride == 0 || header.NumAttributes == 0) {
+		LOG_ERROR("\"{}\" has no vertex data!", filename);
+		return false;
+	}
 
-	// Handle our version
-	if (header.Version == 0x01) {
-		// Determine how many bytes we need in the file
-		size_t requiredBytes =
-			sizeof(BinaryHeader) +
-			(header.NumAttributes * sizeof(BufferAttribute)) +
-			(header.VertexStride * (size_t)header.NumVertices) +
-			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-
-		// Make sure there's enough data in the file
-		if (size < requiredBytes) {
-			LOG_ERROR("Not enough data in the file!");
-			return nullptr;
+	// Determine how many bytes we need in the file
+	size_t requiredBytes =
+		sizeof(BinaryHeader) +
+		(header.NumAttributes * sizeof(BufferAttribute)) +
+		(header.VertexStride * (size_t)header.NumVertices) +
+		(header.NumIndices * GetIndexTypeSize(header.IndicesType));
+
+	// Make sure there's enough data in the file
+	if (size < requiredBytes) {
+		LOG_ERROR("Not enough data in the file!");
+		return false;
+	}
+
+	// Read all attributes from the file, this is basically our VDECL
+	const uint8_t* cursor = data + sizeof(BinaryHeader);
+	std::vector<BufferAttribute> vertexDeclaration;
+	vertexDeclaration.resize(header.NumAttributes);
+	for (int ix = 0; ix < header.NumAttributes; ix++) {
+		memcpy(&vertexDeclaration[ix], cursor, sizeof(BufferAttribute));
+		cursor += sizeof(BufferAttribute);
+
+		const BufferAttribute& attrib = vertexDeclaration[ix];
+		if (attrib.Size < 1 || attrib.Size > 4 || GetAttributeTypeSize(attrib.Type) == 0 || attrib.Offset < 0 ||
+			attrib.Offset + attrib.Size * GetAttributeTypeSize(attrib.Type) > header.VertexStride) {
+			LOG_ERROR("Invalid vertex attribute {} in \"{}\"", ix, filename);
+			return false;
 		}
+	}
+
+	// The indices come first, then the vertices, both are read straight out of the file
+	if (header.NumIndices > 0) {
+		result.IndexData = cursor;
+		result.NumIndices = header.NumIndices;
+		result.IndicesType = header.IndicesType;
+		cursor += header.NumIndices * GetIndexTypeSize(header.IndicesType);
+	}
+	result.VertexData = cursor;
+	result.NumVertices = header.NumVertices;
+	result.VertexStride = header.VertexStride;
+	result.VertexDeclaration = vertexDeclaration;
+
+	// Version 1 doesn't store bounds, so we calculate them from the position attribute
+	result.Bounds = _CalculateBounds(cursor, header.VertexStride, vertexDeclaration, nullptr, header.NumVertices);
+
+	// Calculate and trace out how long it took us to load
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+
+	return true;
+}
+
+bool OptimizedObjLoader::_DecodeBinV2(const std::string& filename, const uint8_t* data, size_t size, MeshData& result) {
+	float startTime = static_cast<float>(glfwGetTime());
+
+	BinaryHeaderV2 header = BinaryHeaderV2();
+	if (size >= sizeof(BinaryHeaderV2)) {
+		memcpy(&header, data, sizeof(BinaryHeaderV2));
+	} else {
+		LOG_ERROR("Not enough data in the file!");
+		return false;
+	}
+	if (header.HeaderSize != sizeof(BinaryHeaderV2)) {
+		LOG_ERROR("Unexpected header size {} in \"{}\"", header.HeaderSize, filename);
+		return false;
+	}
+
+	// Make sure every section is aligned and inside of the file before we read from the tables
+	const size_t indexSize = GetIndexTypeSize(header.IndicesType);
+	const uint64_t attributeBytes = header.NumAttributes * (uint64_t)sizeof(BinaryAttribute);
+	const uint64_t subMeshBytes = header.NumSubMeshes * (uint64_t)sizeof(BinarySubMesh);
+	const uint64_t indexBytes = header.NumIndices * (uint64_t)indexSize;
+	const uint64_t vertexBytes = header.NumVertices * (uint64_t)header.VertexStride;
+	auto isValidSection = [&](uint64_t offset, uint64_t bytes) {
+		return offset % BINARY_ALIGNMENT == 0 && offset >= sizeof(BinaryHeaderV2) && offset <= size && bytes <= size - offset;
+	};
+	if ((header.Flags & ~BINARY_FLAG_PACKED_POSITIONS) != 0 ||
+		(header.NumIndices > 0 && indexSize == 0) ||
+		header.NumVertices == 0 || header.VertexStride == 0 || header.NumAttributes == 0 ||
+		!isValidSection(header.AttributesOffset, attributeBytes) ||
+		!isValidSection(header.SubMeshesOffset, subMeshBytes) ||
+		!isValidSection(header.IndexDataOffset, indexBytes) ||
+		!isValidSection(header.VertexDataOffset, vertexBytes)) {
+		LOG_ERROR("Invalid or truncated BOBJ header in \"{}\"", filename);
+		return false;
+	}
+
+	// The checksum covers the header and both tables, so we know the values we're about to use weren't corrupted.
+	// The bulk data is left out, hashing it would mean touching every page we mapped
+	uint32_t checksum = header.Checksum;
+	header.Checksum = 0;
+	uint32_t hash = _Fnv1a(&header, sizeof(BinaryHeaderV2));
+	hash = _Fnv1a(data + header.AttributesOffset, attributeBytes, hash);
+	hash = _Fnv1a(data + header.SubMeshesOffset, subMeshBytes, hash);
+	if (hash != checksum) {
+		LOG_ERROR("Checksum mismatch in \"{}\", the file may be corrupt", filename);
+		return false;
+	}
 
-		// Read all attributes from the file, this is basically our VDECL
-		std::vector<BufferAttribute> vertexDeclaration;
-		vertexDeclaration.resize(header.NumAttributes);
-		for (int ix = 0; ix < header.NumAttributes; ix++) {
-			file.read(reinterpret_cast<char*>(&vertexDeclaration[ix]), sizeof(BufferAttribute));
+	// Read the attribute table into a vertex declaration
+	VertexArrayObject::VertexDeclaration vertexDeclaration;
+	vertexDeclaration.reserve(header.NumAttributes);
+	for (uint32_t ix = 0; ix < header.NumAttributes; ix++) {
+		BinaryAttribute attrib;
+		memcpy(&attrib, data + header.AttributesOffset + ix * sizeof(BinaryAttribute), sizeof(BinaryAttribute));
+
+		const size_t typeSize = GetAttributeTypeSize(attrib.Type);
+		if (attrib.Size < 1 || attrib.Size > 4 || typeSize == 0 || attrib.Offset + attrib.Size * typeSize > header.VertexStride) {
+			LOG_ERROR("Invalid vertex attribute {} in \"{}\"", ix, filename);
+			return false;
 		}
+		vertexDeclaration.push_back(BufferAttribute(attrib.Slot, attrib.Size, attrib.Type, header.VertexStride, attrib.Offset, attrib.Usage, attrib.Normalized != 0));
+	}
 
-		// These will have the buffer pointers
-		IndexBuffer::Sptr indices = nullptr;
-		VertexBuffer::Sptr vertices = nullptr;
-
-		// If we have index data, load it
-		if (header.NumIndices > 0) {
-			// Create index buffer
-			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
-
-			// Create memory to store indices, then read from the file
-			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
-			free(dataStore);
+	// Read the submesh table
+	std::vector<VertexArrayObject::SubMesh> subMeshes;
+	subMeshes.reserve(header.NumSubMeshes);
+	for (uint32_t ix = 0; ix < header.NumSubMeshes; ix++) {
+		BinarySubMesh subMesh;
+		memcpy(&subMesh, data + header.SubMeshesOffset + ix * sizeof(BinarySubMesh), sizeof(BinarySubMesh));
+
+		if ((uint64_t)subMesh.IndexOffset + subMesh.IndexCount > header.NumIndices || subMesh.BaseVertex < 0 || (uint32_t)subMesh.BaseVertex >= header.NumVertices) {
+			LOG_ERROR("Invalid submesh {} in \"{}\"", ix, filename);
+			return false;
 		}
+		subMeshes.push_back(VertexArrayObject::SubMesh(subMesh.IndexOffset, subMesh.IndexCount, subMesh.BaseVertex, subMesh.Lod,
+			AABB(glm::vec3(subMesh.BoundsMin[0], subMesh.BoundsMin[1], subMesh.BoundsMin[2]), glm::vec3(subMesh.BoundsMax[0], subMesh.BoundsMax[1], subMesh.BoundsMax[2]))));
+	}
+
+	// Point at the sections in the mapped data, these go to OpenGL without a copy in UploadMesh
+	if (header.NumIndices > 0) {
+		result.IndexData = data + header.IndexDataOffset;
+		result.NumIndices = header.NumIndices;
+		result.IndicesType = header.IndicesType;
+	}
+	result.VertexData = data + header.VertexDataOffset;
+	result.NumVertices = header.NumVertices;
+	result.VertexStride = header.VertexStride;
+	result.VertexDeclaration = vertexDeclaration;
+	result.SubMeshes = subMeshes;
+	result.Bounds = AABB(glm::vec3(header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2]), glm::vec3(header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2]));
+	result.PackedPositions = (header.Flags & BINARY_FLAG_PACKED_POSITIONS) != 0;
 
-		// Create a new VBO
-		vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	// Calculate and trace out how long it took us to load
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices, {} submeshes)", filename, endTime - startTime, header.NumVertices, header.NumIndices,
+		subMeshes.size());
+
+	return true;
+}
 
-		// Create memory to store vertices and load from file
-		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
-		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
+void OptimizedObjLoader::_SaveBinV2(const std::string& outFilename, const void* vertices, uint32_t numVertices, uint32_t vertexStride,
+									const VertexArrayObject::VertexDeclaration& vDecl, const uint32_t* indices, uint32_t numIndices,
+									const std::vector<VertexArrayObject::SubMesh>& subMeshes, const AABB& packedBounds)
+{
+	// We write to a temporary file and move it into place once it's complete, so that nobody can
+	// map a half written file
+	const std::string tempFilename = outFilename + ".tmp";
+	std::ofstream file(tempFilename, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open output file");
+	}
+
+	const uint8_t* vertexData = reinterpret_cast<const uint8_t*>(vertices);
+	auto alignUp = [](uint64_t value) { return (value + BINARY_ALIGNMENT - 1) & ~(uint64_t)(BINARY_ALIGNMENT - 1); };
+
+	// If we don't have any submeshes, we store the whole mesh as LOD 0
+	std::vector<BinarySubMesh> binarySubMeshes;
+	if (subMeshes.size() > 0) {
+		binarySubMeshes.reserve(subMeshes.size());
+		for (const VertexArrayObject::SubMesh& subMesh : subMeshes) {
+			LOG_ASSERT((uint64_t)subMesh.IndexOffset + subMesh.IndexCount <= numIndices, "Submesh is outside of the index buffer!");
+			BinarySubMesh entry;
+			entry.IndexOffset = subMesh.IndexOffset;
+			entry.IndexCount  = subMesh.IndexCount;
+			entry.BaseVertex  = subMesh.BaseVertex;
+			entry.Lod         = subMesh.Lod;
+			// Calculate the bounds if they weren't provided
+			AABB bounds = subMesh.Bounds.IsValid() ? subMesh.Bounds : 
+				_CalculateBounds(vertexData, vertexStride, vDecl, indices + subMesh.IndexOffset, subMesh.IndexCount, subMesh.BaseVertex, packedBounds);
+			memcpy(entry.BoundsMin, &bounds.Min, sizeof(entry.BoundsMin));
+			memcpy(entry.BoundsMax, &bounds.Max, sizeof(entry.BoundsMax));
+			binarySubMeshes.push_back(entry);
+		}
+	} else if (numIndices > 0) {
+		BinarySubMesh entry;
+		entry.IndexCount = numIndices;
+		binarySubMeshes.push_back(entry);
+	}
 
-		// Load data into OpenGL and free the CPU copy
-		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
+	// Calculate the bounds of the whole mesh, packed positions need the exact bounds they were packed with
+	AABB bounds = packedBounds.IsValid() ? packedBounds : _CalculateBounds(vertexData, vertexStride, vDecl, nullptr, numVertices);
+	if (!bounds.IsValid()) {
+		bounds = AABB(glm::vec3(0.0f), glm::vec3(0.0f));
+	}
+	if (subMeshes.size() == 0 && binarySubMeshes.size() == 1) {
+		memcpy(binarySubMeshes[0].BoundsMin, &bounds.Min, sizeof(binarySubMeshes[0].BoundsMin));
+		memcpy(binarySubMeshes[0].BoundsMax, &bounds.Max, sizeof(binarySubMeshes[0].BoundsMax));
+	}
 
-		// Create the VAO and attach our index and vertex buffers
-		VertexArrayObject::Sptr result = VertexArrayObject::Create();
-		result->SetIndexBuffer(indices);
-		result->AddVertexBuffer(vertices, vertexDeclaration);
+	// Convert the vertex declaration into our fixed size records
+	std::vector<BinaryAttribute> attributes;
+	attributes.reserve(vDecl.size());
+	for (const BufferAttribute& attrib : vDecl) {
+		BinaryAttribute entry;
+		entry.Slot       = attrib.Slot;
+		entry.Size       = static_cast<uint8_t>(attrib.Size);
+		entry.Normalized = attrib.Normalized ? 1 : 0;
+		entry.Usage      = attrib.Usage;
+		entry.Type       = attrib.Type;
+		entry.Offset     = attrib.Offset;
+		attributes.push_back(entry);
+	}
 
-		// Copy in the vertex declaration we loaded
-		result->SetVDecl(vertexDeclaration);
+	// Small meshes can use 16 bit indices, which halves the size of the index buffer
+	uint32_t maxIndex = 0;
+	for (uint32_t ix = 0; ix < numIndices; ix++) {
+		maxIndex = std::max(maxIndex, indices[ix]);
+	}
+	IndexType indexType = maxIndex <= std::numeric_limits<uint16_t>::max() ? IndexType::UShort : IndexType::UInt;
+	std::vector<uint16_t> shortIndices;
+	if (indexType == IndexType::UShort) {
+		shortIndices.resize(numIndices);
+		for (uint32_t ix = 0; ix < numIndices; ix++) {
+			shortIndices[ix] = static_cast<uint16_t>(indices[ix]);
+		}
+	}
 
-		// Calculate and trace out how long it took us to load
-		float endTime = static_cast<float>(glfwGetTime());
-		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+	// Lay out all our sections, each starting on an aligned offset
+	BinaryHeaderV2 header    = BinaryHeaderV2();
+	header.Flags             = packedBounds.IsValid() ? BINARY_FLAG_PACKED_POSITIONS : 0;
+	header.NumVertices       = numVertices;
+	header.VertexStride      = vertexStride;
+	header.NumIndices        = numIndices;
+	header.IndicesType       = numIndices > 0 ? indexType : IndexType::Unknown;
+	header.NumAttributes     = static_cast<uint16_t>(attributes.size());
+	header.NumSubMeshes      = static_cast<uint16_t>(binarySubMeshes.size());
+	header.AttributesOffset  = static_cast<uint32_t>(alignUp(sizeof(BinaryHeaderV2)));
+	header.SubMeshesOffset   = static_cast<uint32_t>(alignUp(header.AttributesOffset + attributes.size() * sizeof(BinaryAttribute)));
+	header.IndexDataOffset   = alignUp(header.SubMeshesOffset + binarySubMeshes.size() * sizeof(BinarySubMesh));
+	header.VertexDataOffset  = alignUp(header.IndexDataOffset + numIndices * GetIndexTypeSize(header.IndicesType));
+	memcpy(header.BoundsMin, &bounds.Min, sizeof(header.BoundsMin));
+	memcpy(header.BoundsMax, &bounds.Max, sizeof(header.BoundsMax));
+
+	// Checksum is calculated with the checksum field set to zero
+	uint32_t hash = _Fnv1a(&header, sizeof(BinaryHeaderV2));
+	hash = _Fnv1a(attributes.data(), attributes.size() * sizeof(BinaryAttribute), hash);
+	hash = _Fnv1a(binarySubMeshes.data(), binarySubMeshes.size() * sizeof(BinarySubMesh), hash);
+	header.Checksum = hash;
+
+	// Writes zeroes until we reach the given offset
+	auto padTo = [&](uint64_t offset) {
+		static const char zeroes[BINARY_ALIGNMENT] ={ 0 };
+		uint64_t position = static_cast<uint64_t>(file.tellp());
+		LOG_ASSERT(position <= offset, "Binary file sections overlap!");
+		file.write(zeroes, offset - position);
+	};
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeaderV2));
+	padTo(header.AttributesOffset);
+	file.write(reinterpret_cast<const char*>(attributes.data()), attributes.size() * sizeof(BinaryAttribute));
+	padTo(header.SubMeshesOffset);
+	file.write(reinterpret_cast<const char*>(binarySubMeshes.data()), binarySubMeshes.size() * sizeof(BinarySubMesh));
+	padTo(header.IndexDataOffset);
+	if (indexType == IndexType::UShort) {
+		file.write(reinterpret_cast<const char*>(shortIndices.data()), numIndices * sizeof(uint16_t));
+	} else {
+		file.write(reinterpret_cast<const char*>(indices), numIndices * sizeof(uint32_t));
+	}
+	padTo(header.VertexDataOffset);
+	file.write(reinterpret_cast<const char*>(vertexData), numVertices * (size_t)vertexStride);
+
+	file.close();
+	std::error_code error;
+	if (file.fail()) {
+		fs::remove(tempFilename, error);
+		throw std::runtime_error("Failed to write output file");
+	}
+	fs::rename(tempFilename, outFilename, error);
+	if (error) {
+		fs::remove(tempFilename, error);
+		throw std::runtime_error("Failed to move output file into place");
+	}
+}
 
-		return result;
+AABB OptimizedObjLoader::_CalculateBounds(const uint8_t* vertices, uint32_t stride, const VertexArrayObject::VertexDeclaration& vDecl,
+										  const uint32_t* indices, uint32_t count, int32_t baseVertex, const AABB& packedBounds)
+{
+	AABB bounds;
+	for (const BufferAttribute& attrib : vDecl) {
+		if (attrib.Usage != AttribUsage::Position || attrib.Size < 3) continue;
+
+		const bool isPacked = attrib.Type == AttributeType::UShort && attrib.Normalized && packedBounds.IsValid();
+		if (attrib.Type != AttributeType::Float && !isPacked) continue;
+
+		const uint8_t* data = vertices + attrib.Offset;
+		for (uint32_t ix = 0; ix < count; ix++) {
+			size_t vertex = indices != nullptr ? (size_t)(indices[ix] + baseVertex) : ix;
+			glm::vec3 position;
+			if (isPacked) {
+				glm::u16vec3 packed;
+				memcpy(&packed, data + vertex * stride, sizeof(glm::u16vec3));
+				position = packedBounds.Min + glm::vec3(packed) / 65535.0f * (packedBounds.Max - packedBounds.Min);
+			} else {
+				memcpy(&position, data + vertex * stride, sizeof(glm::vec3));
+			}
+			bounds.Expand(position);
+		}
+		break;
 	}
+	return bounds;
+}
 
-	return nullptr;
+uint32_t OptimizedObjLoader::_Fnv1a(const void* data, size_t size, uint32_t hash) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	for (size_t ix = 0; ix < size; ix++) {
+		hash ^= bytes[ix];
+		hash *= 16777619u;
+	}
+	return hash;
 }
@@ -7,11 +7,29 @@
  */
 #pragma once
 #include <fstream>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <filesystem>
+#include <unordered_map>
 
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
 
 #include "Utils/MeshBuilder.h"
+#include "Utils/MeshOptimizer.h"
+
+class MappedFile;
+
+/// <summary>
+/// The vertex formats that OBJ files can be converted to
+/// </summary>
+ENUM(BinaryVertexFormat, int,
+	// VertexPosNormTexColTangents, full precision floats (80 bytes)
+	Full   = 0,
+	// VertexPackedPosNormTexColTangents, quantized positions, normals, UVs and colors (24 bytes)
+	Packed = 1
+)
 
 /// <summary>
 /// An optimized OBJ loader that can convert an OBJ file to a binary representation
@@ -19,6 +37,46 @@
 /// </summary>
 class OptimizedObjLoader {
 public:
+	/// <summary>
+	/// Settings that are applied when converting OBJ files to binary files
+	/// </summary>
+	struct ConversionSettings {
+		// True to reorder the mesh for the GPU's vertex caches before saving, see MeshOptimizer
+		bool                   OptimizeMesh = true;
+		MeshOptimizer::Options Optimizer;
+		// The vertex format to store in the binary file
+		BinaryVertexFormat     VertexFormat = BinaryVertexFormat::Full;
+	};
+
+	/// <summary>
+	/// The contents of a binary file that has been mapped and validated, but not uploaded to OpenGL yet.
+	/// The index and vertex data point into the mapped file, which stays open as long as this does
+	/// </summary>
+	struct MeshData {
+		std::string                             Filename;
+		std::shared_ptr<MappedFile>             File = nullptr;
+		const uint8_t*                          IndexData = nullptr;
+		uint32_t                                NumIndices = 0;
+		IndexType                               IndicesType = IndexType::Unknown;
+		const uint8_t*                          VertexData = nullptr;
+		uint32_t                                NumVertices = 0;
+		uint32_t                                VertexStride = 0;
+		VertexArrayObject::VertexDeclaration    VertexDeclaration;
+		std::vector<VertexArrayObject::SubMesh> SubMeshes;
+		AABB                                    Bounds;
+		// True if positions are unorm16 values relative to the bounds
+		bool                                    PackedPositions = false;
+	};
+
+	/// <summary>
+	/// Sets the settings used by ConvertToBinary, including the conversions done by LoadFromFile
+	/// </summary>
+	static void SetConversionSettings(const ConversionSettings& settings);
+	/// <summary>
+	/// Gets the settings used by ConvertToBinary
+	/// </summary>
+	static const ConversionSettings& GetConversionSettings();
+
 	/// <summary>
 	/// Loads a VAO from an OBJ file. On the first time this is called for an OBJ file, will convert the OBJ file 
 	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
@@ -27,6 +85,21 @@ public:
 	/// <returns>A VAO loaded from disk</returns>
 	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename);
 	/// <summary>
+	/// Does all the work of LoadFromFile that doesn't need OpenGL, so it can be run on a worker thread. This
+	/// includes converting OBJ files that don't have a binary file yet. Pass the result to UploadMesh on the
+	/// main thread to create the VAO
+	/// </summary>
+	/// <param name="filename">The path to the .obj or .bin file to load</param>
+	/// <param name="result">Will be filled with the mesh data</param>
+	/// <returns>True if the mesh was loaded, false if otherwise</returns>
+	static bool DecodeFile(const std::string& filename, MeshData& result);
+	/// <summary>
+	/// Creates a VAO from mesh data that was loaded by DecodeFile, must be called on the main thread
+	/// </summary>
+	/// <param name="data">The mesh data to upload</param>
+	/// <returns>The VAO for the mesh</returns>
+	static VertexArrayObject::Sptr UploadMesh(const MeshData& data);
+	/// <summary>
 	/// Manually converts an OBJ file into a binary mesh file
 	/// </summary>
 	/// <param name="inFile">The path to OBJ file to convert</param>
@@ -36,14 +109,25 @@ public:
 	/// <summary>
 	/// Saves a mesh builder of the given type to a binary file
 	/// </summary>
-	/// <typeparam name="VertexType"></typeparam>
-	/// <param name="mesh"></param>
-	/// <param name="outFilename"></param>
+	/// <typeparam name="VertexType">The type of vertex stored in the mesh, must have a V_DECL and a Position</typeparam>
+	/// <param name="mesh">The mesh to save</param>
+	/// <param name="outFilename">The path to write the binary file to</param>
+	/// <param name="subMeshes">The submeshes and LODs in the mesh's index buffer, or empty to store the whole mesh as a single submesh</param>
+	/// <param name="packedBounds">For vertices with unorm16 positions, the bounds that the positions are relative to</param>
 	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::vector<VertexArrayObject::SubMesh>& subMeshes = {}, const AABB& packedBounds = AABB());
 
 protected:
-	// Will be put at the start of the binary file, contains info about the contents of the file
+	// The first few bytes of every binary file, so we can figure out which version we're loading
+	struct BinaryHeaderCommon {
+		// A check value so we can ensure that we're loading in the right file type
+		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
+		// The version code, we can use this to create different loaders if our format changes
+		uint16_t  Version = 0;
+	};
+
+	// Version 1 header, contains info about the contents of the file. Followed by the
+	// raw BufferAttribute structs, the indices, and then the vertices
 	struct BinaryHeader {
 		// A check value so we can ensure that we're loading in the right file type
 		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
@@ -61,42 +145,125 @@ protected:
 		uint8_t   NumAttributes = 0;
 	};
 
+	// Version 2 header. Every section starts on a 16 byte boundary and is located by it's offset
+	// from the start of the file, so the index and vertex data can be handed to OpenGL straight
+	// from a memory mapped file
+	struct BinaryHeaderV2 {
+		// A check value so we can ensure that we're loading in the right file type
+		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
+		// The version code, always 2 for this header
+		uint16_t  Version = 2;
+		// The size of this structure, lets us catch files written with a mismatched layout
+		uint16_t  HeaderSize = sizeof(BinaryHeaderV2);
+		// FNV-1a hash of the header (with this field zeroed), attribute table and submesh table
+		uint32_t  Checksum = 0;
+		// A combination of BINARY_FLAG_ values
+		uint32_t  Flags = 0;
+		// The number of vertices in the mesh
+		uint32_t  NumVertices = 0;
+		// The size of a single vertex structure
+		uint32_t  VertexStride = 0;
+		// The number of indices in the mesh
+		uint32_t  NumIndices = 0;
+		// The type of index to load
+		IndexType IndicesType = IndexType::Unknown;
+		// The number of entries in the attribute table
+		uint16_t  NumAttributes = 0;
+		// The number of entries in the submesh table
+		uint16_t  NumSubMeshes = 0;
+		// Offsets from the start of the file to each of the sections
+		uint32_t  AttributesOffset = 0;
+		uint32_t  SubMeshesOffset = 0;
+		uint32_t  Reserved0 = 0;
+		uint64_t  IndexDataOffset = 0;
+		uint64_t  VertexDataOffset = 0;
+		// The model space bounds of the entire mesh, so we don't need to touch the vertex data
+		float     BoundsMin[3] ={ 0.0f, 0.0f, 0.0f };
+		float     BoundsMax[3] ={ 0.0f, 0.0f, 0.0f };
+		uint32_t  Reserved1[2] ={ 0, 0 };
+	};
+
+	// An entry in the version 2 attribute table, fixed size so it doesn't depend on how
+	// the compiler lays out BufferAttribute
+	struct BinaryAttribute {
+		uint32_t      Slot = 0;
+		uint8_t       Size = 0;
+		uint8_t       Normalized = 0;
+		AttribUsage   Usage = AttribUsage::Unknown;
+		uint8_t       Reserved = 0;
+		AttributeType Type = AttributeType::Unknown;
+		uint32_t      Offset = 0;
+	};
+
+	// An entry in the version 2 submesh table
+	struct BinarySubMesh {
+		uint32_t IndexOffset = 0;
+		uint32_t IndexCount = 0;
+		int32_t  BaseVertex = 0;
+		uint32_t Lod = 0;
+		float    BoundsMin[3] ={ 0.0f, 0.0f, 0.0f };
+		float    BoundsMax[3] ={ 0.0f, 0.0f, 0.0f };
+		uint32_t Reserved[2] ={ 0, 0 };
+	};
+
+	static_assert(sizeof(BinaryHeaderV2) == 96, "BOBJ v2 header layout has changed!");
+	static_assert(sizeof(BinaryAttribute) == 16, "BOBJ v2 attribute layout has changed!");
+	static_assert(sizeof(BinarySubMesh) == 48, "BOBJ v2 submesh layout has changed!");
+
+	// All sections in a version 2 file start on a multiple of this
+	static const uint32_t BINARY_ALIGNMENT = 16;
+	// Set if positions are unorm16 values relative to the header's bounds
+	static const uint32_t BINARY_FLAG_PACKED_POSITIONS = 1 << 0;
+
+	static ConversionSettings __conversionSettings;
+
+	// Locks for the binary files that are being converted, keyed by absolute path. Entries are
+	// removed once nobody is converting that file
+	static std::mutex __conversionMutex;
+	static std::unordered_map<std::string, std::shared_ptr<std::mutex>> __conversionsInFlight;
+
 	OptimizedObjLoader() = default;
 	~OptimizedObjLoader() = default;
 
+	/// <summary>
+	/// Converts an OBJ file to a binary file if the binary file does not exist yet. Only one thread will
+	/// convert a given file, anyone else converting it will wait for that conversion to finish
+	/// </summary>
+	static void _ConvertIfMissing(const std::string& inFile, const std::filesystem::path& outFile);
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
-	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	static bool _DecodeBinFile(const std::string& filename, MeshData& result);
+	static bool _DecodeBinV1(const std::string& filename, const uint8_t* data, size_t size, MeshData& result);
+	static bool _DecodeBinV2(const std::string& filename, const uint8_t* data, size_t size, MeshData& result);
+
+	/// <summary>
+	/// Writes a version 2 binary file, this is the non-templated part of SaveBinaryFile
+	/// </summary>
+	static void _SaveBinV2(const std::string& outFilename, const void* vertices, uint32_t numVertices, uint32_t vertexStride, 
+						   const VertexArrayObject::VertexDeclaration& vDecl, const uint32_t* indices, uint32_t numIndices,
+						   const std::vector<VertexArrayObject::SubMesh>& subMeshes, const AABB& packedBounds);
+
+	/// <summary>
+	/// Calculates the bounds of the given vertices using the first float position attribute in the
+	/// vertex declaration. Vertices are read with memcpy, so the data does not need to be aligned
+	/// </summary>
+	/// <param name="vertices">The vertex data to read from</param>
+	/// <param name="stride">The size of a single vertex</param>
+	/// <param name="vDecl">The attributes in each vertex</param>
+	/// <param name="indices">The indices to read vertices from, or nullptr to read the first count vertices</param>
+	/// <param name="count">The number of indices (or vertices) to read</param>
+	/// <param name="baseVertex">Added to each index before looking up the vertex</param>
+	/// <param name="packedBounds">The bounds that unorm16 positions are relative to, if the positions are packed</param>
+	static AABB _CalculateBounds(const uint8_t* vertices, uint32_t stride, const VertexArrayObject::VertexDeclaration& vDecl,
+								 const uint32_t* indices, uint32_t count, int32_t baseVertex = 0, const AABB& packedBounds = AABB());
+
+	/// <summary>
+	/// Continues a 32 bit FNV-1a hash with the given bytes, used for the v2 header checksum
+	/// </summary>
+	static uint32_t _Fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u);
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
-	// Open the output file
-	std::ofstream file(outFilename, std::ios::binary);
-	if (!file) {
-		throw std::runtime_error("Failed to open output file");
-	}
-
-	// Create the fixed size header for our output file
-	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
-	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
-	header.NumVertices   = mesh.GetVertexCount();
-	header.VertexStride  = sizeof(VertexType);
-	header.NumAttributes = VertexType::V_DECL.size();
-
-	// Write header bytes to the stream
-	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
-
-	// Write which attributes we have to the stream
-	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
-		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
-	}
-	// Write any index data to the file
-	if (mesh.GetIndexCount() > 0) {
-		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
-	}
-
-	// Write vertex data to file
-	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::vector<VertexArrayObject::SubMesh>& subMeshes, const AABB& packedBounds) {
+	_SaveBinV2(outFilename, mesh.GetVertexDataPtr(), static_cast<uint32_t>(mesh.GetVertexCount()), sizeof(VertexType),
+			   VertexType::V_DECL, mesh.GetIndexDataPtr(), static_cast<uint32_t>(mesh.GetIndexCount()), subMeshes, packedBounds);
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "Utils/GUID.hpp"
 #include "json.hpp"
+#include <functional>
 
 #include "Utils/TypeHelpers.h"
 
@@ -12,11 +13,21 @@
 /// Resources must additionally define a static method as such:
 /// static std::shared_ptr<Type> FromJson(const nlohmann::json&);
 /// where Type is the Type of resource
+/// 
+/// Resources that are expensive to decode can also define:
+/// static std::function<std::shared_ptr<Type>()> DecodeFromJson(const nlohmann::json&);
+/// which will be called from a worker thread by ResourceManager::LoadAsync. It should do all the
+/// CPU side work (reading files, decoding images, parsing meshes) without touching OpenGL or the
+/// resource manager, and return a function that creates the resource on the main thread
 /// </summary>
 class IResource {
 public:
 	typedef std::shared_ptr<IResource> Sptr;
 	typedef std::weak_ptr<IResource>   Wptr;
+	/// <summary>
+	/// Finishes loading a resource that was decoded on a worker thread, always invoked on the main thread
+	/// </summary>
+	typedef std::function<Sptr()>      UploadFunc;
 
 	virtual ~IResource() = default;
 
@@ -55,4 +66,14 @@ protected:
 template <typename T>
 constexpr bool is_valid_resource() {
 	return std::is_base_of<IResource, T>::value && test_json<T, const nlohmann::json&>::value;
+}
+
+/// <summary>
+/// Returns true if the given resource type can be decoded on a worker thread,
+/// IE it implements a static DecodeFromJson method
+/// </summary>
+/// <typeparam name="T">The type to check</typeparam>
+template <typename T>
+constexpr bool is_async_resource() {
+	return is_valid_resource<T>() && test_decode_json<T, const nlohmann::json&>::value;
 }
\ No newline at end of file
@@ -3,9 +3,23 @@
 #include "Utils/ObjLoader.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
+#include "Logging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
 
 std::map<std::type_index, std::map<Guid, IResource::Sptr>> ResourceManager::_resources;
 std::map<std::string, std::function<Guid(const nlohmann::json&)>> ResourceManager::_typeLoaders;
+std::map<std::string, ResourceManager::AsyncTypeLoader> ResourceManager::_asyncLoaders;
+std::map<std::type_index, std::map<Guid, std::shared_ptr<ResourceLoadState>>> ResourceManager::_pendingLoads;
+std::map<std::type_index, std::set<Guid>> ResourceManager::_failedLoads;
+
+std::deque<std::shared_ptr<ResourceLoadState>> ResourceManager::_uploadQueue;
+std::mutex              ResourceManager::_uploadMutex;
+std::condition_variable ResourceManager::_uploadCondition;
 
 nlohmann::ordered_json ResourceManager::_manifest;
 
@@ -27,17 +41,77 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 	_manifest = blob;
 
 	if (preloadAssets) {
-		for (auto& [typeName, items] : blob.items()) {
-			auto& func = _typeLoaders[typeName];
-			if (func) {
-				for (auto& [guid, blob] : items.items()) {
-					func(blob);
-				}
+		// Decode everything on the thread pool, but wait for the uploads here so that
+		// all the assets are ready when we return
+		LoadAllAsync();
+		WaitForLoads();
+	}
+}
+
+void ResourceManager::LoadAllAsync() {
+	for (auto& [typeName, items] : _manifest.items()) {
+		if (_asyncLoaders.count(typeName) > 0) {
+			for (auto& [guid, blob] : items.items()) {
+				_LoadAsync(typeName, Guid(guid));
 			}
 		}
 	}
 }
 
+uint32_t ResourceManager::ProcessUploads(float budgetMs) {
+	auto startTime = std::chrono::high_resolution_clock::now();
+	uint32_t count = 0;
+
+	while (true) {
+		// Grab the next load, we don't hold the lock during the upload since it may need to
+		// wait on other loads (ex: a material waiting on it's textures)
+		std::shared_ptr<ResourceLoadState> state = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(_uploadMutex);
+			if (_uploadQueue.empty()) {
+				break;
+			}
+			state = _uploadQueue.front();
+			_uploadQueue.pop_front();
+		}
+
+		// Loads that were finished early by Get are still in the queue, skip them
+		if (state->Status != ResourceLoadStatus::Uploading) {
+			continue;
+		}
+
+		_CompleteUpload(state);
+		count++;
+
+		// Check the budget after the upload, so we always make some progress
+		float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		if (elapsedMs >= budgetMs) {
+			break;
+		}
+	}
+
+	return count;
+}
+
+void ResourceManager::WaitForLoads() {
+	while (GetPendingLoadCount() > 0) {
+		// Every pending load will end up in the queue once it's decoded, so we can sleep until something arrives
+		{
+			std::unique_lock<std::mutex> lock(_uploadMutex);
+			_uploadCondition.wait(lock, []() { return !_uploadQueue.empty(); });
+		}
+		ProcessUploads(std::numeric_limits<float>::max());
+	}
+}
+
+uint32_t ResourceManager::GetPendingLoadCount() {
+	size_t result = 0;
+	for (auto& [type, map] : _pendingLoads) {
+		result += map.size();
+	}
+	return static_cast<uint32_t>(result);
+}
+
 void ResourceManager::SaveManifest(const std::string& path) {
 	// Update all resources in the manifest so they match their current representation
 	for (auto& [type, map] : _resources) {
@@ -53,8 +127,154 @@ void ResourceManager::SaveManifest(const std::string& path) {
 }
 
 void ResourceManager::Cleanup() {
+	// Let any decodes that are in flight finish, then drop everything that hasn't been uploaded
+	for (auto& [type, map] : _pendingLoads) {
+		for (auto& [id, state] : map) {
+			{
+				std::unique_lock<std::mutex> lock(_uploadMutex);
+				_uploadCondition.wait(lock, [&]() { return state->Status != ResourceLoadStatus::Decoding; });
+			}
+			state->Upload = nullptr;
+			state->Status = ResourceLoadStatus::Failed;
+		}
+	}
+	_pendingLoads.clear();
+	{
+		std::lock_guard<std::mutex> lock(_uploadMutex);
+		_uploadQueue.clear();
+	}
+
+	_failedLoads.clear();
+
 	for (auto& [type, map] : _resources) {
 		map.clear();
 	}
 }
 
+std::shared_ptr<ResourceLoadState> ResourceManager::_LoadAsync(const std::string& typeName, Guid id) {
+	auto loader = _asyncLoaders.find(typeName);
+	if (loader == _asyncLoaders.end()) {
+		LOG_WARN("Cannot load \"{}\", type \"{}\" has not been registered", id.str(), typeName);
+		return std::make_shared<ResourceLoadState>(id, std::type_index(typeid(IResource)), typeName, ResourceLoadStatus::Failed);
+	}
+	const std::type_index type = loader->second.Type;
+
+	// If the resource is already loaded, we can hand back a finished load
+	auto& resources = _resources[type];
+	auto existing = resources.find(id);
+	if (existing != resources.end() && existing->second != nullptr) {
+		std::shared_ptr<ResourceLoadState> result = std::make_shared<ResourceLoadState>(id, type, typeName, ResourceLoadStatus::Loaded);
+		result->Resource = existing->second;
+		return result;
+	}
+
+	// If it's already loading, share the existing load
+	std::shared_ptr<ResourceLoadState> pending = _FindPendingLoad(type, id);
+	if (pending != nullptr) {
+		return pending;
+	}
+
+	// If it already failed, the file isn't going to load any better this time
+	if (_HasLoadFailed(type, id)) {
+		return std::make_shared<ResourceLoadState>(id, type, typeName, ResourceLoadStatus::Failed);
+	}
+
+	std::string key = id.str();
+	if (!_manifest.contains(typeName) || !_manifest[typeName].contains(key)) {
+		LOG_WARN("Cannot load \"{}\", it is not in the manifest", key);
+		return std::make_shared<ResourceLoadState>(id, type, typeName, ResourceLoadStatus::Failed);
+	}
+
+	// Workers get their own copy of the JSON, since the manifest can change while they run
+	nlohmann::json data = _manifest[typeName][key];
+	std::shared_ptr<ResourceLoadState> state = std::make_shared<ResourceLoadState>(id, type, typeName, ResourceLoadStatus::Decoding);
+	_pendingLoads[type][id] = state;
+
+	if (loader->second.DecodeOnWorker) {
+		_LoaderPool().Submit([state, decode = loader->second.Decode, data]() {
+			IResource::UploadFunc upload = nullptr;
+			try {
+				upload = decode(data);
+			}
+			catch (const std::exception& e) {
+				LOG_ERROR("Failed to decode \"{}\": {}", state->Id.str(), e.what());
+			}
+
+			// Failed decodes still go to the queue, so that the main thread can clean up the load
+			std::lock_guard<std::mutex> lock(_uploadMutex);
+			state->Upload = upload;
+			state->Status = ResourceLoadStatus::Uploading;
+			_uploadQueue.push_back(state);
+			_uploadCondition.notify_all();
+		});
+	} else {
+		std::lock_guard<std::mutex> lock(_uploadMutex);
+		state->Upload = loader->second.Decode(data);
+		state->Status = ResourceLoadStatus::Uploading;
+		_uploadQueue.push_back(state);
+		_uploadCondition.notify_all();
+	}
+
+	return state;
+}
+
+ThreadPool& ResourceManager::_LoaderPool() {
+	// A few threads is plenty to keep the disk busy, we don't want to crowd out the shared pool
+	static ThreadPool pool(std::clamp(std::thread::hardware_concurrency() / 4, 2u, 4u));
+	return pool;
+}
+
+std::shared_ptr<ResourceLoadState> ResourceManager::_FindPendingLoad(std::type_index type, Guid id) {
+	auto map = _pendingLoads.find(type);
+	if (map != _pendingLoads.end()) {
+		auto it = map->second.find(id);
+		if (it != map->second.end()) {
+			return it->second;
+		}
+	}
+	return nullptr;
+}
+
+bool ResourceManager::_HasLoadFailed(std::type_index type, Guid id) {
+	auto set = _failedLoads.find(type);
+	return set != _failedLoads.end() && set->second.count(id) > 0;
+}
+
+void ResourceManager::_FinishLoad(const std::shared_ptr<ResourceLoadState>& state) {
+	if (state->Status == ResourceLoadStatus::Decoding) {
+		std::unique_lock<std::mutex> lock(_uploadMutex);
+		_uploadCondition.wait(lock, [&]() { return state->Status != ResourceLoadStatus::Decoding; });
+	}
+	// The load stays in the upload queue, ProcessUploads will skip it once it's done
+	if (state->Status == ResourceLoadStatus::Uploading) {
+		_CompleteUpload(state);
+	}
+}
+
+void ResourceManager::_CompleteUpload(const std::shared_ptr<ResourceLoadState>& state) {
+	IResource::Sptr resource = nullptr;
+	if (state->Upload) {
+		try {
+			resource = state->Upload();
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR("Failed to upload \"{}\": {}", state->Id.str(), e.what());
+		}
+	}
+	// Release the decoded data as soon as we're done with it
+	state->Upload = nullptr;
+
+	if (resource != nullptr) {
+		resource->OverrideGUID(state->Id);
+		_resources[state->Type][state->Id] = resource;
+		state->Resource = resource;
+		state->Status = ResourceLoadStatus::Loaded;
+	} else {
+		LOG_WARN("Failed to load {} \"{}\"", state->TypeName, state->Id.str());
+		_failedLoads[state->Type].insert(state->Id);
+		state->Status = ResourceLoadStatus::Failed;
+	}
+
+	_pendingLoads[state->Type].erase(state->Id);
+}
+
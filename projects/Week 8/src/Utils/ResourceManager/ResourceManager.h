@@ -3,17 +3,113 @@
 #include <json.hpp>
 #include <unordered_map>
 #include <typeindex>
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <EnumToString.h>
 
 #include "Utils/GUID.hpp"
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/StringUtils.h"
 
+/// <summary>
+/// The stages that an asynchronous resource load goes through
+/// </summary>
+ENUM(ResourceLoadStatus, int,
+	// The resource is waiting for, or running on, a worker thread
+	Decoding  = 0,
+	// The resource has been decoded, and is waiting in the main thread's upload queue
+	Uploading = 1,
+	// The resource has been loaded and stored in the resource manager
+	Loaded    = 2,
+	// The resource could not be loaded
+	Failed    = 3
+);
+
+/// <summary>
+/// The state of a resource that's being loaded with ResourceManager::LoadAsync, shared
+/// between the handles, the worker that decodes it and the upload queue
+/// </summary>
+struct ResourceLoadState {
+	Guid                            Id;
+	std::type_index                 Type;
+	std::string                     TypeName;
+	std::atomic<ResourceLoadStatus> Status;
+	// Set by the worker thread before the status moves to Uploading
+	IResource::UploadFunc           Upload;
+	// Set on the main thread before the status moves to Loaded
+	IResource::Sptr                 Resource;
+
+	ResourceLoadState(Guid id, std::type_index type, const std::string& typeName, ResourceLoadStatus status) :
+		Id(id), Type(type), TypeName(typeName), Status(status), Upload(nullptr), Resource(nullptr) { }
+};
+
+/// <summary>
+/// A handle to a resource that's being loaded in the background, see ResourceManager::LoadAsync
+/// </summary>
+/// <typeparam name="T">The type of resource being loaded</typeparam>
+template <typename T>
+class ResourceLoadHandle {
+public:
+	ResourceLoadHandle() : _state(nullptr) { }
+	explicit ResourceLoadHandle(const std::shared_ptr<ResourceLoadState>& state) : _state(state) { }
+
+	/// <summary>
+	/// Returns true if this handle refers to a load
+	/// </summary>
+	bool IsValid() const { return _state != nullptr; }
+	/// <summary>
+	/// Gets the GUID of the resource being loaded
+	/// </summary>
+	Guid GetGUID() const { return _state != nullptr ? _state->Id : Guid(); }
+	/// <summary>
+	/// Gets the current stage of the load, can be called from any thread
+	/// </summary>
+	ResourceLoadStatus GetStatus() const { return _state != nullptr ? _state->Status.load() : ResourceLoadStatus::Failed; }
+	/// <summary>
+	/// Returns true if the load has finished, either successfully or not
+	/// </summary>
+	bool IsDone() const {
+		ResourceLoadStatus status = GetStatus();
+		return status == ResourceLoadStatus::Loaded || status == ResourceLoadStatus::Failed;
+	}
+	/// <summary>
+	/// Returns true if the resource has been loaded and can be used
+	/// </summary>
+	bool IsLoaded() const { return GetStatus() == ResourceLoadStatus::Loaded; }
+
+	/// <summary>
+	/// Gets the resource, or nullptr if it hasn't finished loading yet
+	/// </summary>
+	std::shared_ptr<T> Get() const {
+		return IsLoaded() ? std::dynamic_pointer_cast<T>(_state->Resource) : nullptr;
+	}
+	/// <summary>
+	/// Blocks until the resource has been decoded, then finishes it's upload right away instead of
+	/// waiting for the upload queue. Must be called from the main thread
+	/// </summary>
+	/// <returns>The resource, or nullptr if it failed to load</returns>
+	std::shared_ptr<T> Wait() const;
+
+protected:
+	std::shared_ptr<ResourceLoadState> _state;
+};
+
+class ThreadPool;
+
 /// <summary>
 /// Utility class for managing and loading resources from JSON
 /// manifest files
 /// </summary>
 class ResourceManager {
 public:
+	template <typename T>
+	friend class ResourceLoadHandle;
+
 	/// <summary>
 	/// Initializes the resource manager and performs any first-time
 	/// setup required
@@ -58,6 +154,18 @@ public:
 
 		// If the asset is null, we can try finding it in the manifest to load it
 		if (result == nullptr) {
+			// If an asynchronous load of the asset already failed, don't try the file again
+			if (_HasLoadFailed(std::type_index(typeid(T)), id)) {
+				return nullptr;
+			}
+
+			// If the asset is already being loaded in the background, finish it now instead of loading it twice
+			std::shared_ptr<ResourceLoadState> pending = _FindPendingLoad(std::type_index(typeid(T)), id);
+			if (pending != nullptr) {
+				_FinishLoad(pending);
+				return std::dynamic_pointer_cast<T>(pending->Resource);
+			}
+
 			// Get the type name it'll be stored under
 			std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
 
@@ -75,6 +183,46 @@ public:
 		return result;
 	}
 
+	/// <summary>
+	/// Starts loading the resource with the given type and GUID from the manifest in the background.
+	/// Types with a DecodeFromJson method are decoded on the thread pool, then finished on the main
+	/// thread by ProcessUploads. Other types are loaded entirely by ProcessUploads
+	/// 
+	/// If the resource is already loaded, the handle will be ready right away. Calling Get for a
+	/// resource that is still loading will finish the load immediately
+	/// </summary>
+	/// <typeparam name="T">The type of resource to load</typeparam>
+	/// <param name="id">The ID of the resource to load</param>
+	/// <returns>A handle that can be used to check on the load and get the resource</returns>
+	template<typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
+	static ResourceLoadHandle<T> LoadAsync(Guid id) {
+		return ResourceLoadHandle<T>(_LoadAsync(StringTools::SanitizeClassName(typeid(T).name()), id));
+	}
+
+	/// <summary>
+	/// Starts loading every resource in the manifest that isn't loaded yet in the background
+	/// </summary>
+	static void LoadAllAsync();
+
+	/// <summary>
+	/// Finishes asynchronous loads that have been decoded, until the time budget runs out. Should
+	/// be called once per frame from the main thread. At least one load is always finished if any
+	/// are waiting, so a single large upload can go over the budget
+	/// </summary>
+	/// <param name="budgetMs">The maximum time to spend uploading, in milliseconds</param>
+	/// <returns>The number of resources that were finished</returns>
+	static uint32_t ProcessUploads(float budgetMs);
+
+	/// <summary>
+	/// Blocks until all asynchronous loads have finished, must be called from the main thread
+	/// </summary>
+	static void WaitForLoads();
+
+	/// <summary>
+	/// Gets the number of asynchronous loads that haven't finished yet
+	/// </summary>
+	static uint32_t GetPendingLoadCount();
+
 	/// <summary>
 	/// Registers a resource type with the resource manager, only types that have been registered
 	/// can be loaded from JSON manifest files!
@@ -94,6 +242,24 @@ public:
 			return res->GetGUID();
 		};
 
+		// Create the asynchronous loader for the type, types that can't be decoded on a worker
+		// are loaded with FromJson during the upload instead
+		std::function<IResource::UploadFunc(const nlohmann::json&)> decode;
+		if constexpr (is_async_resource<T>()) {
+			decode = [](const nlohmann::json& data) -> IResource::UploadFunc {
+				std::function<std::shared_ptr<T>()> upload = T::DecodeFromJson(data);
+				if (!upload) {
+					return nullptr;
+				}
+				return [upload]() -> IResource::Sptr { return upload(); };
+			};
+		} else {
+			decode = [](const nlohmann::json& data) -> IResource::UploadFunc {
+				return [data]() -> IResource::Sptr { return T::FromJson(data); };
+			};
+		}
+		_asyncLoaders.insert_or_assign(typeName, AsyncTypeLoader{ std::type_index(typeid(T)), decode, is_async_resource<T>() });
+
 		// Make sure we haven't registered the type yet, then add an empty object
 		// to the manifest to ensure it can be saved
 		if (!_manifest.contains(typeName)) {
@@ -159,9 +325,75 @@ protected:
 	/// </summary>
 	static std::map<std::string, std::function<Guid(const nlohmann::json&)>> _typeLoaders;
 
+	/// <summary>
+	/// Describes how to load a registered type asynchronously
+	/// </summary>
+	struct AsyncTypeLoader {
+		std::type_index Type;
+		// Decodes the resource from it's JSON, returning the function that finishes it on the main thread
+		std::function<IResource::UploadFunc(const nlohmann::json&)> Decode;
+		// True if Decode can run on a worker thread, otherwise it's invoked while queuing the load
+		bool            DecodeOnWorker;
+	};
+	/// <summary>
+	/// Async loaders for all the registered types, keyed by type name
+	/// </summary>
+	static std::map<std::string, AsyncTypeLoader> _asyncLoaders;
+	/// <summary>
+	/// Loads that have been started but not finished, only accessed from the main thread
+	/// </summary>
+	static std::map<std::type_index, std::map<Guid, std::shared_ptr<ResourceLoadState>>> _pendingLoads;
+	/// <summary>
+	/// Resources whose asynchronous load failed, so that they are only loaded (and reported) once.
+	/// Only accessed from the main thread
+	/// </summary>
+	static std::map<std::type_index, std::set<Guid>> _failedLoads;
+
+	/// <summary>
+	/// Loads that are ready to be finished on the main thread. Workers push to this as they finish
+	/// decoding, and notify the condition so that the main thread can wait on specific loads
+	/// </summary>
+	static std::deque<std::shared_ptr<ResourceLoadState>> _uploadQueue;
+	static std::mutex              _uploadMutex;
+	static std::condition_variable _uploadCondition;
+
 	/// <summary>
 	/// We use an ORDERED JSON file to allow serializing types in the order they are registered.
 	/// This allows us to register dependencies before the dependent resource
 	/// </summary>
 	static nlohmann::ordered_json _manifest;
-};
\ No newline at end of file
+
+	/// <summary>
+	/// Starts loading a resource in the background, this is the non-templated part of LoadAsync
+	/// </summary>
+	static std::shared_ptr<ResourceLoadState> _LoadAsync(const std::string& typeName, Guid id);
+	/// <summary>
+	/// Gets the workers that decode resources. Loads get their own threads, so that long decodes never
+	/// sit in front of the per-frame work on the shared pool
+	/// </summary>
+	static ThreadPool& _LoaderPool();
+	/// <summary>
+	/// Gets the load state for a resource that's being loaded asynchronously, or nullptr if there is none
+	/// </summary>
+	static std::shared_ptr<ResourceLoadState> _FindPendingLoad(std::type_index type, Guid id);
+	/// <summary>
+	/// Returns true if an asynchronous load of the given resource has already failed
+	/// </summary>
+	static bool _HasLoadFailed(std::type_index type, Guid id);
+	/// <summary>
+	/// Waits for a load to finish decoding, then finishes it on the calling (main) thread
+	/// </summary>
+	static void _FinishLoad(const std::shared_ptr<ResourceLoadState>& state);
+	/// <summary>
+	/// Runs the upload for a load that has been decoded, and stores the result
+	/// </summary>
+	static void _CompleteUpload(const std::shared_ptr<ResourceLoadState>& state);
+};
+
+template <typename T>
+std::shared_ptr<T> ResourceLoadHandle<T>::Wait() const {
+	if (_state != nullptr) {
+		ResourceManager::_FinishLoad(_state);
+	}
+	return Get();
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "Utils/ThreadPool.h"
+#include <algorithm>
+
+thread_local ThreadPool* ThreadPool::_currentPool = nullptr;
+
+ThreadPool::ThreadPool(uint32_t threadCount) :
+	_queues(std::vector<std::unique_ptr<WorkerQueue>>()),
+	_threads(std::vector<std::thread>()),
+	_nextQueue(0),
+	_queuedTasks(0),
+	_sleepMutex(),
+	_wakeCondition(),
+	_isRunning(true)
+{
+	// Leave a hardware thread free for the main thread, since it helps out in ParallelFor
+	if (threadCount == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	// We always want at least one queue, so tasks have somewhere to go
+	for (uint32_t ix = 0; ix < threadCount; ix++) {
+		_queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (uint32_t ix = 0; ix < threadCount; ix++) {
+		_threads.emplace_back(&ThreadPool::_WorkerMain, this, ix);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_isRunning = false;
+	}
+	_wakeCondition.notify_all();
+
+	for (std::thread& thread : _threads) {
+		thread.join();
+	}
+}
+
+ThreadPool& ThreadPool::Get() {
+	static ThreadPool instance;
+	return instance;
+}
+
+ThreadPool& ThreadPool::Current() {
+	return _currentPool != nullptr ? *_currentPool : Get();
+}
+
+void ThreadPool::Submit(Task task) {
+	uint32_t queueIndex = _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+	{
+		std::lock_guard<std::mutex> lock(_queues[queueIndex]->Mutex);
+		_queues[queueIndex]->Tasks.push_back(std::move(task));
+	}
+
+	// Take the sleep lock when bumping the count, so that a worker can't miss the wakeup between
+	// checking the count and going to sleep
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_queuedTasks.fetch_add(1, std::memory_order_release);
+	}
+	_wakeCondition.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t chunkSize, const RangeTask& task) {
+	if (count == 0) return;
+	chunkSize = std::max<size_t>(chunkSize, 1);
+
+	// If there's only one chunk, it's not worth the overhead of queueing it
+	if (count <= chunkSize) {
+		task(0, count);
+		return;
+	}
+
+	// Chunks are claimed from a shared counter rather than queued one by one, so the calling thread
+	// only ever runs it's own chunks. Helpers that start after every chunk is claimed just return, so
+	// the counters live on the heap rather than on our stack
+	struct ParallelForState {
+		std::atomic<size_t> NextChunk;
+		std::atomic<size_t> Remaining;
+	};
+	const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->NextChunk.store(0, std::memory_order_relaxed);
+	state->Remaining.store(chunkCount, std::memory_order_relaxed);
+
+	// The task is only touched while a chunk is claimed, and we don't return until every chunk is
+	// done, so it's safe to reference it here
+	const RangeTask* rangeTask = &task;
+	auto runChunks = [state, rangeTask, count, chunkSize, chunkCount]() {
+		for (size_t chunk = state->NextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunkCount; chunk = state->NextChunk.fetch_add(1, std::memory_order_relaxed)) {
+			size_t begin = chunk * chunkSize;
+			size_t end = std::min(begin + chunkSize, count);
+			(*rangeTask)(begin, end);
+			state->Remaining.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	};
+
+	// We run chunks ourselves as well, so we need one less helper than we have chunks
+	const size_t helperCount = std::min<size_t>(chunkCount - 1, _threads.size());
+	for (size_t ix = 0; ix < helperCount; ix++) {
+		Submit(runChunks);
+	}
+
+	runChunks();
+
+	// Wait for any chunks that helpers are still working on
+	while (state->Remaining.load(std::memory_order_acquire) > 0) {
+		std::this_thread::yield();
+	}
+}
+
+bool ThreadPool::_TryRunTask(uint32_t queueIndex) {
+	Task task;
+	const uint32_t queueCount = static_cast<uint32_t>(_queues.size());
+
+	for (uint32_t offset = 0; offset < queueCount && !task; offset++) {
+		WorkerQueue& queue = *_queues[(queueIndex + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (queue.Tasks.empty()) continue;
+
+		// Take from the front of our own queue, and steal from the back of everyone else's
+		if (offset == 0) {
+			task = std::move(queue.Tasks.front());
+			queue.Tasks.pop_front();
+		} else {
+			task = std::move(queue.Tasks.back());
+			queue.Tasks.pop_back();
+		}
+	}
+
+	if (!task) {
+		return false;
+	}
+
+	_queuedTasks.fetch_sub(1, std::memory_order_acq_rel);
+	task();
+	return true;
+}
+
+void ThreadPool::_WorkerMain(uint32_t queueIndex) {
+	_currentPool = this;
+	while (true) {
+		if (_TryRunTask(queueIndex)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wakeCondition.wait(lock, [this]() { return !_isRunning || _queuedTasks.load(std::memory_order_acquire) > 0; });
+		if (!_isRunning) {
+			return;
+		}
+	}
+}
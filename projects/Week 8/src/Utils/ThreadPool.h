@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// A simple work stealing thread pool. Each worker has it's own queue of tasks, and will
+/// steal tasks from the back of other worker's queues when it runs out of work, which keeps
+/// all the workers busy when tasks have uneven costs
+///
+/// Threads that call ParallelFor will help execute their own chunks while they wait, so it's safe
+/// to use from the main thread (or from inside a task) without wasting a core. They never pick up
+/// unrelated tasks, so a long task submitted by someone else can't stall the caller
+/// </summary>
+class ThreadPool {
+public:
+	typedef std::function<void()> Task;
+	typedef std::function<void(size_t begin, size_t end)> RangeTask;
+
+	// Delete copy and move
+	ThreadPool(const ThreadPool& other) = delete;
+	ThreadPool(ThreadPool&& other) = delete;
+	ThreadPool& operator =(const ThreadPool& other) = delete;
+	ThreadPool& operator =(ThreadPool&& other) = delete;
+
+	/// <summary>
+	/// Creates a new thread pool with the given number of worker threads
+	/// </summary>
+	/// <param name="threadCount">The number of workers to create, or 0 to use one less than the number of hardware threads</param>
+	explicit ThreadPool(uint32_t threadCount = 0);
+	~ThreadPool();
+
+	/// <summary>
+	/// Gets the shared thread pool, which is created on first use
+	/// </summary>
+	static ThreadPool& Get();
+	/// <summary>
+	/// Gets the pool that the calling thread is a worker for, or the shared pool if the calling
+	/// thread does not belong to a pool. Lets work started from inside a task stay on the same pool
+	/// </summary>
+	static ThreadPool& Current();
+
+	/// <summary>
+	/// Gets the number of worker threads in the pool, note that threads calling ParallelFor
+	/// will also execute tasks
+	/// </summary>
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(_threads.size()); }
+
+	/// <summary>
+	/// Queues a task to be executed by one of the workers
+	/// </summary>
+	/// <param name="task">The task to run</param>
+	void Submit(Task task);
+
+	/// <summary>
+	/// Splits the range [0, count) into chunks, and executes the chunks across the pool. Blocks
+	/// until all chunks have completed, executing chunks on the calling thread while it waits
+	/// </summary>
+	/// <param name="count">The number of elements in the range</param>
+	/// <param name="chunkSize">The maximum number of elements that a single task will handle</param>
+	/// <param name="task">The function to invoke for each chunk, will be passed the start and end of the chunk</param>
+	void ParallelFor(size_t count, size_t chunkSize, const RangeTask& task);
+
+protected:
+	struct WorkerQueue {
+		std::mutex       Mutex;
+		std::deque<Task> Tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> _queues;
+	std::vector<std::thread>                  _threads;
+
+	// Used to hand out tasks to queues in a round robin fashion
+	std::atomic<uint32_t> _nextQueue;
+	// The number of tasks that are sitting in queues, used so that idle workers can sleep
+	std::atomic<uint32_t> _queuedTasks;
+
+	std::mutex              _sleepMutex;
+	std::condition_variable _wakeCondition;
+	bool                    _isRunning;
+
+	// The pool that owns the current thread, if any
+	static thread_local ThreadPool* _currentPool;
+
+	/// <summary>
+	/// Attempts to run a single task, starting with the given queue and then stealing from
+	/// the other queues
+	/// </summary>
+	/// <param name="queueIndex">The queue to check first</param>
+	/// <returns>True if a task was run, false if all queues were empty</returns>
+	bool _TryRunTask(uint32_t queueIndex);
+
+	void _WorkerMain(uint32_t queueIndex);
+};
@@ -11,4 +11,14 @@ namespace detail {
 } // detail::
 
 template<class T, class Arg>
-struct test_json : decltype(detail::test_json<T, Arg>(0)){};
\ No newline at end of file
+struct test_json : decltype(detail::test_json<T, Arg>(0)){};
+
+namespace detail {
+	template<class T, class A0>
+	static auto test_decode_json(int)->sfinae_true<decltype(std::declval<T>().DecodeFromJson(std::declval<A0>()))>;
+	template<class, class A0>
+	static auto test_decode_json(long)->std::false_type;
+} // detail::
+
+template<class T, class Arg>
+struct test_decode_json : decltype(detail::test_decode_json<T, Arg>(0)){};